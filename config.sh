@@ -52,6 +52,8 @@ if __name__ == '__main__':
             help='A directory to search for prefetchers')
     search_group.add_argument('--replacement-dir', action='append', default=[], metavar='DIR',
             help='A directory to search for replacement policies')
+    search_group.add_argument('--memdep-dir', action='append', default=[], metavar='DIR',
+            help='A directory to search for memory dependence predictors')
 
     parser.add_argument('--compile-all-modules', action='store_true',
             help='Compile all modules in the search path')
@@ -71,7 +73,7 @@ if __name__ == '__main__':
     parsed_test = config.parse.parse_config({'executable_name': '000-test-main'}, module_dir=[os.path.join(test_root, 'cpp', 'modules')], compile_all_modules=True)
 
     parsed_configs = (
-            config.parse.parse_config(*c, module_dir=args.module_dir, branch_dir=args.branch_dir, btb_dir=args.btb_dir, pref_dir=args.prefetcher_dir, repl_dir=args.replacement_dir, compile_all_modules=args.compile_all_modules)
+            config.parse.parse_config(*c, module_dir=args.module_dir, branch_dir=args.branch_dir, btb_dir=args.btb_dir, pref_dir=args.prefetcher_dir, repl_dir=args.replacement_dir, memdep_dir=args.memdep_dir, compile_all_modules=args.compile_all_modules)
         for c in config_files)
 
     with config.filewrite.writer(bindir_name, objdir_name) as wr:
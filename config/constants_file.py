@@ -29,6 +29,7 @@ def get_constants_file(env, pmem):
         'constexpr std::size_t DRAM_CHANNELS = {channels};'.format(**pmem),
         'constexpr std::size_t DRAM_RANKS = {ranks};'.format(**pmem),
         'constexpr std::size_t DRAM_BANKS = {banks};'.format(**pmem),
+        'constexpr std::size_t DRAM_BANK_GROUPS = {bank_groups};'.format(**pmem),
         'constexpr std::size_t DRAM_ROWS = {rows};'.format(**pmem),
         'constexpr std::size_t DRAM_COLUMNS = {columns};'.format(**pmem),
         'constexpr std::size_t DRAM_CHANNEL_WIDTH = {channel_width};'.format(**pmem),
@@ -14,22 +14,42 @@
 
 import itertools
 import functools
+import json
 import operator
 
 from . import util
 
-pmem_fmtstr = 'MEMORY_CONTROLLER {name}{{{frequency}, {io_freq}, {tRP}, {tRCD}, {tCAS}, {turn_around_time}, {{{_ulptr}}}}};'
-vmem_fmtstr = 'VirtualMemory vmem{{{pte_page_size}, {num_levels}, {minor_fault_penalty}, {dram_name}}};'
+pmem_timing_fmtstr = 'champsim::dram_timing_parameters{{{tRP}, {tRCD}, {tCAS}, {tRAS}, {tWR}, {tRTP}, {tWTR_S}, {tWTR_L}, {tRRD_S}, {tRRD_L}, {tCCD_S}, {tCCD_L}, {tFAW}, {tREFI}, {tRFC}, {tRFCsb}, {turn_around_time}, {_refresh}}}'
+pmem_refresh_modes = { 'none': 'NONE', 'all_bank': 'ALL_BANK', 'same_bank': 'SAME_BANK' }
+pmem_address_mappings = { 'row_rank_column_bank_channel': 'row_rank_column_bank_channel', 'row_rank_bank_channel_column': 'row_rank_bank_channel_column', 'permutation': 'permutation', 'xor': 'xor_hash' }
+pmem_row_policies = { 'open': 'OPEN', 'closed': 'CLOSED', 'timeout': 'TIMEOUT', 'adaptive': 'ADAPTIVE' }
+vmem_placements = { 'first_touch': 'FIRST_TOUCH', 'interleave': 'INTERLEAVE', 'hot_page': 'HOT_PAGE' }
+vmem_huge_policies = { 'none': 'NONE', 'fixed': 'FIXED', 'promote': 'PROMOTE' }
+vmem_fmtstr = 'VirtualMemory vmem{{{pte_page_size}, {num_levels}, {minor_fault_penalty}, {{{_tiers}}}, champsim::page_placement::{_placement}, {promotion_threshold}, {_huge_pages}, {_allocation}}};'
+vmem_allocations = { 'sequential': 'SEQUENTIAL', 'random': 'RANDOM', 'colored': 'COLORED', 'fragmented': 'FRAGMENTED' }
+vmem_allocation_fmtstr = 'champsim::page_allocation_config{{champsim::page_allocation::{_policy}, {allocation_seed}, {page_colors}, {fragment_pages}}}'
+vmem_huge_fmtstr = 'champsim::huge_page_config{{champsim::huge_page_policy::{_policy}, {huge_page_size}, {huge_page_fraction}, {huge_page_promotion_threshold}}}'
+
+cache_arbiter_policies = { 'priority': 'PRIORITY', 'confidence': 'CONFIDENCE' }
+cache_arbiter_fmtstr = 'champsim::prefetch_arbiter::config_type{{champsim::prefetch_arbiter::policy::{_policy}, {issue_budget}, {filter_size}, {queue_size}, {{{_priority}}}}}'
+
+cache_throttle_fmtstr = 'champsim::prefetch_throttle::config_type{{{interval}, {{{_degrees}}}, {accuracy_high}, {accuracy_low}, {lateness}, {pollution}, {bandwidth_high}, {pollution_filter_size}}}'
+
+cache_pq_policy_fmtstr = 'champsim::prefetch_queue_policy{{{confidence_order:b}, {drop_redundant:b}, {max_age}, {mshr_reserve}}}'
+
+cache_sandbox_fmtstr = 'champsim::prefetch_sandbox::config_type{{{interval}, {shadow_sets}, {shadow_ways}, {accuracy_threshold}}}'
 
 queue_fmtstr = 'champsim::channel {name}{{{rq_size}, {pq_size}, {wq_size}, {_offset_bits}, {_queue_check_full_addr:b}}};'
 
 core_builder_parts = {
+    'ftq_size': '.ftq_size({ftq_size})',
     'ifetch_buffer_size': '.ifetch_buffer_size({ifetch_buffer_size})',
     'decode_buffer_size': '.decode_buffer_size({dispatch_buffer_size})',
     'dispatch_buffer_size': '.dispatch_buffer_size({decode_buffer_size})',
     'rob_size': '.rob_size({rob_size})',
     'lq_size': '.lq_size({lq_size})',
     'sq_size': '.sq_size({sq_size})',
+    'prediction_width': '.prediction_width({prediction_width})',
     'fetch_width': '.fetch_width({fetch_width})',
     'decode_width': '.decode_width({decode_width})',
     'dispatch_width': '.dispatch_width({dispatch_width})',
@@ -43,11 +63,19 @@ core_builder_parts = {
     'dispatch_latency': '.dispatch_latency({dispatch_latency})',
     'schedule_latency': '.schedule_latency({schedule_latency})',
     'execute_latency': '.execute_latency({execute_latency})',
+    'memory_replay_penalty': '.memory_replay_penalty({memory_replay_penalty})',
     'dib_set': '  .dib_set({dib_set})',
     'dib_way': '  .dib_way({dib_way})',
     'dib_window': '  .dib_window({dib_window})'
 }
 
+exec_port_classes = {
+    'alu': 'instr_class::ALU',
+    'branch': 'instr_class::BRANCH',
+    'load': 'instr_class::LOAD',
+    'store': 'instr_class::STORE'
+}
+
 dib_builder_parts = {
     'sets': '  .dib_set({DIB[sets]})',
     'ways': '  .dib_way({DIB[ways]})',
@@ -82,6 +110,45 @@ def vector_string(iterable):
         return hoisted[0]
     return '{'+', '.join(hoisted)+'}'
 
+# Module parameters are given to the simulator as strings, and are parsed by the module that declares them
+def module_parameters_string(params):
+    def value_string(value):
+        if isinstance(value, bool):
+            return 'true' if value else 'false'
+        return str(value)
+    return '{'+', '.join('{{{}, {}}}'.format(json.dumps(str(k)), json.dumps(value_string(v))) for k,v in params.items())+'}'
+
+# An arbiter may be enabled with true, or configured with a dictionary. The prefetchers are given priority in the order they are listed.
+def prefetch_arbiter_string(arbiter, prefetcher_data):
+    if not isinstance(arbiter, dict):
+        arbiter = {}
+    return cache_arbiter_fmtstr.format(
+            _policy=cache_arbiter_policies[arbiter.get('policy', 'priority')],
+            _priority=', '.join('CACHE::p{}'.format(k['name']) for k in prefetcher_data),
+            **util.chain(arbiter, {'issue_budget': 1, 'filter_size': 64, 'queue_size': 32}))
+
+# A throttle may be enabled with true, or configured with a dictionary
+def prefetch_throttle_string(throttle):
+    if not isinstance(throttle, dict):
+        throttle = {}
+    defaults = {
+        'interval': 8192, 'degrees': [1, 2, 4, 8, 16], 'accuracy_high': 0.75, 'accuracy_low': 0.40,
+        'lateness': 0.01, 'pollution': 0.005, 'bandwidth_high': 0.75, 'pollution_filter_size': 4096
+    }
+    throttle = {**defaults, **throttle}
+    return cache_throttle_fmtstr.format(_degrees=', '.join(str(d) for d in throttle['degrees']), **throttle)
+
+def prefetch_queue_policy_string(policy):
+    defaults = { 'confidence_order': False, 'drop_redundant': False, 'max_age': 0, 'mshr_reserve': 0 }
+    return cache_pq_policy_fmtstr.format(**{**defaults, **policy})
+
+# A sandbox may be enabled with true, or configured with a dictionary
+def prefetch_sandbox_string(sandbox):
+    if not isinstance(sandbox, dict):
+        sandbox = {}
+    defaults = { 'interval': 32768, 'shadow_sets': 256, 'shadow_ways': 8, 'accuracy_threshold': 0.25 }
+    return cache_sandbox_fmtstr.format(**{**defaults, **sandbox})
+
 def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
     upper_level_pairs = tuple(itertools.chain(
         ((elem['lower_level'], elem['name']) for elem in ptws),
@@ -118,10 +185,37 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
             yield queue_fmtstr.format(name='{}_to_{}_queues'.format(ul, ll), **v)
     yield ''
 
-    yield pmem_fmtstr.format(
-            _ulptr=vector_string('&{}_to_{}_queues'.format(ul, pmem['name']) for ul in upper_levels[pmem['name']]['uppers']),
-            **pmem)
-    yield vmem_fmtstr.format(dram_name=pmem['name'], **vmem)
+    # Each memory tier serves its own address range, taking its requests from the queues to the physical memory
+    memories = (pmem, *pmem.get('tiers', []))
+    for i,mem in enumerate(memories):
+        yield 'MEMORY_CONTROLLER {name}{{MEMORY_CONTROLLER::Builder{{}}'.format(**mem)
+        yield '.name("{name}")'.format(**mem)
+        yield '.frequency({frequency})'.format(**mem)
+        yield '.io_freq({io_freq})'.format(**mem)
+        yield '.timing({})'.format(pmem_timing_fmtstr.format(_refresh='champsim::dram_refresh_mode::'+pmem_refresh_modes[mem['refresh']], **mem))
+        yield '.scheduler_age_cap({scheduler_age_cap})'.format(**mem)
+        yield '.address_mapping(champsim::dram_address_mapping::{}())'.format(pmem_address_mappings[mem['address_mapping']])
+        yield '.row_policy(champsim::dram_row_policy::{}, {})'.format(pmem_row_policies[mem['row_policy']], mem['row_policy_timeout'])
+        if len(memories) > 1:
+            yield '.address_range({} * MEMORY_CONTROLLER::CAPACITY, MEMORY_CONTROLLER::CAPACITY)'.format(i)
+        if mem.get('link_latency', 0):
+            yield '.link_latency({link_latency})'.format(**mem)
+        if vmem.get('placement') == 'hot_page':
+            yield '.virtual_memory(&vmem)'
+        yield '.upper_levels({{{}}})'.format(vector_string('&{}_to_{}_queues'.format(ul, pmem['name']) for ul in upper_levels[pmem['name']]['uppers']))
+        yield '};'
+        yield ''
+
+    yield vmem_fmtstr.format(
+            _tiers=', '.join('{name}'.format(**mem) for mem in memories),
+            _placement=vmem_placements[vmem.get('placement', 'first_touch')],
+            _huge_pages=vmem_huge_fmtstr.format(
+                _policy=vmem_huge_policies[vmem.get('huge_pages', 'none')],
+                **util.chain(vmem, {'huge_page_size': (1 << 21), 'huge_page_fraction': 0, 'huge_page_promotion_threshold': 0})),
+            _allocation=vmem_allocation_fmtstr.format(
+                _policy=vmem_allocations[vmem.get('page_allocation', 'sequential')],
+                **util.chain(vmem, {'allocation_seed': 0, 'page_colors': 1, 'fragment_pages': 16})),
+            **util.chain(vmem, {'promotion_threshold': 0}))
 
     for ptw in ptws:
         yield 'PageTableWalker {name}{{PageTableWalker::Builder{{champsim::defaults::default_ptw}}'.format(**ptw)
@@ -176,6 +270,21 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
         if elem.get('_prefetcher_data'):
             yield '.prefetcher<{}>()'.format(' | '.join('CACHE::p{}'.format(k['name']) for k in elem['_prefetcher_data']))
 
+        if elem.get('prefetch_arbiter'):
+            yield '.prefetch_arbiter({})'.format(prefetch_arbiter_string(elem['prefetch_arbiter'], elem.get('_prefetcher_data', [])))
+
+        if elem.get('prefetch_throttle'):
+            yield '.prefetch_throttle({})'.format(prefetch_throttle_string(elem['prefetch_throttle']))
+
+        if elem.get('prefetch_queue'):
+            yield '.prefetch_queue_policy({})'.format(prefetch_queue_policy_string(elem['prefetch_queue']))
+
+        if elem.get('prefetch_sandbox'):
+            yield '.prefetch_sandbox({})'.format(prefetch_sandbox_string(elem['prefetch_sandbox']))
+
+        if elem.get('prefetcher_params'):
+            yield '.prefetcher_parameters({})'.format(module_parameters_string(elem['prefetcher_params']))
+
         yield '.upper_levels({{{}}})'.format(vector_string('&{}_to_{}_queues'.format(ul, elem['name']) for ul in upper_levels[elem['name']]['uppers']))
         yield '.lower_level({})'.format('&{}_to_{}_queues'.format(elem['name'], elem['lower_level']))
 
@@ -197,10 +306,15 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
         yield from (v.format(**cpu) for k,v in core_builder_parts.items() if k in cpu)
         yield from (v.format(**cpu['DIB']) for k,v in dib_builder_parts.items() if k in cpu)
 
+        for k,v in cpu.get('execution_ports', {}).items():
+            yield '.execution_port({_class}, {count}, {latency}, {pipelined:b})'.format(_class=exec_port_classes[k], **{'count': 1, 'latency': 1, 'pipelined': True, **v})
+
         if cpu.get('_branch_predictor_data'):
             yield '.branch_predictor<{}>()'.format(' | '.join('O3_CPU::b{}'.format(k['name']) for k in cpu['_branch_predictor_data']))
         if cpu.get('_btb_data'):
             yield '.btb<{}>()'.format(' | '.join('O3_CPU::t{}'.format(k['name']) for k in cpu['_btb_data']))
+        if cpu.get('_memdep_data'):
+            yield '.memory_dependence_predictor<{}>()'.format(' | '.join('O3_CPU::m{}'.format(k['name']) for k in cpu['_memdep_data']))
 
         yield '.fetch_queues({})'.format('&{}_to_{}_queues'.format(cpu['name'], cpu['L1I']))
         yield '.data_queues({})'.format('&{}_to_{}_queues'.format(cpu['name'], cpu['L1D']))
@@ -233,9 +347,19 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
     yield 'MEMORY_CONTROLLER& dram_view() override {{ return {}; }}'.format(pmem['name'])
     yield ''
 
+    yield 'std::vector<std::reference_wrapper<MEMORY_CONTROLLER>> memory_view() override {'
+    yield '  return {'
+    yield '    ' + ', '.join('{name}'.format(**elem) for elem in memories)
+    yield '  };'
+    yield '}'
+    yield ''
+
+    yield 'VirtualMemory& vmem_view() override { return vmem; }'
+    yield ''
+
     yield 'std::vector<std::reference_wrapper<champsim::operable>> operable_view() override {'
     yield '  return {'
-    yield '    ' + ', '.join('{name}'.format(**elem) for elem in itertools.chain(cores, ptws, caches, (pmem,)))
+    yield '    ' + ', '.join('{name}'.format(**elem) for elem in itertools.chain(cores, ptws, caches, memories))
     yield '  };'
     yield '}'
     yield ''
@@ -44,7 +44,7 @@ class ModuleSearchContext:
         files = itertools.starmap(os.path.join, itertools.chain(*(zip(itertools.repeat(b), d) for b,d,_ in base_dirs)))
         return [self.data_from_path(f) for f in files]
 
-# A unifying function for the four module types to return their information
+# A unifying function for the five module types to return their information
 def data_getter(prefix, module_name, funcs):
     return {
         'name': module_name,
@@ -58,6 +58,9 @@ def get_branch_data(module_name):
 def get_btb_data(module_name):
     return data_getter('btb', module_name, ('initialize_btb', 'update_btb', 'btb_prediction'))
 
+def get_memdep_data(module_name):
+    return data_getter('mdp', module_name, ('initialize_memory_dependence_predictor', 'predict_load_dependence', 'dispatch_store', 'execute_store', 'memory_order_violation'))
+
 def get_pref_data(module_name, is_instruction_cache=False):
     prefix = 'ipref' if is_instruction_cache else 'pref'
     return util.chain(
@@ -108,36 +111,43 @@ def mangled_prohibited_definitions(fname, names, args=tuple(), rtype='void', *ta
     yield from ('[[{}]] {} {}({}) {{ throw std::runtime_error("Not implemented"); }}'.format(attrstring, rtype, name, argstring) for name in names)
 
 # Generate C++ code giving the declaration for a discriminator function. If the class name is given, the declaration is assumed to be outside the class declaration
-def discriminator_function_declaration(fname, rtype, args, varname, secondary_varname, classname):
-    yield 'template <unsigned long long {}, unsigned long long {}>'.format(*sorted([varname, secondary_varname]))
+def discriminator_function_declaration(fname, rtype, args, varnames, classname):
+    yield 'template <{}>'.format(', '.join('unsigned long long ' + v for v in varnames))
     argstring = ', '.join((a[0]+' '+a[1]) for a in args)
     yield '{} {}::impl_{}({})'.format(rtype, classname, fname, argstring)
 
+# Generate C++ code for one branch of a discriminator function, which makes the call if the module is selected.
+# If a prologue is given, it is formatted with the class name and the module's key and placed before the call.
+def discriminator_branch(call, varname, classname, key, condition, prologue):
+    if prologue is None:
+        return '  {} (({} & {}::{}) != 0) {}'.format(condition, varname, classname, key, call)
+    return '  {} (({} & {}::{}) != 0) {{ {} {} }}'.format(condition, varname, classname, key, prologue.format(classname=classname, key=key), call)
+
 # Generate C++ code for the body of a discriminator function that returns void
-def discriminator_function_definition_void(fname, args, varname, zipped_keys_and_funcs, classname):
+def discriminator_function_definition_void(fname, args, varname, zipped_keys_and_funcs, classname, condition='if constexpr', prologue=None):
     # Discriminate between the module variants
-    yield from ('  if constexpr (({} & {}::{}) != 0) intern_->{}({});'.format(varname, classname, k, n, ', '.join(a[1] for a in args)) for k,n in zipped_keys_and_funcs)
+    yield from (discriminator_branch('intern_->{}({});'.format(n, ', '.join(a[1] for a in args)), varname, classname, k, condition, prologue) for k,n in zipped_keys_and_funcs)
 
 # Generate C++ code for the body of a discriminator function that returns nonvoid
-def discriminator_function_definition_nonvoid(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname):
+def discriminator_function_definition_nonvoid(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname, condition='if constexpr', prologue=None):
     # Declare result
     yield '  ' + rtype + ' result{};'
     yield '  ' + join_op + '<decltype(result)> joiner{};'
 
     # Discriminate between the module variants
-    yield from ('  if constexpr (({} & {}::{}) != 0) result = joiner(result, intern_->{}({}));'.format(varname, classname, k, n, ', '.join(a[1] for a in args)) for k,n in zipped_keys_and_funcs)
+    yield from (discriminator_branch('result = joiner(result, intern_->{}({}));'.format(n, ', '.join(a[1] for a in args)), varname, classname, k, condition, prologue) for k,n in zipped_keys_and_funcs)
 
     # Return result
     yield '  return result;'
 
 # Generate C++ code for the body of a discriminator function
-def discriminator_function_definition(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname):
+def discriminator_function_definition(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname, condition='if constexpr', prologue=None):
     yield '{'
 
     if rtype == 'void':
-        yield from discriminator_function_definition_void(fname, args, varname, zipped_keys_and_funcs, classname)
+        yield from discriminator_function_definition_void(fname, args, varname, zipped_keys_and_funcs, classname, condition, prologue)
     else:
-        yield from discriminator_function_definition_nonvoid(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname)
+        yield from discriminator_function_definition_nonvoid(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname, condition, prologue)
 
     yield '}'
 
@@ -147,9 +157,33 @@ def get_module_variant_declarations(fname, fnamelist, args=tuple(), rtype='void'
     yield ''
 
 # For a given module function, generate C++ code defining the discriminator function
-def get_discriminator(fname, varname, secondary_varname, zipped_keys_and_funcs, args=tuple(), rtype='void', join_op=None, *tail, classname=None):
-    yield from discriminator_function_declaration(fname, rtype, args, varname, secondary_varname, classname)
-    yield from discriminator_function_definition(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname.split(':')[0])
+def get_discriminator(fname, varname, template_varnames, zipped_keys_and_funcs, args=tuple(), rtype='void', join_op=None, *tail, classname=None, prologue=None):
+    yield from discriminator_function_declaration(fname, rtype, args, template_varnames, classname)
+    yield from discriminator_function_definition(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname.split(':')[0], prologue=prologue)
+    yield ''
+
+# For a given module function, generate C++ code defining the discriminator function of the model that selects its modules at run time.
+# Only the compiled modules may be named here, since the definition refers to their functions whether or not they are selected.
+def get_dynamic_discriminator(fname, varname, zipped_keys_and_funcs, args=tuple(), rtype='void', join_op=None, *tail, classname=None, prologue=None):
+    if not zipped_keys_and_funcs:
+        # No modules of this kind were compiled, so the arguments are unused
+        argstring = ', '.join(a[0] for a in args)
+        yield 'inline {} {}::impl_{}({}) {{ {}}}'.format(rtype, classname, fname, argstring, '' if rtype == 'void' else 'return {}; ')
+    else:
+        argstring = ', '.join((a[0]+' '+a[1]) for a in args)
+        yield 'inline {} {}::impl_{}({})'.format(rtype, classname, fname, argstring)
+        yield from discriminator_function_definition(fname, rtype, join_op, args, varname, zipped_keys_and_funcs, classname.split(':')[0], condition='if', prologue=prologue)
+    yield ''
+
+# Generate C++ code defining the registry that maps the names of the compiled modules to their constants
+def get_module_registry(funcname, prefix, mod_data, classname):
+    yield 'inline const champsim::module_registry& {}::{}()'.format(classname, funcname)
+    yield '{'
+    yield '  static const champsim::module_registry registry{'
+    yield from ('    {{"{}", {}::{}{}}},'.format(os.path.basename(os.path.normpath(data['fname'])), classname, prefix, data['name']) for data in mod_data)
+    yield '  };'
+    yield '  return registry;'
+    yield '}'
     yield ''
 
 # For a set of module data, generate C++ code defining the constants that distinguish the modules
@@ -157,7 +191,7 @@ def constants_for_modules(prefix, mod_data):
     yield from ('constexpr static unsigned long long {0}{2:{prec}} = 1ull << {1};'.format(prefix, n, data['name'], prec=max(len(k['name']) for k in mod_data)) for n,data in enumerate(mod_data))
 
 # Return a pair containing two generators: The first generates C++ code declaring all functions for the O3_CPU modules, and the second generates C++ code defining the functions
-def get_ooo_cpu_module_lines(branch_data, btb_data):
+def get_ooo_cpu_module_lines(branch_data, btb_data, memdep_data, compiled=None):
     branch_prefix = 'b'
     branch_varname = 'B_FLAG'
     branch_variant_data = [
@@ -174,26 +208,53 @@ def get_ooo_cpu_module_lines(branch_data, btb_data):
         ('btb_prediction', (('uint64_t','ip'),), 'std::pair<uint64_t, uint8_t>', 'champsim::detail::take_last')
     ]
 
-    classname = 'O3_CPU::module_model<' + branch_varname + ', ' + btb_varname + '>'
+    memdep_prefix = 'm'
+    memdep_varname = 'M_FLAG'
+    memdep_variant_data = [
+        ('initialize_memory_dependence_predictor',),
+        ('predict_load_dependence', (('uint64_t','ip'),), 'uint64_t', 'champsim::detail::take_last'),
+        ('dispatch_store', (('uint64_t','ip'), ('uint64_t','instr_id'))),
+        ('execute_store', (('uint64_t','ip'), ('uint64_t','instr_id'))),
+        ('memory_order_violation', (('uint64_t','load_ip'), ('uint64_t','store_ip')))
+    ]
+
+    template_varnames = (branch_varname, btb_varname, memdep_varname)
+    classname = 'O3_CPU::module_model<' + ', '.join(template_varnames) + '>'
+    dynamic_classname = 'O3_CPU::dynamic_module_model'
+
+    compiled_branch_data = [v for k,v in branch_data.items() if compiled is None or k in compiled]
+    compiled_btb_data = [v for k,v in btb_data.items() if compiled is None or k in compiled]
+    compiled_memdep_data = [v for k,v in memdep_data.items() if compiled is None or k in compiled]
 
     return (
         itertools.chain(
             constants_for_modules(branch_prefix, branch_data.values()), ('',),
             constants_for_modules(btb_prefix, btb_data.values()), ('',),
+            constants_for_modules(memdep_prefix, memdep_data.values()), ('',),
 
             # Declare name-mangled functions
             *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in branch_data.values()], *finfo) for fname, *finfo in branch_variant_data),
-            *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in btb_data.values()], *finfo) for fname, *finfo in btb_variant_data)
+            *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in btb_data.values()], *finfo) for fname, *finfo in btb_variant_data),
+            *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in memdep_data.values()], *finfo) for fname, *finfo in memdep_variant_data)
         ),
 
         itertools.chain(
-            *(get_discriminator(fname, branch_varname, btb_varname, [(branch_prefix + v['name'], v['func_map'][fname]) for v in branch_data.values()], *finfo, classname=classname) for fname, *finfo in branch_variant_data),
-            *(get_discriminator(fname, btb_varname, branch_varname, [(btb_prefix + v['name'], v['func_map'][fname]) for v in btb_data.values()], *finfo, classname=classname) for fname, *finfo in btb_variant_data)
+            *(get_discriminator(fname, branch_varname, template_varnames, [(branch_prefix + v['name'], v['func_map'][fname]) for v in branch_data.values()], *finfo, classname=classname) for fname, *finfo in branch_variant_data),
+            *(get_discriminator(fname, btb_varname, template_varnames, [(btb_prefix + v['name'], v['func_map'][fname]) for v in btb_data.values()], *finfo, classname=classname) for fname, *finfo in btb_variant_data),
+            *(get_discriminator(fname, memdep_varname, template_varnames, [(memdep_prefix + v['name'], v['func_map'][fname]) for v in memdep_data.values()], *finfo, classname=classname) for fname, *finfo in memdep_variant_data),
+
+            *(get_dynamic_discriminator(fname, 'b_flags', [(branch_prefix + v['name'], v['func_map'][fname]) for v in compiled_branch_data], *finfo, classname=dynamic_classname) for fname, *finfo in branch_variant_data),
+            *(get_dynamic_discriminator(fname, 't_flags', [(btb_prefix + v['name'], v['func_map'][fname]) for v in compiled_btb_data], *finfo, classname=dynamic_classname) for fname, *finfo in btb_variant_data),
+            *(get_dynamic_discriminator(fname, 'm_flags', [(memdep_prefix + v['name'], v['func_map'][fname]) for v in compiled_memdep_data], *finfo, classname=dynamic_classname) for fname, *finfo in memdep_variant_data),
+
+            get_module_registry('branch_predictor_registry', branch_prefix, compiled_branch_data, 'O3_CPU'),
+            get_module_registry('btb_registry', btb_prefix, compiled_btb_data, 'O3_CPU'),
+            get_module_registry('memory_dependence_predictor_registry', memdep_prefix, compiled_memdep_data, 'O3_CPU')
         )
        )
 
 # Return a pair containing two generators: The first generates C++ code declaring all functions for the cache modules, and the second generates C++ code defining the functions
-def get_cache_module_lines(pref_data, repl_data):
+def get_cache_module_lines(pref_data, repl_data, compiled=None):
     pref_prefix = 'p'
     pref_varname = 'P_FLAG'
 
@@ -219,7 +280,15 @@ def get_cache_module_lines(pref_data, repl_data):
         ('replacement_final_stats',)
     ]
 
-    classname = 'CACHE::module_model<' + pref_varname + ', ' + repl_varname + '>'
+    # Record which prefetcher is running, so that the prefetches it issues can be attributed to it
+    pref_prologue = 'intern_->active_prefetcher = {classname}::{key};'
+
+    template_varnames = (pref_varname, repl_varname)
+    classname = 'CACHE::module_model<' + ', '.join(template_varnames) + '>'
+    dynamic_classname = 'CACHE::dynamic_module_model'
+
+    compiled_pref_data = [v for k,v in pref_data.items() if compiled is None or k in compiled]
+    compiled_repl_data = [v for k,v in repl_data.items() if compiled is None or k in compiled]
 
     return (
         itertools.chain(
@@ -239,7 +308,13 @@ def get_cache_module_lines(pref_data, repl_data):
         ),
 
         itertools.chain(
-            *(get_discriminator(fname, pref_varname, repl_varname, [(pref_prefix + v['name'], v['func_map'][fname]) for v in pref_data.values()], *finfo, classname=classname) for fname, *finfo in itertools.chain(pref_nonbranch_variant_data, pref_branch_variant_data)),
-            *(get_discriminator(fname, repl_varname, pref_varname, [(repl_prefix + v['name'], v['func_map'][fname]) for v in repl_data.values()], *finfo, classname=classname) for fname, *finfo in repl_variant_data)
+            *(get_discriminator(fname, pref_varname, template_varnames, [(pref_prefix + v['name'], v['func_map'][fname]) for v in pref_data.values()], *finfo, classname=classname, prologue=pref_prologue) for fname, *finfo in itertools.chain(pref_nonbranch_variant_data, pref_branch_variant_data)),
+            *(get_discriminator(fname, repl_varname, template_varnames, [(repl_prefix + v['name'], v['func_map'][fname]) for v in repl_data.values()], *finfo, classname=classname) for fname, *finfo in repl_variant_data),
+
+            *(get_dynamic_discriminator(fname, 'p_flags', [(pref_prefix + v['name'], v['func_map'][fname]) for v in compiled_pref_data], *finfo, classname=dynamic_classname, prologue=pref_prologue) for fname, *finfo in itertools.chain(pref_nonbranch_variant_data, pref_branch_variant_data)),
+            *(get_dynamic_discriminator(fname, 'r_flags', [(repl_prefix + v['name'], v['func_map'][fname]) for v in compiled_repl_data], *finfo, classname=dynamic_classname) for fname, *finfo in repl_variant_data),
+
+            get_module_registry('prefetcher_registry', pref_prefix, compiled_pref_data, 'CACHE'),
+            get_module_registry('replacement_registry', repl_prefix, compiled_repl_data, 'CACHE')
         )
        )
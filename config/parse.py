@@ -23,8 +23,26 @@ from . import util
 
 default_root = { 'block_size': 64, 'page_size': 4096, 'heartbeat_frequency': 10000000, 'num_cores': 1 }
 default_core = { 'frequency' : 4000 }
-default_pmem = { 'name': 'DRAM', 'frequency': 3200, 'channels': 1, 'ranks': 1, 'banks': 8, 'rows': 65536, 'columns': 128, 'lines_per_column': 8, 'channel_width': 8, 'wq_size': 64, 'rq_size': 64, 'tRP': 12.5, 'tRCD': 12.5, 'tCAS': 12.5, 'turn_around_time': 7.5 }
-default_vmem = { 'pte_page_size': (1 << 12), 'num_levels': 5, 'minor_fault_penalty': 200 }
+default_pmem = { 'name': 'DRAM', 'frequency': 3200, 'channels': 1, 'ranks': 1, 'banks': 8, 'rows': 65536, 'columns': 128, 'lines_per_column': 8, 'channel_width': 8, 'wq_size': 64, 'rq_size': 64, 'bank_groups': 2, 'tRP': 12.5, 'tRCD': 12.5, 'tCAS': 12.5, 'tRAS': 32, 'tWR': 15, 'tRTP': 7.5, 'tWTR_S': 2.5, 'tWTR_L': 7.5, 'tRRD_S': 5.3, 'tRRD_L': 6.4, 'tCCD_S': 2.5, 'tCCD_L': 5, 'tFAW': 30, 'tREFI': 7800, 'tRFC': 350, 'tRFCsb': 0, 'refresh': 'all_bank', 'turn_around_time': 7.5, 'scheduler_age_cap': 500, 'address_mapping': 'row_rank_column_bank_channel', 'row_policy': 'open', 'row_policy_timeout': 50, 'link_latency': 0 }
+
+# Standard parts, selected with the 'preset' key. Keys given in the configuration take precedence.
+pmem_presets = {
+    'DDR4-3200': { 'frequency': 3200, 'banks': 16, 'bank_groups': 4, 'channel_width': 8,
+        'tRP': 13.75, 'tRCD': 13.75, 'tCAS': 13.75, 'tRAS': 32, 'tWR': 15, 'tRTP': 7.5, 'tWTR_S': 2.5, 'tWTR_L': 7.5,
+        'tRRD_S': 2.5, 'tRRD_L': 4.9, 'tCCD_S': 2.5, 'tCCD_L': 5, 'tFAW': 21, 'tREFI': 7800, 'tRFC': 350, 'tRFCsb': 0, 'refresh': 'all_bank' },
+    'DDR5-4800': { 'frequency': 4800, 'banks': 32, 'bank_groups': 8, 'channel_width': 4,
+        'tRP': 16, 'tRCD': 16, 'tCAS': 16.67, 'tRAS': 32, 'tWR': 30, 'tRTP': 7.5, 'tWTR_S': 2.5, 'tWTR_L': 10,
+        'tRRD_S': 3.33, 'tRRD_L': 5, 'tCCD_S': 3.33, 'tCCD_L': 5, 'tFAW': 13.33, 'tREFI': 3900, 'tRFC': 295, 'tRFCsb': 130, 'refresh': 'same_bank' },
+    'DDR5-6400': { 'frequency': 6400, 'banks': 32, 'bank_groups': 8, 'channel_width': 4,
+        'tRP': 16, 'tRCD': 16, 'tCAS': 16.25, 'tRAS': 32, 'tWR': 30, 'tRTP': 7.5, 'tWTR_S': 2.5, 'tWTR_L': 10,
+        'tRRD_S': 2.5, 'tRRD_L': 5, 'tCCD_S': 2.5, 'tCCD_L': 5, 'tFAW': 10, 'tREFI': 3900, 'tRFC': 295, 'tRFCsb': 130, 'refresh': 'same_bank' }
+}
+default_vmem = { 'pte_page_size': (1 << 12), 'num_levels': 5, 'minor_fault_penalty': 200, 'placement': 'first_touch', 'promotion_threshold': 64,
+                'huge_pages': 'none', 'huge_page_size': (1 << 21), 'huge_page_fraction': 0, 'huge_page_promotion_threshold': 256,
+                'page_allocation': 'sequential', 'allocation_seed': 0, 'fragment_pages': 16 }
+
+# Additional memory tiers must share the geometry of the physical memory
+pmem_geometry_keys = ('channels', 'ranks', 'banks', 'bank_groups', 'rows', 'columns', 'lines_per_column', 'channel_width', 'wq_size', 'rq_size')
 
 cache_deprecation_keys = {
     'max_read': 'max_tag_check',
@@ -69,7 +87,7 @@ def normalize_config(config_file):
 
     # Default core elements
     # Give cores numeric indices
-    core_keys_to_copy = ('frequency', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'rob_size', 'lq_size', 'sq_size', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width', 'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency', 'schedule_latency', 'execute_latency', 'branch_predictor', 'btb', 'DIB')
+    core_keys_to_copy = ('frequency', 'ftq_size', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'rob_size', 'lq_size', 'sq_size', 'prediction_width', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width', 'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency', 'schedule_latency', 'execute_latency', 'branch_predictor', 'btb', 'memory_dependence_predictor', 'memory_replay_penalty', 'execution_ports', 'DIB')
     cores = [util.chain(cpu, util.subdict(config_file, core_keys_to_copy), {'name': 'cpu'+str(i), '_index': i}) for i,cpu in enumerate(cores)]
 
     pinned_cache_names = ('L1I', 'L1D', 'ITLB', 'DTLB', 'L2C', 'STLB')
@@ -114,12 +132,23 @@ def normalize_config(config_file):
 
     return cores, caches, ptws, config_file.get('physical_memory', {}), config_file.get('virtual_memory', {})
 
-def parse_normalized(cores, caches, ptws, pmem, vmem, merged_configs, branch_context, btb_context, prefetcher_context, replacement_context, compile_all_modules):
+def parse_normalized(cores, caches, ptws, pmem, vmem, merged_configs, branch_context, btb_context, prefetcher_context, replacement_context, memdep_context, compile_all_modules):
     config_file = util.chain(merged_configs, default_root)
 
-    pmem = util.chain(pmem, default_pmem)
+    if pmem.get('preset') is not None and pmem.get('preset') not in pmem_presets:
+        print('WARNING: unknown physical memory preset "{}". Known presets are: {}'.format(pmem.get('preset'), ', '.join(pmem_presets)))
+    pmem = util.chain(pmem, pmem_presets.get(pmem.get('preset'), {}), default_pmem)
     vmem = util.chain(vmem, default_vmem)
 
+    # Additional memory tiers inherit the parameters of the physical memory
+    tiers = [util.chain(tier, {'name': 'DRAM{}'.format(i+1), 'link_latency': 0}, pmem_presets.get(tier.get('preset'), {}), {k:v for k,v in pmem.items() if k not in ('tiers', 'name', 'preset')})
+             for i,tier in enumerate(pmem.get('tiers', []))]
+    for tier, key in itertools.product(tiers, pmem_geometry_keys):
+        if tier[key] != pmem[key]:
+            print('WARNING: memory tier {} has {} {}, but all tiers share the geometry of the physical memory. Using {}.'.format(tier['name'], key, tier[key], pmem[key]))
+            tier[key] = pmem[key]
+    pmem['tiers'] = tiers
+
     cores = [util.chain(cpu, {'DIB': dict()}, default_core) for cpu in cores]
 
     # Frequencies are the maximum of the upper levels, unless specified
@@ -160,8 +189,9 @@ def parse_normalized(cores, caches, ptws, pmem, vmem, merged_configs, branch_con
     # Remove caches that are inaccessible
     caches = filter_inaccessible(caches, [cpu[name] for cpu,name in itertools.product(cores, ('ITLB', 'DTLB', 'L1I', 'L1D'))])
 
-    pmem['io_freq'] = pmem['frequency'] # Save value
-    scale_frequencies(itertools.chain(cores, caches.values(), ptws.values(), (pmem,)))
+    for mem in (pmem, *pmem['tiers']):
+        mem['io_freq'] = mem['frequency'] # Save value
+    scale_frequencies(itertools.chain(cores, caches.values(), ptws.values(), (pmem,), pmem['tiers']))
 
     # TODO can these be removed in favor of the defaults in inc/defaults.hpp?
     # All cores have a default branch predictor and BTB
@@ -201,15 +231,21 @@ def parse_normalized(cores, caches, ptws, pmem, vmem, merged_configs, branch_con
 
     cores = list(util.combine_named(cores,
             ({'name': c['name'], '_branch_predictor_data': [branch_context.find(f) for f in util.wrap_list(c.get('branch_predictor',[]))]} for c in cores),
-            ({'name': c['name'], '_btb_data': [btb_context.find(f) for f in util.wrap_list(c.get('btb',[]))]} for c in cores)
+            ({'name': c['name'], '_btb_data': [btb_context.find(f) for f in util.wrap_list(c.get('btb',[]))]} for c in cores),
+            ({'name': c['name'], '_memdep_data': [memdep_context.find(f) for f in util.wrap_list(c.get('memory_dependence_predictor',[]))]} for c in cores)
             ).values())
 
+    # By default, the color of a page is the part of its page number that indexes the last-level cache
+    llc_sets = [c.get('sets', 1) for c in caches.values() if c.get('lower_level') == pmem['name']]
+    vmem.setdefault('page_colors', max(1, max(llc_sets, default=1) * config_file['block_size'] // config_file['page_size']))
+
     elements = {'cores': cores, 'caches': tuple(caches.values()), 'ptws': tuple(ptws.values()), 'pmem': pmem, 'vmem': vmem}
     module_info = {
             'repl': util.combine_named(*(c['_replacement_data'] for c in caches.values()), replacement_context.find_all()),
             'pref': util.combine_named(*(c['_prefetcher_data'] for c in caches.values()), prefetcher_context.find_all()),
             'branch': util.combine_named(*(c['_branch_predictor_data'] for c in cores), branch_context.find_all()),
-            'btb': util.combine_named(*(c['_btb_data'] for c in cores), btb_context.find_all())
+            'btb': util.combine_named(*(c['_btb_data'] for c in cores), btb_context.find_all()),
+            'memdep': util.combine_named(*(c['_memdep_data'] for c in cores), memdep_context.find_all())
             }
 
     if compile_all_modules:
@@ -219,7 +255,8 @@ def parse_normalized(cores, caches, ptws, pmem, vmem, merged_configs, branch_con
             *(c['_replacement_data'] for c in caches.values()),
             *(c['_prefetcher_data'] for c in caches.values()),
             *(c['_branch_predictor_data'] for c in cores),
-            *(c['_btb_data'] for c in cores)
+            *(c['_btb_data'] for c in cores),
+            *(c['_memdep_data'] for c in cores)
         ))]
 
     env_vars = ('CC', 'CXX', 'CPPFLAGS', 'CXXFLAGS', 'LDFLAGS', 'LDLIBS')
@@ -227,7 +264,7 @@ def parse_normalized(cores, caches, ptws, pmem, vmem, merged_configs, branch_con
 
     return elements, modules_to_compile, module_info, util.subdict(config_file, extern_config_file_keys), util.subdict(config_file, env_vars)
 
-def parse_config(*configs, module_dir=[], branch_dir=[], btb_dir=[], pref_dir=[], repl_dir=[], compile_all_modules=False):
+def parse_config(*configs, module_dir=[], branch_dir=[], btb_dir=[], pref_dir=[], repl_dir=[], memdep_dir=[], compile_all_modules=False):
     champsim_root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
 
     name = executable_name(*configs)
@@ -238,6 +275,7 @@ def parse_config(*configs, module_dir=[], branch_dir=[], btb_dir=[], pref_dir=[]
         btb_context = modules.ModuleSearchContext([*(os.path.join(m, 'btb') for m in module_dir), *btb_dir, os.path.join(champsim_root, 'btb')]),
         replacement_context = modules.ModuleSearchContext([*(os.path.join(m, 'replacement') for m in module_dir), *repl_dir, os.path.join(champsim_root, 'replacement')]),
         prefetcher_context = modules.ModuleSearchContext([*(os.path.join(m, 'prefetcher') for m in module_dir), *pref_dir, os.path.join(champsim_root, 'prefetcher')]),
+        memdep_context = modules.ModuleSearchContext([*(os.path.join(m, 'memdep') for m in module_dir), *memdep_dir, os.path.join(champsim_root, 'memdep')]),
         compile_all_modules = compile_all_modules
     )
 
@@ -246,6 +284,7 @@ def parse_config(*configs, module_dir=[], branch_dir=[], btb_dir=[], pref_dir=[]
             'pref': {k: util.chain(v, modules.get_pref_data(v['name'], v['_is_instruction_prefetcher'])) for k,v in module_info['pref'].items()},
             'branch': {k: util.chain(v, modules.get_branch_data(v['name'])) for k,v in module_info['branch'].items()},
             'btb': {k: util.chain(v, modules.get_btb_data(v['name'])) for k,v in module_info['btb'].items()},
+            'memdep': {k: util.chain(v, modules.get_memdep_data(v['name'])) for k,v in module_info['memdep'].items()},
             }
 
     return name, elements, modules_to_compile, module_info, config_file, env
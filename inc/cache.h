@@ -25,18 +25,64 @@
 #include <array>
 #include <bitset>
 #include <deque>
+#include <limits>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "champsim.h"
 #include "champsim_constants.h"
 #include "channel.h"
 #include "module_impl.h"
+#include "module_parameters.h"
 #include "operable.h"
+#include "prefetch_arbiter.h"
+#include "prefetch_sandbox.h"
+#include "prefetch_throttle.h"
 #include <type_traits>
 
+namespace champsim
+{
+struct prefetch_source_stats {
+  constexpr static std::size_t TIMELINESS_BUCKETS = 16;
+
+  std::string name;
+  uint64_t proposed = 0;  // calls to prefetch_line()
+  uint64_t duplicate = 0; // dropped by the arbiter because the block was issued recently, or was already waiting
+  uint64_t dropped = 0;   // dropped by the arbiter because its queue was full
+  uint64_t filtered = 0;  // dropped because the block was already in the cache, the MSHR, or the prefetch queue
+  uint64_t issued = 0;    // written to the prefetch queue, including those that were then discarded
+  uint64_t discarded = 0; // removed from the prefetch queue unchecked, or refused an MSHR entry, by the prefetch queue policy
+  uint64_t redundant = 0; // found the block already in the cache or in the MSHR
+  uint64_t filled = 0;
+  uint64_t useful = 0;    // hit by a demand access, including late prefetches
+  uint64_t late = 0;      // hit by a demand access while still in the MSHR
+  uint64_t useless = 0;   // evicted without being hit
+  uint64_t throttled = 0; // dropped because the prefetcher exceeded the degree its throttle allows
+  uint64_t dark = 0;      // evaluated by the sandbox but not issued, because another prefetcher was selected
+  uint64_t selected = 0;  // sandbox intervals in which the prefetcher was selected to issue
+
+  // The number of throttle intervals the prefetcher spent at each level of aggressiveness
+  std::vector<uint64_t> throttle_levels{};
+
+  // Bucket i counts prefetches whose distance lies in [2^i, 2^(i+1)) cycles, except that the first bucket also counts zero and the last counts all longer
+  // distances. Timely prefetches are measured from the fill to the first demand hit, and late prefetches from their issue to the arrival of the demand.
+  std::array<uint64_t, TIMELINESS_BUCKETS> timely_cycles{};
+  std::array<uint64_t, TIMELINESS_BUCKETS> late_cycles{};
+};
+
+// How a cache manages the prefetches of its own prefetchers. The defaults keep the prefetch queue first-in, first-out, and let prefetches take any MSHR entry.
+struct prefetch_queue_policy {
+  bool confidence_order = false; // order the queue by the confidence of each prefetch's prefetcher, and let a more confident prefetch displace the least
+  bool drop_redundant = false;   // drop prefetches to blocks that are already in the cache, the MSHR, or the queue
+  uint64_t max_age = 0;          // cycles a prefetch may wait in the queue before it is discarded, or zero to wait indefinitely
+  std::size_t mshr_reserve = 0;  // MSHR entries that prefetches may not take, left for demand misses
+};
+} // namespace champsim
+
 struct cache_stats {
   std::string name;
   // prefetch stats
@@ -46,6 +92,9 @@ struct cache_stats {
   uint64_t pf_useless = 0;
   uint64_t pf_fill = 0;
 
+  // Stats for each prefetcher of the cache, in the order of its sources
+  std::vector<champsim::prefetch_source_stats> pf_sources{};
+
   std::array<std::array<uint64_t, NUM_CPUS>, champsim::to_underlying(access_type::NUM_TYPES)> hits = {};
   std::array<std::array<uint64_t, NUM_CPUS>, champsim::to_underlying(access_type::NUM_TYPES)> misses = {};
 
@@ -53,6 +102,16 @@ struct cache_stats {
   uint64_t total_miss_latency = 0;
 };
 
+// The occupancy and size of each queue of a cache
+struct cache_occupancy {
+  uint64_t cycle = std::numeric_limits<uint64_t>::max(); // when the sample was taken
+  std::size_t mshr = 0, mshr_size = 0;
+  std::size_t internal_pq = 0, internal_pq_size = 0;
+
+  // One element for each upper level
+  std::vector<std::size_t> rq{}, rq_size{}, wq{}, wq_size{}, pq{}, pq_size{};
+};
+
 class CACHE : public champsim::operable
 {
   enum [[deprecated(
@@ -72,6 +131,7 @@ class CACHE : public champsim::operable
 
     uint32_t pf_metadata;
     uint32_t cpu;
+    std::size_t pf_source = 0;
 
     access_type type;
     bool prefetch_from_this;
@@ -79,6 +139,8 @@ class CACHE : public champsim::operable
     bool is_translated;
     bool translate_issued = false;
 
+    uint64_t cycle_enqueued = 0;
+
     uint8_t asid[2] = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
 
     uint64_t event_cycle = std::numeric_limits<uint64_t>::max();
@@ -99,6 +161,7 @@ class CACHE : public champsim::operable
 
     uint32_t pf_metadata;
     uint32_t cpu;
+    std::size_t pf_source;
 
     access_type type;
     bool prefetch_from_this;
@@ -108,6 +171,9 @@ class CACHE : public champsim::operable
     uint64_t event_cycle = std::numeric_limits<uint64_t>::max();
     uint64_t cycle_enqueued;
 
+    std::string_view served_by{};
+    unsigned page_bits = 0;
+
     std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
     std::vector<std::deque<response_type>*> to_return{};
 
@@ -134,6 +200,9 @@ class CACHE : public champsim::operable
     uint64_t data = 0;
 
     uint32_t pf_metadata = 0;
+    std::size_t pf_source = 0; // The source of the prefetcher that brought this block in
+    uint64_t fill_cycle = 0;
+    unsigned page_bits = 0; // In translation caches, the log2 of the size of the page, if larger than a block
 
     BLOCK() = default;
     explicit BLOCK(mshr_type mshr);
@@ -144,13 +213,36 @@ class CACHE : public champsim::operable
   std::pair<set_type::const_iterator, set_type::const_iterator> get_set_span(uint64_t address) const;
   std::size_t get_set_index(uint64_t address) const;
 
+  // Translation caches may hold entries for pages of several sizes. Entries larger than a block are placed in the set indexed by
+  // their page number, and every size that has been filled is probed on lookup.
+  std::vector<unsigned> larger_page_bits{};
+  uint64_t set_address(uint64_t address, unsigned page_bits) const;
+  auto matches_address(uint64_t address) const;
+  std::tuple<set_type::iterator, set_type::iterator, set_type::iterator> find_block(uint64_t address);
+  std::tuple<set_type::const_iterator, set_type::const_iterator, set_type::const_iterator> find_block(uint64_t address) const;
+
   template <typename T>
   bool should_activate_prefetcher(const T& pkt) const;
 
   template <bool>
   auto initiate_tag_check(champsim::channel* ul = nullptr);
 
+  bool issue_prefetch(const champsim::prefetch_arbiter::candidate& pf);
+
+  // The flag of each prefetcher, numbered as sources in the arbiter's order if there is one, or else in flag order
+  std::vector<unsigned long long> pf_source_flags{};
+  std::size_t pf_source_of(unsigned long long flag) const;
+  champsim::prefetch_source_stats* pf_source_stats(std::size_t source);
+  void record_useful_prefetch(std::size_t source, bool late, uint64_t cycles);
+  void record_useless_prefetch(std::size_t source);
+  void record_discarded_prefetch(std::size_t source);
+
+  // The fraction of the source's prefetches in this phase that were useful, with one of each assumed
+  double pf_source_confidence(std::size_t source) const;
+  bool prefetch_is_redundant(uint64_t address) const;
+
   std::deque<tag_lookup_type> internal_PQ{};
+  mutable cache_occupancy occupancy_sample{};
   std::deque<tag_lookup_type> inflight_tag_check{};
   std::deque<tag_lookup_type> translation_stash{};
 
@@ -164,6 +256,7 @@ public:
   const uint32_t NUM_SET, NUM_WAY, MSHR_SIZE;
   const std::size_t PQ_SIZE;
   const uint64_t HIT_LATENCY, FILL_LATENCY;
+  const uint64_t LATENCY; // The total latency the cache was configured with. A hit latency given with it takes precedence.
   const unsigned OFFSET_BITS;
   set_type block{NUM_SET * NUM_WAY};
   const long int MAX_TAG, MAX_FILL;
@@ -171,7 +264,25 @@ public:
   const bool match_offset_bits;
   const bool virtual_prefetch;
   bool ever_seen_data = false;
-  const unsigned pref_activate_mask = (1 << champsim::to_underlying(access_type::LOAD)) | (1 << champsim::to_underlying(access_type::PREFETCH));
+  unsigned pref_activate_mask = (1 << champsim::to_underlying(access_type::LOAD)) | (1 << champsim::to_underlying(access_type::PREFETCH));
+
+  // Run-time parameters for the prefetcher, read when the prefetcher is initialized
+  champsim::module_parameters prefetcher_params;
+
+  // Chooses among the prefetches of several prefetchers, if the cache was configured with one
+  std::optional<champsim::prefetch_arbiter> pf_arbiter{};
+
+  // Adapts the aggressiveness of the prefetchers to their accuracy and to the memory bandwidth, if the cache was configured with one
+  std::optional<champsim::prefetch_throttle> pf_throttle{};
+
+  // Evaluates the prefetchers without issuing their prefetches, and selects the one that issues, if the cache was configured with one
+  std::optional<champsim::prefetch_sandbox> pf_sandbox{};
+
+  // How the prefetches of this cache's prefetchers are queued and given MSHR entries
+  champsim::prefetch_queue_policy pq_policy{};
+
+  // The prefetcher whose function is being called, set by the module dispatch
+  unsigned long long active_prefetcher = 0;
 
   using stats_type = cache_stats;
 
@@ -191,10 +302,18 @@ public:
   [[deprecated("get_size() returns 0 for every input except 0 (MSHR). Use get_mshr_size() instead.")]] std::size_t get_size(uint8_t queue_type,
                                                                                                                             uint64_t address);
 
+  // The occupancy of every queue, without allocating. The queues of the upper levels are sampled once per cycle, and the MSHR and
+  // the internal prefetch queue on every call, since this cache's prefetchers fill them within a cycle.
+  const cache_occupancy& get_occupancy_snapshot() const;
+
   std::size_t get_mshr_occupancy() const;
   std::size_t get_mshr_size() const;
   double get_mshr_occupancy_ratio() const;
 
+  // The prefetch queue that the prefetchers of this cache write to, which is always current
+  std::size_t get_internal_pq_occupancy() const;
+  std::size_t get_internal_pq_size() const;
+
   std::vector<std::size_t> get_rq_occupancy() const;
   std::vector<std::size_t> get_rq_size() const;
   std::vector<double> get_rq_occupancy_ratio() const;
@@ -217,6 +336,9 @@ public:
   
   int prefetch_line(uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata);
 
+  // The number of prefetches the calling prefetcher may issue for the current trigger, as allowed by the throttle
+  std::size_t prefetch_degree() const;
+
   [[deprecated("Use CACHE::prefetch_line(pf_addr, fill_this_level, prefetch_metadata) instead.")]] int
   prefetch_line(uint64_t ip, uint64_t base_addr, uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata);
 
@@ -240,6 +362,9 @@ public:
     virtual void impl_update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr,
                                                uint32_t type, uint8_t hit) = 0;
     virtual void impl_replacement_final_stats() = 0;
+
+    virtual unsigned long long prefetcher_flags() const = 0;
+    virtual unsigned long long replacement_flags() const = 0;
   };
 
   template <unsigned long long P_FLAG, unsigned long long R_FLAG>
@@ -247,6 +372,33 @@ public:
     CACHE* intern_;
     explicit module_model(CACHE* cache) : intern_(cache) {}
 
+    unsigned long long prefetcher_flags() const { return P_FLAG; }
+    unsigned long long replacement_flags() const { return R_FLAG; }
+
+    void impl_prefetcher_initialize();
+    uint32_t impl_prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, bool useful_prefetch, uint8_t type, uint32_t metadata_in);
+    uint32_t impl_prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way, uint8_t prefetch, uint64_t evicted_addr, uint32_t metadata_in);
+    void impl_prefetcher_cycle_operate();
+    void impl_prefetcher_final_stats();
+    void impl_prefetcher_branch_operate(uint64_t ip, uint8_t branch_type, uint64_t branch_target);
+
+    void impl_initialize_replacement();
+    uint32_t impl_find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr,
+                              uint32_t type);
+    void impl_update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr,
+                                       uint32_t type, uint8_t hit);
+    void impl_replacement_final_stats();
+  };
+
+  // A model whose modules are chosen when the simulator starts, rather than when it is configured
+  struct dynamic_module_model final : module_concept {
+    CACHE* intern_;
+    unsigned long long p_flags, r_flags;
+    dynamic_module_model(CACHE* cache, unsigned long long p, unsigned long long r) : intern_(cache), p_flags(p), r_flags(r) {}
+
+    unsigned long long prefetcher_flags() const { return p_flags; }
+    unsigned long long replacement_flags() const { return r_flags; }
+
     void impl_prefetcher_initialize();
     uint32_t impl_prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, bool useful_prefetch, uint8_t type, uint32_t metadata_in);
     uint32_t impl_prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way, uint8_t prefetch, uint64_t evicted_addr, uint32_t metadata_in);
@@ -264,19 +416,38 @@ public:
 
   std::unique_ptr<module_concept> module_pimpl;
 
+  // The modules compiled into the simulator, by name
+  static const champsim::module_registry& prefetcher_registry();
+  static const champsim::module_registry& replacement_registry();
+
+  // Replace the modules chosen when the simulator was configured. These must be called before the cache is initialized.
+  void select_prefetcher(const std::vector<std::string>& names);
+  void select_replacement(const std::vector<std::string>& names);
+
+  // Each call that tells the prefetcher of an event is a new trigger for the throttle. Prefetches issued as the cycles pass, such as the
+  // steps of a lookahead, count against the most recent trigger, which is usually the one that started them.
+  void begin_prefetch_trigger()
+  {
+    if (pf_throttle.has_value())
+      pf_throttle->begin_trigger();
+  }
+
   void impl_prefetcher_initialize() { module_pimpl->impl_prefetcher_initialize(); }
   uint32_t impl_prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, bool useful_prefetch, uint8_t type, uint32_t metadata_in)
   {
+    begin_prefetch_trigger();
     return module_pimpl->impl_prefetcher_cache_operate(addr, ip, cache_hit, useful_prefetch, type, metadata_in);
   }
   uint32_t impl_prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way, uint8_t prefetch, uint64_t evicted_addr, uint32_t metadata_in)
   {
+    begin_prefetch_trigger();
     return module_pimpl->impl_prefetcher_cache_fill(addr, set, way, prefetch, evicted_addr, metadata_in);
   }
   void impl_prefetcher_cycle_operate() { module_pimpl->impl_prefetcher_cycle_operate(); }
   void impl_prefetcher_final_stats() { module_pimpl->impl_prefetcher_final_stats(); }
   void impl_prefetcher_branch_operate(uint64_t ip, uint8_t branch_type, uint64_t branch_target)
   {
+    begin_prefetch_trigger();
     module_pimpl->impl_prefetcher_branch_operate(ip, branch_type, branch_target);
   }
 
@@ -317,6 +488,11 @@ public:
     bool m_va_pref{};
 
     unsigned m_pref_act_mask{};
+    champsim::module_parameters m_pref_params{};
+    std::optional<champsim::prefetch_arbiter::config_type> m_pf_arbiter{};
+    std::optional<champsim::prefetch_throttle::config_type> m_pf_throttle{};
+    champsim::prefetch_queue_policy m_pq_policy{};
+    std::optional<champsim::prefetch_sandbox::config_type> m_pf_sandbox{};
     std::vector<CACHE::channel_type*> m_uls{};
     CACHE::channel_type* m_ll{};
     CACHE::channel_type* m_lt{nullptr};
@@ -328,7 +504,9 @@ public:
         : m_name(other.m_name), m_freq_scale(other.m_freq_scale), m_sets(other.m_sets), m_ways(other.m_ways), m_pq_size(other.m_pq_size),
           m_mshr_size(other.m_mshr_size), m_hit_lat(other.m_hit_lat), m_fill_lat(other.m_fill_lat), m_latency(other.m_latency), m_max_tag(other.m_max_tag),
           m_max_fill(other.m_max_fill), m_offset_bits(other.m_offset_bits), m_pref_load(other.m_pref_load), m_wq_full_addr(other.m_wq_full_addr),
-          m_va_pref(other.m_va_pref), m_pref_act_mask(other.m_pref_act_mask), m_uls(other.m_uls), m_ll(other.m_ll), m_lt(other.m_lt)
+          m_va_pref(other.m_va_pref), m_pref_act_mask(other.m_pref_act_mask), m_pref_params(other.m_pref_params), m_pf_arbiter(other.m_pf_arbiter),
+          m_pf_throttle(other.m_pf_throttle), m_pq_policy(other.m_pq_policy), m_pf_sandbox(other.m_pf_sandbox),
+          m_uls(other.m_uls), m_ll(other.m_ll), m_lt(other.m_lt)
     {
     }
 
@@ -431,6 +609,31 @@ public:
       m_pref_act_mask = ((1u << champsim::to_underlying(pref_act_elems)) | ... | 0);
       return *this;
     }
+    self_type& prefetcher_parameters(champsim::module_parameters pref_params_)
+    {
+      m_pref_params = std::move(pref_params_);
+      return *this;
+    }
+    self_type& prefetch_arbiter(champsim::prefetch_arbiter::config_type pf_arbiter_)
+    {
+      m_pf_arbiter = std::move(pf_arbiter_);
+      return *this;
+    }
+    self_type& prefetch_throttle(champsim::prefetch_throttle::config_type pf_throttle_)
+    {
+      m_pf_throttle = std::move(pf_throttle_);
+      return *this;
+    }
+    self_type& prefetch_queue_policy(champsim::prefetch_queue_policy pq_policy_)
+    {
+      m_pq_policy = pq_policy_;
+      return *this;
+    }
+    self_type& prefetch_sandbox(champsim::prefetch_sandbox::config_type pf_sandbox_)
+    {
+      m_pf_sandbox = pf_sandbox_;
+      return *this;
+    }
     self_type& upper_levels(std::vector<CACHE::channel_type*>&& uls_)
     {
       m_uls = std::move(uls_);
@@ -462,10 +665,17 @@ public:
   explicit CACHE(Builder<P_FLAG, R_FLAG> b)
       : champsim::operable(b.m_freq_scale), upper_levels(std::move(b.m_uls)), lower_level(b.m_ll), lower_translate(b.m_lt), NAME(b.m_name), NUM_SET(b.m_sets),
         NUM_WAY(b.m_ways), MSHR_SIZE(b.m_mshr_size), PQ_SIZE(b.m_pq_size), HIT_LATENCY((b.m_hit_lat > 0) ? b.m_hit_lat : b.m_latency - b.m_fill_lat),
-        FILL_LATENCY(b.m_fill_lat), OFFSET_BITS(b.m_offset_bits), MAX_TAG(b.m_max_tag), MAX_FILL(b.m_max_fill), prefetch_as_load(b.m_pref_load),
-        match_offset_bits(b.m_wq_full_addr), virtual_prefetch(b.m_va_pref), pref_activate_mask(b.m_pref_act_mask),
+        FILL_LATENCY(b.m_fill_lat), LATENCY((b.m_latency > 0) ? b.m_latency : HIT_LATENCY + FILL_LATENCY), OFFSET_BITS(b.m_offset_bits),
+        MAX_TAG(b.m_max_tag), MAX_FILL(b.m_max_fill), prefetch_as_load(b.m_pref_load), match_offset_bits(b.m_wq_full_addr), virtual_prefetch(b.m_va_pref),
+        pref_activate_mask(b.m_pref_act_mask), prefetcher_params(std::move(b.m_pref_params)), pq_policy(b.m_pq_policy),
         module_pimpl(std::make_unique<module_model<P_FLAG, R_FLAG>>(this))
   {
+    if (b.m_pf_arbiter.has_value())
+      pf_arbiter.emplace(*b.m_pf_arbiter, OFFSET_BITS);
+    if (b.m_pf_throttle.has_value())
+      pf_throttle.emplace(*b.m_pf_throttle, OFFSET_BITS);
+    if (b.m_pf_sandbox.has_value())
+      pf_sandbox.emplace(*b.m_pf_sandbox, OFFSET_BITS);
   }
 };
 
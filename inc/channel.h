@@ -87,10 +87,13 @@ class channel
     uint64_t v_address;
     uint64_t data;
     uint32_t pf_metadata = 0;
+    std::string_view served_by{}; // The name of the level of the hierarchy that supplied the data
+    unsigned page_bits = 0;       // For translations, the log2 of the size of the page that holds the address, if larger than a block
     std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
 
-    response(uint64_t addr, uint64_t v_addr, uint64_t data_, uint32_t pf_meta, std::vector<std::reference_wrapper<ooo_model_instr>> deps)
-        : address(addr), v_address(v_addr), data(data_), pf_metadata(pf_meta), instr_depend_on_me(deps)
+    response(uint64_t addr, uint64_t v_addr, uint64_t data_, uint32_t pf_meta, std::vector<std::reference_wrapper<ooo_model_instr>> deps,
+             std::string_view served = {})
+        : address(addr), v_address(v_addr), data(data_), pf_metadata(pf_meta), served_by(served), instr_depend_on_me(deps)
     {
     }
     explicit response(request req) : response(req.address, req.v_address, req.data, req.pf_metadata, req.instr_depend_on_me) {}
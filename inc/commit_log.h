@@ -0,0 +1,123 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COMMIT_LOG_H
+#define COMMIT_LOG_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "inf_stream.h"
+
+struct ooo_model_instr;
+
+namespace champsim
+{
+/*
+ * The commit log is a gzip-compressed stream beginning with a header, followed by tagged records:
+ *   LEVEL:  tag, id (1 byte), name length (1 byte), name
+ *   INSTR:  tag, instr_id, ip, fetch, decode, dispatch, execute, and retire cycles (8 bytes each), number of loads (1 byte),
+ *           then for each load its virtual address (8 bytes) and the id of the level that served it (1 byte)
+ * All multi-byte values are little-endian. A LEVEL record precedes the first INSTR record that refers to it.
+ */
+namespace commit_log
+{
+constexpr std::string_view MAGIC{"CSCL"};
+constexpr uint32_t VERSION = 1;
+constexpr uint8_t LEVEL_TAG = 1;
+constexpr uint8_t INSTR_TAG = 2;
+constexpr uint8_t UNKNOWN_LEVEL = std::numeric_limits<uint8_t>::max();
+
+using stream_tag = decomp_tags::gzip_tag_t<>;
+} // namespace commit_log
+
+struct commit_record {
+  struct load {
+    uint64_t address = 0;
+    std::string served_by{};
+  };
+
+  uint64_t instr_id = 0;
+  uint64_t ip = 0;
+  uint64_t fetch_cycle = 0;
+  uint64_t decode_cycle = 0;
+  uint64_t dispatch_cycle = 0;
+  uint64_t execute_cycle = 0;
+  uint64_t retire_cycle = 0;
+  std::vector<load> loads{};
+};
+
+/*
+ * Records retired instructions. Records are batched into chunks, which are handed to a background thread that compresses and writes them.
+ * Chunks only batch the writes: they continue the same compressed stream, and cannot be decoded on their own.
+ */
+class commit_log_writer
+{
+  constexpr static std::size_t CHUNK_SIZE = (1 << 16);
+  constexpr static std::size_t MAX_PENDING_CHUNKS = 64;
+
+  std::vector<char> current_chunk{};
+  std::map<std::string, uint8_t, std::less<>> level_ids{};
+
+  std::mutex pending_mutex{};
+  std::condition_variable pending_cv{};
+  std::deque<std::vector<char>> pending_chunks{};
+  bool finished = false;
+
+  inf_ostream<commit_log::stream_tag> out;
+  std::thread worker;
+
+  uint8_t level_id(std::string_view name);
+  void submit_chunk();
+  void write_chunks();
+
+public:
+  explicit commit_log_writer(std::string filename);
+  ~commit_log_writer();
+
+  void log(const ooo_model_instr& instr, uint64_t retire_cycle);
+};
+
+/*
+ * Reads the records written by a commit_log_writer, in retirement order.
+ */
+class commit_log_reader
+{
+  inf_istream<commit_log::stream_tag> in;
+  std::vector<std::string> levels = std::vector<std::string>(commit_log::UNKNOWN_LEVEL);
+
+  bool read_bytes(char* dest, std::size_t count);
+  template <typename T>
+  std::optional<T> read_value();
+
+public:
+  explicit commit_log_reader(std::string filename);
+
+  std::optional<commit_record> next();
+};
+} // namespace champsim
+
+#endif
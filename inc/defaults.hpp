@@ -28,12 +28,14 @@ const auto default_core = O3_CPU::Builder{}
                               .dib_set(32)
                               .dib_way(8)
                               .dib_window(16)
+                              .ftq_size(32)
                               .ifetch_buffer_size(64)
                               .decode_buffer_size(32)
                               .dispatch_buffer_size(32)
                               .rob_size(352)
                               .lq_size(128)
                               .sq_size(72)
+                              .prediction_width(6)
                               .fetch_width(6)
                               .decode_width(6)
                               .dispatch_width(6)
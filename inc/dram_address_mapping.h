@@ -0,0 +1,116 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DRAM_ADDRESS_MAPPING_H
+#define DRAM_ADDRESS_MAPPING_H
+
+#include <cstdint>
+
+#include "champsim_constants.h"
+#include "util/bits.h"
+
+namespace champsim
+{
+/*
+ * One field of a DRAM address. The field is a slice of the physical address, optionally XORed with other address bits.
+ * The bits selected by xor_mask are shifted down to bit zero and folded into the width of the field. To keep the mapping
+ * one-to-one, xor_mask must not select any bits of the field's own slice.
+ */
+struct dram_address_field {
+  std::size_t shift = 0;
+  std::size_t width = 0;
+  uint64_t xor_mask = 0;
+
+  // Found once, rather than on every decode: the position of the lowest bit of xor_mask, and the number of times its bits fold
+  std::size_t xor_shift = 0;
+  std::size_t xor_folds = 0;
+
+  constexpr dram_address_field() = default;
+  constexpr dram_address_field(std::size_t shift_, std::size_t width_, uint64_t xor_mask_ = 0)
+      : shift(shift_), width(width_), xor_mask(xor_mask_), xor_shift(champsim::lg2(xor_mask_ & (~xor_mask_ + 1)))
+  {
+    if (width > 0 && xor_mask != 0)
+      xor_folds = (champsim::lg2(xor_mask) - xor_shift + width) / width;
+  }
+
+  constexpr uint64_t operator()(uint64_t address) const
+  {
+    auto value = (address >> shift) & champsim::bitmask(width);
+    auto hash = (address & xor_mask) >> xor_shift;
+    for (std::size_t i = 0; i < xor_folds; ++i, hash >>= width)
+      value ^= hash & champsim::bitmask(width);
+    return value;
+  }
+};
+
+/*
+ * Describes how physical addresses are divided into DRAM coordinates. The presets are resolved at compile time into a
+ * shift, mask, and XOR for each field.
+ */
+struct dram_address_mapping {
+  dram_address_field channel{0, champsim::lg2(DRAM_CHANNELS)};
+  dram_address_field rank{0, champsim::lg2(DRAM_RANKS)};
+  dram_address_field bank{0, champsim::lg2(DRAM_BANKS)};
+  dram_address_field row{0, champsim::lg2(DRAM_ROWS)};
+  dram_address_field column{0, champsim::lg2(DRAM_COLUMNS)};
+
+  // Place the given fields contiguously above the block offset, from least to most significant
+  template <typename... Fields>
+  constexpr static dram_address_mapping sliced(Fields... fields)
+  {
+    dram_address_mapping mapping;
+    std::size_t shift = LOG2_BLOCK_SIZE;
+    (((mapping.*fields).shift = shift, shift += (mapping.*fields).width), ...);
+    return mapping;
+  }
+
+  // | row | rank | column | bank | channel | block offset |
+  constexpr static dram_address_mapping row_rank_column_bank_channel()
+  {
+    return sliced(&dram_address_mapping::channel, &dram_address_mapping::bank, &dram_address_mapping::column, &dram_address_mapping::rank,
+                  &dram_address_mapping::row);
+  }
+
+  // | row | rank | bank | channel | column | block offset |
+  // Consecutive blocks share a row, which favors row buffer locality over bank and channel parallelism.
+  constexpr static dram_address_mapping row_rank_bank_channel_column()
+  {
+    return sliced(&dram_address_mapping::column, &dram_address_mapping::channel, &dram_address_mapping::bank, &dram_address_mapping::rank,
+                  &dram_address_mapping::row);
+  }
+
+  // Permutation-based interleaving: the bank index is XORed with the low bits of the row, so that rows that conflict in
+  // the same bank under row_rank_column_bank_channel are spread across banks.
+  constexpr static dram_address_mapping permutation()
+  {
+    auto mapping = row_rank_column_bank_channel();
+    mapping.bank = {mapping.bank.shift, mapping.bank.width, champsim::bitmask(mapping.bank.width) << mapping.row.shift};
+    return mapping;
+  }
+
+  // XOR hashing in the style of recent server memory controllers: in addition to the bank permutation, the channel is
+  // XORed with a fold of the column and row bits, so that power-of-two strides are spread across channels.
+  constexpr static dram_address_mapping xor_hash()
+  {
+    auto mapping = permutation();
+    mapping.channel = {mapping.channel.shift, mapping.channel.width,
+                       (champsim::bitmask(mapping.column.width) << mapping.column.shift) | (champsim::bitmask(mapping.row.width) << mapping.row.shift)};
+    return mapping;
+  }
+};
+} // namespace champsim
+
+#endif
@@ -19,19 +19,56 @@
 
 #include <array>
 #include <cmath>
+#include <functional>
 #include <limits>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include "champsim_constants.h"
 #include "channel.h"
+#include "dram_address_mapping.h"
+#include "dram_row_policy.h"
+#include "dram_telemetry.h"
 #include "operable.h"
 
+namespace champsim
+{
+enum class dram_refresh_mode { NONE, ALL_BANK, SAME_BANK };
+
+/*
+ * DRAM timing constraints, in nanoseconds, as given in the configuration. A constraint of zero is not enforced.
+ */
+struct dram_timing_parameters {
+  double tRP = 0, tRCD = 0, tCAS = 0, tRAS = 0, tWR = 0, tRTP = 0, tWTR_S = 0, tWTR_L = 0, tRRD_S = 0, tRRD_L = 0, tCCD_S = 0, tCCD_L = 0, tFAW = 0,
+         tREFI = 0, tRFC = 0, tRFCsb = 0, turnaround = 0;
+  dram_refresh_mode refresh = dram_refresh_mode::NONE;
+};
+
+/*
+ * The same constraints, in DRAM bus cycles
+ */
+struct dram_timing {
+  uint64_t tRP = 0, tRCD = 0, tCAS = 0, tRAS = 0, tWR = 0, tRTP = 0, tWTR_S = 0, tWTR_L = 0, tRRD_S = 0, tRRD_L = 0, tCCD_S = 0, tCCD_L = 0, tFAW = 0,
+           tREFI = 0, tRFC = 0, tRFCsb = 0, turnaround = 0;
+  uint64_t tBURST = 0; // cycles to transfer one block on the data bus
+  dram_refresh_mode refresh = dram_refresh_mode::NONE;
+
+  dram_timing() = default;
+  dram_timing(const dram_timing_parameters& params, int io_freq);
+};
+} // namespace champsim
+
 struct dram_stats {
   std::string name{};
   uint64_t dbus_cycle_congested = 0, dbus_count_congested = 0;
+  uint64_t refresh_cycles = 0;
 
   unsigned WQ_ROW_BUFFER_HIT = 0, WQ_ROW_BUFFER_MISS = 0, RQ_ROW_BUFFER_HIT = 0, RQ_ROW_BUFFER_MISS = 0, WQ_FULL = 0;
+  unsigned ACTIVATIONS = 0, REFRESHES = 0, CONFLICT_PRECHARGES = 0, POLICY_PRECHARGES = 0;
 };
 
 struct DRAM_CHANNEL {
@@ -48,6 +85,10 @@ struct DRAM_CHANNEL {
     uint64_t v_address = 0;
     uint64_t data = 0;
     uint64_t event_cycle = std::numeric_limits<uint64_t>::max();
+    uint64_t cycle_enqueued = 0;
+
+    std::size_t bank_idx = 0;
+    std::size_t row = 0;
 
     std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
     std::vector<std::deque<response_type>*> to_return{};
@@ -57,9 +98,14 @@ struct DRAM_CHANNEL {
   using value_type = request_type;
   using queue_type = std::vector<std::optional<value_type>>;
   queue_type WQ{DRAM_WQ_SIZE}, RQ{DRAM_RQ_SIZE};
+  std::size_t wq_occupancy = 0, rq_occupancy = 0;
+
+  // The unscheduled requests to each bank, in arrival order
+  using bank_queue_type = std::vector<queue_type::iterator>;
+  std::array<bank_queue_type, DRAM_RANKS * DRAM_BANKS> bank_wq{}, bank_rq{};
 
   struct BANK_REQUEST {
-    bool valid = false, row_buffer_hit = false;
+    bool valid = false, row_buffer_hit = false, is_write = false;
 
     std::size_t open_row = std::numeric_limits<uint32_t>::max();
 
@@ -71,17 +117,59 @@ struct DRAM_CHANNEL {
   using request_array_type = std::array<BANK_REQUEST, DRAM_RANKS * DRAM_BANKS>;
   request_array_type bank_request = {};
   request_array_type::iterator active_request = std::end(bank_request);
+  std::size_t busy_banks = 0;
+
+  // The earliest cycle at which each command may be issued to a bank, bank group, or rank
+  struct bank_state {
+    uint64_t next_activate = 0, next_precharge = 0, next_column = 0;
+    uint64_t close_at = champsim::row_buffer_policy::NEVER; // when the row policy will close the open row
+    std::size_t last_row = std::numeric_limits<uint32_t>::max();
+    bool refresh_pending = false;
+  };
+
+  struct command_timer {
+    uint64_t next_activate = 0, next_read = 0, next_write = 0;
+  };
+
+  struct rank_state : command_timer {
+    std::array<uint64_t, 4> faw_window{}; // the cycles at which each of the last four activations leaves the four-activate window
+    std::size_t next_faw_slot = 0;
+    uint64_t next_refresh = 0;
+    uint64_t refresh_end = 0; // the cycle at which the most recent refresh completes
+    std::size_t next_refresh_bank = 0;
+  };
+
+  static_assert(DRAM_BANKS % DRAM_BANK_GROUPS == 0, "Each bank group must have the same number of banks");
+  constexpr static std::size_t BANKS_PER_GROUP = DRAM_BANKS / DRAM_BANK_GROUPS;
+  std::array<bank_state, DRAM_RANKS * DRAM_BANKS> bank_timers{};
+  std::array<command_timer, DRAM_RANKS * DRAM_BANK_GROUPS> group_timers{};
+  std::array<rank_state, DRAM_RANKS> rank_timers{};
+  champsim::dram_timing timing{};
+  std::unique_ptr<champsim::row_buffer_policy> row_policy = std::make_unique<champsim::open_row_policy>();
 
   bool write_mode = false;
   uint64_t dbus_cycle_available = 0;
+  uint64_t dbus_cycles_used = 0; // DRAM cycles in which the data bus has carried data
 
   using stats_type = dram_stats;
   stats_type roi_stats, sim_stats;
+  champsim::dram_interval_stats interval_stats{};
 
-  void check_collision();
+  void enqueue(queue_type::iterator it, bool is_write);
+  void release(queue_type::iterator it, bool is_write);
+  std::optional<queue_type::iterator> select_request(uint64_t current_cycle, uint64_t age_cap);
+  uint64_t issue_commands(std::size_t bank_idx, std::size_t row, bool is_write, uint64_t current_cycle);
+  void finish_access(std::size_t bank_idx, uint64_t current_cycle);
+  void close_idle_rows(uint64_t current_cycle);
+  long refresh(uint64_t current_cycle);
+  uint64_t refresh_interval() const;
+
+  void check_collision(std::string_view served_by);
   void print_deadlock();
 };
 
+class VirtualMemory;
+
 class MEMORY_CONTROLLER : public champsim::operable
 {
   using channel_type = champsim::channel;
@@ -90,20 +178,131 @@ class MEMORY_CONTROLLER : public champsim::operable
   std::vector<channel_type*> queues;
 
   // Latencies
-  const uint64_t tRP, tRCD, tCAS, DRAM_DBUS_TURN_AROUND_TIME, DRAM_DBUS_RETURN_TIME;
+  const champsim::dram_timing timing;
+
+  // Requests older than this are scheduled ahead of row buffer hits
+  const uint64_t SCHEDULER_AGE_CAP;
+
+  const champsim::dram_address_mapping address_mapping;
+
+  const uint64_t ROW_POLICY_TIMEOUT;
+
+  // The physical addresses served by this controller, as [begin, begin + size)
+  const uint64_t RANGE_BEGIN;
+  const uint64_t RANGE_SIZE;
+
+  // Added to every request, to model the link to a remote memory
+  const uint64_t LINK_LATENCY;
+
+  // If set, accesses are reported to the virtual memory to drive page placement
+  VirtualMemory* vmem;
+
+  uint64_t next_telemetry_sample = 0;
+  void sample_telemetry();
+  void write_telemetry();
 
   // these values control when to send out a burst of writes
   constexpr static std::size_t DRAM_WRITE_HIGH_WM = ((DRAM_WQ_SIZE * 7) >> 3);         // 7/8th
   constexpr static std::size_t DRAM_WRITE_LOW_WM = ((DRAM_WQ_SIZE * 6) >> 3);          // 6/8th
   constexpr static std::size_t MIN_DRAM_WRITES_PER_SWITCH = ((DRAM_WQ_SIZE * 1) >> 2); // 1/4
-
   void initiate_requests();
+  bool in_range(uint64_t address) const;
   bool add_rq(const request_type& pkt, champsim::channel* ul);
   bool add_wq(const request_type& pkt);
 
 public:
+  // The name reported to upper levels as the source of returned data
+  const std::string NAME;
+
+  // The data rate, in MT/s
+  const int IO_FREQ;
+
+  constexpr static uint64_t CAPACITY = DRAM_CHANNELS * DRAM_RANKS * DRAM_BANKS * DRAM_ROWS * DRAM_COLUMNS * BLOCK_SIZE;
+
   std::array<DRAM_CHANNEL, DRAM_CHANNELS> channels;
 
+  // If set, the activity of each channel is written at regular intervals
+  std::unique_ptr<champsim::dram_telemetry_writer> telemetry;
+
+  class Builder
+  {
+    std::string_view m_name{"DRAM"};
+    double m_freq_scale{1};
+    int m_io_freq{DRAM_IO_FREQ};
+    champsim::dram_timing_parameters m_timing{};
+    double m_age_cap{500};
+    champsim::dram_address_mapping m_mapping{champsim::dram_address_mapping::row_rank_column_bank_channel()};
+    champsim::dram_row_policy m_row_policy{champsim::dram_row_policy::OPEN};
+    double m_row_policy_timeout{0};
+    uint64_t m_range_begin{0};
+    uint64_t m_range_size{std::numeric_limits<uint64_t>::max()};
+    double m_link_latency{0};
+    VirtualMemory* m_vmem{};
+    std::vector<channel_type*> m_uls{};
+
+    friend class MEMORY_CONTROLLER;
+
+  public:
+    Builder& name(std::string_view name_)
+    {
+      m_name = name_;
+      return *this;
+    }
+    Builder& frequency(double freq_scale_)
+    {
+      m_freq_scale = freq_scale_;
+      return *this;
+    }
+    Builder& io_freq(int io_freq_)
+    {
+      m_io_freq = io_freq_;
+      return *this;
+    }
+    Builder& timing(champsim::dram_timing_parameters timing_)
+    {
+      m_timing = timing_;
+      return *this;
+    }
+    Builder& scheduler_age_cap(double age_cap_)
+    {
+      m_age_cap = age_cap_;
+      return *this;
+    }
+    Builder& address_mapping(champsim::dram_address_mapping mapping_)
+    {
+      m_mapping = mapping_;
+      return *this;
+    }
+    Builder& row_policy(champsim::dram_row_policy policy_, double timeout_)
+    {
+      m_row_policy = policy_;
+      m_row_policy_timeout = timeout_;
+      return *this;
+    }
+    Builder& address_range(uint64_t begin_, uint64_t size_)
+    {
+      m_range_begin = begin_;
+      m_range_size = size_;
+      return *this;
+    }
+    Builder& link_latency(double latency_)
+    {
+      m_link_latency = latency_;
+      return *this;
+    }
+    Builder& virtual_memory(VirtualMemory* vmem_)
+    {
+      m_vmem = vmem_;
+      return *this;
+    }
+    Builder& upper_levels(std::vector<channel_type*>&& uls_)
+    {
+      m_uls = std::move(uls_);
+      return *this;
+    }
+  };
+
+  explicit MEMORY_CONTROLLER(Builder builder);
   MEMORY_CONTROLLER(double freq_scale, int io_freq, double t_rp, double t_rcd, double t_cas, double turnaround, std::vector<channel_type*>&& ul);
 
   void initialize() override final;
@@ -113,6 +312,10 @@ public:
   void print_deadlock() override final;
 
   std::size_t size() const;
+  std::pair<uint64_t, uint64_t> address_range() const;
+
+  // Gives a function that returns the fraction of the data bus cycles of all channels that carried data since its previous call
+  std::function<double()> bandwidth_monitor() const;
 
   uint32_t dram_get_channel(uint64_t address);
   uint32_t dram_get_rank(uint64_t address);
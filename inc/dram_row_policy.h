@@ -0,0 +1,96 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DRAM_ROW_POLICY_H
+#define DRAM_ROW_POLICY_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+#include "champsim_constants.h"
+#include "msl/fwcounter.h"
+
+namespace champsim
+{
+enum class dram_row_policy { OPEN, CLOSED, TIMEOUT, ADAPTIVE };
+
+/*
+ * Decides when a DRAM bank closes its open row. Banks are indexed as in DRAM_CHANNEL::bank_request.
+ */
+class row_buffer_policy
+{
+public:
+  constexpr static uint64_t NEVER = std::numeric_limits<uint64_t>::max();
+
+  enum class access_result {
+    HIT,            // the requested row was open
+    CONFLICT,       // a different row was open
+    CLOSED_REOPEN,  // the bank was closed, and the request is to the row that was last open
+    CLOSED_OTHER    // the bank was closed, and the request is to a different row
+  };
+
+  virtual ~row_buffer_policy() = default;
+
+  // Called when a request is scheduled to a bank, with the state of its row buffer
+  virtual void access(std::size_t bank, access_result result);
+
+  // Called when a bank finishes a request. Returns the cycle at which the row should be closed, if the bank is still idle.
+  // pending_hit is true if a queued request will hit in the open row.
+  virtual uint64_t close_after(std::size_t bank, bool pending_hit, uint64_t current_cycle) = 0;
+
+  static std::unique_ptr<row_buffer_policy> make(dram_row_policy type, uint64_t timeout);
+};
+
+// Rows stay open until a conflicting request or a refresh closes them
+class open_row_policy final : public row_buffer_policy
+{
+public:
+  uint64_t close_after(std::size_t bank, bool pending_hit, uint64_t current_cycle) override final;
+};
+
+// Rows are closed as soon as the bank is idle, unless a queued request will hit in the row
+class closed_row_policy final : public row_buffer_policy
+{
+public:
+  uint64_t close_after(std::size_t bank, bool pending_hit, uint64_t current_cycle) override final;
+};
+
+// Rows are closed after the bank has been idle for a fixed time
+class timeout_row_policy final : public row_buffer_policy
+{
+  uint64_t timeout;
+
+public:
+  explicit timeout_row_policy(uint64_t timeout_cycles);
+  uint64_t close_after(std::size_t bank, bool pending_hit, uint64_t current_cycle) override final;
+};
+
+// Each bank predicts whether its next access will hit in the open row, with a saturating counter trained on the outcomes
+// of its accesses. Rows predicted to miss are closed as soon as the bank is idle.
+class adaptive_row_policy final : public row_buffer_policy
+{
+  std::array<champsim::msl::fwcounter<2>, DRAM_RANKS * DRAM_BANKS> predictors{};
+
+public:
+  adaptive_row_policy();
+  void access(std::size_t bank, access_result result) override final;
+  uint64_t close_after(std::size_t bank, bool pending_hit, uint64_t current_cycle) override final;
+};
+} // namespace champsim
+
+#endif
@@ -0,0 +1,62 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DRAM_TELEMETRY_H
+#define DRAM_TELEMETRY_H
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+namespace champsim
+{
+/*
+ * The activity of one DRAM channel over a telemetry interval
+ */
+struct dram_interval_stats {
+  constexpr static std::size_t LATENCY_BUCKETS = 16;
+
+  uint64_t cycles = 0;
+  uint64_t reads = 0, writes = 0;
+  uint64_t rq_occupancy = 0, wq_occupancy = 0; // summed over the cycles of the interval
+  uint64_t write_drains = 0, write_mode_cycles = 0;
+
+  // Bucket i counts the reads whose latency, in DRAM cycles, was in [2^i, 2^(i+1)). The last bucket also counts longer latencies.
+  std::array<uint64_t, LATENCY_BUCKETS> read_latency{};
+
+  void record_read(uint64_t latency);
+};
+
+/*
+ * Writes the interval statistics of each channel of a memory controller as CSV, one row per channel per interval.
+ */
+class dram_telemetry_writer
+{
+  std::ofstream out;
+  int io_freq;
+
+public:
+  const uint64_t interval;
+
+  dram_telemetry_writer(std::string filename, uint64_t interval_cycles, int io_freq_mts);
+
+  void write(std::string_view controller, std::size_t channel, uint64_t cycle, const dram_interval_stats& stats);
+};
+} // namespace champsim
+
+#endif
@@ -18,8 +18,12 @@
 #define INF_STREAM_H
 
 #include <bzlib.h>
+#include <array>
 #include <cassert>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <lzma.h>
 #include <memory>
 #include <zlib.h>
@@ -52,10 +56,10 @@ struct bzip2_tag_t {
 
   static status_type deflate(deflate_state_type& x, bool flush)
   {
-    auto ret = ::BZ2_bzCompress(x.get(), flush ? BZ_FLUSH : BZ_RUN);
-    if (ret == BZ_RUN_OK)
+    auto ret = ::BZ2_bzCompress(x.get(), flush ? BZ_FINISH : BZ_RUN);
+    if (ret == BZ_RUN_OK || ret == BZ_FINISH_OK)
       return status_type::CAN_CONTINUE;
-    if (ret == BZ_FLUSH_OK)
+    if (ret == BZ_STREAM_END)
       return status_type::END;
     return status_type::ERROR;
   }
@@ -112,7 +116,7 @@ struct gzip_tag_t {
   {
     deflate_state_type state{new state_type};
     *state = state_type{Z_NULL, 0, 0, Z_NULL, 0, 0, NULL, NULL, Z_NULL, Z_NULL, Z_NULL, 0, 0ul, 0ul};
-    ::deflateInit(state.get(), compression);
+    ::deflateInit2(state.get(), compression, Z_DEFLATED, window, 8, Z_DEFAULT_STRATEGY);
     return state;
   }
 
@@ -136,7 +140,7 @@ struct lzma_tag_t {
 
   static status_type deflate(deflate_state_type& x, bool flush)
   {
-    auto ret = ::lzma_code(x.get(), flush ? LZMA_FULL_FLUSH : LZMA_RUN);
+    auto ret = ::lzma_code(x.get(), flush ? LZMA_FINISH : LZMA_RUN);
     if (ret == LZMA_OK)
       return status_type::CAN_CONTINUE;
     else if (ret == LZMA_STREAM_END)
@@ -277,6 +281,93 @@ auto inf_istream<T, S>::inf_streambuf<I>::underflow() -> int_type
              std::next(this->out_buf.data(), static_cast<std::make_signed_t<decltype(bytes_remaining)>>(bytes_remaining)));
   return base_type::traits_type::to_int_type(this->out_buf.front());
 }
+
+template <typename Tag, typename StreamType = std::ofstream>
+struct inf_ostream {
+  using strm_in_buf_type = typename Tag::in_char_type;
+  using strm_out_buf_type = typename Tag::out_char_type;
+
+  constexpr static std::size_t CHUNK = (1 << 16);
+
+  std::unique_ptr<StreamType> underlying;
+  typename Tag::deflate_state_type strm = Tag::new_deflate_state();
+  std::unique_ptr<std::array<strm_in_buf_type, CHUNK>> in_buf = std::make_unique<std::array<strm_in_buf_type, CHUNK>>();
+  std::size_t in_buf_occupancy = 0;
+
+  inf_ostream& write(const char* s, std::streamsize count);
+  void flush() { deflate_buffer(false); }
+  void close();
+
+  explicit inf_ostream(std::string s) : underlying(std::make_unique<StreamType>(s, std::ios::binary)) {}
+  explicit inf_ostream(StreamType&& str) : underlying(std::make_unique<StreamType>(std::move(str))) {}
+  inf_ostream(inf_ostream&&) = default;
+  inf_ostream& operator=(inf_ostream&&) = default;
+  ~inf_ostream() { close(); }
+
+private:
+  void deflate_buffer(bool finish);
+};
+
+template <typename T, typename S>
+auto inf_ostream<T, S>::write(const char* s, std::streamsize count) -> inf_ostream&
+{
+  assert(count >= 0);
+  auto remaining = static_cast<std::size_t>(count);
+  while (remaining > 0) {
+    // Stage the data, compressing whenever the staging buffer fills
+    auto to_copy = std::min(remaining, std::size(*in_buf) - in_buf_occupancy);
+    std::memcpy(std::next(in_buf->data(), static_cast<std::ptrdiff_t>(in_buf_occupancy)), s, to_copy);
+    in_buf_occupancy += to_copy;
+    s = std::next(s, static_cast<std::ptrdiff_t>(to_copy));
+    remaining -= to_copy;
+
+    if (in_buf_occupancy == std::size(*in_buf))
+      deflate_buffer(false);
+  }
+  return *this;
+}
+
+template <typename T, typename S>
+void inf_ostream<T, S>::close()
+{
+  // A moved-from stream has nothing to finish
+  if (strm && underlying) {
+    deflate_buffer(true);
+    underlying->flush();
+    strm.reset();
+  }
+}
+
+template <typename T, typename S>
+void inf_ostream<T, S>::deflate_buffer(bool finish)
+{
+  // Compressors may reject calls that make no progress
+  if (!finish && in_buf_occupancy == 0)
+    return;
+
+  std::array<strm_out_buf_type, CHUNK> out_buf;
+
+  strm->next_in = in_buf->data();
+  strm->avail_in = static_cast<decltype(strm->avail_in)>(in_buf_occupancy);
+
+  auto result = T::status_type::CAN_CONTINUE;
+  do {
+    strm->next_out = out_buf.data();
+    strm->avail_out = static_cast<decltype(strm->avail_out)>(std::size(out_buf));
+
+    result = T::deflate(strm, finish);
+    assert(result != T::status_type::ERROR);
+
+    auto bytes_produced = std::size(out_buf) - strm->avail_out;
+    std::array<typename S::char_type, CHUNK> sig_out_buf;
+    std::memcpy(sig_out_buf.data(), out_buf.data(), bytes_produced);
+    underlying->write(sig_out_buf.data(), static_cast<std::streamsize>(bytes_produced));
+  }
+  // Repeat until all input is consumed and, if finishing, the stream has ended. Otherwise, the compressor holds any pending output until the next call.
+  while (result != T::status_type::ERROR && (strm->avail_in > 0 || (finish && result != T::status_type::END)));
+
+  in_buf_occupancy = 0;
+}
 } // namespace champsim
 
 #endif
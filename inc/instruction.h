@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <functional>
 #include <limits>
+#include <string_view>
 #include <vector>
 
 #include "trace_instruction.h"
@@ -38,6 +39,10 @@ enum branch_type {
   BRANCH_OTHER = 7
 };
 
+// execution classes, which are bound to execution ports
+enum class instr_class : uint8_t { ALU = 0, BRANCH, LOAD, STORE };
+constexpr std::size_t NUM_INSTR_CLASSES = 4;
+
 struct ooo_model_instr {
   uint64_t instr_id = 0;
   uint64_t ip = 0;
@@ -47,12 +52,15 @@ struct ooo_model_instr {
   bool branch_taken = 0;
   bool branch_prediction = 0;
   bool branch_mispredicted = 0; // A branch can be mispredicted even if the direction prediction is correct when the predicted target is not correct
+  bool dib_hit = 0;             // The instruction was found in the decoded instruction buffer, and so skips decode
 
   std::array<uint8_t, 2> asid = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
 
   uint8_t branch_type = NOT_BRANCH;
   uint64_t branch_target = 0;
 
+  instr_class exec_class = instr_class::ALU;
+
   uint8_t dib_checked = 0;
   uint8_t fetched = 0;
   uint8_t decoded = 0;
@@ -62,11 +70,21 @@ struct ooo_model_instr {
   unsigned completed_mem_ops = 0;
   int num_reg_dependent = 0;
 
+  uint64_t memory_stall_cycles = 0; // cycles this instruction blocked retirement while waiting on memory
+  std::string_view served_by{};     // the level of the memory hierarchy that returned this instruction's data
+
+  // the cycles at which this instruction entered each stage of the pipeline
+  uint64_t fetch_cycle = 0;
+  uint64_t decode_cycle = 0;
+  uint64_t dispatch_cycle = 0;
+  uint64_t execute_cycle = 0;
+
   std::vector<uint8_t> destination_registers = {}; // output registers
   std::vector<uint8_t> source_registers = {};      // input registers
 
   std::vector<uint64_t> destination_memory = {};
   std::vector<uint64_t> source_memory = {};
+  std::array<std::string_view, NUM_INSTR_SOURCES> source_memory_served_by = {}; // the level that returned each element of source_memory
 
   // these are indices of instructions in the ROB that depend on me
   std::vector<std::reference_wrapper<ooo_model_instr>> registers_instrs_depend_on_me;
@@ -136,6 +154,17 @@ public:
 
   std::size_t num_mem_ops() const { return std::size(destination_memory) + std::size(source_memory); }
 
+  void record_served_by(uint64_t address, std::string_view level)
+  {
+    // Attribute the response to the first load of this address that has not been served
+    for (std::size_t i = 0; i < std::min(std::size(source_memory), std::size(source_memory_served_by)); ++i) {
+      if (source_memory[i] == address && std::empty(source_memory_served_by[i])) {
+        source_memory_served_by[i] = level;
+        return;
+      }
+    }
+  }
+
   static bool program_order(const ooo_model_instr& lhs, const ooo_model_instr& rhs) { return lhs.instr_id < rhs.instr_id; }
 };
 
@@ -17,8 +17,19 @@
 #ifndef MODULE_IMPL_H
 #define MODULE_IMPL_H
 
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
 namespace champsim
 {
+// The names of the modules compiled into the simulator, with the constants that select them
+using module_registry = std::vector<std::pair<std::string, unsigned long long>>;
+
+// Combine the constants that select the named modules. A module may be named by its directory or by a path to it.
+// Throws std::invalid_argument if a module was not compiled into the simulator.
+unsigned long long select_modules(const module_registry& registry, const std::vector<std::string>& names, std::string_view kind);
 
 namespace detail
 {
@@ -0,0 +1,98 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_PARAMETERS_H
+#define MODULE_PARAMETERS_H
+
+#include <charconv>
+#include <initializer_list>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace champsim
+{
+/*
+ * Named parameters given to a module at run time. The values are given as strings, by the configuration file or the command line,
+ * and a module declares each parameter it reads by giving its type and a default value. Parameters that were given but never
+ * declared are reported, so that a misspelled name does not silently leave the default in place.
+ */
+class module_parameters
+{
+  std::map<std::string, std::string> values;
+  mutable std::set<std::string> declared;
+
+  static void parse(const std::string& text, bool& result);
+  static void parse(const std::string& text, double& result);
+  static void parse(const std::string& text, std::string& result);
+
+  template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+  static void parse(const std::string& text, T& result)
+  {
+    auto first = text.data();
+    auto last = text.data() + text.size();
+    int base = 10;
+    if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+      first += 2;
+      base = 16;
+    }
+    auto [ptr, ec] = std::from_chars(first, last, result, base);
+    if (ec != std::errc{} || ptr != last)
+      throw std::invalid_argument{"'" + text + "' is not a representable integer"};
+  }
+
+public:
+  module_parameters() = default;
+  module_parameters(std::initializer_list<std::pair<const std::string, std::string>> init) : values(init) {}
+
+  // Give a value to a parameter, replacing any value it already has
+  void set(const std::string& name, std::string value) { values.insert_or_assign(name, std::move(value)); }
+
+  // Give a value from a string of the form NAME=VALUE
+  void set(const std::string& assignment);
+
+  bool contains(const std::string& name) const { return values.count(name) > 0; }
+
+  // Declare a parameter, returning its value if one was given, or the default otherwise
+  template <typename T>
+  T get(const std::string& name, T default_value) const
+  {
+    declared.insert(name);
+    auto found = values.find(name);
+    if (found == std::end(values))
+      return default_value;
+
+    T result{};
+    try {
+      parse(found->second, result);
+    } catch (const std::invalid_argument& err) {
+      throw std::invalid_argument{"Module parameter " + name + ": " + err.what()};
+    }
+    return result;
+  }
+
+  std::string get(const std::string& name, const char* default_value) const { return get<std::string>(name, default_value); }
+
+  // The names of the parameters that were given, but not declared by any module
+  std::vector<std::string> undeclared() const;
+};
+} // namespace champsim
+
+#endif
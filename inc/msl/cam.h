@@ -0,0 +1,133 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MSL_CAM_H
+#define MSL_CAM_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "msl/table_policies.h"
+
+namespace champsim::msl
+{
+/*
+ * A fully-associative table of SIZE entries, keyed by 64-bit integers.
+ *
+ * The keys are kept apart from the data, so that a lookup compares every key in one pass over a contiguous array. The
+ * comparison does not exit early, which lets the compiler vectorize it.
+ */
+template <typename T, std::size_t SIZE, typename Policy = lru_policy<SIZE>>
+class cam
+{
+public:
+  using key_type = uint64_t;
+  using value_type = T;
+
+private:
+  std::array<key_type, SIZE> keys{};
+  std::array<bool, SIZE> valid{};
+  std::array<value_type, SIZE> data{};
+  Policy replacement{};
+
+  std::size_t match(key_type key) const
+  {
+    std::size_t found = SIZE;
+    for (std::size_t i = SIZE; i-- > 0;)
+      found = (valid[i] && keys[i] == key) ? i : found;
+    return found;
+  }
+
+public:
+  constexpr static std::size_t capacity() { return SIZE; }
+
+  std::size_t occupancy() const { return static_cast<std::size_t>(std::count(std::begin(valid), std::end(valid), true)); }
+
+  // Look up an entry without updating the replacement state
+  value_type* find(key_type key)
+  {
+    auto way = match(key);
+    return way == SIZE ? nullptr : &data[way];
+  }
+
+  const value_type* find(key_type key) const
+  {
+    auto way = match(key);
+    return way == SIZE ? nullptr : &data[way];
+  }
+
+  // Look up an entry, and mark it as used
+  value_type* touch(key_type key)
+  {
+    auto way = match(key);
+    if (way == SIZE)
+      return nullptr;
+    replacement.touch(way);
+    return &data[way];
+  }
+
+  /*
+   * Insert or overwrite the entry for the key. An invalid entry is filled before any valid one is replaced.
+   * Returns the key and data of the entry that was replaced, if one was valid.
+   */
+  std::optional<std::pair<key_type, value_type>> insert(key_type key, value_type value)
+  {
+    if (auto way = match(key); way != SIZE) {
+      data[way] = std::move(value);
+      replacement.touch(way);
+      return std::nullopt;
+    }
+
+    std::optional<std::pair<key_type, value_type>> evicted;
+    auto way = static_cast<std::size_t>(std::distance(std::begin(valid), std::find(std::begin(valid), std::end(valid), false)));
+    if (way == SIZE) {
+      way = replacement.victim();
+      evicted.emplace(keys[way], std::move(data[way]));
+    }
+
+    keys[way] = key;
+    valid[way] = true;
+    data[way] = std::move(value);
+    replacement.insert(way);
+    return evicted;
+  }
+
+  // Invalidate the entry for the key, returning its data if it was present
+  std::optional<value_type> erase(key_type key)
+  {
+    auto way = match(key);
+    if (way == SIZE)
+      return std::nullopt;
+    valid[way] = false;
+    return std::exchange(data[way], value_type{});
+  }
+
+  // Call func(key, value) for each valid entry
+  template <typename F>
+  void for_each(F&& func) const
+  {
+    for (std::size_t i = 0; i < SIZE; ++i) {
+      if (valid[i])
+        func(keys[i], data[i]);
+    }
+  }
+};
+} // namespace champsim::msl
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MSL_COUNTER_ARRAY_H
+#define MSL_COUNTER_ARRAY_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+
+#include "msl/bits.h"
+
+namespace champsim::msl
+{
+/*
+ * An array of SIZE unsigned saturating counters of BITS bits each, packed into 64-bit words. A counter never straddles
+ * two words.
+ */
+template <std::size_t BITS, std::size_t SIZE>
+class counter_array
+{
+  static_assert(BITS > 0 && BITS <= 32);
+
+public:
+  using value_type = uint32_t;
+  constexpr static value_type maximum = static_cast<value_type>(bitmask(BITS));
+
+private:
+  constexpr static std::size_t PER_WORD = 64 / BITS;
+  std::array<uint64_t, (SIZE + PER_WORD - 1) / PER_WORD> words{};
+
+  constexpr static std::size_t word_of(std::size_t i) { return i / PER_WORD; }
+  constexpr static std::size_t shift_of(std::size_t i) { return (i % PER_WORD) * BITS; }
+
+public:
+  counter_array() = default;
+  explicit counter_array(value_type init) { fill(init); }
+
+  constexpr static std::size_t size() { return SIZE; }
+
+  value_type get(std::size_t i) const
+  {
+    assert(i < SIZE);
+    return static_cast<value_type>((words[word_of(i)] >> shift_of(i)) & maximum);
+  }
+
+  value_type operator[](std::size_t i) const { return get(i); }
+
+  // Set a counter, clamping the value to the width of the counter
+  void set(std::size_t i, uint64_t value)
+  {
+    assert(i < SIZE);
+    auto& word = words[word_of(i)];
+    word = (word & ~(uint64_t{maximum} << shift_of(i))) | (std::min<uint64_t>(value, maximum) << shift_of(i));
+  }
+
+  void increment(std::size_t i, value_type amount = 1) { set(i, uint64_t{get(i)} + amount); }
+
+  void decrement(std::size_t i, value_type amount = 1)
+  {
+    auto value = get(i);
+    set(i, value > amount ? value - amount : 0);
+  }
+
+  void fill(value_type value)
+  {
+    uint64_t word = 0;
+    for (std::size_t i = 0; i < PER_WORD; ++i)
+      word |= uint64_t{std::min(value, maximum)} << (i * BITS);
+    words.fill(word);
+  }
+};
+} // namespace champsim::msl
+
+#endif
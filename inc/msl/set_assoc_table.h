@@ -0,0 +1,87 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MSL_SET_ASSOC_TABLE_H
+#define MSL_SET_ASSOC_TABLE_H
+
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "msl/cam.h"
+#include "msl/table_policies.h"
+
+namespace champsim::msl
+{
+/*
+ * A set-associative table, keyed by 64-bit integers. The associativity is fixed at compile time, and the number of sets
+ * when the table is constructed. The set of a key is the key modulo the number of sets, so a key should be hashed
+ * beforehand if its low bits are poorly distributed. Each set is a cam, with its own replacement state.
+ */
+template <typename T, std::size_t WAYS, typename Policy = lru_policy<WAYS>>
+class set_assoc_table
+{
+public:
+  using key_type = uint64_t;
+  using value_type = T;
+  using set_type = cam<T, WAYS, Policy>;
+
+private:
+  std::vector<set_type> table;
+
+  set_type& get_set(key_type key) { return table[key % std::size(table)]; }
+  const set_type& get_set(key_type key) const { return table[key % std::size(table)]; }
+
+public:
+  explicit set_assoc_table(std::size_t sets) : table(sets) { assert(sets > 0); }
+
+  std::size_t num_sets() const { return std::size(table); }
+  constexpr static std::size_t num_ways() { return WAYS; }
+
+  std::size_t occupancy() const
+  {
+    std::size_t result = 0;
+    for (const auto& set : table)
+      result += set.occupancy();
+    return result;
+  }
+
+  // Look up an entry without updating the replacement state
+  value_type* find(key_type key) { return get_set(key).find(key); }
+  const value_type* find(key_type key) const { return get_set(key).find(key); }
+
+  // Look up an entry, and mark it as used
+  value_type* touch(key_type key) { return get_set(key).touch(key); }
+
+  // Insert or overwrite the entry for the key. Returns the key and data of the entry that was replaced, if one was valid.
+  std::optional<std::pair<key_type, value_type>> insert(key_type key, value_type value) { return get_set(key).insert(key, std::move(value)); }
+
+  // Invalidate the entry for the key, returning its data if it was present
+  std::optional<value_type> erase(key_type key) { return get_set(key).erase(key); }
+
+  // Call func(key, value) for each valid entry
+  template <typename F>
+  void for_each(F&& func) const
+  {
+    for (const auto& set : table)
+      set.for_each(func);
+  }
+};
+} // namespace champsim::msl
+
+#endif
@@ -0,0 +1,120 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MSL_TABLE_POLICIES_H
+#define MSL_TABLE_POLICIES_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <numeric>
+
+#include "msl/bits.h"
+
+/*
+ * Replacement policies for the associative tables. Each object holds the replacement state of one set of WAYS entries.
+ *   touch(way)  is called when an entry hits
+ *   insert(way) is called when an entry is filled
+ *   victim()    selects the way to replace when every way in the set is valid
+ */
+namespace champsim::msl
+{
+// True LRU, kept as the recency rank of each way (0 is the most recently used)
+template <std::size_t WAYS>
+class lru_policy
+{
+  static_assert(WAYS > 0 && WAYS <= 256);
+  std::array<uint8_t, WAYS> rank;
+
+public:
+  lru_policy() { std::iota(std::begin(rank), std::end(rank), uint8_t{0}); }
+
+  void touch(std::size_t way)
+  {
+    auto old_rank = rank[way];
+    for (auto& r : rank)
+      r = static_cast<uint8_t>(r + (r < old_rank));
+    rank[way] = 0;
+  }
+
+  void insert(std::size_t way) { touch(way); }
+
+  std::size_t victim() const { return static_cast<std::size_t>(std::distance(std::begin(rank), std::max_element(std::begin(rank), std::end(rank)))); }
+};
+
+// Tree pseudo-LRU. Each node of the tree points toward the less recently used half of its subtree.
+template <std::size_t WAYS>
+class plru_policy
+{
+  static_assert(WAYS > 0 && WAYS <= 64 && isPowerOf2(WAYS));
+  constexpr static unsigned LEVELS = lg2(WAYS);
+  uint64_t tree = 0; // node n (1-indexed, in heap order) is bit n
+
+public:
+  void touch(std::size_t way)
+  {
+    std::size_t node = 1;
+    for (unsigned level = 0; level < LEVELS; ++level) {
+      auto right = (way >> (LEVELS - 1 - level)) & 1;
+      // Point away from the way that was just used
+      tree = (tree & ~(uint64_t{1} << node)) | (uint64_t{!right} << node);
+      node = 2 * node + right;
+    }
+  }
+
+  void insert(std::size_t way) { touch(way); }
+
+  std::size_t victim() const
+  {
+    std::size_t node = 1;
+    std::size_t way = 0;
+    for (unsigned level = 0; level < LEVELS; ++level) {
+      auto right = (tree >> node) & 1;
+      way = (way << 1) | right;
+      node = 2 * node + right;
+    }
+    return way;
+  }
+};
+
+// Static re-reference interval prediction, with RRPV_BITS-bit predictions. New entries are predicted to be re-referenced
+// in the long interval, and hits predict a near re-reference.
+template <std::size_t WAYS, unsigned RRPV_BITS = 2>
+class srrip_policy
+{
+  static_assert(WAYS > 0 && RRPV_BITS > 0 && RRPV_BITS < 8);
+  constexpr static uint8_t MAX_RRPV = static_cast<uint8_t>(bitmask(RRPV_BITS));
+  std::array<uint8_t, WAYS> rrpv;
+
+public:
+  srrip_policy() { rrpv.fill(MAX_RRPV); }
+
+  void touch(std::size_t way) { rrpv[way] = 0; }
+
+  void insert(std::size_t way) { rrpv[way] = MAX_RRPV - 1; }
+
+  std::size_t victim()
+  {
+    // Age every entry until one is predicted to be re-referenced in the distant future
+    auto oldest = *std::max_element(std::begin(rrpv), std::end(rrpv));
+    for (auto& r : rrpv)
+      r = static_cast<uint8_t>(r + MAX_RRPV - oldest);
+    return static_cast<std::size_t>(std::distance(std::begin(rrpv), std::find(std::begin(rrpv), std::end(rrpv), MAX_RRPV)));
+  }
+};
+} // namespace champsim::msl
+
+#endif
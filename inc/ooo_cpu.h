@@ -22,22 +22,28 @@
 #ifndef OOO_CPU_H
 #define OOO_CPU_H
 
+#include <algorithm>
 #include <array>
 #include <bitset>
 #include <deque>
 #include <limits>
+#include <map>
 #include <memory>
 #include <optional>
 #include <queue>
 #include <stdexcept>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include "champsim.h"
 #include "champsim_constants.h"
 #include "channel.h"
+#include "commit_log.h"
 #include "instruction.h"
 #include "module_impl.h"
 #include "operable.h"
+#include "util/bits.h"
 #include "util/lru_table.h"
 #include <type_traits>
 
@@ -61,20 +67,44 @@ public:
   bool issue_write(request_type packet);
 };
 
+// Causes to which a cycle without retirement is attributed. BASE counts cycles in which at least one instruction retired.
+enum class stall_type : unsigned {
+  BASE = 0,
+  FRONTEND_ICACHE,
+  FRONTEND_DIB_MISS,
+  FRONTEND_FETCH_STALL,
+  BAD_SPECULATION,
+  MEMORY,
+  CORE,
+  NUM_TYPES,
+};
+
+inline constexpr std::array<std::string_view, champsim::to_underlying(stall_type::NUM_TYPES)> stall_type_names{
+    std::string_view{"BASE"}, std::string_view{"FRONTEND_ICACHE"}, std::string_view{"FRONTEND_DIB_MISS"}, std::string_view{"FRONTEND_FETCH_STALL"},
+    std::string_view{"BAD_SPECULATION"}, std::string_view{"MEMORY"}, std::string_view{"CORE"}};
+
 struct cpu_stats {
   std::string name;
   uint64_t begin_instrs = 0, begin_cycles = 0;
   uint64_t end_instrs = 0, end_cycles = 0;
   uint64_t total_rob_occupancy_at_branch_mispredict = 0;
+  uint64_t memory_order_violations = 0;
+  uint64_t false_memory_dependences = 0;
 
   std::array<long long, 8> total_branch_types = {};
   std::array<long long, 8> branch_type_misses = {};
 
+  std::array<uint64_t, champsim::to_underlying(stall_type::NUM_TYPES)> stall_cycles = {};
+  std::map<std::string, uint64_t, std::less<>> memory_stall_cycles = {}; // MEMORY stalls, by the level that serviced the load
+
   uint64_t instrs() const { return end_instrs - begin_instrs; }
   uint64_t cycles() const { return end_cycles - begin_cycles; }
 };
 
 struct LSQ_ENTRY {
+  // How a load is released when the store it waits on finishes
+  enum class dependence_type { FORWARD, SYNCHRONIZE, REPLAY };
+
   uint64_t instr_id = 0;
   uint64_t virtual_address = 0;
   uint64_t ip = 0;
@@ -84,10 +114,17 @@ struct LSQ_ENTRY {
   bool fetch_issued = false;
 
   uint64_t producer_id = std::numeric_limits<uint64_t>::max();
+  dependence_type producer_dependence = dependence_type::FORWARD;
   std::vector<std::reference_wrapper<std::optional<LSQ_ENTRY>>> lq_depend_on_me{};
 
   LSQ_ENTRY(uint64_t id, uint64_t addr, uint64_t ip, std::array<uint8_t, 2> asid);
-  void finish(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end) const;
+  std::deque<ooo_model_instr>::iterator finish(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end) const;
+};
+
+struct execution_port_config {
+  unsigned count = 0; // zero ports means the class uses the shared execute width and latency
+  unsigned latency = 0;
+  bool pipelined = true;
 };
 
 // cpu
@@ -123,6 +160,7 @@ public:
   dib_type DIB;
 
   // reorder buffer, load/store queue, register file
+  std::deque<ooo_model_instr> FETCH_TARGET_QUEUE;
   std::deque<ooo_model_instr> IFETCH_BUFFER;
   std::deque<ooo_model_instr> DISPATCH_BUFFER;
   std::deque<ooo_model_instr> DECODE_BUFFER;
@@ -133,29 +171,46 @@ public:
 
   std::array<std::vector<std::reference_wrapper<ooo_model_instr>>, std::numeric_limits<uint8_t>::max() + 1> reg_producers;
 
+  // execution ports, indexed by instruction class. Each element holds the cycle at which a port can next accept an instruction.
+  std::array<std::vector<uint64_t>, NUM_INSTR_CLASSES> exec_port_available_cycle;
+
   // Constants
-  const std::size_t IFETCH_BUFFER_SIZE, DISPATCH_BUFFER_SIZE, DECODE_BUFFER_SIZE, ROB_SIZE, SQ_SIZE;
-  const long int FETCH_WIDTH, DECODE_WIDTH, DISPATCH_WIDTH, SCHEDULER_SIZE, EXEC_WIDTH;
+  const std::size_t FTQ_SIZE, IFETCH_BUFFER_SIZE, DISPATCH_BUFFER_SIZE, DECODE_BUFFER_SIZE, ROB_SIZE, SQ_SIZE;
+  const long int PREDICTION_WIDTH, FETCH_WIDTH, DECODE_WIDTH, DISPATCH_WIDTH, SCHEDULER_SIZE, EXEC_WIDTH;
   const long int LQ_WIDTH, SQ_WIDTH;
   const long int RETIRE_WIDTH;
   const unsigned BRANCH_MISPREDICT_PENALTY, DISPATCH_LATENCY, DECODE_LATENCY, SCHEDULING_LATENCY, EXEC_LATENCY;
   const long int L1I_BANDWIDTH, L1D_BANDWIDTH;
+  const unsigned MEMORY_REPLAY_PENALTY;
+  const std::array<execution_port_config, NUM_INSTR_CLASSES> EXEC_PORTS;
+
+  // If no memory dependence predictor is configured, loads are perfectly disambiguated
+  const bool PERFECT_MEMORY_DISAMBIGUATION;
 
   // branch
   uint64_t fetch_resume_cycle = 0;
+  bool recovering_from_mispredict = false; // set from the resolution of a mispredicted branch until the correct path reaches the ROB
 
-  const long IN_QUEUE_SIZE = 2 * FETCH_WIDTH;
+  // number of entries at the head of the FTQ that have already been considered for instruction prefetching
+  std::size_t ftq_prefetch_head = 0;
+
+  const long IN_QUEUE_SIZE = 2 * std::max(FETCH_WIDTH, PREDICTION_WIDTH);
   std::deque<ooo_model_instr> input_queue;
 
   CacheBus L1I_bus, L1D_bus;
   CACHE* l1i;
 
+  // If set, retired instructions in the detailed phase are recorded here
+  std::unique_ptr<champsim::commit_log_writer> commit_log;
+
   void initialize() override final;
   long operate() override final;
   void begin_phase() override final;
   void end_phase(unsigned cpu) override final;
 
   void initialize_instruction();
+  long prefetch_from_ftq();
+  long promote_to_ifetch();
   long check_dib();
   long fetch_instruction();
   long promote_to_decode();
@@ -167,6 +222,7 @@ public:
   long complete_inflight_instruction();
   long handle_memory_return();
   long retire_rob();
+  stall_type classify_stall() const;
 
   bool do_init_instruction(ooo_model_instr& instr);
   bool do_predict_branch(ooo_model_instr& instr);
@@ -174,7 +230,7 @@ public:
   bool do_fetch_instruction(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end);
   void do_dib_update(const ooo_model_instr& instr);
   void do_scheduling(ooo_model_instr& instr);
-  void do_execution(ooo_model_instr& rob_it);
+  bool do_execution(ooo_model_instr& rob_it);
   void do_memory_scheduling(ooo_model_instr& instr);
   void do_complete_execution(ooo_model_instr& instr);
   void do_sq_forward_to_lq(LSQ_ENTRY& sq_entry, LSQ_ENTRY& lq_entry);
@@ -202,13 +258,27 @@ public:
     virtual void impl_initialize_btb() = 0;
     virtual void impl_update_btb(uint64_t ip, uint64_t predicted_target, uint8_t taken, uint8_t branch_type) = 0;
     virtual std::pair<uint64_t, uint8_t> impl_btb_prediction(uint64_t ip) = 0;
+
+    virtual void impl_initialize_memory_dependence_predictor() = 0;
+    virtual uint64_t impl_predict_load_dependence(uint64_t ip) = 0;
+    virtual void impl_dispatch_store(uint64_t ip, uint64_t instr_id) = 0;
+    virtual void impl_execute_store(uint64_t ip, uint64_t instr_id) = 0;
+    virtual void impl_memory_order_violation(uint64_t load_ip, uint64_t store_ip) = 0;
+
+    virtual unsigned long long branch_predictor_flags() const = 0;
+    virtual unsigned long long btb_flags() const = 0;
+    virtual unsigned long long memory_dependence_predictor_flags() const = 0;
   };
 
-  template <unsigned long long B_FLAG, unsigned long long T_FLAG>
+  template <unsigned long long B_FLAG, unsigned long long T_FLAG, unsigned long long M_FLAG>
   struct module_model final : module_concept {
     O3_CPU* intern_;
     explicit module_model(O3_CPU* core) : intern_(core) {}
 
+    unsigned long long branch_predictor_flags() const { return B_FLAG; }
+    unsigned long long btb_flags() const { return T_FLAG; }
+    unsigned long long memory_dependence_predictor_flags() const { return M_FLAG; }
+
     void impl_initialize_branch_predictor();
     void impl_last_branch_result(uint64_t ip, uint64_t target, uint8_t taken, uint8_t branch_type);
     uint8_t impl_predict_branch(uint64_t ip);
@@ -216,10 +286,51 @@ public:
     void impl_initialize_btb();
     void impl_update_btb(uint64_t ip, uint64_t predicted_target, uint8_t taken, uint8_t branch_type);
     std::pair<uint64_t, uint8_t> impl_btb_prediction(uint64_t ip);
+
+    void impl_initialize_memory_dependence_predictor();
+    uint64_t impl_predict_load_dependence(uint64_t ip);
+    void impl_dispatch_store(uint64_t ip, uint64_t instr_id);
+    void impl_execute_store(uint64_t ip, uint64_t instr_id);
+    void impl_memory_order_violation(uint64_t load_ip, uint64_t store_ip);
+  };
+
+  // A model whose modules are chosen when the simulator starts, rather than when it is configured
+  struct dynamic_module_model final : module_concept {
+    O3_CPU* intern_;
+    unsigned long long b_flags, t_flags, m_flags;
+    dynamic_module_model(O3_CPU* core, unsigned long long b, unsigned long long t, unsigned long long m) : intern_(core), b_flags(b), t_flags(t), m_flags(m) {}
+
+    unsigned long long branch_predictor_flags() const { return b_flags; }
+    unsigned long long btb_flags() const { return t_flags; }
+    unsigned long long memory_dependence_predictor_flags() const { return m_flags; }
+
+    void impl_initialize_branch_predictor();
+    void impl_last_branch_result(uint64_t ip, uint64_t target, uint8_t taken, uint8_t branch_type);
+    uint8_t impl_predict_branch(uint64_t ip);
+
+    void impl_initialize_btb();
+    void impl_update_btb(uint64_t ip, uint64_t predicted_target, uint8_t taken, uint8_t branch_type);
+    std::pair<uint64_t, uint8_t> impl_btb_prediction(uint64_t ip);
+
+    void impl_initialize_memory_dependence_predictor();
+    uint64_t impl_predict_load_dependence(uint64_t ip);
+    void impl_dispatch_store(uint64_t ip, uint64_t instr_id);
+    void impl_execute_store(uint64_t ip, uint64_t instr_id);
+    void impl_memory_order_violation(uint64_t load_ip, uint64_t store_ip);
   };
 
   std::unique_ptr<module_concept> module_pimpl;
 
+  // The modules compiled into the simulator, by name
+  static const champsim::module_registry& branch_predictor_registry();
+  static const champsim::module_registry& btb_registry();
+  static const champsim::module_registry& memory_dependence_predictor_registry();
+
+  // Replace the modules chosen when the simulator was configured. These must be called before the core is initialized.
+  void select_branch_predictor(const std::vector<std::string>& names);
+  void select_btb(const std::vector<std::string>& names);
+  void select_memory_dependence_predictor(const std::vector<std::string>& names);
+
   void impl_initialize_branch_predictor() { module_pimpl->impl_initialize_branch_predictor(); }
   void impl_last_branch_result(uint64_t ip, uint64_t target, uint8_t taken, uint8_t branch_type)
   {
@@ -234,25 +345,33 @@ public:
   }
   std::pair<uint64_t, uint8_t> impl_btb_prediction(uint64_t ip) { return module_pimpl->impl_btb_prediction(ip); }
 
+  void impl_initialize_memory_dependence_predictor() { module_pimpl->impl_initialize_memory_dependence_predictor(); }
+  uint64_t impl_predict_load_dependence(uint64_t ip) { return module_pimpl->impl_predict_load_dependence(ip); }
+  void impl_dispatch_store(uint64_t ip, uint64_t instr_id) { module_pimpl->impl_dispatch_store(ip, instr_id); }
+  void impl_execute_store(uint64_t ip, uint64_t instr_id) { module_pimpl->impl_execute_store(ip, instr_id); }
+  void impl_memory_order_violation(uint64_t load_ip, uint64_t store_ip) { module_pimpl->impl_memory_order_violation(load_ip, store_ip); }
+
   class builder_conversion_tag
   {
   };
-  template <unsigned long long B_FLAG = 0, unsigned long long T_FLAG = 0>
+  template <unsigned long long B_FLAG = 0, unsigned long long T_FLAG = 0, unsigned long long M_FLAG = 0>
   class Builder
   {
-    using self_type = Builder<B_FLAG, T_FLAG>;
+    using self_type = Builder<B_FLAG, T_FLAG, M_FLAG>;
 
     uint32_t m_cpu{};
     double m_freq_scale{};
     std::size_t m_dib_set{};
     std::size_t m_dib_way{};
     std::size_t m_dib_window{};
+    std::size_t m_ftq_size{};
     std::size_t m_ifetch_buffer_size{};
     std::size_t m_decode_buffer_size{};
     std::size_t m_dispatch_buffer_size{};
     std::size_t m_rob_size{};
     std::size_t m_lq_size{};
     std::size_t m_sq_size{};
+    unsigned m_prediction_width{};
     unsigned m_fetch_width{};
     unsigned m_decode_width{};
     unsigned m_dispatch_width{};
@@ -266,6 +385,8 @@ public:
     unsigned m_dispatch_latency{};
     unsigned m_schedule_latency{};
     unsigned m_execute_latency{};
+    unsigned m_memory_replay_penalty{};
+    std::array<execution_port_config, NUM_INSTR_CLASSES> m_exec_ports{};
 
     CACHE* m_l1i{};
     long int m_l1i_bw{};
@@ -275,16 +396,16 @@ public:
 
     friend class O3_CPU;
 
-    template <unsigned long long OTHER_B, unsigned long long OTHER_T>
-    Builder(builder_conversion_tag, const Builder<OTHER_B, OTHER_T>& other)
+    template <unsigned long long OTHER_B, unsigned long long OTHER_T, unsigned long long OTHER_M>
+    Builder(builder_conversion_tag, const Builder<OTHER_B, OTHER_T, OTHER_M>& other)
         : m_cpu(other.m_cpu), m_freq_scale(other.m_freq_scale), m_dib_set(other.m_dib_set), m_dib_way(other.m_dib_way), m_dib_window(other.m_dib_window),
-          m_ifetch_buffer_size(other.m_ifetch_buffer_size), m_decode_buffer_size(other.m_decode_buffer_size),
+          m_ftq_size(other.m_ftq_size), m_ifetch_buffer_size(other.m_ifetch_buffer_size), m_decode_buffer_size(other.m_decode_buffer_size),
           m_dispatch_buffer_size(other.m_dispatch_buffer_size), m_rob_size(other.m_rob_size), m_lq_size(other.m_lq_size), m_sq_size(other.m_sq_size),
-          m_fetch_width(other.m_fetch_width), m_decode_width(other.m_decode_width), m_dispatch_width(other.m_dispatch_width),
+          m_prediction_width(other.m_prediction_width), m_fetch_width(other.m_fetch_width), m_decode_width(other.m_decode_width), m_dispatch_width(other.m_dispatch_width),
           m_schedule_width(other.m_schedule_width), m_execute_width(other.m_execute_width), m_lq_width(other.m_lq_width), m_sq_width(other.m_sq_width),
           m_retire_width(other.m_retire_width), m_mispredict_penalty(other.m_mispredict_penalty), m_decode_latency(other.m_decode_latency),
           m_dispatch_latency(other.m_dispatch_latency), m_schedule_latency(other.m_schedule_latency), m_execute_latency(other.m_execute_latency),
-          m_l1i(other.m_l1i), m_l1i_bw(other.m_l1i_bw), m_l1d_bw(other.m_l1d_bw), m_fetch_queues(other.m_fetch_queues), m_data_queues(other.m_data_queues)
+          m_memory_replay_penalty(other.m_memory_replay_penalty), m_exec_ports(other.m_exec_ports), m_l1i(other.m_l1i), m_l1i_bw(other.m_l1i_bw), m_l1d_bw(other.m_l1d_bw), m_fetch_queues(other.m_fetch_queues), m_data_queues(other.m_data_queues)
     {
     }
 
@@ -316,6 +437,11 @@ public:
       m_dib_window = dib_window_;
       return *this;
     }
+    self_type& ftq_size(std::size_t ftq_size_)
+    {
+      m_ftq_size = ftq_size_;
+      return *this;
+    }
     self_type& ifetch_buffer_size(std::size_t ifetch_buffer_size_)
     {
       m_ifetch_buffer_size = ifetch_buffer_size_;
@@ -346,6 +472,11 @@ public:
       m_sq_size = sq_size_;
       return *this;
     }
+    self_type& prediction_width(unsigned prediction_width_)
+    {
+      m_prediction_width = prediction_width_;
+      return *this;
+    }
     self_type& fetch_width(unsigned fetch_width_)
     {
       m_fetch_width = fetch_width_;
@@ -411,6 +542,16 @@ public:
       m_execute_latency = execute_latency_;
       return *this;
     }
+    self_type& memory_replay_penalty(unsigned memory_replay_penalty_)
+    {
+      m_memory_replay_penalty = memory_replay_penalty_;
+      return *this;
+    }
+    self_type& execution_port(instr_class cls, unsigned count, unsigned latency, bool pipelined)
+    {
+      m_exec_ports.at(champsim::to_underlying(cls)) = {count, latency, pipelined};
+      return *this;
+    }
     self_type& l1i(CACHE* l1i_)
     {
       m_l1i = l1i_;
@@ -438,27 +579,35 @@ public:
     }
 
     template <unsigned long long B>
-    Builder<B, T_FLAG> branch_predictor()
+    Builder<B, T_FLAG, M_FLAG> branch_predictor()
     {
-      return Builder<B, T_FLAG>{builder_conversion_tag{}, *this};
+      return Builder<B, T_FLAG, M_FLAG>{builder_conversion_tag{}, *this};
     }
     template <unsigned long long T>
-    Builder<B_FLAG, T> btb()
+    Builder<B_FLAG, T, M_FLAG> btb()
+    {
+      return Builder<B_FLAG, T, M_FLAG>{builder_conversion_tag{}, *this};
+    }
+    template <unsigned long long M>
+    Builder<B_FLAG, T_FLAG, M> memory_dependence_predictor()
     {
-      return Builder<B_FLAG, T>{builder_conversion_tag{}, *this};
+      return Builder<B_FLAG, T_FLAG, M>{builder_conversion_tag{}, *this};
     }
   };
 
-  template <unsigned long long B_FLAG, unsigned long long T_FLAG>
-  explicit O3_CPU(Builder<B_FLAG, T_FLAG> b)
+  template <unsigned long long B_FLAG, unsigned long long T_FLAG, unsigned long long M_FLAG>
+  explicit O3_CPU(Builder<B_FLAG, T_FLAG, M_FLAG> b)
       : champsim::operable(b.m_freq_scale), cpu(b.m_cpu), DIB(b.m_dib_set, b.m_dib_way, {champsim::lg2(b.m_dib_window)}, {champsim::lg2(b.m_dib_window)}),
-        LQ(b.m_lq_size), IFETCH_BUFFER_SIZE(b.m_ifetch_buffer_size), DISPATCH_BUFFER_SIZE(b.m_dispatch_buffer_size), DECODE_BUFFER_SIZE(b.m_decode_buffer_size),
-        ROB_SIZE(b.m_rob_size), SQ_SIZE(b.m_sq_size), FETCH_WIDTH(b.m_fetch_width), DECODE_WIDTH(b.m_decode_width), DISPATCH_WIDTH(b.m_dispatch_width),
+        LQ(b.m_lq_size), FTQ_SIZE(b.m_ftq_size), IFETCH_BUFFER_SIZE(b.m_ifetch_buffer_size), DISPATCH_BUFFER_SIZE(b.m_dispatch_buffer_size), DECODE_BUFFER_SIZE(b.m_decode_buffer_size),
+        ROB_SIZE(b.m_rob_size), SQ_SIZE(b.m_sq_size), PREDICTION_WIDTH(b.m_prediction_width), FETCH_WIDTH(b.m_fetch_width), DECODE_WIDTH(b.m_decode_width), DISPATCH_WIDTH(b.m_dispatch_width),
         SCHEDULER_SIZE(b.m_schedule_width), EXEC_WIDTH(b.m_execute_width), LQ_WIDTH(b.m_lq_width), SQ_WIDTH(b.m_sq_width), RETIRE_WIDTH(b.m_retire_width),
         BRANCH_MISPREDICT_PENALTY(b.m_mispredict_penalty), DISPATCH_LATENCY(b.m_dispatch_latency), DECODE_LATENCY(b.m_decode_latency),
         SCHEDULING_LATENCY(b.m_schedule_latency), EXEC_LATENCY(b.m_execute_latency), L1I_BANDWIDTH(b.m_l1i_bw), L1D_BANDWIDTH(b.m_l1d_bw),
-        L1I_bus(b.m_cpu, b.m_fetch_queues), L1D_bus(b.m_cpu, b.m_data_queues), l1i(b.m_l1i), module_pimpl(std::make_unique<module_model<B_FLAG, T_FLAG>>(this))
+        MEMORY_REPLAY_PENALTY(b.m_memory_replay_penalty), EXEC_PORTS(b.m_exec_ports), PERFECT_MEMORY_DISAMBIGUATION(M_FLAG == 0), L1I_bus(b.m_cpu, b.m_fetch_queues),
+        L1D_bus(b.m_cpu, b.m_data_queues), l1i(b.m_l1i), module_pimpl(std::make_unique<module_model<B_FLAG, T_FLAG, M_FLAG>>(this))
   {
+    for (std::size_t i = 0; i < NUM_INSTR_CLASSES; ++i)
+      exec_port_available_cycle[i].resize(EXEC_PORTS[i].count);
   }
 };
 
@@ -25,6 +25,8 @@
 #include "cache.h"
 #include "dram_controller.h"
 #include "ooo_cpu.h"
+#include "ptw.h"
+#include "vmem.h"
 #include <string_view>
 
 namespace champsim
@@ -43,7 +45,9 @@ struct phase_stats {
   std::vector<std::string> trace_names;
   std::vector<O3_CPU::stats_type> roi_cpu_stats, sim_cpu_stats;
   std::vector<CACHE::stats_type> roi_cache_stats, sim_cache_stats;
+  std::vector<PageTableWalker::stats_type> roi_ptw_stats, sim_ptw_stats;
   std::vector<DRAM_CHANNEL::stats_type> roi_dram_stats, sim_dram_stats;
+  VirtualMemory::stats_type vmem_stats;
 };
 
 } // namespace champsim
@@ -0,0 +1,141 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PREFETCH_ARBITER_H
+#define PREFETCH_ARBITER_H
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace champsim
+{
+/*
+ * Chooses among the prefetches proposed by several prefetchers on the same cache. Each prefetcher is a source, numbered in order of
+ * priority. Candidates wait in a bounded queue for each source, and each cycle up to the issue budget of them are issued, ordered either by the
+ * priority of their source or by its measured accuracy. A block that any source issued recently is not issued again.
+ *
+ * The blocks that are waiting or were issued recently are kept in an open-addressed table, which is sized when the sources are numbered so that
+ * proposals do not allocate.
+ */
+class prefetch_arbiter
+{
+public:
+  enum class policy { PRIORITY, CONFIDENCE };
+
+  struct config_type {
+    policy order = policy::PRIORITY;
+    std::size_t issue_budget = 1;                // candidates issued per cycle
+    std::size_t filter_size = 64;                // recently issued blocks that are remembered
+    std::size_t queue_size = 32;                 // candidates of each source that may wait to be issued
+    std::vector<unsigned long long> priority{};  // prefetcher flags, highest priority first
+  };
+
+  struct candidate {
+    uint64_t address;
+    bool fill_this_level;
+    uint32_t metadata;
+    uint32_t cpu;
+    std::size_t source;
+  };
+
+  enum class proposal_result { ACCEPTED, DUPLICATE, DROPPED };
+
+  // The useful and useless counts that give a source its confidence are halved when they reach this total
+  constexpr static unsigned CONFIDENCE_WINDOW = 256;
+
+private:
+  struct confidence_counter {
+    unsigned useful = 0;
+    unsigned useless = 0;
+
+    void age();
+  };
+
+  constexpr static uint64_t NO_BLOCK = std::numeric_limits<uint64_t>::max();
+
+  config_type config;
+  unsigned offset_bits;
+  std::vector<unsigned long long> source_flags{};
+  std::vector<confidence_counter> counters{};
+  std::vector<std::deque<candidate>> queues{1}; // one per source, each in the order its candidates were proposed
+  std::size_t waiting = 0;
+  std::vector<uint64_t> recent = std::vector<uint64_t>(config.filter_size, NO_BLOCK); // the recently issued blocks, replaced in turn
+  std::size_t next_recent = 0;
+  std::vector<uint64_t> tracked_blocks{}; // the blocks that are waiting or were issued recently, by linear probing
+  unsigned tracked_bits = 0;              // the log2 of the size of tracked_blocks
+
+  std::size_t home_slot(uint64_t block) const;
+  std::size_t find_slot(uint64_t block) const;
+  void track(uint64_t block);
+  void untrack(uint64_t block);
+  void resize_tracked_blocks();
+
+  void remember(uint64_t block);
+  std::deque<candidate>& next_queue();
+
+public:
+  prefetch_arbiter(config_type config_, unsigned offset_bits_) : config(std::move(config_)), offset_bits(offset_bits_) { resize_tracked_blocks(); }
+
+  // Replace the priority order of the prefetchers. The sources are renumbered by the next call to set_sources().
+  void set_priority(std::vector<unsigned long long> priority) { config.priority = std::move(priority); }
+
+  // Number the prefetchers in the given flags as sources: first those named in the priority order, then the rest in flag order
+  void set_sources(unsigned long long flags);
+
+  const config_type& get_config() const { return config; }
+  const std::vector<unsigned long long>& sources() const { return source_flags; }
+
+  // The source of a prefetcher flag. A flag that is not a source is given the lowest priority.
+  std::size_t source_of(unsigned long long flag) const;
+
+  proposal_result propose(candidate pf);
+
+  // Pass candidates to the issue function, in order, until the budget is spent or the function fails. Returns the number issued.
+  template <typename F>
+  long issue(F&& issue_func);
+
+  void record_useful(std::size_t source);
+  void record_useless(std::size_t source);
+
+  // The fraction of the source's recent prefetches that were useful, with one of each assumed
+  double confidence(std::size_t source) const;
+
+  std::size_t occupancy() const { return waiting; }
+};
+
+template <typename F>
+long prefetch_arbiter::issue(F&& issue_func)
+{
+  long issued{0};
+  while (waiting > 0 && static_cast<std::size_t>(issued) < config.issue_budget) {
+    auto& queue = next_queue();
+    if (!issue_func(queue.front()))
+      break;
+
+    remember(queue.front().address >> offset_bits);
+    queue.pop_front();
+    --waiting;
+    ++issued;
+  }
+
+  return issued;
+}
+} // namespace champsim
+
+#endif
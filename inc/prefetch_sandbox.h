@@ -0,0 +1,102 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PREFETCH_SANDBOX_H
+#define PREFETCH_SANDBOX_H
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace champsim
+{
+/*
+ * Evaluates the prefetchers of a cache without issuing their prefetches, and selects one of them to issue. Every prefetcher is a
+ * candidate. The blocks each candidate predicts are kept in a shadow tag array shared by all candidates, and a candidate is credited
+ * when a demand access that would otherwise have missed finds a block it predicted. At the end of each interval, the candidate that
+ * covered the most such accesses, among those accurate enough, is selected. The others run dark.
+ */
+class prefetch_sandbox
+{
+public:
+  struct config_type {
+    uint64_t interval = 32768; // cycles between selections
+    std::size_t shadow_sets = 256;
+    std::size_t shadow_ways = 8;
+    double accuracy_threshold = 0.25; // a candidate less accurate than this is not selected
+  };
+
+  constexpr static std::size_t NONE = std::numeric_limits<std::size_t>::max();
+
+  // The number of candidates a shadow entry can name
+  constexpr static std::size_t MAX_CANDIDATES = std::numeric_limits<unsigned long long>::digits;
+
+private:
+  struct shadow_entry {
+    bool valid = false;
+    uint64_t block = 0;
+    unsigned long long candidates = 0; // a bit for each candidate that predicted the block
+    uint64_t last_used = 0;
+  };
+
+  // Each count is halved at the end of an interval, so that earlier intervals weigh less
+  struct score_counter {
+    double predicted = 0;
+    double covered = 0;
+  };
+
+  config_type config;
+  unsigned offset_bits;
+  std::vector<shadow_entry> shadow;
+  std::vector<score_counter> counters{};
+  double demand_misses = 0;
+  std::size_t selection = 0;
+
+  uint64_t interval_cycles = 0;
+  uint64_t access_count = 0;
+
+  std::vector<shadow_entry>::iterator set_begin(uint64_t block);
+
+public:
+  prefetch_sandbox(config_type config_, unsigned offset_bits_);
+
+  // Evaluate the given number of candidates, selecting the first
+  void set_sources(std::size_t count);
+
+  const config_type& get_config() const { return config; }
+
+  // Advance one cycle. Returns true if an interval ended and a candidate was selected.
+  bool operate();
+
+  // The candidate whose prefetches are issued, or NONE if no candidate is accurate enough
+  std::size_t selected() const { return selection; }
+  void select(std::size_t source) { selection = source; }
+  bool is_selected(std::size_t source) const { return source == selection; }
+
+  // The fraction of the candidate's predictions that demand accesses used
+  double accuracy(std::size_t source) const;
+
+  // The fraction of the demand accesses that would have missed that the candidate predicted
+  double coverage(std::size_t source) const;
+
+  void record_prediction(std::size_t source, uint64_t address);
+
+  // A demand access that would have missed is one that missed, or that hit a block a prefetch brought in
+  void record_demand(uint64_t address, bool would_miss);
+};
+} // namespace champsim
+
+#endif
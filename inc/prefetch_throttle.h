@@ -0,0 +1,105 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PREFETCH_THROTTLE_H
+#define PREFETCH_THROTTLE_H
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace champsim
+{
+/*
+ * Feedback-directed throttling of the prefetchers of a cache. Over each interval, the throttle measures the accuracy, lateness, and
+ * cache pollution of each prefetcher, and the utilization of the memory bandwidth. At the end of the interval, each prefetcher is moved
+ * up or down a level of aggressiveness. Each level has a degree, the number of prefetches a prefetcher may issue for one trigger.
+ */
+class prefetch_throttle
+{
+public:
+  struct config_type {
+    uint64_t interval = 8192;                         // cycles between updates of the levels
+    std::vector<std::size_t> degrees{1, 2, 4, 8, 16}; // the degree of each level, least aggressive first
+    double accuracy_high = 0.75;
+    double accuracy_low = 0.40;
+    double lateness = 0.01;  // the fraction of useful prefetches that may be late
+    double pollution = 0.005; // the fraction of demand misses that may be caused by prefetches
+    double bandwidth_high = 0.75;
+    std::size_t pollution_filter_size = 4096;
+  };
+
+private:
+  // Each count is halved at the end of an interval, so that earlier intervals weigh less
+  struct feedback_counter {
+    double issued = 0;
+    double useful = 0;
+    double late = 0;
+    double pollution = 0;
+  };
+
+  config_type config;
+  unsigned offset_bits;
+  std::vector<std::size_t> levels{};
+  std::vector<feedback_counter> counters{};
+  std::vector<std::size_t> trigger_count{};
+  double demand_misses = 0;
+
+  // Indexed by a hash of the block address, the source of the prefetch that last evicted the block, plus one, or zero
+  std::vector<std::size_t> pollution_filter;
+
+  uint64_t interval_cycles = 0;
+  std::function<double()> bandwidth_source{};
+  double last_bandwidth = 0;
+
+  std::size_t filter_index(uint64_t address) const;
+  int level_change(std::size_t source) const;
+
+public:
+  prefetch_throttle(config_type config_, unsigned offset_bits_);
+
+  // Throttle the given number of sources, each starting at the middle level
+  void set_sources(std::size_t count);
+
+  // The function is called at the end of each interval, and gives the utilization of the memory bandwidth over the interval
+  void set_bandwidth_source(std::function<double()> source) { bandwidth_source = std::move(source); }
+
+  const config_type& get_config() const { return config; }
+
+  // Advance one cycle. Returns true if an interval ended and the levels were updated.
+  bool operate();
+
+  // A trigger is one event that a prefetcher is told of. Each source may issue up to its degree of prefetches per trigger.
+  void begin_trigger();
+  bool admit(std::size_t source);
+
+  std::size_t level(std::size_t source) const;
+  std::size_t degree(std::size_t source) const;
+  double accuracy(std::size_t source) const;
+  double lateness(std::size_t source) const;
+  double pollution(std::size_t source) const;
+  double bandwidth() const { return last_bandwidth; }
+
+  void record_issued(std::size_t source);
+  void record_discarded(std::size_t source); // a prefetch that was issued, but discarded before it was sent, is not counted
+  void record_useful(std::size_t source, bool late);
+  void record_prefetch_eviction(std::size_t source, uint64_t address);
+  void record_demand_miss(uint64_t address);
+};
+} // namespace champsim
+
+#endif
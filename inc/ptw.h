@@ -19,12 +19,35 @@
 
 #include <array>
 #include <deque>
+#include <map>
 #include <string>
+#include <vector>
 
+#include "champsim_constants.h"
 #include "channel.h"
 #include "operable.h"
 #include "util/lru_table.h"
 
+struct ptw_stats {
+  constexpr static std::size_t LATENCY_BUCKETS = 16;
+
+  std::string name;
+  uint64_t walks = 0;
+  uint64_t steps = 0; // memory references made by walks
+
+  // Keyed by the level of the page table whose entries the PSCL holds
+  std::map<std::size_t, uint64_t> pscl_hits{};
+  std::map<std::size_t, uint64_t> pscl_misses{};
+
+  // Bucket i counts walks whose latency lies in [2^i, 2^(i+1)), except that the first bucket also counts zero and the last counts all longer walks
+  uint64_t total_walk_latency = 0;
+  std::array<uint64_t, LATENCY_BUCKETS> walk_latency{};
+
+  // The number of cycles in which each number of walks was in progress
+  uint64_t cycles = 0;
+  std::vector<uint64_t> concurrent_walks{};
+};
+
 class VirtualMemory;
 class PageTableWalker : public champsim::operable
 {
@@ -58,6 +81,8 @@ class PageTableWalker : public champsim::operable
     uint8_t asid[2] = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
 
     std::size_t translation_level = 0;
+    uint64_t walk_begin_cycle = 0;
+    unsigned page_bits = LOG2_PAGE_SIZE; // The size of the page that the walk found
 
     mshr_type(request_type req, std::size_t level);
   };
@@ -69,9 +94,13 @@ class PageTableWalker : public champsim::operable
   std::vector<channel_type*> upper_levels;
   channel_type* lower_level;
 
-  std::optional<mshr_type> handle_read(const request_type& pkt, channel_type* ul);
-  std::optional<mshr_type> handle_fill(const mshr_type& pkt);
-  std::optional<mshr_type> step_translation(const mshr_type& source);
+  // The level of the page table whose entries each PSCL holds
+  std::vector<std::size_t> pscl_levels{};
+
+  // Each returns whether the next step of the walk was issued. If so, the walk is placed in the MSHR.
+  bool handle_read(const request_type& pkt, channel_type* ul);
+  bool handle_fill(const mshr_type& pkt);
+  bool step_translation(const mshr_type& source);
 
   void finish_packet(const response_type& packet);
 
@@ -80,6 +109,10 @@ public:
   const uint32_t MSHR_SIZE;
   const long int MAX_READ, MAX_FILL;
   const uint64_t HIT_LATENCY;
+  const uint32_t cpu;
+
+  using stats_type = ptw_stats;
+  stats_type sim_stats, roi_stats;
 
   std::vector<pscl_type> pscl;
   VirtualMemory* vmem;
@@ -165,6 +198,7 @@ public:
   long operate() override final;
 
   void begin_phase() override final;
+  void end_phase(unsigned cpu) override final;
   void print_deadlock() override final;
 };
 
@@ -0,0 +1,41 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RUNTIME_CONFIG_H
+#define RUNTIME_CONFIG_H
+
+#include <istream>
+
+#include "environment.h"
+
+namespace champsim
+{
+/*
+ * Read the modules, prefetcher parameters, prefetch activation, and prefetch arbiters, throttles, sandboxes, and queue policies of a JSON configuration
+ * file, in the format that config.sh reads, and apply them to an environment that has not yet been initialized. The caches and cores are found by the
+ * same names that config.sh gives them.
+ *
+ * The hierarchy itself (the number of cores, and the size and connections of each cache) is fixed when the simulator is configured. The number of cores,
+ * and the sets, ways, latencies, queue sizes, and lower levels that the file gives each cache, must match those the simulator was configured with. All other
+ * keys are ignored. Modules must have been compiled into the simulator, for example with config.sh --compile-all-modules.
+ * Elements whose modules are not named in the file keep the modules they were configured with.
+ *
+ * Throws std::invalid_argument if the file does not match the simulator.
+ */
+void apply_runtime_config(environment& env, std::istream& config_file);
+} // namespace champsim
+
+#endif
@@ -21,6 +21,8 @@
 #include "dram_controller.h"
 #include "ooo_cpu.h"
 #include "phase_info.h"
+#include "ptw.h"
+#include "vmem.h"
 
 namespace champsim
 {
@@ -31,6 +33,8 @@ class plain_printer
   void print(O3_CPU::stats_type);
   void print(CACHE::stats_type);
   void print(DRAM_CHANNEL::stats_type);
+  void print(PageTableWalker::stats_type);
+  void print(VirtualMemory::stats_type);
 
   template <typename T>
   void print(std::vector<T> stats_list)
@@ -0,0 +1,128 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTIL_FLAT_HASH_MAP_H
+#define UTIL_FLAT_HASH_MAP_H
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace champsim
+{
+/*
+ * An open-addressing hash table with linear probing, keyed by 64-bit integers. Entries are stored inline in a single array,
+ * so a lookup usually touches one cache line. Entries cannot be erased. The largest key is reserved to mark empty slots.
+ *
+ * Each slot keeps the whole key beside the value, so a translation takes 16 bytes. The page keys of VirtualMemory already use
+ * every bit of a word for the cpu and the virtual page number, which leaves no room to pack the physical page number beside them.
+ */
+template <typename T>
+class flat_hash_map
+{
+public:
+  using key_type = uint64_t;
+  using mapped_type = T;
+
+  constexpr static key_type EMPTY_KEY = std::numeric_limits<key_type>::max();
+
+private:
+  struct slot_type {
+    key_type key = EMPTY_KEY;
+    mapped_type value{};
+  };
+
+  std::vector<slot_type> slots;
+  std::size_t occupancy = 0;
+
+  // The finalizer of splitmix64, which spreads consecutive keys across the table
+  static uint64_t hash(key_type key)
+  {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ull;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebull;
+    key ^= key >> 31;
+    return key;
+  }
+
+  // The slot holding the key, or the empty slot where it would be inserted
+  std::size_t probe(key_type key) const
+  {
+    auto mask = std::size(slots) - 1;
+    auto idx = static_cast<std::size_t>(hash(key)) & mask;
+    while (slots[idx].key != key && slots[idx].key != EMPTY_KEY)
+      idx = (idx + 1) & mask;
+    return idx;
+  }
+
+  void grow()
+  {
+    auto old_slots = std::exchange(slots, std::vector<slot_type>(2 * std::size(slots)));
+    for (auto& slot : old_slots) {
+      if (slot.key != EMPTY_KEY)
+        slots[probe(slot.key)] = std::move(slot);
+    }
+  }
+
+public:
+  // The capacity is rounded up to a power of two
+  explicit flat_hash_map(std::size_t initial_capacity = 1024)
+  {
+    std::size_t capacity = 1;
+    while (capacity < initial_capacity)
+      capacity *= 2;
+    slots.resize(capacity);
+  }
+
+  mapped_type* find(key_type key)
+  {
+    auto& slot = slots[probe(key)];
+    return (slot.key == key) ? &slot.value : nullptr;
+  }
+
+  const mapped_type* find(key_type key) const
+  {
+    const auto& slot = slots[probe(key)];
+    return (slot.key == key) ? &slot.value : nullptr;
+  }
+
+  // Inserts the value if the key is not present. Returns the mapped value, and whether it was inserted.
+  std::pair<mapped_type*, bool> try_emplace(key_type key, mapped_type value)
+  {
+    assert(key != EMPTY_KEY);
+
+    // Keep the load factor at most 3/4
+    if (4 * (occupancy + 1) > 3 * std::size(slots))
+      grow();
+
+    auto& slot = slots[probe(key)];
+    if (slot.key == key)
+      return {&slot.value, false};
+
+    slot = {key, std::move(value)};
+    ++occupancy;
+    return {&slot.value, true};
+  }
+
+  std::size_t size() const { return occupancy; }
+  std::size_t capacity() const { return std::size(slots); }
+};
+} // namespace champsim
+
+#endif
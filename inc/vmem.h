@@ -18,9 +18,15 @@
 #define VMEM_H
 
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <map>
+#include <optional>
+#include <random>
+#include <vector>
 
 #include "champsim_constants.h"
+#include "util/flat_hash_map.h"
 
 class MEMORY_CONTROLLER;
 
@@ -29,32 +35,141 @@ inline constexpr auto VMEM_RESERVE_CAPACITY = std::max<uint64_t>(PAGE_SIZE, 1ull
 
 inline constexpr std::size_t PTE_BYTES = 8;
 
+namespace champsim
+{
+// How pages are placed when the physical memory has several tiers. The first tier is taken to be the fastest.
+enum class page_placement {
+  FIRST_TOUCH, // fill the tiers in order
+  INTERLEAVE,  // place consecutively allocated pages in each tier in turn
+  HOT_PAGE     // place pages in the last tier, and promote them to the first after enough accesses
+};
+
+// Which regions of the virtual address space are mapped with huge pages
+enum class huge_page_policy {
+  NONE,   // map every page with the base page size
+  FIXED,  // map a fixed fraction of the regions, chosen by a hash of the region, with huge pages
+  PROMOTE // map a region with base pages until enough of them have been touched, then with a huge page
+};
+
+// The order in which base pages are handed out within a tier
+enum class page_allocation {
+  SEQUENTIAL, // in order of address, so that consecutively allocated pages are physically adjacent
+  RANDOM,     // in a random order within each pool of pages set aside from the tier
+  COLORED,    // with the same color as the virtual page, where the color is the part of the page number that indexes the LLC
+  FRAGMENTED  // in runs of random length, separated by pages taken to belong to other processes
+};
+
+struct page_allocation_config {
+  page_allocation policy = page_allocation::SEQUENTIAL;
+  uint64_t seed = 0;
+  uint64_t colors = 1;          // Under COLORED, the number of page colors
+  uint64_t fragment_pages = 16; // Under FRAGMENTED, the mean length of a run of free pages
+};
+
+struct huge_page_config {
+  huge_page_policy policy = huge_page_policy::NONE;
+  uint64_t size = (1ull << 21); // Must be the size of the region mapped by some level of the page table
+  unsigned fraction = 0;        // Under FIXED, the percentage of regions mapped with huge pages
+  uint64_t promote_after = 0;   // Under PROMOTE, the number of base pages touched in a region before it is promoted
+};
+} // namespace champsim
+
 class VirtualMemory
 {
 private:
-  std::map<std::pair<uint32_t, uint64_t>, uint64_t> vpage_to_ppage_map;
-  std::map<std::tuple<uint32_t, uint64_t, uint32_t>, uint64_t> page_table;
+  // Translations are keyed by page_key() of the virtual page. The page table has one map for each level, keyed by page_key() of the
+  // virtual address bits above the level.
+  champsim::flat_hash_map<uint64_t> vpage_to_ppage_map;
+  std::vector<champsim::flat_hash_map<uint64_t>> page_table;
+
+  // Huge pages are keyed by page_key() of the region they map. Under PROMOTE, the number of base pages touched in each region.
+  champsim::flat_hash_map<uint64_t> huge_page_map;
+  champsim::flat_hash_map<uint64_t> region_touches;
 
   uint64_t next_pte_page = 0;
 
-  uint64_t next_ppage;
-  uint64_t last_ppage;
+  // Base pages are allocated upward from next_ppage, and huge pages downward from last_ppage. Under random and fragmented allocation,
+  // base pages are first set aside in a pool, from which they are handed out in the order of the allocation policy. Under colored
+  // allocation, each color has its own cursor, the lowest free page of that color, and next_ppage is above every page handed out.
+  // Pages given back by hot page promotion join the pool, and are handed out again before new ones.
+  struct memory_tier {
+    uint64_t first_ppage;
+    uint64_t next_ppage;
+    uint64_t last_ppage;
+    uint64_t end_ppage;
+    std::deque<uint64_t> free_ppages{};
+    std::vector<uint64_t> next_color_ppage{};
+  };
+  std::vector<memory_tier> tiers;
+  std::size_t next_interleave_tier = 0;
+  std::mt19937_64 allocation_rng;
+
+  constexpr static uint64_t RANDOM_POOL_PAGES = 4096;
+
+  // For hot page promotion, the owner of each page in a slower tier, and the number of accesses to it, keyed by the page frame number.
+  // A frame that is given back when its page is promoted is marked as unmapped until it is handed out again.
+  struct slow_page_entry {
+    uint64_t owner = 0;
+    uint64_t accesses = 0;
+    bool mapped = false;
+  };
+  champsim::flat_hash_map<slow_page_entry> slow_ppages;
+
+  // Packs the CPU into the upper bits of a virtual address shifted right by the given amount
+  static uint64_t page_key(uint32_t cpu_num, uint64_t vaddr, std::size_t shift);
+
+  std::size_t tier_of(uint64_t paddr) const;
+  static bool fits(const memory_tier& tier, std::size_t page_bits);
+  bool can_allocate(std::size_t page_bits) const;
+  void refill_pool(memory_tier& tier);
+  void free_ppage(uint64_t ppage);
+  uint64_t page_color(uint64_t addr) const;
+
+  // The virtual address is given for pages that will map one, so that their color can be matched
+  uint64_t allocate_from(std::size_t tier_idx, std::size_t page_bits = LOG2_PAGE_SIZE, std::optional<uint64_t> vaddr = std::nullopt);
+  uint64_t allocate_ppage(champsim::page_placement how, std::size_t page_bits = LOG2_PAGE_SIZE, std::optional<uint64_t> vaddr = std::nullopt);
 
-  uint64_t ppage_front() const;
-  void ppage_pop();
+  std::size_t huge_page_bits() const;
+  bool chosen_for_huge_page(uint64_t region) const;
 
 public:
   const uint64_t minor_fault_penalty;
   const std::size_t pt_levels;
   const uint64_t pte_page_size; // Size of a PTE page
+  const champsim::page_placement placement;
+  const uint64_t promotion_threshold;
+  const champsim::huge_page_config huge_pages;
+  const champsim::page_allocation_config allocation;
+  const std::size_t huge_page_level;
+
+  uint64_t promotions = 0;           // pages moved to the fastest tier by hot page placement
+  uint64_t huge_page_promotions = 0; // regions remapped with a huge page under PROMOTE
+
+  struct stats_type {
+    uint64_t promotions = 0;
+    uint64_t huge_page_promotions = 0;
+  };
+  stats_type get_stats() const { return {promotions, huge_page_promotions}; }
 
   // capacity and pg_size are measured in bytes, and capacity must be a multiple of pg_size
   VirtualMemory(uint64_t pg_size, std::size_t page_table_levels, uint64_t minor_penalty, MEMORY_CONTROLLER& dram);
+
+  // Pages are allocated from the address range of each memory controller, with the fastest tier first
+  VirtualMemory(uint64_t pg_size, std::size_t page_table_levels, uint64_t minor_penalty, std::vector<std::reference_wrapper<MEMORY_CONTROLLER>> memory_tiers,
+                champsim::page_placement page_placement, uint64_t promote_after, champsim::huge_page_config huge = {},
+                champsim::page_allocation_config page_allocation = {});
   uint64_t shamt(std::size_t level) const;
   uint64_t get_offset(uint64_t vaddr, std::size_t level) const;
   std::size_t available_ppages() const;
   std::pair<uint64_t, uint64_t> va_to_pa(uint32_t cpu_num, uint64_t vaddr);
   std::pair<uint64_t, uint64_t> get_pte_pa(uint32_t cpu_num, uint64_t vaddr, std::size_t level);
+
+  // The level of the page table whose entries map the page holding the address: 1 for base pages, or huge_page_level. If the page
+  // is not yet mapped, this is the level at which va_to_pa() would map it.
+  std::size_t page_level(uint32_t cpu_num, uint64_t vaddr) const;
+
+  // Called by the memory controllers for each read. Under hot page placement, may move the page to the fastest tier.
+  void record_access(uint64_t paddr);
 };
 
 #endif
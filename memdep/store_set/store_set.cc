@@ -0,0 +1,92 @@
+/*
+ * This file implements the store set memory dependence predictor described in
+ * Chrysos and Emer, "Memory Dependence Prediction using Store Sets" (ISCA 1998).
+ *
+ * The Store Set ID Table (SSIT) maps load and store IPs to a store set. The
+ * Last Fetched Store Table (LFST) records the most recently dispatched store in
+ * each set, which loads in the same set are predicted to depend on.
+ */
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <map>
+#include <optional>
+
+#include "msl/bits.h"
+#include "ooo_cpu.h"
+
+namespace
+{
+constexpr std::size_t SSIT_SIZE = 4096;
+constexpr std::size_t LFST_SIZE = 256;
+constexpr uint64_t CLEAR_INTERVAL = 1000000; // cycles between SSIT invalidations
+
+struct store_set_predictor {
+  std::array<std::optional<std::size_t>, SSIT_SIZE> ssit{};
+  std::array<std::optional<uint64_t>, LFST_SIZE> lfst{};
+  uint64_t next_clear_cycle = CLEAR_INTERVAL;
+  std::size_t next_ssid = 0;
+
+  static std::size_t ssit_index(uint64_t ip) { return (ip ^ (ip >> champsim::msl::lg2(SSIT_SIZE))) & champsim::msl::bitmask(champsim::msl::lg2(SSIT_SIZE)); }
+  std::optional<std::size_t>& ssid(uint64_t ip) { return ssit[ssit_index(ip)]; }
+};
+
+std::map<O3_CPU*, store_set_predictor> predictors;
+} // namespace
+
+void O3_CPU::initialize_memory_dependence_predictor() { ::predictors[this] = {}; }
+
+uint64_t O3_CPU::predict_load_dependence(uint64_t ip)
+{
+  auto& pred = ::predictors[this];
+
+  // Periodically forget all store sets so that stale dependences do not accumulate
+  if (current_cycle >= pred.next_clear_cycle) {
+    std::fill(std::begin(pred.ssit), std::end(pred.ssit), std::nullopt);
+    pred.next_clear_cycle = current_cycle + ::CLEAR_INTERVAL;
+  }
+
+  auto ssid = pred.ssid(ip);
+  if (!ssid.has_value() || !pred.lfst[*ssid].has_value())
+    return std::numeric_limits<uint64_t>::max();
+
+  return *pred.lfst[*ssid];
+}
+
+void O3_CPU::dispatch_store(uint64_t ip, uint64_t instr_id)
+{
+  auto& pred = ::predictors[this];
+  if (auto ssid = pred.ssid(ip); ssid.has_value())
+    pred.lfst[*ssid] = instr_id;
+}
+
+void O3_CPU::execute_store(uint64_t ip, uint64_t instr_id)
+{
+  auto& pred = ::predictors[this];
+  if (auto ssid = pred.ssid(ip); ssid.has_value() && pred.lfst[*ssid] == instr_id)
+    pred.lfst[*ssid].reset();
+}
+
+void O3_CPU::memory_order_violation(uint64_t load_ip, uint64_t store_ip)
+{
+  auto& pred = ::predictors[this];
+  auto& load_ssid = pred.ssid(load_ip);
+  auto& store_ssid = pred.ssid(store_ip);
+
+  if (!load_ssid.has_value() && !store_ssid.has_value()) {
+    // Allocate a new store set for both instructions
+    load_ssid = pred.next_ssid;
+    store_ssid = pred.next_ssid;
+    pred.next_ssid = (pred.next_ssid + 1) % ::LFST_SIZE;
+  } else if (!load_ssid.has_value()) {
+    load_ssid = store_ssid;
+  } else if (!store_ssid.has_value()) {
+    store_ssid = load_ssid;
+  } else {
+    // Merge the two sets, with the smaller ID winning
+    auto winner = std::min(*load_ssid, *store_ssid);
+    load_ssid = winner;
+    store_ssid = winner;
+  }
+}
@@ -61,40 +61,27 @@ uint8_t LatencyTable::add(uint64_t addr, uint64_t tag, bool pf, uint64_t cycle)
     std::cout << " prefetch: " << std::dec << +pf << " cycle: " << cycle;
   }
 
-  latency_table *free;
-  free   = nullptr;
-
-  for (int i = 0; i < size; i++)
+  // Search if the addr already exists. If it exist we does not have
+  // to do nothing more
+  if (auto found = latencyt.check_hit({addr}); found.has_value())
   {
-    // Search if the addr already exists. If it exist we does not have
-    // to do nothing more
-    if (latencyt[i].addr == addr)
+    if constexpr (champsim::debug_print) 
     {
-      if constexpr (champsim::debug_print) 
-      {
-        std::cout << " line already found; find_tag: " << latencyt[i].tag;
-        std::cout << " find_pf: " << +latencyt[i].pf << std::endl;
-      }
-      // latencyt[i].time = cycle;
-      latencyt[i].pf   = pf;
-      latencyt[i].tag  = tag;
-      return latencyt[i].pf;
+      std::cout << " line already found; find_tag: " << found->tag;
+      std::cout << " find_pf: " << +found->pf << std::endl;
     }
-
-    // We discover a free space into the latency table, save it for later
-    if (latencyt[i].tag == 0) free = &latencyt[i];
+    found->pf   = pf;
+    found->tag  = tag;
+    latencyt.fill(*found);
+    return pf;
   }
 
-  if (free == nullptr) assert(0 && "No free space latency table");
-
-  // We save the new entry into the latency table
-  free->addr = addr;
-  free->time = cycle;
-  free->tag  = tag;
-  free->pf   = pf;
+  // We save the new entry into the latency table, replacing the least
+  // recently used entry of the set if it is full
+  latencyt.fill({addr, tag, cycle, pf});
 
   if constexpr (champsim::debug_print) std::cout << " new entry" << std::endl;
-  return free->pf;
+  return pf;
 }
 
 uint64_t LatencyTable::del(uint64_t addr)
@@ -114,29 +101,18 @@ uint64_t LatencyTable::del(uint64_t addr)
     std::cout << " addr: " << std::hex << addr;
   }
 
-  for (int i = 0; i < size; i++)
+  // Line already in the table
+  if (auto found = latencyt.invalidate({addr}); found.has_value())
   {
-    // Line already in the table
-    if (latencyt[i].addr == addr)
+    if constexpr (champsim::debug_print)
     {
-      // Calculate latency
-      uint64_t time = latencyt[i].time;
-
-      if constexpr (champsim::debug_print)
-      {
-        std::cout << " tag: " << latencyt[i].tag;
-        std::cout << " prefetch: " << std::dec << +latencyt[i].pf;
-        std::cout << " cycle: " << latencyt[i].time << std::endl;
-      }
-
-      latencyt[i].addr = 0; // Free the entry
-      latencyt[i].tag  = 0; // Free the entry
-      latencyt[i].time = 0; // Free the entry
-      latencyt[i].pf   = 0; // Free the entry
-
-      // Return the latency
-      return time;
+      std::cout << " tag: " << found->tag;
+      std::cout << " prefetch: " << std::dec << +found->pf;
+      std::cout << " cycle: " << found->time << std::endl;
     }
+
+    // Return the latency
+    return found->time;
   }
 
   // We should always track the misses
@@ -161,17 +137,13 @@ uint64_t LatencyTable::get(uint64_t addr)
     std::cout << " addr: " << std::hex << addr << std::dec;
   }
 
-  for (int i = 0; i < size; i++)
+  if (auto found = latencyt.check_hit({addr}); found.has_value())
   {
-    // Search if the addr already exists
-    if (latencyt[i].addr == addr)
+    if constexpr (champsim::debug_print)
     {
-      if constexpr (champsim::debug_print)
-      {
-        std::cout << " time: " << latencyt[i].time << std::endl;
-      }
-      return latencyt[i].time;
+      std::cout << " time: " << found->time << std::endl;
     }
+    return found->time;
   }
 
   if constexpr (champsim::debug_print) std::cout << " NOT FOUND" << std::endl;
@@ -195,16 +167,13 @@ uint64_t LatencyTable::get_tag(uint64_t addr)
     std::cout << " addr: " << std::hex << addr;
   }
 
-  for (int i = 0; i < size; i++)
+  if (auto found = latencyt.check_hit({addr}); found.has_value() && found->tag)
   {
-    if (latencyt[i].addr == addr && latencyt[i].tag) // This is the address
+    if constexpr (champsim::debug_print) 
     {
-      if constexpr (champsim::debug_print) 
-      {
-        std::cout << " tag: " << latencyt[i].tag << std::endl;
-      }
-      return latencyt[i].tag;
+      std::cout << " tag: " << found->tag << std::endl;
     }
+    return found->tag;
   }
 
   if constexpr (champsim::debug_print) std::cout << " NOT_FOUND" << std::endl;
@@ -214,6 +183,25 @@ uint64_t LatencyTable::get_tag(uint64_t addr)
 /******************************************************************************/
 /*                       Shadow Cache functions                               */
 /******************************************************************************/
+auto ShadowCache::get_set_span(uint64_t addr) -> std::pair<std::vector<shadow_cache>::iterator, std::vector<shadow_cache>::iterator>
+{
+  /*
+   * The cache indexes lines by the low bits of the line address. When the
+   * prefetcher is trained on virtual addresses, these bits are the same as
+   * long as they are within the page offset.
+   */
+  auto set = static_cast<std::ptrdiff_t>(addr & champsim::msl::bitmask(champsim::msl::lg2(sets)));
+  auto set_begin = std::next(std::begin(scache), set * static_cast<std::ptrdiff_t>(ways));
+  return {set_begin, std::next(set_begin, static_cast<std::ptrdiff_t>(ways))};
+}
+
+ShadowCache::shadow_cache *ShadowCache::find(uint64_t addr)
+{
+  auto [set_begin, set_end] = get_set_span(addr);
+  auto found = std::find_if(set_begin, set_end, [addr](const auto &x){ return x.addr == addr; });
+  return found == set_end ? nullptr : &*found;
+}
+
 bool ShadowCache::add(uint32_t set, uint32_t way, uint64_t addr, bool pf, uint64_t lat)
 {
   /*
@@ -236,10 +224,14 @@ bool ShadowCache::add(uint32_t set, uint32_t way, uint64_t addr, bool pf, uint64
     std::cout << " latency: " << lat << std::endl;
   }
 
-  scache[set][way].addr = addr;
-  scache[set][way].pf   = pf;
-  scache[set][way].lat  = lat;
-  return scache[set][way].pf;
+  // The fill bypassed the cache
+  if (set >= sets || way >= ways) return pf;
+
+  auto &entry = scache[set * ways + way];
+  entry.addr = addr;
+  entry.pf   = pf;
+  entry.lat  = lat;
+  return entry.pf;
 }
 
 bool ShadowCache::get(uint64_t addr)
@@ -257,22 +249,7 @@ bool ShadowCache::get(uint64_t addr)
     std::cout << " addr: " << std::hex << addr << std::endl;
   }
 
-  for (int i = 0; i < sets; i++)
-  {
-    for (int ii = 0; ii < ways; ii++)
-    {
-      if (scache[i][ii].addr == addr) 
-      {
-        if constexpr (champsim::debug_print)
-        {
-          std::cout << " set: " << i << " way: " << i << std::endl;
-        }
-        return true;
-      }
-    }
-  }
-
-  return false;
+  return find(addr) != nullptr;
 }
 
 void ShadowCache::set_pf(uint64_t addr, bool pf)
@@ -289,26 +266,15 @@ void ShadowCache::set_pf(uint64_t addr, bool pf)
     std::cout << " addr: " << std::hex << addr << std::dec;
   }
 
-  for (int i = 0; i < sets; i++)
+  if (auto entry = find(addr); entry != nullptr)
   {
-    for (int ii = 0; ii < ways; ii++)
+    if constexpr (champsim::debug_print)
     {
-      if (scache[i][ii].addr == addr) 
-      {
-        if constexpr (champsim::debug_print)
-        {
-          std::cout << " set: " << i << " way: " << ii;
-          std::cout << " old_pf_value: " << +scache[i][ii].pf;
-          std::cout << " new_pf_value: " << +pf << std::endl;
-        }
-        scache[i][ii].pf = pf;
-        return;
-      }
+      std::cout << " old_pf_value: " << +entry->pf;
+      std::cout << " new_pf_value: " << +pf << std::endl;
     }
+    entry->pf = pf;
   }
-
-  // The address should always be in the cache
-  assert((0) && "Address is must be in shadow cache");
 }
 
 bool ShadowCache::is_pf(uint64_t addr)
@@ -326,25 +292,17 @@ bool ShadowCache::is_pf(uint64_t addr)
     std::cout << " addr: " << std::hex << addr << std::dec;
   }
 
-  for (int i = 0; i < sets; i++)
-  {
-    for (int ii = 0; ii < ways; ii++)
-    {
-      if (scache[i][ii].addr == addr)
-      {
-        if constexpr (champsim::debug_print)
-        {
-          std::cout << " set: " << i << " way: " << ii;
-          std::cout << " pf: " << +scache[i][ii].pf << std::endl;
-        }
+  // A line the cache indexes differently than its address suggests (a
+  // virtual alias) is not tracked
+  auto entry = find(addr);
 
-        return scache[i][ii].pf;
-      }
-    }
+  if constexpr (champsim::debug_print)
+  {
+    if (entry != nullptr) std::cout << " pf: " << +entry->pf << std::endl;
+    else std::cout << " NOT FOUND" << std::endl;
   }
 
-  assert((0) && "Address is must be in shadow cache");
-  return 0;
+  return entry != nullptr && entry->pf;
 }
 
 uint64_t ShadowCache::get_latency(uint64_t addr)
@@ -363,25 +321,15 @@ uint64_t ShadowCache::get_latency(uint64_t addr)
     std::cout << " addr: " << std::hex << addr << std::dec;
   }
 
-  for (int i = 0; i < sets; i++)
-  {
-    for (int ii = 0; ii < ways; ii++)
-    {
-      if (scache[i][ii].addr == addr) 
-      {
-        if constexpr (champsim::debug_print)
-        {
-          std::cout << " set: " << i << " way: " << ii;
-          std::cout << " latency: " << scache[i][ii].lat << std::endl;
-        }
+  auto entry = find(addr);
 
-        return scache[i][ii].lat;
-      }
-    }
+  if constexpr (champsim::debug_print)
+  {
+    if (entry != nullptr) std::cout << " latency: " << entry->lat << std::endl;
+    else std::cout << " NOT FOUND" << std::endl;
   }
 
-  assert((0) && "Address is must be in shadow cache");
-  return 0;
+  return entry == nullptr ? 0 : entry->lat;
 }
 
 /******************************************************************************/
@@ -397,16 +345,15 @@ void HistoryTable::add(uint64_t tag, uint64_t addr, uint64_t cycle)
    *  - addr: addr access
    */
   uint16_t set = tag & TABLE_SET_MASK;
+  auto &head = history_heads[set];
+
   // If the latest entry is the same, we do not add it
-  if (history_pointers[set] == &historyt[set][ways - 1])
-  {
-    if (historyt[set][0].addr == (addr & ADDR_MASK)) return;
-  } else if ((history_pointers[set] - 1)->addr == (addr & ADDR_MASK)) return;
+  if (historyt[set][(head + ways - 1) % ways].addr == (addr & ADDR_MASK)) return;
 
   // Save new element into the history table
-  history_pointers[set]->tag       = tag;
-  history_pointers[set]->time      = cycle & TIME_MASK;
-  history_pointers[set]->addr      = addr & ADDR_MASK;
+  historyt[set][head].tag       = tag;
+  historyt[set][head].time      = cycle & TIME_MASK;
+  historyt[set][head].addr      = addr & ADDR_MASK;
 
   if constexpr (champsim::debug_print)
   {
@@ -415,10 +362,7 @@ void HistoryTable::add(uint64_t tag, uint64_t addr, uint64_t cycle)
     std::cout << " cycle: " << cycle << " set: " << set << std::endl;
   }
 
-  if (history_pointers[set] == &historyt[set][ways - 1])
-  {
-    history_pointers[set] = &historyt[set][0]; // End the cycle
-  } else history_pointers[set]++; // Pointer to the next (oldest) entry
+  head = (head + 1) % ways; // Pointer to the next (oldest) entry
 }
 
 uint16_t HistoryTable::get_aux(uint32_t latency, 
@@ -450,29 +394,29 @@ uint16_t HistoryTable::get_aux(uint32_t latency,
   // The IPs that is launch in this cycle will be able to launch this prefetch
   cycle -= latency; 
 
-  // Pointer to guide
-  history_table *pointer = history_pointers[set];
+  // Walk the set from the newest to the oldest entry, starting at the head
+  // as the original circular buffer did
+  auto head = history_heads[set];
+  auto index = head;
 
   do
   {
+    const auto &entry = historyt[set][index];
+
     // Look for the IPs that can launch this prefetch
-    if (pointer->tag == tag && pointer->time <= cycle)
+    if (entry.tag == tag && entry.time <= cycle)
     {
       // Test that addr is not duplicated
-      if (pointer->addr == act_addr) return num_on_time;
+      if (entry.addr == act_addr) return num_on_time;
 
       // This IP can launch the prefetch
-      tags[num_on_time] = pointer->tag;
-      addr[num_on_time] = pointer->addr;
+      tags[num_on_time] = entry.tag;
+      addr[num_on_time] = entry.addr;
       num_on_time++;
     }
 
-    if (pointer == historyt[set])
-    {
-      // We get at the end of the history, we start again
-      pointer = &historyt[set][ways - 1];
-    } else pointer--;
-  } while (pointer != history_pointers[set]);
+    index = (index + ways - 1) % ways;
+  } while (index != head);
 
   return num_on_time;
 }
@@ -503,6 +447,38 @@ uint16_t HistoryTable::get(uint32_t latency, uint64_t tag, uint64_t act_addr,
 /******************************************************************************/
 /*                        Berti table functions                               */
 /******************************************************************************/
+Berti::berti *Berti::find(uint64_t tag)
+{
+  /*
+   * Return the entry of the tag, or nullptr if it is not tracked
+   */
+  auto set_begin = std::next(std::begin(bertit), static_cast<std::ptrdiff_t>((tag % BERTI_TABLE_SETS) * BERTI_TABLE_WAYS));
+  auto set_end = std::next(set_begin, BERTI_TABLE_WAYS);
+  auto found = std::find_if(set_begin, set_end, [tag](const auto &x){ return x.valid && x.tag == tag; });
+  return found == set_end ? nullptr : &*found;
+}
+
+Berti::berti *Berti::allocate(uint64_t tag)
+{
+  /*
+   * Replace the oldest entry of the set of the tag (FIFO replacement)
+   */
+  auto set = tag % BERTI_TABLE_SETS;
+  auto &victim = bertit[set * BERTI_TABLE_WAYS + bertit_fifo[set]];
+  bertit_fifo[set] = (bertit_fifo[set] + 1) % BERTI_TABLE_WAYS;
+
+  if constexpr (champsim::debug_print)
+  {
+    if (victim.valid)
+      std::cout << " removing tag: " << std::hex << victim.tag << std::dec << ";";
+  }
+
+  victim = berti{};
+  victim.tag = tag;
+  victim.valid = true;
+  return &victim;
+}
+
 void Berti::increase_conf_tag(uint64_t tag)
 {
   /*
@@ -514,7 +490,8 @@ void Berti::increase_conf_tag(uint64_t tag)
   if constexpr (champsim::debug_print)
     std::cout << "[BERTI_BERTI] " << __func__ << " tag: " << std::hex << tag << std::dec;
 
-  if (bertit.find(tag) == bertit.end())
+  berti *entry = find(tag);
+  if (entry == nullptr)
   {
     // Tag not found
     if constexpr (champsim::debug_print) 
@@ -525,17 +502,17 @@ void Berti::increase_conf_tag(uint64_t tag)
 
   // Get the entries and the deltas
 
-  bertit[tag]->conf += CONFIDENCE_INC;
+  entry->conf += CONFIDENCE_INC;
 
   if constexpr (champsim::debug_print) 
-    std::cout << " global_conf: " << bertit[tag]->conf;
+    std::cout << " global_conf: " << entry->conf;
 
 
-  if (bertit[tag]->conf == CONFIDENCE_MAX) 
+  if (entry->conf == CONFIDENCE_MAX) 
   {
 
     // Max confidence achieve
-    for (auto &i: bertit[tag]->deltas)
+    for (auto &i: entry->deltas)
     {
       // Set bits to prefetch level
       if (i.conf > CONFIDENCE_L1)i.rpl = BERTI_L1;
@@ -553,7 +530,7 @@ void Berti::increase_conf_tag(uint64_t tag)
       i.conf = 0; // Reset confidence
     }
 
-    bertit[tag]->conf = 0; // Reset global confidence
+    entry->conf = 0; // Reset global confidence
   }
 
   if constexpr (champsim::debug_print) std::cout << std::endl;
@@ -590,32 +567,18 @@ void Berti::add(uint64_t tag, int64_t delta)
     *it = new_delta;
   };
 
-  if (bertit.find(tag) == bertit.end())
+  // Get the delta
+  berti *entry  = find(tag);
+
+  if (entry == nullptr)
   {
     if constexpr (champsim::debug_print)
       std::cout << " allocating a new entry;";
 
     // We are not tracking this tag
-    if (bertit_queue.size() > BERTI_TABLE_SIZE)
-    {
-      // FIFO replacent algorithm
-      uint64_t key = bertit_queue.front();
-      berti *entry = bertit[key];
-
-      if constexpr (champsim::debug_print)
-        std::cout << " removing tag: " << std::hex << key << std::dec << ";";
-
-      delete entry; // Free previous entry
-
-      bertit.erase(bertit_queue.front());
-      bertit_queue.pop();
-    }
-
-    bertit_queue.push(tag); // Add new tag
-    assert((bertit.size() <= BERTI_TABLE_SIZE) && "Tracking too much tags");
+    entry = allocate(tag);
 
     // Confidence IP
-    berti *entry = new berti;
     entry->conf = CONFIDENCE_INC;
 
     // Saving the new stride
@@ -624,14 +587,9 @@ void Berti::add(uint64_t tag, int64_t delta)
     if constexpr (champsim::debug_print)
       std::cout << " confidence: " << CONFIDENCE_INIT << std::endl;
 
-    // Save the new tag
-    bertit.insert(std::make_pair(tag, entry));
     return;
   }
 
-  // Get the delta
-  berti *entry  = bertit[tag];
-
   for (auto &i: entry->deltas)
   {
     if (i.delta == delta)
@@ -688,7 +646,8 @@ uint8_t Berti::get(uint64_t tag, std::vector<delta_t> &res)
     std::cout << std::dec;
   }
 
-  if (!bertit.count(tag))
+  berti *entry  = find(tag);
+  if (entry == nullptr)
   {
     if constexpr (champsim::debug_print)
       std::cout << " TAG NOT FOUND" << std::endl;
@@ -699,9 +658,6 @@ uint8_t Berti::get(uint64_t tag, std::vector<delta_t> &res)
 
   if constexpr (champsim::debug_print) std::cout << std::endl;
 
-  // We found the tag
-  berti *entry  = bertit[tag];
-
   for (auto &i: entry->deltas) if (i.delta != 0 && i.rpl != BERTI_R) res.push_back(i);
 
   if (res.empty() && entry->conf >= LAUNCH_MIDDLE_CONF)
@@ -901,18 +857,20 @@ uint64_t Berti::ip_hash(uint64_t ip)
 /******************************************************************************/
 void CACHE::prefetcher_initialize() 
 {
-  // Calculate latency table size
-  uint64_t latency_table_size = get_mshr_size();
-  for (auto const &i : get_rq_size()) latency_table_size += i;
-  for (auto const &i : get_wq_size()) latency_table_size += i;
-  for (auto const &i : get_pq_size()) latency_table_size += i;
+  // Calculate latency table size: it tracks the lines in the MSHR and PQ
+  const auto& occupancy = get_occupancy_snapshot();
+  std::size_t latency_table_size = occupancy.mshr_size + occupancy.internal_pq_size;
+  for (auto const &i : occupancy.pq_size) latency_table_size += i;
+  std::size_t latency_table_sets = (latency_table_size + LATENCY_TABLE_WAYS - 1) / LATENCY_TABLE_WAYS;
+  latency_table_sets = std::size_t{1} << champsim::msl::lg2(2 * latency_table_sets - 1); // Round up to a power of two
 
   // New structures
   picturePF foo;
-  foo.latencyt = new LatencyTable(latency_table_size);
+  foo.latencyt = new LatencyTable(latency_table_sets, LATENCY_TABLE_WAYS);
   foo.scache = new ShadowCache(this->NUM_SET, this->NUM_WAY);
   foo.historyt = new HistoryTable();
   foo.berti = new Berti(BERTI_TABLE_DELTA_SIZE);
+  foo.deltas.reserve(2 * BERTI_TABLE_DELTA_SIZE);
   bigPicture.push_back(foo);
 
   std::cout << "Berti Prefetcher" << std::endl;
@@ -1022,7 +980,9 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip,
       std::cout << "[BERTI] operate cache hit" << std::endl;
   }
 
-  std::vector<delta_t> deltas(BERTI_TABLE_DELTA_SIZE);
+  // The default deltas end the candidates after they are sorted
+  std::vector<delta_t> &deltas = bigPicture[cpu].deltas;
+  deltas.assign(BERTI_TABLE_DELTA_SIZE, delta_t{});
   berti->get(ip_hash, deltas);
 
   bool first_issue = true;
@@ -39,6 +39,7 @@
 
 #include "berti_parameters.h"
 #include "cache.h"
+#include "msl/lru_table.h"
 
 #include <algorithm>
 #include <iostream>
@@ -48,9 +49,9 @@
 #include <time.h>
 #include <cstdio>
 #include <tuple>
-#include <queue>
 #include <cmath>
-#include <map>
+#include <array>
+#include <utility>
 
 namespace berti_space
 {
@@ -102,16 +103,16 @@ namespace berti_space
         uint64_t time = 0; // Event cycle
         bool     pf   = false;   // Is the entry accessed by a demand miss
       };
-      int size;
-      
-      latency_table *latencyt;
+
+      struct by_addr {
+        auto operator()(const latency_table &x) const { return x.addr; }
+      };
+
+      // Entries for lines that are never filled at this level age out
+      champsim::msl::lru_table<latency_table, by_addr, by_addr> latencyt;
   
     public:
-      LatencyTable(const int size) : size(size)
-      {
-        latencyt = new latency_table[size];
-      }
-      ~LatencyTable() { delete latencyt;}
+      LatencyTable(const std::size_t sets, const std::size_t ways) : latencyt(sets, ways) {}
   
       uint8_t  add(uint64_t addr, uint64_t tag, bool pf, uint64_t cycle);
       uint64_t get(uint64_t addr);
@@ -129,25 +130,16 @@ namespace berti_space
         bool     pf   = false;   // Is a prefetch 
       }; // This struct is the vberti table
   
-      int sets;
-      int ways;
-      shadow_cache **scache;
+      std::size_t sets;
+      std::size_t ways;
+      std::vector<shadow_cache> scache;
+
+      // The ways of the set the cache would place the line in
+      std::pair<std::vector<shadow_cache>::iterator, std::vector<shadow_cache>::iterator> get_set_span(uint64_t addr);
+      shadow_cache *find(uint64_t addr);
   
     public:
-      ShadowCache(const int sets, const int ways)
-      {
-        scache = new shadow_cache*[sets];
-        for (int i = 0; i < sets; i++) scache[i] = new shadow_cache[ways];
-  
-        this->sets = sets;
-        this->ways = ways;
-      }
-  
-      ~ShadowCache()
-      {
-        for (int i = 0; i < sets; i++) delete scache[i];
-        delete scache;
-      }
+      ShadowCache(const std::size_t p_sets, const std::size_t p_ways) : sets(p_sets), ways(p_ways), scache(p_sets * p_ways) {}
   
       bool add(uint32_t set, uint32_t way, uint64_t addr, bool pf, uint64_t lat);
       bool get(uint64_t addr);
@@ -166,32 +158,17 @@ namespace berti_space
         uint64_t time = 0; // Time where the line is accessed
       }; // This struct is the history table
   
-      const int sets = HISTORY_TABLE_SETS;
-      const int ways = HISTORY_TABLE_WAYS;
+      constexpr static std::size_t sets = HISTORY_TABLE_SETS;
+      constexpr static std::size_t ways = HISTORY_TABLE_WAYS;
   
-      history_table **historyt;
-      history_table **history_pointers;
+      // Every set is a circular buffer, and the head is the next (oldest)
+      // entry to be replaced
+      std::array<std::array<history_table, ways>, sets> historyt{};
+      std::array<std::size_t, sets> history_heads{};
   
       uint16_t get_aux(uint32_t latency, uint64_t tag, uint64_t act_addr,
           uint64_t *tags, uint64_t *addr, uint64_t cycle);
     public:
-      HistoryTable()
-      {
-        history_pointers = new history_table*[sets];
-        historyt = new history_table*[sets];
-  
-        for (int i = 0; i < sets; i++) historyt[i] = new history_table[ways];
-        for (int i = 0; i < sets; i++) history_pointers[i] = historyt[i];
-      }
-  
-      ~HistoryTable()
-      {
-        for (int i = 0; i < sets; i++) delete historyt[i];
-        delete historyt;
-  
-        delete history_pointers;
-      }
-  
       int get_ways();
       void add(uint64_t tag, uint64_t addr, uint64_t cycle);
       uint16_t get(uint32_t latency, uint64_t tag, uint64_t act_addr, 
@@ -206,16 +183,21 @@ namespace berti_space
         std::array<delta_t, BERTI_TABLE_DELTA_SIZE> deltas;
         uint64_t conf = 0;
         uint64_t total_used = 0;
+        uint64_t tag = 0;
+        bool valid = false;
       };
   
-      std::map<uint64_t, berti*> bertit;
-      std::queue<uint64_t> bertit_queue;
+      // Set-associative, indexed by the IP hash, with FIFO replacement
+      std::array<berti, BERTI_TABLE_SETS * BERTI_TABLE_WAYS> bertit{};
+      std::array<std::size_t, BERTI_TABLE_SETS> bertit_fifo{};
      
       uint64_t size = 0;
   
       bool static compare_greater_delta(delta_t a, delta_t b);
       bool static compare_rpl(delta_t a, delta_t b);
   
+      berti *find(uint64_t tag);
+      berti *allocate(uint64_t tag);
       void increase_conf_tag(uint64_t tag);
       void conf_tag(uint64_t tag);
       void add(uint64_t tag, int64_t delta);
@@ -239,6 +221,7 @@ namespace berti_space
     ShadowCache *scache;
     HistoryTable *historyt;
     Berti *berti;
+    std::vector<delta_t> deltas; // Reused for the deltas of every access
   } picturePF_t;
 
   std::vector<picturePF_t> bigPicture;
@@ -1,7 +1,7 @@
 # ifndef _BERTI_PARAMETERS_H_
 # define _BERTI_PARAMETERS_H_
 
-namespace berti_space
+namespace berti_stride_space
 {
   /*
    * Berti: an Accurate Local-Delta Data Prefetcher
@@ -43,13 +43,17 @@ namespace berti_space
    *                              SIZES                                        *
    *****************************************************************************/
   // BERTI
-  # define BERTI_TABLE_SIZE             (64) // Big enough to fit all entries
+  # define BERTI_TABLE_SETS             (8)
+  # define BERTI_TABLE_WAYS             (8)
   # define BERTI_TABLE_DELTA_SIZE       (16)
   
   // HISTORY
   # define HISTORY_TABLE_SETS           (8)
   # define HISTORY_TABLE_WAYS           (16)
 
+  // LATENCY (the sets are sized from the MSHR and PQ)
+  # define LATENCY_TABLE_WAYS           (8)
+
   // Hash Function
   //#define HASH_FN
   //# define HASH_ORIGINAL
@@ -4,17 +4,22 @@
 
 using namespace bop_space;
 
-BOP::BOP()
-    : scoreMax(SCORE_MAX), roundMax(ROUND_MAX), badScore(BAD_SCORE), rrEntries(RR_SIZE), tagMask((1 << TAG_BITS) - 1),
-      bestOffset(0), phaseBestOffset(0), bestScore(0), round(0), issuePrefetchRequests(false)
+BOP::BOP(const champsim::module_parameters& params)
+    : scoreMax(params.get<unsigned int>("SCORE_MAX", SCORE_MAX)), roundMax(params.get<unsigned int>("ROUND_MAX", ROUND_MAX)),
+      badScore(params.get<unsigned int>("BAD_SCORE", BAD_SCORE)), rrEntries(params.get<unsigned int>("RR_SIZE", RR_SIZE)),
+      tagMask((1u << params.get<unsigned int>("TAG_BITS", TAG_BITS)) - 1), bestOffset(0), phaseBestOffset(0), bestScore(0), round(0),
+      issuePrefetchRequests(false)
 {
+  const auto offset_list_size = params.get<unsigned int>("OFFSET_LIST_SIZE", OFFSET_LIST_SIZE);
+  const auto negative_offsets = params.get<bool>("NEGATIVE_OFFSETS_ENABLE", NEGATIVE_OFFSETS_ENABLE);
+
   if (!champsim::msl::isPowerOf2(rrEntries)) {
     throw std::invalid_argument{"Number of RR entries is not power of 2\n"};
   }
   if (!champsim::msl::isPowerOf2(BLOCK_SIZE)) {
     throw std::invalid_argument{"Cache line size is not power of 2\n"};
   }
-  if (NEGATIVE_OFFSETS_ENABLE && (OFFSET_LIST_SIZE % 2 != 0)) {
+  if (negative_offsets && (offset_list_size % 2 != 0)) {
     throw std::invalid_argument{"Negative offsets enabled with odd offset list size\n"};
   }
 
@@ -28,7 +33,7 @@ BOP::BOP()
   unsigned int i = 0;
   int64_t offset_i = 1;
 
-  while (i < OFFSET_LIST_SIZE) {
+  while (i < offset_list_size) {
     int64_t offset = offset_i;
 
     for (int n : factors) {
@@ -44,7 +49,7 @@ BOP::BOP()
        * If we want to use negative offsets, add also the negative value
        * of the offset just calculated
        */
-      if (NEGATIVE_OFFSETS_ENABLE) {
+      if (negative_offsets) {
         offsetsList.push_back(OffsetListEntry(-offset_i, 0));
         i++;
       }
@@ -210,7 +215,7 @@ void BOP::insertFill(uint64_t addr, uint8_t prefetch, uint32_t metadata_in)
 
 void CACHE::prefetcher_initialize() 
 { 
-  bop = new BOP();
+  bop = new BOP(prefetcher_params);
   std::cout << "BOP Prefetcher Initialise" << std::endl; 
 }
 
@@ -10,6 +10,7 @@
 
 #include "bop_parameters.h"
 #include "cache.h"
+#include "module_parameters.h"
 #include "msl/bits.h"
 
 namespace bop_space
@@ -83,7 +84,7 @@ public:
 
   void insertFill(uint64_t addr, uint8_t prefetch, uint32_t metadata_in);
 
-  BOP();
+  explicit BOP(const champsim::module_parameters& params);
   ~BOP() = default;
 }; // class bop
 
@@ -20,6 +20,38 @@ constexpr bool is_power_of_2(T n)
 
 using namespace caerus_space;
 
+Parameters::Parameters(const champsim::module_parameters& params)
+{
+  score_max = params.get("SCORE_MAX", score_max);
+  round_max = params.get("ROUND_MAX", round_max);
+  bad_score = params.get("BAD_SCORE", bad_score);
+  offset_list_size = params.get("OFFSET_LIST_SIZE", offset_list_size);
+  num_offsets = params.get("NUM_OFFSETS", num_offsets);
+  train_speed = params.get("TRAIN_SPEED", train_speed);
+  negative_offsets = params.get("NEGATIVE_OFFSETS_ENABLE", negative_offsets);
+  recent_prefetches_size = params.get("RECENT_PREFETCHES_SIZE", recent_prefetches_size);
+  accuracy_threshold = params.get("ACCURACY_THRESHOLD", accuracy_threshold);
+  accuracy_increment = params.get("ACCURACY_INCREMENT", accuracy_increment);
+  accuracy_decrement = params.get("ACCURACY_DECREMENT", accuracy_decrement);
+  rr_size = params.get("RR_SIZE", rr_size);
+  holding_table_size = params.get("HOLDING_TABLE_SIZE", holding_table_size);
+  accuracy_table_size = params.get("ACCURACY_TABLE_SIZE", accuracy_table_size);
+  eviction_table_size = params.get("EVICTION_TABLE_SIZE", eviction_table_size);
+  allow_cross_page = params.get("ALLOW_CROSS_PAGE", allow_cross_page);
+  overlap_leakage = params.get("OVERLAP_LEAKAGE", overlap_leakage);
+  leakage_period = params.get("LEAKAGE_PERIOD", leakage_period);
+
+  if (num_offsets == 0 || num_offsets > MAX_NUM_OFFSETS) {
+    throw std::invalid_argument{"Number of offsets must be between 1 and " + std::to_string(MAX_NUM_OFFSETS) + "\n"};
+  }
+  if (accuracy_table_size == 0 || accuracy_table_size > MAX_ACCURACY_TABLE_SIZE) {
+    throw std::invalid_argument{"Accuracy table size must be between 1 and " + std::to_string(MAX_ACCURACY_TABLE_SIZE) + "\n"};
+  }
+  if (leakage_period == 0) {
+    throw std::invalid_argument{"Leakage period must be nonzero\n"};
+  }
+}
+
 static inline std::size_t hash_index(uint64_t value, std::size_t log_size) {
     uint64_t hash = value ^ (value >> log_size);
     hash &= ((1ULL << log_size) - 1);
@@ -114,47 +146,48 @@ uint64_t RecentPrefetchesTable::index(uint64_t pf_addr) const
 }
 
 
-AccuracyTable::AccuracyTable(std::size_t size)
-    : table_size(size),
-      table(size, std::vector<uint16_t>(NUM_OFFSETS, 8)) 
-{}
+AccuracyTable::AccuracyTable(std::size_t size, std::size_t num_offsets, uint32_t increment, uint32_t decrement)
+    : table_size(size), row_size(num_offsets), increment_value(increment), decrement_value(decrement),
+      table(INIT_VAL) 
+{
+  assert(size * num_offsets <= table.size());
+}
 
-int AccuracyTable::getIndex(uint64_t pc) const { return (pc ^ (pc / table_size)) % table_size; }
+std::size_t AccuracyTable::getIndex(uint64_t pc, int offset_idx) const
+{
+  std::size_t row = (pc ^ (pc / table_size)) % table_size;
+  return row * row_size + static_cast<std::size_t>(offset_idx);
+}
 
 int16_t AccuracyTable::lookup(uint64_t pc, int offset_idx) const
 {
-  int idx = getIndex(pc);
-  if (offset_idx >= 0 && offset_idx < NUM_OFFSETS) {
-    return table[idx][offset_idx];
+  if (offset_idx >= 0 && static_cast<std::size_t>(offset_idx) < row_size) {
+    return static_cast<int16_t>(table[getIndex(pc, offset_idx)]);
   }
   return 0; 
 }
 
 void AccuracyTable::increment(uint64_t pc, int offset_idx)
 {
-  int idx = getIndex(pc);
-  if (offset_idx >= 0 && offset_idx < NUM_OFFSETS) {
-    if (table[idx][offset_idx] < ACC_MAX)
-      table[idx][offset_idx]+= ACCURACY_INCREMENT; // More optimistic for accuracy 
+  if (offset_idx >= 0 && static_cast<std::size_t>(offset_idx) < row_size) {
+    table.increment(getIndex(pc, offset_idx), increment_value); // More optimistic for accuracy 
   }
 }
 
 void AccuracyTable::decrement(uint64_t pc, int offset_idx)
 {
-  int idx = getIndex(pc);
-  if (offset_idx >= 0 && offset_idx < NUM_OFFSETS) {
-    if (table[idx][offset_idx] > ACC_MIN)
-      table[idx][offset_idx]-= ACCURACY_DECREMENT;
+  if (offset_idx >= 0 && static_cast<std::size_t>(offset_idx) < row_size) {
+    table.decrement(getIndex(pc, offset_idx), decrement_value);
   }
 }
 
 void AccuracyTable::resetOffsetStats(int offset_idx)
 {
-  if (offset_idx < 0 || offset_idx >= NUM_OFFSETS)
+  if (offset_idx < 0 || static_cast<std::size_t>(offset_idx) >= row_size)
     return;
 
   for (std::size_t i = 0; i < table_size; ++i) {
-    table[i][offset_idx] = 8;
+    table.set(i * row_size + static_cast<std::size_t>(offset_idx), INIT_VAL);
   }
 }
 
@@ -182,22 +215,32 @@ bool EvictionTable::test(uint64_t addr) const
   return table[idx] == line_addr;
 }
 
-CAERUS::CAERUS()
-    : scoreMax(SCORE_MAX), roundMax(ROUND_MAX), phaseBestOffset(0), bestScore(0), round(0), rr_table(RR_SIZE), holding_table(HOLDING_TABLE_SIZE),
-      accuracy_table(ACCURACY_TABLE_SIZE), eviction_table(EVICTION_TABLE_SIZE), recent_prefetches_table(RECENT_PREFETCHES_SIZE)
+CAERUS::CAERUS(const Parameters& parameters)
+    : params(parameters), scoreMax(params.score_max), roundMax(params.round_max), learned_offsets(params.num_offsets, 0), phaseBestOffset(0), bestScore(0),
+      round(0), rr_table(params.rr_size), holding_table(params.holding_table_size),
+      accuracy_table(params.accuracy_table_size, params.num_offsets, params.accuracy_increment, params.accuracy_decrement),
+      eviction_table(params.eviction_table_size), recent_prefetches_table(params.recent_prefetches_size)
 
 {
-  if (!is_power_of_2(RR_SIZE)) {
+  if (!is_power_of_2(params.rr_size)) {
     throw std::invalid_argument{"Number of RR entries is not power of 2\n"};
   }
   if (!is_power_of_2(BLOCK_SIZE)) {
     throw std::invalid_argument{"Cache line size is not power of 2\n"};
   }
 
-  if (!is_power_of_2(HOLDING_TABLE_SIZE)) {
+  if (!is_power_of_2(params.holding_table_size)) {
     throw std::invalid_argument{"Holding table size is not power of 2\n"};
   }
 
+  if (!is_power_of_2(params.eviction_table_size)) {
+    throw std::invalid_argument{"Eviction table size is not power of 2\n"};
+  }
+
+  if (!is_power_of_2(params.recent_prefetches_size)) {
+    throw std::invalid_argument{"Recent prefetches table size is not power of 2\n"};
+  }
+
   /*
    * Following the paper implementation, a list with the specified number
    * of offsets which are of the form 2^i * 3^j * 5^k with i,j,k >= 0
@@ -208,7 +251,7 @@ CAERUS::CAERUS()
   int64_t offset_i = 1;
     
 
-  while (i < OFFSET_LIST_SIZE) 
+  while (i < params.offset_list_size) 
   {
     int64_t offset = offset_i;
 
@@ -225,7 +268,7 @@ CAERUS::CAERUS()
        * If we want to use negative offsets, add also the negative value
        * of the offset just calculated
        */
-      if (NEGATIVE_OFFSETS_ENABLE) {
+      if (params.negative_offsets) {
         offsetsList.push_back(OffsetListEntry(-offset_i, 0));
         i++;
       }
@@ -257,10 +300,10 @@ void CAERUS::bestOffsetLearning(uint64_t addr, uint8_t cache_hit)
 
       // Overlap Prevention MOD 
       uint64_t prev_pf_addr = addr - (off << LOG2_BLOCK_SIZE);
-      if (rr_table.test(prev_pf_addr) and accuracy_table.lookup(rr_table.lookup(prev_pf_addr).pc, i) >= ACCURACY_THRESHOLD) {
-        if (OVERLAP_LEAKAGE) {
+      if (rr_table.test(prev_pf_addr) and accuracy_table.lookup(rr_table.lookup(prev_pf_addr).pc, i) >= params.accuracy_threshold) {
+        if (params.overlap_leakage) {
           overlap_leakage_counter++;
-          if (overlap_leakage_counter % LEAKAGE_PERIOD != 0) {
+          if (overlap_leakage_counter % params.leakage_period != 0) {
             return; 
           }
         } else {
@@ -290,7 +333,7 @@ void CAERUS::bestOffsetLearning(uint64_t addr, uint8_t cache_hit)
     }
   }
 
-  for (std::size_t i = 0; i < TRAIN_SPEED; ++i) 
+  for (std::size_t i = 0; i < params.train_speed; ++i) 
   {
 
     uint64_t offset = (*offsetsListIterator).first;
@@ -332,7 +375,7 @@ void CAERUS::bestOffsetLearning(uint64_t addr, uint8_t cache_hit)
       if (round >= roundMax) round_max_counter++;
 
       // This avoids training bad offsets
-      if (bestScore > BAD_SCORE) {
+      if (bestScore > params.bad_score) {
         learned_offsets[current_learning_offset_idx] = phaseBestOffset;
         // Reset statistics for this offset
         accuracy_table.resetOffsetStats(current_learning_offset_idx);
@@ -360,7 +403,7 @@ void CAERUS::bestOffsetLearning(uint64_t addr, uint8_t cache_hit)
 std::vector<uint64_t> CAERUS::calculateAccuratePrefetchAddrs(uint64_t addr, uint64_t pc, CACHE* cache)
 {
   std::vector<uint64_t> pf_addrs;
-  for (int i = 0; i < NUM_OFFSETS; i++) {
+  for (int i = 0; i < static_cast<int>(learned_offsets.size()); i++) {
     uint64_t offset = learned_offsets[i];
     if (offset == 0)
       continue;
@@ -369,16 +412,16 @@ std::vector<uint64_t> CAERUS::calculateAccuratePrefetchAddrs(uint64_t addr, uint
     // TEST MOD no accuracy filtering 
     // score = 10; 
 
-    if (score >= ACCURACY_THRESHOLD) {
+    if (score >= params.accuracy_threshold) {
       uint64_t pf_addr = addr + (offset << LOG2_BLOCK_SIZE);
 
-      if (!ALLOW_CROSS_PAGE) {
+      if (!params.allow_cross_page) {
         if ((addr >> LOG2_PAGE_SIZE) != (pf_addr >> LOG2_PAGE_SIZE)) {
           continue;
         }
       }
 
-      if (cache->get_pq_occupancy().back() >= cache->get_pq_size().back()) {
+      if (cache->get_internal_pq_occupancy() >= cache->get_internal_pq_size()) {
         continue;
       }
 
@@ -391,7 +434,7 @@ std::vector<uint64_t> CAERUS::calculateAccuratePrefetchAddrs(uint64_t addr, uint
 std::vector<uint64_t> CAERUS::calculateAccuratePrefetchOffsets(uint64_t addr, uint64_t pc, CACHE* cache)
 {
   std::vector<uint64_t> pf_offsets;
-  for (int i = 0; i < NUM_OFFSETS; i++) {
+  for (int i = 0; i < static_cast<int>(learned_offsets.size()); i++) {
     uint64_t offset = learned_offsets[i];
     if (offset == 0)
       continue;
@@ -400,15 +443,15 @@ std::vector<uint64_t> CAERUS::calculateAccuratePrefetchOffsets(uint64_t addr, ui
     // TEST MOD no accuracy filtering 
     // score = 10; 
 
-    if (score >= ACCURACY_THRESHOLD) {
+    if (score >= params.accuracy_threshold) {
 
-      if (!ALLOW_CROSS_PAGE) {
+      if (!params.allow_cross_page) {
         if ((addr >> LOG2_PAGE_SIZE) != ((addr + (offset << LOG2_BLOCK_SIZE)) >> LOG2_PAGE_SIZE)) {
           continue;
         }
       }
 
-      if (cache->get_pq_occupancy().back() >= cache->get_pq_size().back()) {
+      if (cache->get_internal_pq_occupancy() >= cache->get_internal_pq_size()) {
         continue;
       }
 
@@ -428,7 +471,7 @@ std::vector<uint64_t> CAERUS::calculateAllPrefetchAddrs(uint64_t addr)
 
     uint64_t pf_addr = (addr + offset) << LOG2_BLOCK_SIZE; // shift to get full addr bits
 
-    if(!ALLOW_CROSS_PAGE){
+    if(!params.allow_cross_page){
       if (((addr << LOG2_BLOCK_SIZE) >> LOG2_PAGE_SIZE) != (pf_addr >> LOG2_PAGE_SIZE)) {
         pf_addrs.push_back(0); // represent page crosses by 0
         continue;
@@ -453,12 +496,12 @@ void CAERUS::accuracy_train(uint64_t line_addr, uint64_t pc)
 
   std::vector<uint64_t> pf_addrs = calculateAllPrefetchAddrs(line_addr);
 
-  for (int i = 0; i < NUM_OFFSETS; ++i) {
+  for (int i = 0; i < static_cast<int>(learned_offsets.size()); ++i) {
     if (i >= static_cast<int>(pf_addrs.size())){
       break; // for safety
     }
     
-    if(!ALLOW_CROSS_PAGE){
+    if(!params.allow_cross_page){
       if(pf_addrs[i] == 0) {
         continue; // skip prefetches that cross page boundary
       }
@@ -490,7 +533,7 @@ void CAERUS::insertFill(uint64_t addr, uint64_t current_cycle)
 
 void CACHE::prefetcher_initialize()
 {
-  caerus_prefetchers[this] = std::make_unique<CAERUS>();
+  caerus_prefetchers[this] = std::make_unique<CAERUS>(Parameters{prefetcher_params});
   std::cout << "CAERUS Prefetcher Initialised" << std::endl;
 }
 
@@ -515,8 +558,8 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
       // for (auto pf_addr : pf_addrs) {
         
       //   // Basic MSHR Occupancy Based Filtering
-      //   if (this->get_pq_occupancy().back() < this->get_pq_size().back() &&
-      //       this->get_pq_occupancy().back() + this->get_mshr_occupancy() < this->get_mshr_size() - 1) {
+      //   if (this->get_internal_pq_occupancy() < this->get_internal_pq_size() &&
+      //       this->get_internal_pq_occupancy() + this->get_mshr_occupancy() < this->get_mshr_size() - 1) {
 
       //     bool issued = this->prefetch_line(pf_addr, true, 0x1);
           
@@ -550,8 +593,8 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
       for (auto pf_offset : pf_offsets) {
         
         // Basic MSHR Occupancy Based Filtering
-        if (this->get_pq_occupancy().back() < this->get_pq_size().back() &&
-            this->get_pq_occupancy().back() + this->get_mshr_occupancy() < this->get_mshr_size() - 1) {
+        if (this->get_internal_pq_occupancy() < this->get_internal_pq_size() &&
+            this->get_internal_pq_occupancy() + this->get_mshr_occupancy() < this->get_mshr_size() - 1) {
 
           uint64_t pf_addr = addr + (pf_offset << LOG2_BLOCK_SIZE);
 
@@ -11,7 +11,9 @@
 #include <vector>
 
 #include "cache.h"
+#include "module_parameters.h"
 #include "msl/bits.h"
+#include "msl/counter_array.h"
 #include "msl/lru_table.h"
 #include "caerus_parameters.h"
 #include <unordered_set>
@@ -19,6 +21,34 @@
 namespace caerus_space
 {
 
+/** Parameters that may be given at run time through the cache's
+ *  prefetcher_params. Each is named as in caerus_parameters.h, which
+ *  gives the defaults.
+ */
+struct Parameters {
+  unsigned int score_max = SCORE_MAX;
+  unsigned int round_max = ROUND_MAX;
+  unsigned int bad_score = BAD_SCORE;
+  unsigned int offset_list_size = OFFSET_LIST_SIZE;
+  std::size_t num_offsets = NUM_OFFSETS;
+  unsigned int train_speed = TRAIN_SPEED;
+  bool negative_offsets = NEGATIVE_OFFSETS_ENABLE;
+  std::size_t recent_prefetches_size = RECENT_PREFETCHES_SIZE;
+  int16_t accuracy_threshold = ACCURACY_THRESHOLD;
+  uint32_t accuracy_increment = ACCURACY_INCREMENT;
+  uint32_t accuracy_decrement = ACCURACY_DECREMENT;
+  std::size_t rr_size = RR_SIZE;
+  std::size_t holding_table_size = HOLDING_TABLE_SIZE;
+  std::size_t accuracy_table_size = ACCURACY_TABLE_SIZE;
+  std::size_t eviction_table_size = EVICTION_TABLE_SIZE;
+  bool allow_cross_page = ALLOW_CROSS_PAGE;
+  bool overlap_leakage = OVERLAP_LEAKAGE;
+  uint64_t leakage_period = LEAKAGE_PERIOD;
+
+  Parameters() = default;
+  explicit Parameters(const champsim::module_parameters& params);
+};
+
 class RRTable
 {
 public:
@@ -91,7 +121,7 @@ private:
 class AccuracyTable
 {
 public:
-  explicit AccuracyTable(std::size_t size);
+  AccuracyTable(std::size_t size, std::size_t num_offsets, uint32_t increment, uint32_t decrement);
 
   int16_t lookup(uint64_t pc, int offset_idx) const;
 
@@ -103,13 +133,16 @@ public:
 
 private:
   std::size_t table_size;
+  std::size_t row_size;
+  uint32_t increment_value;
+  uint32_t decrement_value;
   
-  std::vector<std::vector<uint16_t>> table;
+  // 4 bit sat counters, one row of row_size offsets per PC
+  champsim::msl::counter_array<4, MAX_ACCURACY_TABLE_SIZE * MAX_NUM_OFFSETS> table;
 
-  int getIndex(uint64_t pc) const;
+  std::size_t getIndex(uint64_t pc, int offset_idx) const;
 
-  static constexpr int16_t ACC_MIN = 0;
-  static constexpr int16_t ACC_MAX = 15; // 4 bit sat counter
+  static constexpr int16_t INIT_VAL = 8;
 };
 
 
@@ -130,6 +163,8 @@ private:
 class CAERUS
 {
 private:
+  const Parameters params;
+
   /** Learning phase parameters */
   const unsigned int scoreMax;
   const unsigned int roundMax;
@@ -138,7 +173,7 @@ private:
   typedef std::pair<int16_t, uint8_t> OffsetListEntry;
   std::vector<OffsetListEntry> offsetsList;
 
-  std::array<uint64_t, NUM_OFFSETS> learned_offsets = {0};
+  std::vector<uint64_t> learned_offsets;
   unsigned int current_learning_offset_idx = 0;
 
   /** Current best offset found in the learning phase */
@@ -197,7 +232,7 @@ public:
   void accuracy_train(uint64_t addr, uint64_t pc);
 
 
-  CAERUS();
+  explicit CAERUS(const Parameters& parameters);
   ~CAERUS() = default;
 }; // class CAERUS
 
@@ -40,6 +40,11 @@ namespace caerus_space
   # define OVERLAP_LEAKAGE          (false) // Determines if overlap leakage is enabled
   # define LEAKAGE_PERIOD           (50)   // One out of X overlapping prefetches will be trained 
 
+  // LIMITS
+  // The parameters above are defaults, and may be changed at run time. The accuracy table is sized for these limits.
+  # define MAX_NUM_OFFSETS          (16)   // The largest number of offsets that can be learnt
+  # define MAX_ACCURACY_TABLE_SIZE  (1024) // The largest pc accuracy table
+
 
 
 };
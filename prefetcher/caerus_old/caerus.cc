@@ -2,7 +2,7 @@
 
 #include <algorithm>
 
-using namespace caerus_space;
+using namespace caerus_old_space;
 
 RRTable::RRTable(std::size_t size) : log_size(champsim::lg2(size)) { table.resize(size); }
 
@@ -473,8 +473,7 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
           ++(caerus->pf_issued_caerus);
         } else {
           if constexpr (champsim::caerus_dbug) {
-            std::vector<std::size_t> pq_occupancy = get_pq_occupancy();
-            std::cout << "PQ FULL, pq_occupany: " << pq_occupancy[2] << std::endl; // hard-coded for L2 occupancy
+            std::cout << "PQ FULL, pq_occupany: " << get_internal_pq_occupancy() << std::endl;
           }
         }
       }
@@ -16,7 +16,7 @@
 #include "msl/lru_table.h"
 #include <unordered_set>
 
-namespace caerus_space
+namespace caerus_old_space
 {
 
 class RRTable
@@ -176,7 +176,7 @@ public:
 
 CAERUS* caerus;
 
-} // namespace caerus_space
+} // namespace caerus_old_space
 
 #endif /* __MEM_CACHE_PREFETCH_CAERUS_HH__ */
 
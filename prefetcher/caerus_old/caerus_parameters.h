@@ -1,7 +1,7 @@
 # ifndef _CAERUS_PARAMETERS_H_
 # define _CAERUS_PARAMETERS_H_
 
-namespace caerus_space
+namespace caerus_old_space
 { 
   /*****************************************************************************
    *                              PARAMS                                       *
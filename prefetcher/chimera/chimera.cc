@@ -51,43 +51,38 @@ struct HistoryEntry {
 // PC-based prefetcher table entry
 struct PCEntry {
     uint32_t ip_tag;
-    std::vector<uint32_t> offset_confidence;  // Confidence for each offset
+    std::array<uint32_t, OFFSET_COUNT> offset_confidence{};  // Confidence for each offset
     int best_offset1, best_offset2;           // Best offsets
     uint32_t best_confidence1, best_confidence2; // Best confidences
     
-    PCEntry() : ip_tag(0), offset_confidence(OFFSET_COUNT, 0), 
-               best_offset1(-1), best_offset2(-1), 
+    PCEntry() : ip_tag(0), best_offset1(-1), best_offset2(-1), 
                best_confidence1(0), best_confidence2(0) {}
                
-    PCEntry(uint32_t ip) : ip_tag(ip), offset_confidence(OFFSET_COUNT, 0), 
-                         best_offset1(-1), best_offset2(-1), 
+    PCEntry(uint32_t ip) : ip_tag(ip), best_offset1(-1), best_offset2(-1), 
                          best_confidence1(0), best_confidence2(0) {}
 };
 
 // Space-based prefetcher table entry
 struct SpaceEntry {
     uint32_t region_tag;
-    std::vector<uint32_t> offset_confidence;  // Confidence for each offset
+    std::array<uint32_t, OFFSET_COUNT> offset_confidence{};  // Confidence for each offset
     int best_offset1, best_offset2;           // Best offsets
     uint32_t best_confidence1, best_confidence2; // Best confidences
     
-    SpaceEntry() : region_tag(0), offset_confidence(OFFSET_COUNT, 0), 
-                 best_offset1(-1), best_offset2(-1), 
+    SpaceEntry() : region_tag(0), best_offset1(-1), best_offset2(-1), 
                  best_confidence1(0), best_confidence2(0) {}
                  
-    SpaceEntry(uint32_t region) : region_tag(region), offset_confidence(OFFSET_COUNT, 0), 
-                                best_offset1(-1), best_offset2(-1), 
+    SpaceEntry(uint32_t region) : region_tag(region), best_offset1(-1), best_offset2(-1), 
                                 best_confidence1(0), best_confidence2(0) {}
 };
 
 // Epoch-based prefetcher
 struct EpochEntry {
-    std::vector<uint32_t> offset_confidence;  // Confidence for each offset
+    std::array<uint32_t, OFFSET_COUNT> offset_confidence{};  // Confidence for each offset
     int best_offset1, best_offset2, best_offset3; // Three best offsets
     uint32_t refresh_count;                    // Refresh counter
     
-    EpochEntry() : offset_confidence(OFFSET_COUNT, 0), 
-                 best_offset1(-1), best_offset2(-1), best_offset3(-1),
+    EpochEntry() : best_offset1(-1), best_offset2(-1), best_offset3(-1),
                  refresh_count(0) {}
                  
     void update_best_offsets() {
@@ -443,8 +438,8 @@ public:
             uint64_t pf_addr = pf_line_addr << LOG2_BLOCK_SIZE;
             
             // Check if prefetch queue and MSHR have space (modern ChampSim API)
-            if (cache->get_pq_occupancy().back() < cache->get_pq_size().back() &&
-                cache->get_pq_occupancy().back() + cache->get_mshr_occupancy() < cache->get_mshr_size()) {
+            if (cache->get_internal_pq_occupancy() < cache->get_internal_pq_size() &&
+                cache->get_internal_pq_occupancy() + cache->get_mshr_occupancy() < cache->get_mshr_size()) {
                 
                 bool fill_this_level = (pf.level == FILL_L1);
                 int success = cache->prefetch_line(pf_addr, fill_this_level, 0);
@@ -33,7 +33,7 @@ struct tracker {
   champsim::msl::lru_table<tracker_entry> table{TRACKER_SETS, TRACKER_WAYS};
 
 public:
-  void initiate_lookahead(uint64_t ip, uint64_t cl_addr)
+  void initiate_lookahead(CACHE* cache, uint64_t ip, uint64_t cl_addr)
   {
     int64_t stride = 0;
 
@@ -46,9 +46,11 @@ public:
       stride = static_cast<int64_t>(cl_addr) - static_cast<int64_t>(found->last_cl_addr);
 
       // Initialize prefetch state unless we somehow saw the same address twice in
-      // a row or if this is the first time we've seen this stride
-      if (stride != 0 && stride == found->last_stride)
-        active_lookahead = {cl_addr << LOG2_BLOCK_SIZE, stride, PREFETCH_DEGREE};
+      // a row or if this is the first time we've seen this stride.
+      // The degree is limited by the cache's prefetch throttle, if it has one.
+      auto degree = static_cast<int>(std::min<std::size_t>(PREFETCH_DEGREE, cache->prefetch_degree()));
+      if (stride != 0 && stride == found->last_stride && degree > 0)
+        active_lookahead = {cl_addr << LOG2_BLOCK_SIZE, stride, degree};
     }
 
     // update tracking set
@@ -92,7 +94,7 @@ void CACHE::prefetcher_cycle_operate() { ::trackers[this].advance_lookahead(this
 
 uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, bool useful_prefetch, uint8_t type, uint32_t metadata_in)
 {
-  ::trackers[this].initiate_lookahead(ip, addr >> LOG2_BLOCK_SIZE);
+  ::trackers[this].initiate_lookahead(this, ip, addr >> LOG2_BLOCK_SIZE);
   return metadata_in;
 }
 
@@ -1,6 +1,7 @@
 /* Multi-Lookahead Offset Prefetcher (MLOP) */
 
 #include "cache.h"
+#include "msl/set_assoc_table.h"
 #include <bits/stdc++.h>
 
 using namespace std;
@@ -117,170 +118,6 @@ class Table {
     vector<vector<string>> cells;
 };
 
-template <class T> class SetAssociativeCache {
-  public:
-    class Entry {
-      public:
-        uint64_t key;
-        uint64_t index;
-        uint64_t tag;
-        bool valid;
-        T data;
-    };
-
-    SetAssociativeCache(int size, int num_ways, int debug_level = 0)
-        : size(size), num_ways(num_ways), num_sets(size / num_ways), entries(num_sets, vector<Entry>(num_ways)),
-          cams(num_sets), debug_level(debug_level) {
-        // assert(size % num_ways == 0);
-        for (int i = 0; i < num_sets; i += 1)
-            for (int j = 0; j < num_ways; j += 1)
-                entries[i][j].valid = false;
-        /* calculate `index_len` (number of bits required to store the index) */
-        for (int max_index = num_sets - 1; max_index > 0; max_index >>= 1)
-            this->index_len += 1;
-    }
-
-    /**
-     * Invalidates the entry corresponding to the given key.
-     * @return A pointer to the invalidated entry
-     */
-    Entry *erase(uint64_t key) {
-        Entry *entry = this->find(key);
-        uint64_t index = key % this->num_sets;
-        uint64_t tag = key / this->num_sets;
-        auto &cam = cams[index];
-        int num_erased = cam.erase(tag);
-        if (entry)
-            entry->valid = false;
-        // assert(entry ? num_erased == 1 : num_erased == 0);
-        return entry;
-    }
-
-    /**
-     * @return The old state of the entry that was updated
-     */
-    Entry insert(uint64_t key, const T &data) {
-        Entry *entry = this->find(key);
-        if (entry != nullptr) {
-            Entry old_entry = *entry;
-            entry->data = data;
-            return old_entry;
-        }
-        uint64_t index = key % this->num_sets;
-        uint64_t tag = key / this->num_sets;
-        vector<Entry> &set = this->entries[index];
-        int victim_way = -1;
-        for (int i = 0; i < this->num_ways; i += 1)
-            if (!set[i].valid) {
-                victim_way = i;
-                break;
-            }
-        if (victim_way == -1) {
-            victim_way = this->select_victim(index);
-        }
-        Entry &victim = set[victim_way];
-        Entry old_entry = victim;
-        victim = {key, index, tag, true, data};
-        auto &cam = cams[index];
-        if (old_entry.valid) {
-            int num_erased = cam.erase(old_entry.tag);
-            // assert(num_erased == 1);
-        }
-        cam[tag] = victim_way;
-        return old_entry;
-    }
-
-    Entry *find(uint64_t key) {
-        uint64_t index = key % this->num_sets;
-        uint64_t tag = key / this->num_sets;
-        auto &cam = cams[index];
-        if (cam.find(tag) == cam.end())
-            return nullptr;
-        int way = cam[tag];
-        Entry &entry = this->entries[index][way];
-        // assert(entry.tag == tag && entry.valid);
-        return &entry;
-    }
-
-    /**
-     * Creates a table with the given headers and populates the rows by calling `write_data` on all
-     * valid entries contained in the cache. This function makes it easy to visualize the contents
-     * of a cache.
-     * @return The constructed table as a string
-     */
-    string log(vector<string> headers) {
-        vector<Entry> valid_entries = this->get_valid_entries();
-        Table table(headers.size(), valid_entries.size() + 1);
-        table.set_row(0, headers);
-        for (unsigned i = 0; i < valid_entries.size(); i += 1)
-            this->write_data(valid_entries[i], table, i + 1);
-        return table.to_string();
-    }
-
-    int get_index_len() { return this->index_len; }
-
-    void set_debug_level(int debug_level) { this->debug_level = debug_level; }
-
-  protected:
-    /* should be overriden in children */
-    virtual void write_data(Entry &entry, Table &table, int row) {}
-
-    /**
-     * @return The way of the selected victim
-     */
-    virtual int select_victim(uint64_t index) {
-        /* random eviction policy if not overriden */
-        return rand() % this->num_ways;
-    }
-
-    vector<Entry> get_valid_entries() {
-        vector<Entry> valid_entries;
-        for (int i = 0; i < num_sets; i += 1)
-            for (int j = 0; j < num_ways; j += 1)
-                if (entries[i][j].valid)
-                    valid_entries.push_back(entries[i][j]);
-        return valid_entries;
-    }
-
-    int size;
-    int num_ways;
-    int num_sets;
-    int index_len = 0; /* in bits */
-    vector<vector<Entry>> entries;
-    vector<unordered_map<uint64_t, int>> cams;
-    int debug_level = 0;
-};
-
-template <class T> class LRUSetAssociativeCache : public SetAssociativeCache<T> {
-    typedef SetAssociativeCache<T> Super;
-
-  public:
-    LRUSetAssociativeCache(int size, int num_ways, int debug_level = 0)
-        : Super(size, num_ways, debug_level), lru(this->num_sets, vector<uint64_t>(num_ways)) {}
-
-    void set_mru(uint64_t key) { *this->get_lru(key) = this->t++; }
-
-    void set_lru(uint64_t key) { *this->get_lru(key) = 0; }
-
-  protected:
-    /* @override */
-    int select_victim(uint64_t index) {
-        vector<uint64_t> &lru_set = this->lru[index];
-        return min_element(lru_set.begin(), lru_set.end()) - lru_set.begin();
-    }
-
-    uint64_t *get_lru(uint64_t key) {
-        uint64_t index = key % this->num_sets;
-        uint64_t tag = key / this->num_sets;
-        // assert(this->cams[index].count(tag) == 1);
-        int way = this->cams[index][tag];
-        return &this->lru[index][way];
-    }
-
-    vector<vector<uint64_t>> lru;
-    uint64_t t = 1;
-};
-
 /**
  * A very simple and efficient hash function that:
  * 1) Splits key into blocks of length `index_len` bits and computes the XOR of all blocks.
@@ -309,9 +146,39 @@ uint64_t hash_index(uint64_t key, int index_len) {
 enum State { INIT = 0, ACCESS = 1, PREFTCH = 2 };
 char state_char[] = {'I', 'A', 'P'};
 
-string map_to_string(const vector<State> &access_map, const vector<int> &prefetch_map) {
+/* zones are equivalent to pages in this implementation */
+constexpr int MAX_BLOCKS_IN_ZONE = PAGE_SIZE / BLOCK_SIZE;
+constexpr int MAX_QUEUE_SIZE = 16;
+
+/**
+ * The most recent accesses to a zone, newest first. It holds at most `MAX_QUEUE_SIZE` offsets, and
+ * the oldest offset is dropped when the queue is full.
+ */
+class HistoryQueue {
+  public:
+    void push_front(int zone_offset, unsigned limit) {
+        unsigned new_size = min(this->count + 1, limit);
+        for (unsigned i = new_size - 1; i > 0; i -= 1)
+            this->offsets[i] = this->offsets[i - 1];
+        this->offsets[0] = zone_offset;
+        this->count = new_size;
+    }
+
+    int operator[](unsigned i) const { return this->offsets[i]; }
+    unsigned size() const { return this->count; }
+    bool empty() const { return this->count == 0; }
+
+  private:
+    array<int, MAX_QUEUE_SIZE> offsets{};
+    unsigned count = 0;
+};
+
+using AccessMap = array<State, MAX_BLOCKS_IN_ZONE>;
+using PrefetchMap = array<int, MAX_BLOCKS_IN_ZONE>;
+
+string map_to_string(const AccessMap &access_map, const PrefetchMap &prefetch_map, int blocks_in_zone) {
     ostringstream oss;
-    for (unsigned i = 0; i < access_map.size(); i += 1)
+    for (int i = 0; i < blocks_in_zone; i += 1)
         if (access_map[i] == State::PREFTCH) {
             oss << prefetch_map[i];
         } else {
@@ -324,23 +191,28 @@ class AccessMapData {
   public:
     /* block states are represented with a `State` and an `int` in this software implementation but
      * in a hardware implementation, they'd be represented with only 2 bits. */
-    vector<State> access_map;
-    vector<int> prefetch_map;
+    AccessMap access_map{};
+    PrefetchMap prefetch_map{};
 
-    deque<int> hist_queue;
+    HistoryQueue hist_queue;
 };
 
-class AccessMapTable : public LRUSetAssociativeCache<AccessMapData> {
-    typedef LRUSetAssociativeCache<AccessMapData> Super;
-
+class AccessMapTable {
   public:
-    /* NOTE: zones are equivalent to pages (64 blocks) in this implementation */
-    AccessMapTable(int size, int blocks_in_zone, int queue_size, int debug_level = 0, int num_ways = 16)
-        : Super(size, num_ways, debug_level), blocks_in_zone(blocks_in_zone), queue_size(queue_size) {
+    static constexpr std::size_t NUM_WAYS = 16;
+
+    AccessMapTable(int amt_size, int zone_blocks, int hist_size, int dbg_level = 0)
+        : table(max<int>(1, amt_size / (int)NUM_WAYS)), blocks_in_zone(zone_blocks), queue_size(hist_size),
+          debug_level(dbg_level) {
         if (this->debug_level >= 1)
-            cerr << "AccessMapTable::AccessMapTable(size=" << size << ", blocks_in_zone=" << blocks_in_zone
-                 << ", queue_size=" << queue_size << ", debug_level=" << debug_level << ", num_ways=" << num_ways << ")"
+            cerr << "AccessMapTable::AccessMapTable(size=" << amt_size << ", blocks_in_zone=" << zone_blocks
+                 << ", queue_size=" << hist_size << ", debug_level=" << dbg_level << ", num_ways=" << NUM_WAYS << ")"
                  << endl;
+        assert(zone_blocks <= MAX_BLOCKS_IN_ZONE);
+        assert(hist_size <= MAX_QUEUE_SIZE);
+        /* calculate `index_len` (number of bits required to store the index) */
+        for (int max_index = (int)this->table.num_sets() - 1; max_index > 0; max_index >>= 1)
+            this->index_len += 1;
     }
 
     /**
@@ -361,34 +233,32 @@ class AccessMapTable : public LRUSetAssociativeCache<AccessMapData> {
         int zone_offset = block_number % this->blocks_in_zone;
 
         uint64_t key = this->build_key(zone_number);
-        Entry *entry = Super::find(key);
+        AccessMapData *entry = this->table.find(key);
         if (!entry) {
             // assert(new_state != State::PREFTCH);
             if (new_state == State::INIT)
                 return;
-            Super::insert(key, {vector<State>(blocks_in_zone, State::INIT), vector<int>(blocks_in_zone, 0)});
-            entry = Super::find(key);
-            // assert(entry->data.hist_queue.empty());
+            this->table.insert(key, AccessMapData{});
+            entry = this->table.find(key);
+            // assert(entry->hist_queue.empty());
         }
 
-        auto &access_map = entry->data.access_map;
-        auto &prefetch_map = entry->data.prefetch_map;
-        auto &hist_queue = entry->data.hist_queue;
+        auto &access_map = entry->access_map;
+        auto &prefetch_map = entry->prefetch_map;
+        auto &hist_queue = entry->hist_queue;
 
         if (new_state == State::ACCESS) {
-            Super::set_mru(key);
+            this->table.touch(key);
 
             /* insert access into queue */
-            hist_queue.push_front(zone_offset);
-            if (hist_queue.size() > this->queue_size)
-                hist_queue.pop_back();
+            hist_queue.push_front(zone_offset, this->queue_size);
         }
 
         State old_state = access_map[zone_offset];
         int old_fill_level = prefetch_map[zone_offset];
 
-        vector<State> old_access_map = access_map;
-        vector<int> old_prefetch_map = prefetch_map;
+        AccessMap old_access_map = access_map;
+        PrefetchMap old_prefetch_map = prefetch_map;
 
         access_map[zone_offset] = new_state;
         prefetch_map[zone_offset] = new_fill_level;
@@ -402,7 +272,7 @@ class AccessMapTable : public LRUSetAssociativeCache<AccessMapData> {
                     break;
                 }
             if (all_init)
-                Super::erase(key);
+                this->table.erase(key);
         }
 
         if (this->debug_level >= 2) {
@@ -410,41 +280,52 @@ class AccessMapTable : public LRUSetAssociativeCache<AccessMapData> {
                  << ", zone_offset=" << setw(2) << zone_offset << ": state transition from " << state_char[old_state]
                  << " to " << state_char[new_state] << endl;
             if (old_state != new_state || old_fill_level != new_fill_level) {
-                cerr << "[AccessMapTable::set_state] old_access_map=" << map_to_string(old_access_map, old_prefetch_map)
-                     << endl;
-                cerr << "[AccessMapTable::set_state] new_access_map=" << map_to_string(access_map, prefetch_map)
-                     << endl;
+                cerr << "[AccessMapTable::set_state] old_access_map="
+                     << map_to_string(old_access_map, old_prefetch_map, this->blocks_in_zone) << endl;
+                cerr << "[AccessMapTable::set_state] new_access_map="
+                     << map_to_string(access_map, prefetch_map, this->blocks_in_zone) << endl;
             }
         }
     }
 
-    Entry *find(uint64_t zone_number) {
+    AccessMapData *find(uint64_t zone_number) {
         if (this->debug_level >= 2)
             cerr << "AccessMapTable::find(zone_number=0x" << hex << zone_number << ")" << dec << endl;
         uint64_t key = this->build_key(zone_number);
-        return Super::find(key);
+        return this->table.find(key);
     }
 
+    /**
+     * Creates a table of all valid entries. This function makes it easy to visualize the contents of the table.
+     * @return The constructed table as a string
+     */
     string log() {
-        vector<string> headers({"Zone", "Access Map"});
-        return Super::log(headers);
+        vector<pair<uint64_t, string>> rows;
+        this->table.for_each([&](uint64_t key, const AccessMapData &data) {
+            rows.emplace_back(hash_index(key, this->index_len), map_to_string(data.access_map, data.prefetch_map, this->blocks_in_zone));
+        });
+        Table log_table(2, rows.size() + 1);
+        log_table.set_row(0, {"Zone", "Access Map"});
+        for (unsigned i = 0; i < rows.size(); i += 1) {
+            log_table.set_cell(i + 1, 0, rows[i].first);
+            log_table.set_cell(i + 1, 1, rows[i].second);
+        }
+        return log_table.to_string();
     }
 
-  private:
-    /* @override */
-    void write_data(Entry &entry, Table &table, int row) {
-        uint64_t zone_number = hash_index(entry.key, this->index_len);
-        table.set_cell(row, 0, zone_number);
-        table.set_cell(row, 1, map_to_string(entry.data.access_map, entry.data.prefetch_map));
-    }
+    void set_debug_level(int dbg_level) { this->debug_level = dbg_level; }
 
+  private:
     uint64_t build_key(uint64_t zone_number) {
         uint64_t key = zone_number; /* no truncation (52 bits) */
         return hash_index(key, this->index_len);
     }
 
+    champsim::msl::set_assoc_table<AccessMapData, NUM_WAYS> table;
     unsigned blocks_in_zone;
     unsigned queue_size;
+    int index_len = 0; /* in bits */
+    int debug_level = 0;
 
     /*===================================================================*/
     /* Entry   = [tag, map, queue, valid, LRU]                           */
@@ -494,7 +375,7 @@ class MLOP {
         //     assert(this->offset_scores[i][ORIGIN] == 0);
 
         /* update scores */
-        AccessMapTable::Entry *entry = this->access_map_table.find(zone_number);
+        AccessMapData *entry = this->access_map_table.find(zone_number);
         if (!entry) {
             /* stats */
             this->zone_cnt += 1;
@@ -506,11 +387,11 @@ class MLOP {
             /* ===== */
             return;
         }
-        vector<State> access_map = entry->data.access_map;
+        AccessMap access_map = entry->access_map;
         if (access_map[zone_offset] == State::ACCESS)
             return; /* ignore repeated trigger access */
         this->update_cnt += 1;
-        const deque<int> &queue = entry->data.hist_queue;
+        const HistoryQueue &queue = entry->hist_queue;
         for (int d = 0; d <= (int)queue.size(); d += 1) {
             /* unmark latest access to increase prediction depth */
             if (d != 0) {
@@ -635,12 +516,12 @@ class MLOP {
         int pf_issued = 0;
         uint64_t zone_number = block_number / this->blocks_in_zone;
         int zone_offset = block_number % this->blocks_in_zone;
-        AccessMapTable::Entry *entry = this->access_map_table.find(zone_number);
+        AccessMapData *entry = this->access_map_table.find(zone_number);
         // assert(entry); /* I expect `mark` to have been called before `prefetch` */
-        const vector<State> &access_map = entry->data.access_map;
-        const vector<int> &prefetch_map = entry->data.prefetch_map;
+        const AccessMap &access_map = entry->access_map;
+        const PrefetchMap &prefetch_map = entry->prefetch_map;
         if (this->debug_level >= 2) {
-            cerr << "[MLOP::prefetch] old_access_map=" << map_to_string(access_map, prefetch_map) << endl;
+            cerr << "[MLOP::prefetch] old_access_map=" << map_to_string(access_map, prefetch_map, this->blocks_in_zone) << endl;
         }
         for (int d = 0; d < PF_DEGREE; d += 1) {
             for (auto &cur_pf_offset : this->pf_offset[d]) {
@@ -655,8 +536,8 @@ class MLOP {
                     continue;
 
                 if (this->is_inside_zone(offset_to_prefetch) &&
-                    cache->get_pq_occupancy().back() < cache->get_pq_size().back() &&
-                    cache->get_pq_occupancy().back() + cache->get_mshr_occupancy() < cache->get_mshr_size() - 1) {
+                    cache->get_internal_pq_occupancy() < cache->get_internal_pq_size() &&
+                    cache->get_internal_pq_occupancy() + cache->get_mshr_occupancy() < cache->get_mshr_size() - 1) {
                     uint64_t pf_block_number = block_number + cur_pf_offset;
                     uint64_t pf_addr = pf_block_number << LOG2_BLOCK_SIZE;
                     bool fill_this_level = (this->pf_level[d] == FILL_L1);
@@ -669,7 +550,7 @@ class MLOP {
             }
         }
         if (this->debug_level >= 2) {
-            cerr << "[MLOP::prefetch] new_access_map=" << map_to_string(access_map, prefetch_map) << endl;
+            cerr << "[MLOP::prefetch] new_access_map=" << map_to_string(access_map, prefetch_map, this->blocks_in_zone) << endl;
             cerr << "[MLOP::prefetch] issued " << pf_issued << " prefetch(es)" << endl;
         }
     }
@@ -713,15 +594,15 @@ class MLOP {
     void track(uint64_t block_number) {
         uint64_t zone_number = block_number / this->blocks_in_zone;
         if (this->tracking && zone_number == this->tracked_zone_number) {
-            AccessMapTable::Entry *entry = this->access_map_table.find(zone_number);
+            AccessMapData *entry = this->access_map_table.find(zone_number);
             if (!entry) {
                 this->tracking = false; /* end of zone lifetime, stop tracking */
                 this->zone_life.push_back(string(this->blocks_in_zone, state_char[State::INIT]));
                 return;
             }
-            const vector<State> &access_map = entry->data.access_map;
-            const vector<int> &prefetch_map = entry->data.prefetch_map;
-            string s = map_to_string(access_map, prefetch_map);
+            const AccessMap &access_map = entry->access_map;
+            const PrefetchMap &prefetch_map = entry->prefetch_map;
+            string s = map_to_string(access_map, prefetch_map, this->blocks_in_zone);
             if (s != this->zone_life.back())
                 this->zone_life.push_back(s);
         }
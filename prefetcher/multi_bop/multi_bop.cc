@@ -33,10 +33,19 @@ void PrefetchTable::remove(uint64_t addr) {
   }
 }
 
-MULTI_BOP::MULTI_BOP()
-    : scoreMax(SCORE_MAX), roundMax(ROUND_MAX), rrEntries(RR_SIZE), tagMask((1 << TAG_BITS) - 1),
-      prefetch_table(PREFETCH_TABLE_SIZE), phaseBestOffset(0), bestScore(0), round(0)
+MULTI_BOP::MULTI_BOP(const champsim::module_parameters& params)
+    : scoreMax(params.get<unsigned int>("SCORE_MAX", SCORE_MAX)), roundMax(params.get<unsigned int>("ROUND_MAX", ROUND_MAX)),
+      rrEntries(params.get<unsigned int>("RR_SIZE", RR_SIZE)), tagMask((1u << params.get<unsigned int>("TAG_BITS", TAG_BITS)) - 1),
+      learned_offsets(params.get<std::size_t>("NUM_OFFSETS", NUM_OFFSETS), 0), phaseBestOffset(0), bestScore(0), round(0),
+      prefetch_table(params.get<std::size_t>("PREFETCH_TABLE_SIZE", PREFETCH_TABLE_SIZE))
 {
+  const auto offset_list_size = params.get<unsigned int>("OFFSET_LIST_SIZE", OFFSET_LIST_SIZE);
+
+  if (learned_offsets.empty()) {
+    throw std::invalid_argument{"Number of offsets must be nonzero\n"};
+  }
+  learned_offsets.front() = 1;
+
   if (!champsim::msl::isPowerOf2(rrEntries)) {
     throw std::invalid_argument{"Number of RR entries is not power of 2\n"};
   }
@@ -54,7 +63,7 @@ MULTI_BOP::MULTI_BOP()
   unsigned int i = 0;
   int64_t offset_i = 1;
 
-  while (i < OFFSET_LIST_SIZE) {
+  while (i < offset_list_size) {
     int64_t offset = offset_i;
 
     for (int n : factors) {
@@ -305,7 +314,7 @@ void MULTI_BOP::recordAccuracy() {
 
 void CACHE::prefetcher_initialize() 
 { 
-  multi_bop = new MULTI_BOP();
+  multi_bop = new MULTI_BOP(prefetcher_params);
   std::cout << "MULTI_BOP Prefetcher Initialise" << std::endl; 
 }
 
@@ -357,8 +366,7 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
         multi_bop->offset_issued[offset]++;
       } else {
         if constexpr (champsim::multi_bop_dbug) {
-          std::vector<std::size_t> pq_occupancy = get_pq_occupancy();
-          std::cout << "PQ FULL, pq_occupany: " << pq_occupancy[2] << std::endl;
+          std::cout << "PQ FULL, pq_occupany: " << get_internal_pq_occupancy() << std::endl;
         }
       }
     }
@@ -13,6 +13,7 @@
 
 #include "multi_bop_parameters.h"
 #include "cache.h"
+#include "module_parameters.h"
 #include "msl/bits.h"
 #include "msl/lru_table.h"
 
@@ -52,7 +53,7 @@ private:
   typedef std::pair<int16_t, uint8_t> OffsetListEntry;
   std::vector<OffsetListEntry> offsetsList;
 
-  std::array<uint64_t, NUM_OFFSETS> learned_offsets = {1};
+  std::vector<uint64_t> learned_offsets;
   unsigned int current_learning_offset_idx = 0;
 
   std::unordered_set<uint64_t> suppressed_offsets;
@@ -119,7 +120,7 @@ public:
 
   void insertFill(uint64_t addr);
 
-  MULTI_BOP();
+  explicit MULTI_BOP(const champsim::module_parameters& params);
   ~MULTI_BOP() = default;
 }; // class MULTI_BOP
 
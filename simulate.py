@@ -5,9 +5,6 @@ import argparse
 import sys 
 import os 
 import json 
-import datetime
-import glob
-import shutil
 from concurrent.futures import ThreadPoolExecutor
 
 from _SPEC2017_def import SPEC2017_SHORTCODE, SPEC2017_PATH
@@ -25,20 +22,13 @@ parser.add_argument('--name', type=str, help='Optional name for result directory
 parser.add_argument('--clean', action='store_true', help='Clean the build', required=False)
 parser.add_argument('--no_conf', action='store_true', help='Skip configuration (Still Make)', required=False) 
 parser.add_argument('--cppflags', type=str, help='Extra CPPFLAGS to pass to make (e.g. "-DKAIROS_DBUG -DTEST_DBUG")', required=False)
-parser.add_argument('--clean-old', action='store_true', help='Clean old build directories')
 
 args = parser.parse_args()
 
-def cleanup_old_builds(base_dir="bin", keep_last=5):
-    builds = sorted(glob.glob(os.path.join(base_dir, '*')), key=os.path.getmtime, reverse=True)
-    for old_build in builds[keep_last:]:
-        if os.path.basename(old_build) in ["champsim"]:
-            continue
-        print(f"Removing old build: {old_build}")
-        shutil.rmtree(old_build)
-
-if args.clean_old:
-    cleanup_old_builds("bin", keep_last=5)
+# Every module is compiled into a single binary, whose hierarchy is taken from this configuration.
+# The configuration of each run only chooses the modules and their parameters, so it must share this hierarchy.
+# The simulator rejects a configuration whose caches differ from it.
+HIERARCHY_CONFIG = "no_prefetch.json"
 
 # See if input benchmark is valid
 if args.benchmark not in SPEC2017_SHORTCODE:
@@ -58,16 +48,13 @@ if args.config:
       prefetcher = args.name
 else: prefetcher = "no"
 
-# Create unique run name with timestamp if not provided
-timestamp = datetime.datetime.now().strftime("%Y%m%d_%H%M%S")
-run_name = f"{prefetcher}_{timestamp}"
-build_dir = os.path.abspath(f"bin/{run_name}")
+build_dir = os.path.abspath("bin/all_modules")
 
 if not args.no_conf:
     print("======================") 
     print("Updating Configuration")
     print("======================")
-    result = subprocess.run(["./config.sh", "--bindir", build_dir, config_path])
+    result = subprocess.run(["./config.sh", "--compile-all-modules", "--bindir", build_dir, HIERARCHY_CONFIG])
     if result.returncode != 0:
         print("Configuration failed")
         sys.exit(1)
@@ -125,6 +112,7 @@ def champsim_kernel(kernel_arg):
         print(f"Dispatching {benchmark} ... [{job_number+1} / {total+1}]")
         result = subprocess.run([
             f"{build_dir}/champsim", 
+            "--config", config_path,
             "--warmup-instructions", f"{WARMUP_INSTRUCTIONS}000000",
             "--simulation-instructions", f"{SIMULATION_INSTRUCTIONS}000000",
             SPEC2017_PATH + benchmark
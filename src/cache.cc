@@ -34,6 +34,14 @@
 
 #include <iostream>
 
+namespace
+{
+std::size_t timeliness_bucket(uint64_t cycles)
+{
+  return std::min<std::size_t>(cycles == 0 ? 0 : champsim::lg2(cycles), champsim::prefetch_source_stats::TIMELINESS_BUCKETS - 1);
+}
+} // namespace
+
 CACHE::tag_lookup_type::tag_lookup_type(request_type req, bool local_pref, bool skip)
     : address(req.address), v_address(req.v_address), data(req.data), ip(req.ip), instr_id(req.instr_id), pf_metadata(req.pf_metadata), cpu(req.cpu),
       type(req.type), prefetch_from_this(local_pref), skip_fill(skip), is_translated(req.is_translated), instr_depend_on_me(req.instr_depend_on_me)
@@ -42,7 +50,7 @@ CACHE::tag_lookup_type::tag_lookup_type(request_type req, bool local_pref, bool
 
 CACHE::mshr_type::mshr_type(tag_lookup_type req, uint64_t cycle)
     : address(req.address), v_address(req.v_address), data(req.data), ip(req.ip), instr_id(req.instr_id), pf_metadata(req.pf_metadata), cpu(req.cpu),
-      type(req.type), prefetch_from_this(req.prefetch_from_this), cycle_enqueued(cycle), instr_depend_on_me(req.instr_depend_on_me), to_return(req.to_return)
+      pf_source(req.pf_source), type(req.type), prefetch_from_this(req.prefetch_from_this), cycle_enqueued(cycle), instr_depend_on_me(req.instr_depend_on_me), to_return(req.to_return)
 {
 }
 
@@ -60,6 +68,8 @@ CACHE::mshr_type CACHE::mshr_type::merge(mshr_type predecessor, mshr_type succes
   retval.instr_depend_on_me = merged_instr;
   retval.to_return = merged_return;
   retval.data = predecessor.data;
+  retval.served_by = predecessor.served_by;
+  retval.page_bits = predecessor.page_bits;
 
   if (predecessor.event_cycle < std::numeric_limits<uint64_t>::max()) {
     retval.event_cycle = predecessor.event_cycle;
@@ -77,19 +87,61 @@ CACHE::mshr_type CACHE::mshr_type::merge(mshr_type predecessor, mshr_type succes
 }
 
 CACHE::BLOCK::BLOCK(mshr_type mshr)
-    : valid(true), prefetch(mshr.prefetch_from_this), dirty(mshr.type == access_type::WRITE), address(mshr.address), v_address(mshr.v_address), data(mshr.data)
+    : valid(true), prefetch(mshr.prefetch_from_this), dirty(mshr.type == access_type::WRITE), address(mshr.address), v_address(mshr.v_address), data(mshr.data),
+      pf_source(mshr.pf_source), page_bits(mshr.page_bits)
 {
 }
 
+uint64_t CACHE::set_address(uint64_t address, unsigned page_bits) const { return (page_bits > OFFSET_BITS) ? ((address >> page_bits) << OFFSET_BITS) : address; }
+
+auto CACHE::matches_address(uint64_t address) const
+{
+  return [address, offset_bits = OFFSET_BITS](const BLOCK& entry) {
+    auto shamt = std::max(offset_bits, entry.page_bits);
+    return (entry.address >> shamt) == (address >> shamt);
+  };
+}
+
+auto CACHE::find_block(uint64_t address) -> std::tuple<set_type::iterator, set_type::iterator, set_type::iterator>
+{
+  auto [set_begin, set_end] = get_set_span(address);
+  auto way = std::find_if(set_begin, set_end, matches_address(address));
+  for (auto it = std::begin(larger_page_bits); way == set_end && it != std::end(larger_page_bits); ++it) {
+    std::tie(set_begin, set_end) = get_set_span(set_address(address, *it));
+    way = std::find_if(set_begin, set_end, matches_address(address));
+  }
+  return {set_begin, set_end, way};
+}
+
+auto CACHE::find_block(uint64_t address) const -> std::tuple<set_type::const_iterator, set_type::const_iterator, set_type::const_iterator>
+{
+  auto [set_begin, set_end] = get_set_span(address);
+  auto way = std::find_if(set_begin, set_end, matches_address(address));
+  for (auto it = std::begin(larger_page_bits); way == set_end && it != std::end(larger_page_bits); ++it) {
+    std::tie(set_begin, set_end) = get_set_span(set_address(address, *it));
+    way = std::find_if(set_begin, set_end, matches_address(address));
+  }
+  return {set_begin, set_end, way};
+}
+
 bool CACHE::handle_fill(const mshr_type& fill_mshr)
 {
   cpu = fill_mshr.cpu;
 
   // find victim
-  auto [set_begin, set_end] = get_set_span(fill_mshr.address);
+  const auto set_idx = get_set_index(set_address(fill_mshr.address, fill_mshr.page_bits));
+  auto [set_begin, set_end] = get_set_span(set_address(fill_mshr.address, fill_mshr.page_bits));
   auto way = std::find_if_not(set_begin, set_end, [](auto x) { return x.valid; });
+  if (fill_mshr.page_bits > OFFSET_BITS) {
+    if (std::find(std::begin(larger_page_bits), std::end(larger_page_bits), fill_mshr.page_bits) == std::end(larger_page_bits))
+      larger_page_bits.push_back(fill_mshr.page_bits);
+
+    // Walks for different parts of the same page may return separately, but the page needs only one entry
+    if (auto existing = std::find_if(set_begin, set_end, matches_address(fill_mshr.address)); existing != set_end)
+      way = existing;
+  }
   if (way == set_end)
-    way = std::next(set_begin, impl_find_victim(fill_mshr.cpu, fill_mshr.instr_id, get_set_index(fill_mshr.address), &*set_begin, fill_mshr.ip,
+    way = std::next(set_begin, impl_find_victim(fill_mshr.cpu, fill_mshr.instr_id, set_idx, &*set_begin, fill_mshr.ip,
                                                 fill_mshr.address, champsim::to_underlying(fill_mshr.type)));
   assert(set_begin <= way);
   assert(way <= set_end);
@@ -98,7 +150,7 @@ bool CACHE::handle_fill(const mshr_type& fill_mshr)
   if constexpr (champsim::debug_print) {
     fmt::print(
         "[{}] {} instr_id: {} address: {:#x} v_address: {:#x} set: {} way: {} type: {} prefetch_metadata: {} cycle_enqueued: {} cycle: {}\n",
-        NAME, __func__, fill_mshr.instr_id, fill_mshr.address, fill_mshr.v_address, get_set_index(fill_mshr.address), way_idx,
+        NAME, __func__, fill_mshr.instr_id, fill_mshr.address, fill_mshr.v_address, set_idx, way_idx,
         access_type_names.at(champsim::to_underlying(fill_mshr.type)), fill_mshr.pf_metadata, fill_mshr.cycle_enqueued, current_cycle);
   }
 
@@ -129,17 +181,23 @@ bool CACHE::handle_fill(const mshr_type& fill_mshr)
     if (success) {
       auto evicting_address = (ever_seen_data ? way->address : way->v_address) & ~champsim::bitmask(match_offset_bits ? 0 : OFFSET_BITS);
 
-      if (way->prefetch && way->pf_metadata == 0x1) // Only records Berti
-        ++sim_stats.pf_useless;
+      if (way->valid && way->prefetch)
+        record_useless_prefetch(way->pf_source);
+
+      if (way->valid && fill_mshr.prefetch_from_this && pf_throttle.has_value())
+        pf_throttle->record_prefetch_eviction(fill_mshr.pf_source, way->address);
 
       if (fill_mshr.type == access_type::PREFETCH)
         ++sim_stats.pf_fill;
 
+      if (auto source_stats = pf_source_stats(fill_mshr.pf_source); fill_mshr.prefetch_from_this && source_stats != nullptr)
+        ++source_stats->filled;
+
       *way = BLOCK{fill_mshr};
+      way->fill_cycle = current_cycle;
 
-      metadata_thru = impl_prefetcher_cache_fill(pkt_address, get_set_index(fill_mshr.address), way_idx, fill_mshr.type == access_type::PREFETCH,
-                                                 evicting_address, metadata_thru);
-      impl_update_replacement_state(fill_mshr.cpu, get_set_index(fill_mshr.address), way_idx, fill_mshr.address, fill_mshr.ip, evicting_address,
+      metadata_thru = impl_prefetcher_cache_fill(pkt_address, set_idx, way_idx, fill_mshr.type == access_type::PREFETCH, evicting_address, metadata_thru);
+      impl_update_replacement_state(fill_mshr.cpu, set_idx, way_idx, fill_mshr.address, fill_mshr.ip, evicting_address,
                                     champsim::to_underlying(fill_mshr.type), false);
 
       way->pf_metadata = metadata_thru;
@@ -148,9 +206,8 @@ bool CACHE::handle_fill(const mshr_type& fill_mshr)
     // Bypass
     assert(fill_mshr.type != access_type::WRITE);
 
-    metadata_thru =
-        impl_prefetcher_cache_fill(pkt_address, get_set_index(fill_mshr.address), way_idx, fill_mshr.type == access_type::PREFETCH, 0, metadata_thru);
-    impl_update_replacement_state(fill_mshr.cpu, get_set_index(fill_mshr.address), way_idx, fill_mshr.address, fill_mshr.ip, 0,
+    metadata_thru = impl_prefetcher_cache_fill(pkt_address, set_idx, way_idx, fill_mshr.type == access_type::PREFETCH, 0, metadata_thru);
+    impl_update_replacement_state(fill_mshr.cpu, set_idx, way_idx, fill_mshr.address, fill_mshr.ip, 0,
                                   champsim::to_underlying(fill_mshr.type), false);
   }
 
@@ -158,7 +215,8 @@ bool CACHE::handle_fill(const mshr_type& fill_mshr)
     // COLLECT STATS
     sim_stats.total_miss_latency += current_cycle - (fill_mshr.cycle_enqueued + 1);
 
-    response_type response{fill_mshr.address, fill_mshr.v_address, fill_mshr.data, metadata_thru, fill_mshr.instr_depend_on_me};
+    response_type response{fill_mshr.address, fill_mshr.v_address, fill_mshr.data, metadata_thru, fill_mshr.instr_depend_on_me, fill_mshr.served_by};
+    response.page_bits = fill_mshr.page_bits;
     for (auto ret : fill_mshr.to_return)
       ret->push_back(response);
   }
@@ -171,9 +229,7 @@ bool CACHE::try_hit(const tag_lookup_type& handle_pkt)
   cpu = handle_pkt.cpu;
 
   // access cache
-  auto [set_begin, set_end] = get_set_span(handle_pkt.address);
-  auto way = std::find_if(set_begin, set_end,
-                          [match = handle_pkt.address >> OFFSET_BITS, shamt = OFFSET_BITS](const auto& entry) { return (entry.address >> shamt) == match; });
+  auto [set_begin, set_end, way] = find_block(handle_pkt.address);
   const auto hit = (way != set_end);
   const auto useful_prefetch = (hit && way->prefetch && !handle_pkt.prefetch_from_this);
 
@@ -195,22 +251,33 @@ bool CACHE::try_hit(const tag_lookup_type& handle_pkt)
 
     // update replacement policy
     const auto way_idx = static_cast<std::size_t>(std::distance(set_begin, way)); // cast protected by earlier assertion
-    impl_update_replacement_state(handle_pkt.cpu, get_set_index(handle_pkt.address), way_idx, way->address, handle_pkt.ip, 0,
-                                  champsim::to_underlying(handle_pkt.type), true);
+    const auto set_idx = static_cast<std::size_t>(std::distance(std::begin(block), set_begin)) / NUM_WAY;
+    impl_update_replacement_state(handle_pkt.cpu, set_idx, way_idx, way->address, handle_pkt.ip, 0, champsim::to_underlying(handle_pkt.type), true);
 
-    response_type response{handle_pkt.address, handle_pkt.v_address, way->data, metadata_thru, handle_pkt.instr_depend_on_me};
+    // An entry for a larger page holds the translation of one address in the page
+    auto data = (way->page_bits > OFFSET_BITS) ? champsim::splice_bits(way->data, handle_pkt.address, way->page_bits) : way->data;
+    response_type response{handle_pkt.address, handle_pkt.v_address, data, metadata_thru, handle_pkt.instr_depend_on_me, NAME};
+    response.page_bits = way->page_bits;
     for (auto ret : handle_pkt.to_return)
       ret->push_back(response);
 
     way->dirty |= (handle_pkt.type == access_type::WRITE);
 
+    // A demand access that a prefetch turned into a hit would otherwise have missed
+    if (pf_sandbox.has_value() && handle_pkt.type != access_type::PREFETCH)
+      pf_sandbox->record_demand(virtual_prefetch ? handle_pkt.v_address : handle_pkt.address, useful_prefetch);
+
     // update prefetch stats and reset prefetch bit
-    if (useful_prefetch && way->pf_metadata == 0x1) { // Exludes Stride
-      ++sim_stats.pf_useful;
+    if (useful_prefetch) {
+      record_useful_prefetch(way->pf_source, false, current_cycle - way->fill_cycle);
       way->prefetch = false;
     }
   }
 
+  // A prefetch that finds its block already in the cache is redundant
+  if (auto source_stats = pf_source_stats(handle_pkt.pf_source); hit && handle_pkt.prefetch_from_this && source_stats != nullptr)
+    ++source_stats->redundant;
+
   return hit;
 }
 
@@ -235,19 +302,31 @@ bool CACHE::handle_miss(const tag_lookup_type& handle_pkt)
   if (mshr_entry != MSHR.end()) // miss already inflight
   {
     if (mshr_entry->type == access_type::PREFETCH && handle_pkt.type != access_type::PREFETCH) {
-      // Mark the prefetch as useful
+      // Mark the prefetch as useful, but late
       if (mshr_entry->prefetch_from_this)
-        ++sim_stats.pf_useful;
+        record_useful_prefetch(mshr_entry->pf_source, true, current_cycle - mshr_entry->cycle_enqueued);
     }
 
+    // A prefetch that finds its block already in flight is redundant
+    if (auto source_stats = pf_source_stats(handle_pkt.pf_source); handle_pkt.prefetch_from_this && source_stats != nullptr)
+      ++source_stats->redundant;
+
     *mshr_entry = mshr_type::merge(*mshr_entry, to_allocate);
   } else {
-    if (mshr_full) { // not enough MSHR resource
+    // Prefetches may not take the MSHR entries reserved for demand misses
+    bool mshr_reserved = (handle_pkt.type == access_type::PREFETCH) && (std::size(MSHR) + pq_policy.mshr_reserve >= MSHR_SIZE);
+    if (mshr_full || mshr_reserved) { // not enough MSHR resource
       if constexpr (champsim::debug_print) {
         fmt::print("[{}] {} MSHR full\n", NAME, __func__);
       }
 
-      return false;  // TODO should we allow prefetches anyway if they will not be filled to this level?
+      // With a reservation, this cache's own prefetches are discarded, rather than holding up the demand misses behind them
+      if (pq_policy.mshr_reserve > 0 && handle_pkt.prefetch_from_this) {
+        record_discarded_prefetch(handle_pkt.pf_source);
+        return true;
+      }
+
+      return false;
     }
 
     request_type fwd_pkt;
@@ -289,6 +368,10 @@ bool CACHE::handle_miss(const tag_lookup_type& handle_pkt)
   }
 
   ++sim_stats.misses[champsim::to_underlying(handle_pkt.type)][handle_pkt.cpu];
+  if (pf_throttle.has_value() && handle_pkt.type != access_type::PREFETCH)
+    pf_throttle->record_demand_miss(handle_pkt.address);
+  if (pf_sandbox.has_value() && handle_pkt.type != access_type::PREFETCH)
+    pf_sandbox->record_demand(virtual_prefetch ? handle_pkt.v_address : handle_pkt.address, true);
 
   return true;
 }
@@ -360,6 +443,35 @@ long CACHE::operate()
   }
   progress += MAX_FILL - fill_bw;
 
+  // Update the aggressiveness of the prefetchers at the end of each throttle interval
+  if (pf_throttle.has_value() && pf_throttle->operate()) {
+    for (std::size_t source = 0; source < std::size(sim_stats.pf_sources); ++source)
+      ++sim_stats.pf_sources[source].throttle_levels.at(pf_throttle->level(source));
+  }
+
+  // Select the prefetcher that issues at the end of each sandbox interval
+  if (pf_sandbox.has_value()) {
+    auto previous = pf_sandbox->selected();
+    if (auto source_stats = pf_source_stats(previous); pf_sandbox->operate() && source_stats != nullptr)
+      ++source_stats->selected;
+  }
+
+  // Discard the prefetches that have waited too long to be checked
+  if (pq_policy.max_age > 0) {
+    auto stale = [cycle = current_cycle, max_age = pq_policy.max_age](const auto& entry) { return entry.cycle_enqueued + max_age < cycle; };
+    for (const auto& entry : internal_PQ) {
+      if (stale(entry))
+        record_discarded_prefetch(entry.pf_source);
+    }
+    auto first_stale = std::remove_if(std::begin(internal_PQ), std::end(internal_PQ), stale);
+    progress += std::distance(first_stale, std::end(internal_PQ));
+    internal_PQ.erase(first_stale, std::end(internal_PQ));
+  }
+
+  // Issue the prefetches chosen by the arbiter
+  if (pf_arbiter.has_value())
+    progress += pf_arbiter->issue([this](const auto& pf) { return this->issue_prefetch(pf); });
+
   // Initiate tag checks
   auto tag_bw = std::max(0ll, std::min<long long>(static_cast<long long>(MAX_TAG), MAX_TAG * HIT_LATENCY - std::size(inflight_tag_check)));
   auto can_translate = [avail = (std::size(translation_stash) < static_cast<std::size_t>(MSHR_SIZE))](const auto& entry) {
@@ -451,17 +563,14 @@ auto CACHE::get_set_span(uint64_t address) const -> std::pair<std::vector<BLOCK>
 // LCOV_EXCL_START exclude deprecated function
 uint64_t CACHE::get_way(uint64_t address, uint64_t) const
 {
-  auto [begin, end] = get_set_span(address);
-  return std::distance(
-      begin, std::find_if(begin, end, [match = address >> OFFSET_BITS, shamt = OFFSET_BITS](const auto& entry) { return (entry.address >> shamt) == match; }));
+  auto [begin, end, way] = find_block(address);
+  return std::distance(begin, way);
 }
 // LCOV_EXCL_STOP
 
 uint64_t CACHE::invalidate_entry(uint64_t inval_addr)
 {
-  auto [begin, end] = get_set_span(inval_addr);
-  auto inv_way =
-      std::find_if(begin, end, [match = inval_addr >> OFFSET_BITS, shamt = OFFSET_BITS](const auto& entry) { return (entry.address >> shamt) == match; });
+  auto [begin, end, inv_way] = find_block(inval_addr);
 
   if (inv_way != end)
     inv_way->valid = 0;
@@ -484,23 +593,170 @@ int CACHE::prefetch_line(uint64_t pf_addr, bool fill_this_level, uint32_t prefet
 {
   ++sim_stats.pf_requested;
 
-  if (std::size(internal_PQ) >= PQ_SIZE)
+  auto source = pf_source_of(active_prefetcher);
+  auto source_stats = pf_source_stats(source);
+  if (source_stats != nullptr)
+    ++source_stats->proposed;
+
+  // The sandbox evaluates every prefetcher, but only the selected one issues. The others are told that their prefetches were accepted,
+  // so that they go on predicting as they would if they issued. Every prediction is recorded, whatever the cache holds, so that the
+  // blocks the selected prefetcher has already brought in do not favor it.
+  if (pf_sandbox.has_value()) {
+    pf_sandbox->record_prediction(source, pf_addr);
+    if (!pf_sandbox->is_selected(source)) {
+      if (source_stats != nullptr)
+        ++source_stats->dark;
+      return true;
+    }
+  }
+
+  // Drop the prefetches beyond the degree the throttle allows the prefetcher for this trigger
+  if (pf_throttle.has_value() && !pf_throttle->admit(source)) {
+    if (source_stats != nullptr)
+      ++source_stats->throttled;
     return false;
+  }
+
+  // Virtual prefetch addresses cannot be compared with the blocks in the cache
+  if (pq_policy.drop_redundant && !virtual_prefetch && prefetch_is_redundant(pf_addr)) {
+    if (source_stats != nullptr)
+      ++source_stats->filtered;
+    return false;
+  }
+
+  if (!pf_arbiter.has_value() || std::empty(pf_arbiter->sources()))
+    return issue_prefetch({pf_addr, fill_this_level, prefetch_metadata, cpu, source});
+
+  // Propose the prefetch to the arbiter, which issues it later if it is chosen
+  using proposal_result = champsim::prefetch_arbiter::proposal_result;
+  auto result = pf_arbiter->propose({pf_addr, fill_this_level, prefetch_metadata, cpu, source});
+  if (result == proposal_result::DUPLICATE && source_stats != nullptr)
+    ++source_stats->duplicate;
+  if (result == proposal_result::DROPPED && source_stats != nullptr)
+    ++source_stats->dropped;
+
+  return result == proposal_result::ACCEPTED;
+}
+
+bool CACHE::issue_prefetch(const champsim::prefetch_arbiter::candidate& pf)
+{
+  auto confidence = pf_source_confidence(pf.source);
+  auto less_confident = [this, confidence](const auto& entry) { return this->pf_source_confidence(entry.pf_source) < confidence; };
+
+  // A full queue may make room by discarding its least confident prefetch
+  if (std::size(internal_PQ) >= PQ_SIZE) {
+    if (!pq_policy.confidence_order || std::empty(internal_PQ))
+      return false;
+
+    auto least = std::min_element(std::begin(internal_PQ), std::end(internal_PQ),
+                                  [this](const auto& x, const auto& y) { return this->pf_source_confidence(x.pf_source) < this->pf_source_confidence(y.pf_source); });
+    if (!less_confident(*least))
+      return false;
+
+    record_discarded_prefetch(least->pf_source);
+    internal_PQ.erase(least);
+  }
 
   request_type pf_packet;
   pf_packet.type = access_type::PREFETCH;
-  pf_packet.pf_metadata = prefetch_metadata;
-  pf_packet.cpu = cpu;
-  pf_packet.address = pf_addr;
-  pf_packet.v_address = virtual_prefetch ? pf_addr : 0;
+  pf_packet.pf_metadata = pf.metadata;
+  pf_packet.cpu = pf.cpu;
+  pf_packet.address = pf.address;
+  pf_packet.v_address = virtual_prefetch ? pf.address : 0;
   pf_packet.is_translated = !virtual_prefetch;
 
-  internal_PQ.emplace_back(pf_packet, true, !fill_this_level);
+  auto position = pq_policy.confidence_order ? std::find_if(std::begin(internal_PQ), std::end(internal_PQ), less_confident) : std::end(internal_PQ);
+  position = internal_PQ.emplace(position, pf_packet, true, !pf.fill_this_level);
+  position->pf_source = pf.source;
+  position->cycle_enqueued = current_cycle;
   ++sim_stats.pf_issued;
+  if (auto source_stats = pf_source_stats(pf.source); source_stats != nullptr)
+    ++source_stats->issued;
+  if (pf_throttle.has_value())
+    pf_throttle->record_issued(pf.source);
 
   return true;
 }
 
+std::size_t CACHE::pf_source_of(unsigned long long flag) const
+{
+  if (pf_arbiter.has_value() && !std::empty(pf_arbiter->sources()))
+    return pf_arbiter->source_of(flag);
+
+  auto found = std::find(std::begin(pf_source_flags), std::end(pf_source_flags), flag);
+  if (found == std::end(pf_source_flags))
+    return std::empty(pf_source_flags) ? 0 : std::size(pf_source_flags) - 1;
+  return static_cast<std::size_t>(std::distance(std::begin(pf_source_flags), found));
+}
+
+champsim::prefetch_source_stats* CACHE::pf_source_stats(std::size_t source)
+{
+  if (source >= std::size(sim_stats.pf_sources))
+    return nullptr;
+  return &sim_stats.pf_sources[source];
+}
+
+void CACHE::record_useful_prefetch(std::size_t source, bool late, uint64_t cycles)
+{
+  ++sim_stats.pf_useful;
+  if (auto source_stats = pf_source_stats(source); source_stats != nullptr) {
+    ++source_stats->useful;
+    if (late) {
+      ++source_stats->late;
+      ++source_stats->late_cycles[timeliness_bucket(cycles)];
+    } else {
+      ++source_stats->timely_cycles[timeliness_bucket(cycles)];
+    }
+  }
+
+  if (pf_arbiter.has_value())
+    pf_arbiter->record_useful(source);
+  if (pf_throttle.has_value())
+    pf_throttle->record_useful(source, late);
+}
+
+void CACHE::record_useless_prefetch(std::size_t source)
+{
+  ++sim_stats.pf_useless;
+  if (auto source_stats = pf_source_stats(source); source_stats != nullptr)
+    ++source_stats->useless;
+
+  if (pf_arbiter.has_value())
+    pf_arbiter->record_useless(source);
+}
+
+void CACHE::record_discarded_prefetch(std::size_t source)
+{
+  if (auto source_stats = pf_source_stats(source); source_stats != nullptr)
+    ++source_stats->discarded;
+  if (pf_throttle.has_value())
+    pf_throttle->record_discarded(source);
+}
+
+double CACHE::pf_source_confidence(std::size_t source) const
+{
+  if (source >= std::size(sim_stats.pf_sources))
+    return 0;
+  const auto& source_stats = sim_stats.pf_sources[source];
+  return (static_cast<double>(source_stats.useful) + 1.0) / (static_cast<double>(source_stats.useful + source_stats.useless) + 2.0);
+}
+
+bool CACHE::prefetch_is_redundant(uint64_t address) const
+{
+  auto same_block = [match = address >> OFFSET_BITS, shamt = OFFSET_BITS](const auto& entry) {
+    return (entry.address >> shamt) == match;
+  };
+  return contains_line(address) || std::any_of(std::begin(MSHR), std::end(MSHR), same_block)
+         || std::any_of(std::begin(internal_PQ), std::end(internal_PQ), same_block);
+}
+
+std::size_t CACHE::prefetch_degree() const
+{
+  if (!pf_throttle.has_value())
+    return std::numeric_limits<std::size_t>::max();
+  return pf_throttle->degree(pf_source_of(active_prefetcher));
+}
+
 // LCOV_EXCL_START exclude deprecated function
 int CACHE::prefetch_line(uint64_t, uint64_t, uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata)
 {
@@ -524,6 +780,8 @@ void CACHE::finish_packet(const response_type& packet)
   // MSHR holds the most updated information about this request
   mshr_entry->data = packet.data;
   mshr_entry->pf_metadata = packet.pf_metadata;
+  mshr_entry->served_by = packet.served_by;
+  mshr_entry->page_bits = packet.page_bits;
   mshr_entry->event_cycle = current_cycle + (warmup ? 0 : FILL_LATENCY);
 
   if constexpr (champsim::debug_print) {
@@ -599,6 +857,33 @@ void CACHE::issue_translation()
 
 std::size_t CACHE::get_mshr_occupancy() const { return std::size(MSHR); }
 
+std::size_t CACHE::get_internal_pq_occupancy() const { return std::size(internal_PQ); }
+
+auto CACHE::get_occupancy_snapshot() const -> const cache_occupancy&
+{
+  occupancy_sample.mshr = get_mshr_occupancy();
+  occupancy_sample.mshr_size = get_mshr_size();
+  occupancy_sample.internal_pq = get_internal_pq_occupancy();
+  occupancy_sample.internal_pq_size = get_internal_pq_size();
+
+  if (occupancy_sample.cycle == current_cycle)
+    return occupancy_sample;
+
+  auto sample_upper_levels = [this](auto& dest, auto func) {
+    dest.resize(std::size(upper_levels));
+    std::transform(std::begin(upper_levels), std::end(upper_levels), std::begin(dest), func);
+  };
+  sample_upper_levels(occupancy_sample.rq, [](auto ulptr) { return ulptr->rq_occupancy(); });
+  sample_upper_levels(occupancy_sample.rq_size, [](auto ulptr) { return ulptr->rq_size(); });
+  sample_upper_levels(occupancy_sample.wq, [](auto ulptr) { return ulptr->wq_occupancy(); });
+  sample_upper_levels(occupancy_sample.wq_size, [](auto ulptr) { return ulptr->wq_size(); });
+  sample_upper_levels(occupancy_sample.pq, [](auto ulptr) { return ulptr->pq_occupancy(); });
+  sample_upper_levels(occupancy_sample.pq_size, [](auto ulptr) { return ulptr->pq_size(); });
+  occupancy_sample.cycle = current_cycle;
+
+  return occupancy_sample;
+}
+
 std::vector<std::size_t> CACHE::get_rq_occupancy() const
 {
   std::vector<std::size_t> retval;
@@ -632,6 +917,8 @@ std::size_t CACHE::get_occupancy(uint8_t queue_type, uint64_t)
 
 std::size_t CACHE::get_mshr_size() const { return MSHR_SIZE; }
 
+std::size_t CACHE::get_internal_pq_size() const { return PQ_SIZE; }
+
 std::vector<std::size_t> CACHE::get_rq_size() const
 {
   std::vector<std::size_t> retval;
@@ -683,9 +970,46 @@ std::vector<double> CACHE::get_wq_occupancy_ratio() const { return ::occupancy_r
 
 std::vector<double> CACHE::get_pq_occupancy_ratio() const { return ::occupancy_ratio_vec(get_pq_occupancy(), get_pq_size()); }
 
+void CACHE::select_prefetcher(const std::vector<std::string>& names)
+{
+  module_pimpl = std::make_unique<dynamic_module_model>(this, champsim::select_modules(prefetcher_registry(), names, "prefetcher"),
+                                                        module_pimpl->replacement_flags());
+
+  // The prefetchers are given priority in the order they are named
+  if (pf_arbiter.has_value()) {
+    std::vector<unsigned long long> priority;
+    for (const auto& name : names)
+      priority.push_back(champsim::select_modules(prefetcher_registry(), {name}, "prefetcher"));
+    pf_arbiter->set_priority(priority);
+  }
+}
+
+void CACHE::select_replacement(const std::vector<std::string>& names)
+{
+  module_pimpl = std::make_unique<dynamic_module_model>(this, module_pimpl->prefetcher_flags(),
+                                                        champsim::select_modules(replacement_registry(), names, "replacement policy"));
+}
+
 void CACHE::initialize()
 {
+  pf_source_flags.clear();
+  if (pf_arbiter.has_value()) {
+    pf_arbiter->set_sources(module_pimpl->prefetcher_flags());
+    pf_source_flags = pf_arbiter->sources();
+  } else {
+    for (auto flags = module_pimpl->prefetcher_flags(); flags != 0; flags &= flags - 1)
+      pf_source_flags.push_back(flags & ~(flags - 1));
+  }
+
+  if (pf_throttle.has_value())
+    pf_throttle->set_sources(std::size(pf_source_flags));
+  if (pf_sandbox.has_value())
+    pf_sandbox->set_sources(std::size(pf_source_flags));
+
   impl_prefetcher_initialize();
+  for (const auto& name : prefetcher_params.undeclared())
+    fmt::print("WARNING: {} prefetcher parameter {} is not used by its prefetcher.\n", NAME, name);
+
   impl_initialize_replacement();
 }
 
@@ -696,6 +1020,17 @@ void CACHE::begin_phase()
   new_roi_stats.name = NAME;
   new_sim_stats.name = NAME;
 
+  const auto& registry = prefetcher_registry();
+  for (auto flag : pf_source_flags) {
+    auto found = std::find_if(std::begin(registry), std::end(registry), [flag](const auto& entry) { return entry.second == flag; });
+    champsim::prefetch_source_stats source_stats;
+    source_stats.name = (found != std::end(registry)) ? found->first : "prefetcher " + std::to_string(std::size(new_sim_stats.pf_sources));
+    if (pf_throttle.has_value())
+      source_stats.throttle_levels.resize(std::size(pf_throttle->get_config().degrees));
+    new_sim_stats.pf_sources.push_back(source_stats);
+  }
+  new_roi_stats.pf_sources = new_sim_stats.pf_sources;
+
   roi_stats = new_roi_stats;
   sim_stats = new_sim_stats;
 
@@ -728,6 +1063,7 @@ void CACHE::end_phase(unsigned finished_cpu)
   roi_stats.pf_useful = sim_stats.pf_useful;
   roi_stats.pf_useless = sim_stats.pf_useless;
   roi_stats.pf_fill = sim_stats.pf_fill;
+  roi_stats.pf_sources = sim_stats.pf_sources;
 
   for (auto ul : upper_levels) {
     ul->roi_stats.RQ_ACCESS = ul->sim_stats.RQ_ACCESS;
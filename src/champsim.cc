@@ -41,6 +41,7 @@ phase_stats do_phase(phase_info phase, environment& env, std::vector<tracereader
 {
   auto [phase_name, is_warmup, length, trace_index, trace_names] = phase;
   auto operables = env.operable_view();
+  auto vmem_begin = env.vmem_view().get_stats();
 
   // Initialize phase
   for (champsim::operable& op : operables) {
@@ -123,11 +124,20 @@ phase_stats do_phase(phase_info phase, environment& env, std::vector<tracereader
   std::transform(std::begin(caches), std::end(caches), std::back_inserter(stats.sim_cache_stats), [](const CACHE& cache) { return cache.sim_stats; });
   std::transform(std::begin(caches), std::end(caches), std::back_inserter(stats.roi_cache_stats), [](const CACHE& cache) { return cache.roi_stats; });
 
-  auto dram = env.dram_view();
-  std::transform(std::begin(dram.channels), std::end(dram.channels), std::back_inserter(stats.sim_dram_stats),
-                 [](const DRAM_CHANNEL& chan) { return chan.sim_stats; });
-  std::transform(std::begin(dram.channels), std::end(dram.channels), std::back_inserter(stats.roi_dram_stats),
-                 [](const DRAM_CHANNEL& chan) { return chan.roi_stats; });
+  auto ptws = env.ptw_view();
+  std::transform(std::begin(ptws), std::end(ptws), std::back_inserter(stats.sim_ptw_stats), [](const PageTableWalker& ptw) { return ptw.sim_stats; });
+  std::transform(std::begin(ptws), std::end(ptws), std::back_inserter(stats.roi_ptw_stats), [](const PageTableWalker& ptw) { return ptw.roi_stats; });
+
+  for (const MEMORY_CONTROLLER& dram : env.memory_view()) {
+    std::transform(std::begin(dram.channels), std::end(dram.channels), std::back_inserter(stats.sim_dram_stats),
+                   [](const DRAM_CHANNEL& chan) { return chan.sim_stats; });
+    std::transform(std::begin(dram.channels), std::end(dram.channels), std::back_inserter(stats.roi_dram_stats),
+                   [](const DRAM_CHANNEL& chan) { return chan.roi_stats; });
+  }
+
+  auto vmem_end = env.vmem_view().get_stats();
+  stats.vmem_stats.promotions = vmem_end.promotions - vmem_begin.promotions;
+  stats.vmem_stats.huge_page_promotions = vmem_end.huge_page_promotions - vmem_begin.huge_page_promotions;
 
   return stats;
 }
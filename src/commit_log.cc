@@ -0,0 +1,199 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "commit_log.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <iterator>
+#include <stdexcept>
+
+#include "instruction.h"
+
+namespace
+{
+template <typename T>
+void append_value(std::vector<char>& buf, T value)
+{
+  for (std::size_t i = 0; i < sizeof(T); ++i)
+    buf.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+} // namespace
+
+champsim::commit_log_writer::commit_log_writer(std::string filename) : out(filename), worker([this] { this->write_chunks(); })
+{
+  current_chunk.reserve(CHUNK_SIZE);
+  std::copy(std::begin(commit_log::MAGIC), std::end(commit_log::MAGIC), std::back_inserter(current_chunk));
+  ::append_value(current_chunk, commit_log::VERSION);
+}
+
+champsim::commit_log_writer::~commit_log_writer()
+{
+  submit_chunk();
+  {
+    std::lock_guard<std::mutex> lock{pending_mutex};
+    finished = true;
+  }
+  pending_cv.notify_all();
+  worker.join();
+}
+
+uint8_t champsim::commit_log_writer::level_id(std::string_view name)
+{
+  if (std::empty(name))
+    return commit_log::UNKNOWN_LEVEL;
+
+  if (auto found = level_ids.find(name); found != std::end(level_ids))
+    return found->second;
+
+  // Introduce the level before its first use
+  auto id = static_cast<uint8_t>(std::size(level_ids));
+  assert(id != commit_log::UNKNOWN_LEVEL);
+  auto name_length = static_cast<uint8_t>(std::min<std::size_t>(std::size(name), std::numeric_limits<uint8_t>::max()));
+  ::append_value(current_chunk, commit_log::LEVEL_TAG);
+  ::append_value(current_chunk, id);
+  ::append_value(current_chunk, name_length);
+  std::copy_n(std::begin(name), name_length, std::back_inserter(current_chunk));
+
+  level_ids.emplace(name, id);
+  return id;
+}
+
+void champsim::commit_log_writer::log(const ooo_model_instr& instr, uint64_t retire_cycle)
+{
+  auto num_loads = std::min(std::size(instr.source_memory), std::size(instr.source_memory_served_by));
+
+  std::array<uint8_t, NUM_INSTR_SOURCES> load_levels{};
+  std::transform(std::begin(instr.source_memory_served_by), std::next(std::begin(instr.source_memory_served_by), static_cast<std::ptrdiff_t>(num_loads)),
+                 std::begin(load_levels), [this](auto name) { return this->level_id(name); });
+
+  ::append_value(current_chunk, commit_log::INSTR_TAG);
+  for (auto value : {instr.instr_id, instr.ip, instr.fetch_cycle, instr.decode_cycle, instr.dispatch_cycle, instr.execute_cycle, retire_cycle})
+    ::append_value(current_chunk, value);
+  ::append_value(current_chunk, static_cast<uint8_t>(num_loads));
+  for (std::size_t i = 0; i < num_loads; ++i) {
+    ::append_value(current_chunk, instr.source_memory[i]);
+    ::append_value(current_chunk, load_levels[i]);
+  }
+
+  if (std::size(current_chunk) >= CHUNK_SIZE)
+    submit_chunk();
+}
+
+void champsim::commit_log_writer::submit_chunk()
+{
+  if (std::empty(current_chunk))
+    return;
+
+  std::unique_lock<std::mutex> lock{pending_mutex};
+  // Apply backpressure if the background thread has fallen behind
+  pending_cv.wait(lock, [this] { return std::size(this->pending_chunks) < MAX_PENDING_CHUNKS; });
+  pending_chunks.push_back(std::move(current_chunk));
+  lock.unlock();
+  pending_cv.notify_all();
+
+  current_chunk = std::vector<char>{};
+  current_chunk.reserve(CHUNK_SIZE);
+}
+
+void champsim::commit_log_writer::write_chunks()
+{
+  while (true) {
+    std::unique_lock<std::mutex> lock{pending_mutex};
+    pending_cv.wait(lock, [this] { return this->finished || !std::empty(this->pending_chunks); });
+    if (std::empty(pending_chunks))
+      return; // finished, and nothing left to write
+
+    auto chunk = std::move(pending_chunks.front());
+    pending_chunks.pop_front();
+    lock.unlock();
+    pending_cv.notify_all();
+
+    out.write(chunk.data(), static_cast<std::streamsize>(std::size(chunk)));
+  }
+}
+
+champsim::commit_log_reader::commit_log_reader(std::string filename) : in(filename)
+{
+  std::array<char, std::size(commit_log::MAGIC)> magic{};
+  auto version = (read_bytes(magic.data(), std::size(magic)) ? read_value<uint32_t>() : std::nullopt);
+  if (std::string_view{magic.data(), std::size(magic)} != commit_log::MAGIC || version != commit_log::VERSION)
+    throw std::invalid_argument{"Not a commit log: " + filename};
+}
+
+bool champsim::commit_log_reader::read_bytes(char* dest, std::size_t count)
+{
+  in.read(dest, static_cast<std::streamsize>(count));
+  return in.gcount() == static_cast<std::streamsize>(count);
+}
+
+template <typename T>
+std::optional<T> champsim::commit_log_reader::read_value()
+{
+  std::array<unsigned char, sizeof(T)> bytes{};
+  if (!read_bytes(reinterpret_cast<char*>(bytes.data()), std::size(bytes)))
+    return std::nullopt;
+
+  T value{0};
+  for (std::size_t i = 0; i < sizeof(T); ++i)
+    value |= static_cast<T>(static_cast<T>(bytes[i]) << (8 * i));
+  return value;
+}
+
+std::optional<champsim::commit_record> champsim::commit_log_reader::next()
+{
+  for (auto tag = read_value<uint8_t>(); tag.has_value(); tag = read_value<uint8_t>()) {
+    if (*tag == commit_log::LEVEL_TAG) {
+      auto id = read_value<uint8_t>();
+      auto length = read_value<uint8_t>();
+      if (!id.has_value() || !length.has_value() || *id == commit_log::UNKNOWN_LEVEL)
+        return std::nullopt;
+
+      std::string name(*length, '\0');
+      if (!read_bytes(name.data(), std::size(name)))
+        return std::nullopt;
+      levels.at(*id) = name;
+    } else if (*tag == commit_log::INSTR_TAG) {
+      commit_record record;
+      for (auto field : {&record.instr_id, &record.ip, &record.fetch_cycle, &record.decode_cycle, &record.dispatch_cycle, &record.execute_cycle,
+                         &record.retire_cycle}) {
+        auto value = read_value<uint64_t>();
+        if (!value.has_value())
+          return std::nullopt;
+        *field = *value;
+      }
+
+      auto num_loads = read_value<uint8_t>();
+      if (!num_loads.has_value())
+        return std::nullopt;
+
+      for (uint8_t i = 0; i < *num_loads; ++i) {
+        auto address = read_value<uint64_t>();
+        auto level = read_value<uint8_t>();
+        if (!address.has_value() || !level.has_value())
+          return std::nullopt;
+        record.loads.push_back({*address, (*level == commit_log::UNKNOWN_LEVEL) ? std::string{} : levels.at(*level)});
+      }
+
+      return record;
+    } else {
+      throw std::runtime_error{"Unknown record in commit log"};
+    }
+  }
+
+  return std::nullopt;
+}
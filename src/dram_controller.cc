@@ -17,13 +17,15 @@
 #include "dram_controller.h"
 
 #include <algorithm>
+#include <cassert>
 #include <cfenv>
 #include <cmath>
+#include <numeric>
 
 #include "champsim_constants.h"
 #include "deadlock.h"
 #include "instruction.h"
-#include "util/span.h"
+#include "vmem.h"
 #include <fmt/core.h>
 
 uint64_t cycles(double time, int io_freq)
@@ -33,12 +35,46 @@ uint64_t cycles(double time, int io_freq)
   return result < 0 ? 0 : static_cast<uint64_t>(result);
 }
 
+champsim::dram_timing::dram_timing(const dram_timing_parameters& params, int io_freq)
+    : tRP(cycles(params.tRP / 1000, io_freq)), tRCD(cycles(params.tRCD / 1000, io_freq)), tCAS(cycles(params.tCAS / 1000, io_freq)),
+      tRAS(cycles(params.tRAS / 1000, io_freq)), tWR(cycles(params.tWR / 1000, io_freq)), tRTP(cycles(params.tRTP / 1000, io_freq)),
+      tWTR_S(cycles(params.tWTR_S / 1000, io_freq)), tWTR_L(cycles(params.tWTR_L / 1000, io_freq)), tRRD_S(cycles(params.tRRD_S / 1000, io_freq)),
+      tRRD_L(cycles(params.tRRD_L / 1000, io_freq)), tCCD_S(cycles(params.tCCD_S / 1000, io_freq)), tCCD_L(cycles(params.tCCD_L / 1000, io_freq)),
+      tFAW(cycles(params.tFAW / 1000, io_freq)), tREFI(cycles(params.tREFI / 1000, io_freq)), tRFC(cycles(params.tRFC / 1000, io_freq)),
+      tRFCsb(cycles(params.tRFCsb / 1000, io_freq)), turnaround(cycles(params.turnaround / 1000, io_freq)),
+      tBURST(cycles(std::ceil(BLOCK_SIZE) / std::ceil(DRAM_CHANNEL_WIDTH), 1)), refresh(params.tREFI > 0 ? params.refresh : dram_refresh_mode::NONE)
+{
+}
+
 MEMORY_CONTROLLER::MEMORY_CONTROLLER(double freq_scale, int io_freq, double t_rp, double t_rcd, double t_cas, double turnaround,
                                      std::vector<channel_type*>&& ul)
-    : champsim::operable(freq_scale), queues(std::move(ul)), tRP(cycles(t_rp / 1000, io_freq)), tRCD(cycles(t_rcd / 1000, io_freq)),
-      tCAS(cycles(t_cas / 1000, io_freq)), DRAM_DBUS_TURN_AROUND_TIME(cycles(turnaround / 1000, io_freq)),
-      DRAM_DBUS_RETURN_TIME(cycles(std::ceil(BLOCK_SIZE) / std::ceil(DRAM_CHANNEL_WIDTH), 1))
+    : MEMORY_CONTROLLER(Builder{}
+                            .frequency(freq_scale)
+                            .io_freq(io_freq)
+                            .timing([&] {
+                              champsim::dram_timing_parameters params;
+                              params.tRP = t_rp;
+                              params.tRCD = t_rcd;
+                              params.tCAS = t_cas;
+                              params.turnaround = turnaround;
+                              return params;
+                            }())
+                            .upper_levels(std::move(ul)))
+{
+}
+
+MEMORY_CONTROLLER::MEMORY_CONTROLLER(Builder b)
+    : champsim::operable(b.m_freq_scale), queues(std::move(b.m_uls)), timing(b.m_timing, b.m_io_freq),
+      SCHEDULER_AGE_CAP(cycles(b.m_age_cap / 1000, b.m_io_freq)), address_mapping(b.m_mapping),
+      ROW_POLICY_TIMEOUT(cycles(b.m_row_policy_timeout / 1000, b.m_io_freq)), RANGE_BEGIN(b.m_range_begin), RANGE_SIZE(b.m_range_size),
+      LINK_LATENCY(cycles(b.m_link_latency / 1000, b.m_io_freq)), vmem(b.m_vmem), NAME(b.m_name), IO_FREQ(b.m_io_freq)
 {
+  for (auto& chan : channels) {
+    chan.timing = timing;
+    chan.row_policy = champsim::row_buffer_policy::make(b.m_row_policy, ROW_POLICY_TIMEOUT);
+    for (auto& rank : chan.rank_timers)
+      rank.next_refresh = chan.refresh_interval();
+  }
 }
 
 long MEMORY_CONTROLLER::operate()
@@ -47,48 +83,64 @@ long MEMORY_CONTROLLER::operate()
 
   initiate_requests();
 
+  if (telemetry && !warmup)
+    sample_telemetry();
+
   for (auto& channel : channels) {
     if (warmup) {
-      for (auto& entry : channel.RQ) {
-        if (entry.has_value()) {
-          response_type response{entry->address, entry->v_address, entry->data, entry->pf_metadata, entry->instr_depend_on_me};
-          for (auto ret : entry.value().to_return)
+      for (auto it = std::begin(channel.RQ); it != std::end(channel.RQ); ++it) {
+        if (it->has_value()) {
+          response_type response{it->value().address, it->value().v_address, it->value().data, it->value().pf_metadata, it->value().instr_depend_on_me, NAME};
+          for (auto ret : it->value().to_return)
             ret->push_back(response);
 
           ++progress;
-          entry.reset();
+          channel.release(it, false);
         }
       }
 
-      for (auto& entry : channel.WQ) {
-        if (entry.has_value()) {
+      for (auto it = std::begin(channel.WQ); it != std::end(channel.WQ); ++it) {
+        if (it->has_value()) {
           ++progress;
+          channel.release(it, true);
         }
-        entry.reset();
       }
     }
 
     // Check for forwarding
-    channel.check_collision();
+    channel.check_collision(NAME);
+
+    // Refresh any ranks that are due, and close rows according to the row buffer policy
+    // A refresh in flight counts as progress, since it may hold every bank for longer than the deadlock limit
+    progress += channel.refresh(current_cycle);
+    channel.close_idle_rows(current_cycle);
 
     // Finish request
     if (channel.active_request != std::end(channel.bank_request) && channel.active_request->event_cycle <= current_cycle) {
       response_type response{channel.active_request->pkt->value().address, channel.active_request->pkt->value().v_address,
                              channel.active_request->pkt->value().data, channel.active_request->pkt->value().pf_metadata,
-                             channel.active_request->pkt->value().instr_depend_on_me};
+                             channel.active_request->pkt->value().instr_depend_on_me, NAME};
       for (auto ret : channel.active_request->pkt->value().to_return)
         ret->push_back(response);
 
+      channel.dbus_cycles_used += timing.tBURST;
+      if (channel.active_request->is_write)
+        ++channel.interval_stats.writes;
+      else
+        channel.interval_stats.record_read(current_cycle - channel.active_request->pkt->value().cycle_enqueued);
+
       channel.active_request->valid = false;
+      --channel.busy_banks;
+      channel.finish_access(static_cast<std::size_t>(std::distance(std::begin(channel.bank_request), channel.active_request)), current_cycle);
 
-      channel.active_request->pkt->reset();
+      channel.release(channel.active_request->pkt, channel.active_request->is_write);
       channel.active_request = std::end(channel.bank_request);
       ++progress;
     }
 
     // Check queue occupancy
-    auto wq_occu = static_cast<std::size_t>(std::count_if(std::begin(channel.WQ), std::end(channel.WQ), [](const auto& x) { return x.has_value(); }));
-    auto rq_occu = static_cast<std::size_t>(std::count_if(std::begin(channel.RQ), std::end(channel.RQ), [](const auto& x) { return x.has_value(); }));
+    auto wq_occu = channel.wq_occupancy;
+    auto rq_occu = channel.rq_occupancy;
 
     // Change modes if the queues are unbalanced
     if ((!channel.write_mode && (wq_occu >= DRAM_WRITE_HIGH_WM || (rq_occu == 0 && wq_occu > 0)))
@@ -98,35 +150,41 @@ long MEMORY_CONTROLLER::operate()
         // Leave active request on the data bus
         if (it != channel.active_request && it->valid) {
           // Leave rows charged
-          if (it->event_cycle < (current_cycle + tCAS))
+          if (it->event_cycle < (current_cycle + timing.tCAS))
             it->open_row = UINT32_MAX;
 
           // This bank is ready for another DRAM request
           it->valid = false;
+          --channel.busy_banks;
           it->pkt->value().scheduled = false;
           it->pkt->value().event_cycle = current_cycle;
+          channel.enqueue(it->pkt, it->is_write);
         }
       }
 
       // Add data bus turn-around time
       if (channel.active_request != std::end(channel.bank_request))
-        channel.dbus_cycle_available = channel.active_request->event_cycle + DRAM_DBUS_TURN_AROUND_TIME; // After ongoing finish
+        channel.dbus_cycle_available = channel.active_request->event_cycle + timing.turnaround; // After ongoing finish
       else
-        channel.dbus_cycle_available = current_cycle + DRAM_DBUS_TURN_AROUND_TIME;
+        channel.dbus_cycle_available = current_cycle + timing.turnaround;
 
       // Invert the mode
       channel.write_mode = !channel.write_mode;
+      if (channel.write_mode)
+        ++channel.interval_stats.write_drains;
     }
 
     // Look for requests to put on the bus
-    auto iter_next_process = std::min_element(std::begin(channel.bank_request), std::end(channel.bank_request),
-                                              [](const auto& lhs, const auto& rhs) { return !rhs.valid || (lhs.valid && lhs.event_cycle < rhs.event_cycle); });
-    if (iter_next_process->valid && iter_next_process->event_cycle <= current_cycle) {
+    auto iter_next_process = std::end(channel.bank_request);
+    if (channel.busy_banks > 0)
+      iter_next_process = std::min_element(std::begin(channel.bank_request), std::end(channel.bank_request),
+                                           [](const auto& lhs, const auto& rhs) { return !rhs.valid || (lhs.valid && lhs.event_cycle < rhs.event_cycle); });
+    if (iter_next_process != std::end(channel.bank_request) && iter_next_process->valid && iter_next_process->event_cycle <= current_cycle) {
       if (channel.active_request == std::end(channel.bank_request) && channel.dbus_cycle_available <= current_cycle) {
         // Bus is available
         // Put this request on the data bus
         channel.active_request = iter_next_process;
-        channel.active_request->event_cycle = current_cycle + DRAM_DBUS_RETURN_TIME;
+        channel.active_request->event_cycle = current_cycle + timing.tBURST;
 
         if (iter_next_process->row_buffer_hit)
           if (channel.write_mode)
@@ -149,34 +207,24 @@ long MEMORY_CONTROLLER::operate()
       }
     }
 
-    // Look for queued packets that have not been scheduled
-    auto next_schedule = [](const auto& lhs, const auto& rhs) {
-      return !(rhs.has_value() && !rhs.value().scheduled) || ((lhs.has_value() && !lhs.value().scheduled) && lhs.value().event_cycle < rhs.value().event_cycle);
-    };
-    DRAM_CHANNEL::queue_type::iterator iter_next_schedule;
-    if (channel.write_mode)
-      iter_next_schedule = std::min_element(std::begin(channel.WQ), std::end(channel.WQ), next_schedule);
-    else
-      iter_next_schedule = std::min_element(std::begin(channel.RQ), std::end(channel.RQ), next_schedule);
+    // Schedule the next request to an idle bank
+    if (auto next_schedule = channel.select_request(current_cycle, SCHEDULER_AGE_CAP); next_schedule.has_value()) {
+      auto& next_request = next_schedule.value()->value();
+      auto& bank = channel.bank_request[next_request.bank_idx];
+      bool row_buffer_hit = (bank.open_row == next_request.row);
 
-    if (iter_next_schedule->has_value() && iter_next_schedule->value().event_cycle <= current_cycle) {
-      auto op_rank = dram_get_rank(iter_next_schedule->value().address);
-      auto op_bank = dram_get_bank(iter_next_schedule->value().address);
-      auto op_row = dram_get_row(iter_next_schedule->value().address);
+      // this bank is now busy
+      auto ready_cycle = channel.issue_commands(next_request.bank_idx, next_request.row, channel.write_mode, current_cycle);
+      bank = {true, row_buffer_hit, channel.write_mode, next_request.row, ready_cycle, *next_schedule};
+      ++channel.busy_banks;
 
-      auto op_idx = op_rank * DRAM_BANKS + op_bank;
+      auto& bank_queue = channel.write_mode ? channel.bank_wq[next_request.bank_idx] : channel.bank_rq[next_request.bank_idx];
+      bank_queue.erase(std::find(std::begin(bank_queue), std::end(bank_queue), *next_schedule));
 
-      if (!channel.bank_request[op_idx].valid) {
-        bool row_buffer_hit = (channel.bank_request[op_idx].open_row == op_row);
+      next_request.scheduled = true;
+      next_request.event_cycle = std::numeric_limits<uint64_t>::max();
 
-        // this bank is now busy
-        channel.bank_request[op_idx] = {true, row_buffer_hit, op_row, current_cycle + tCAS + (row_buffer_hit ? 0 : tRP + tRCD), iter_next_schedule};
-
-        iter_next_schedule->value().scheduled = true;
-        iter_next_schedule->value().event_cycle = std::numeric_limits<uint64_t>::max();
-
-        ++progress;
-      }
+      ++progress;
     }
   }
 
@@ -186,23 +234,29 @@ long MEMORY_CONTROLLER::operate()
 void MEMORY_CONTROLLER::initialize()
 {
   long long int dram_size = DRAM_CHANNELS * DRAM_RANKS * DRAM_BANKS * DRAM_ROWS * DRAM_COLUMNS * BLOCK_SIZE / 1024 / 1024; // in MiB
-  fmt::print("Off-chip DRAM Size: ");
+  fmt::print("Off-chip {} Size: ", NAME);
   if (dram_size > 1024)
     fmt::print("{} GiB", dram_size / 1024);
   else
     fmt::print("{} MiB", dram_size);
-  fmt::print(" Channels: {} Width: {}-bit Data Race: {} MT/s\n", DRAM_CHANNELS, 8 * DRAM_CHANNEL_WIDTH, DRAM_IO_FREQ);
+  fmt::print(" Channels: {} Width: {}-bit Data Race: {} MT/s\n", DRAM_CHANNELS, 8 * DRAM_CHANNEL_WIDTH, IO_FREQ);
 }
 
 void MEMORY_CONTROLLER::begin_phase()
 {
+  // The default controller keeps the historical channel names, and other tiers are distinguished by their names
+  std::string prefix = (NAME == "DRAM") ? std::string{} : NAME + " ";
   std::size_t chan_idx = 0;
   for (auto& chan : channels) {
     DRAM_CHANNEL::stats_type new_stats;
-    new_stats.name = "Channel " + std::to_string(chan_idx++);
+    new_stats.name = prefix + "Channel " + std::to_string(chan_idx++);
     chan.sim_stats = new_stats;
+    chan.interval_stats = {};
   }
 
+  if (telemetry)
+    next_telemetry_sample = current_cycle + telemetry->interval;
+
   for (auto ul : queues) {
     channel_type::stats_type ul_new_roi_stats, ul_new_sim_stats;
     ul->roi_stats = ul_new_roi_stats;
@@ -215,9 +269,240 @@ void MEMORY_CONTROLLER::end_phase(unsigned)
   for (auto& chan : channels) {
     chan.roi_stats = chan.sim_stats;
   }
+
+  // Write the partial interval at the end of the phase, so that its activity is not lost
+  if (telemetry && std::any_of(std::begin(channels), std::end(channels), [](const auto& chan) { return chan.interval_stats.cycles > 0; }))
+    write_telemetry();
+}
+
+void MEMORY_CONTROLLER::sample_telemetry()
+{
+  for (auto& chan : channels) {
+    ++chan.interval_stats.cycles;
+    chan.interval_stats.rq_occupancy += chan.rq_occupancy;
+    chan.interval_stats.wq_occupancy += chan.wq_occupancy;
+    if (chan.write_mode)
+      ++chan.interval_stats.write_mode_cycles;
+  }
+
+  if (current_cycle >= next_telemetry_sample)
+    write_telemetry();
+}
+
+void MEMORY_CONTROLLER::write_telemetry()
+{
+  for (std::size_t chan_idx = 0; chan_idx < std::size(channels); ++chan_idx) {
+    telemetry->write(NAME, chan_idx, current_cycle, channels[chan_idx].interval_stats);
+    channels[chan_idx].interval_stats = {};
+  }
+  next_telemetry_sample = current_cycle + telemetry->interval;
 }
 
-void DRAM_CHANNEL::check_collision()
+void DRAM_CHANNEL::enqueue(queue_type::iterator it, bool is_write)
+{
+  // Keep each bank's queue in arrival order, since requests may be returned to it after being unscheduled
+  auto& bank_queue = is_write ? bank_wq[it->value().bank_idx] : bank_rq[it->value().bank_idx];
+  auto later = std::upper_bound(std::begin(bank_queue), std::end(bank_queue), it->value().cycle_enqueued,
+                                [](uint64_t cycle, const auto& other) { return cycle < other->value().cycle_enqueued; });
+  bank_queue.insert(later, it);
+}
+
+void DRAM_CHANNEL::release(queue_type::iterator it, bool is_write)
+{
+  if (!it->value().scheduled) {
+    auto& bank_queue = is_write ? bank_wq[it->value().bank_idx] : bank_rq[it->value().bank_idx];
+    bank_queue.erase(std::find(std::begin(bank_queue), std::end(bank_queue), it));
+  }
+
+  --(is_write ? wq_occupancy : rq_occupancy);
+  it->reset();
+}
+
+auto DRAM_CHANNEL::select_request(uint64_t current_cycle, uint64_t age_cap) -> std::optional<queue_type::iterator>
+{
+  // First-ready, first-come-first-serve: among idle banks, prefer requests that have waited longer than the age cap, then row buffer hits, then
+  // the oldest request.
+  std::optional<queue_type::iterator> aged, hit, oldest;
+  auto older = [](const std::optional<queue_type::iterator>& lhs, queue_type::iterator rhs) {
+    return !lhs.has_value() || rhs->value().cycle_enqueued < lhs.value()->value().cycle_enqueued;
+  };
+
+  auto& queues = write_mode ? bank_wq : bank_rq;
+  for (std::size_t bank_idx = 0; bank_idx < std::size(queues); ++bank_idx) {
+    const auto& bank_queue = queues[bank_idx];
+    if (bank_request[bank_idx].valid || bank_timers[bank_idx].refresh_pending || std::empty(bank_queue)
+        || bank_queue.front()->value().event_cycle > current_cycle)
+      continue;
+
+    auto front = bank_queue.front();
+    if (current_cycle - front->value().cycle_enqueued >= age_cap && older(aged, front))
+      aged = front;
+    if (older(oldest, front))
+      oldest = front;
+
+    auto row_hit = std::find_if(std::begin(bank_queue), std::end(bank_queue), [open_row = bank_request[bank_idx].open_row, current_cycle](const auto& x) {
+      return x->value().row == open_row && x->value().event_cycle <= current_cycle;
+    });
+    if (row_hit != std::end(bank_queue) && older(hit, *row_hit))
+      hit = *row_hit;
+  }
+
+  if (aged.has_value())
+    return aged;
+  if (hit.has_value())
+    return hit;
+  return oldest;
+}
+
+uint64_t DRAM_CHANNEL::issue_commands(std::size_t bank_idx, std::size_t row, bool is_write, uint64_t current_cycle)
+{
+  auto rank_idx = bank_idx / DRAM_BANKS;
+  auto& bank = bank_timers[bank_idx];
+  auto& group = group_timers[rank_idx * DRAM_BANK_GROUPS + (bank_idx % DRAM_BANKS) % DRAM_BANK_GROUPS];
+  auto& rank = rank_timers[rank_idx];
+  auto open_row = bank_request[bank_idx].open_row;
+
+  using access_result = champsim::row_buffer_policy::access_result;
+  if (open_row == row)
+    row_policy->access(bank_idx, access_result::HIT);
+  else if (open_row != std::numeric_limits<uint32_t>::max())
+    row_policy->access(bank_idx, access_result::CONFLICT);
+  else
+    row_policy->access(bank_idx, (row == bank.last_row) ? access_result::CLOSED_REOPEN : access_result::CLOSED_OTHER);
+
+  bank.close_at = champsim::row_buffer_policy::NEVER;
+
+  auto column_cycle = current_cycle;
+  if (open_row != row) {
+    // Close the open row, if there is one
+    auto activate_cycle = current_cycle;
+    if (open_row != std::numeric_limits<uint32_t>::max()) {
+      activate_cycle = std::max(current_cycle, bank.next_precharge) + timing.tRP;
+      ++sim_stats.CONFLICT_PRECHARGES;
+    }
+
+    activate_cycle = std::max({activate_cycle, bank.next_activate, group.next_activate, rank.next_activate, rank.faw_window[rank.next_faw_slot]});
+    rank.faw_window[rank.next_faw_slot] = activate_cycle + timing.tFAW;
+    rank.next_faw_slot = (rank.next_faw_slot + 1) % std::size(rank.faw_window);
+
+    bank.next_precharge = activate_cycle + timing.tRAS;
+    bank.last_row = row;
+    group.next_activate = std::max(group.next_activate, activate_cycle + timing.tRRD_L);
+    rank.next_activate = std::max(rank.next_activate, activate_cycle + timing.tRRD_S);
+    bank.next_column = activate_cycle + timing.tRCD;
+    ++sim_stats.ACTIVATIONS;
+  }
+
+  if (is_write)
+    column_cycle = std::max({column_cycle, bank.next_column, group.next_write, rank.next_write});
+  else
+    column_cycle = std::max({column_cycle, bank.next_column, group.next_read, rank.next_read});
+
+  if (is_write) {
+    auto data_end = column_cycle + timing.tCAS + timing.tBURST;
+    bank.next_precharge = std::max(bank.next_precharge, data_end + timing.tWR);
+    group.next_read = std::max(group.next_read, data_end + timing.tWTR_L);
+    rank.next_read = std::max(rank.next_read, data_end + timing.tWTR_S);
+  } else {
+    bank.next_precharge = std::max(bank.next_precharge, column_cycle + timing.tRTP);
+  }
+
+  for (auto next : {&group.next_read, &group.next_write})
+    *next = std::max(*next, column_cycle + timing.tCCD_L);
+  for (auto next : {&rank.next_read, &rank.next_write})
+    *next = std::max(*next, column_cycle + timing.tCCD_S);
+
+  return column_cycle + timing.tCAS;
+}
+
+void DRAM_CHANNEL::finish_access(std::size_t bank_idx, uint64_t current_cycle)
+{
+  auto open_row = bank_request[bank_idx].open_row;
+  auto hits_open_row = [open_row](const auto& x) {
+    return x->value().row == open_row;
+  };
+  bool pending_hit = std::any_of(std::begin(bank_rq[bank_idx]), std::end(bank_rq[bank_idx]), hits_open_row)
+                     || std::any_of(std::begin(bank_wq[bank_idx]), std::end(bank_wq[bank_idx]), hits_open_row);
+
+  bank_timers[bank_idx].close_at = row_policy->close_after(bank_idx, pending_hit, current_cycle);
+}
+
+void DRAM_CHANNEL::close_idle_rows(uint64_t current_cycle)
+{
+  for (std::size_t bank_idx = 0; bank_idx < std::size(bank_request); ++bank_idx) {
+    auto& bank = bank_timers[bank_idx];
+    if (!bank_request[bank_idx].valid && bank_request[bank_idx].open_row != std::numeric_limits<uint32_t>::max() && bank.close_at <= current_cycle) {
+      bank.next_activate = std::max(bank.next_activate, std::max(current_cycle, bank.next_precharge) + timing.tRP);
+      bank.close_at = champsim::row_buffer_policy::NEVER;
+      bank_request[bank_idx].open_row = std::numeric_limits<uint32_t>::max();
+      ++sim_stats.POLICY_PRECHARGES;
+    }
+  }
+}
+
+long DRAM_CHANNEL::refresh(uint64_t current_cycle)
+{
+  if (timing.refresh == champsim::dram_refresh_mode::NONE)
+    return 0;
+
+  long progress{0};
+  bool all_bank = (timing.refresh == champsim::dram_refresh_mode::ALL_BANK);
+  for (std::size_t rank_idx = 0; rank_idx < std::size(rank_timers); ++rank_idx) {
+    auto& rank = rank_timers[rank_idx];
+    if (rank.refresh_end > current_cycle)
+      ++progress;
+    if (rank.next_refresh > current_cycle)
+      continue;
+
+    // A same-bank refresh covers the same bank in every bank group
+    std::vector<std::size_t> targets;
+    for (std::size_t bank = 0; bank < DRAM_BANKS; ++bank) {
+      if (all_bank || (bank / DRAM_BANK_GROUPS) == rank.next_refresh_bank)
+        targets.push_back(rank_idx * DRAM_BANKS + bank);
+    }
+
+    // Stop scheduling to the refreshed banks, and wait for their outstanding requests to drain
+    for (auto idx : targets)
+      bank_timers[idx].refresh_pending = true;
+    if (std::any_of(std::begin(targets), std::end(targets), [this](auto idx) { return this->bank_request[idx].valid; }))
+      continue;
+
+    // Precharge any open rows, then refresh
+    auto refresh_start = current_cycle;
+    for (auto idx : targets) {
+      if (bank_request[idx].open_row != std::numeric_limits<uint32_t>::max())
+        refresh_start = std::max(refresh_start, std::max(current_cycle, bank_timers[idx].next_precharge) + timing.tRP);
+    }
+    auto refresh_end = refresh_start + (all_bank ? timing.tRFC : timing.tRFCsb);
+
+    for (auto idx : targets) {
+      bank_request[idx].open_row = std::numeric_limits<uint32_t>::max();
+      bank_timers[idx].next_activate = std::max(bank_timers[idx].next_activate, refresh_end);
+      bank_timers[idx].refresh_pending = false;
+    }
+
+    rank.refresh_end = refresh_end;
+    ++sim_stats.REFRESHES;
+    sim_stats.refresh_cycles += refresh_end - current_cycle;
+    ++progress;
+
+    rank.next_refresh += refresh_interval();
+    if (!all_bank)
+      rank.next_refresh_bank = (rank.next_refresh_bank + 1) % BANKS_PER_GROUP;
+  }
+
+  return progress;
+}
+
+uint64_t DRAM_CHANNEL::refresh_interval() const
+{
+  // Same-bank refreshes are issued more often, so that every bank is refreshed once per interval
+  if (timing.refresh == champsim::dram_refresh_mode::SAME_BANK)
+    return timing.tREFI / BANKS_PER_GROUP;
+  return timing.tREFI;
+}
+
+void DRAM_CHANNEL::check_collision(std::string_view served_by)
 {
   for (auto wq_it = std::begin(WQ); wq_it != std::end(WQ); ++wq_it) {
     if (wq_it->has_value() && !wq_it->value().forward_checked) {
@@ -225,9 +510,9 @@ void DRAM_CHANNEL::check_collision()
         return pkt.has_value() && (pkt->address >> offset) == (addr >> offset);
       };
       if (auto found = std::find_if(std::begin(WQ), wq_it, checker); found != wq_it) { // Forward check
-        wq_it->reset();
+        release(wq_it, true);
       } else if (found = std::find_if(std::next(wq_it), std::end(WQ), checker); found != std::end(WQ)) { // Backward check
-        wq_it->reset();
+        release(wq_it, true);
       } else {
         wq_it->value().forward_checked = true;
       }
@@ -241,12 +526,12 @@ void DRAM_CHANNEL::check_collision()
       };
       if (auto wq_it = std::find_if(std::begin(WQ), std::end(WQ), checker); wq_it != std::end(WQ)) {
         response_type response{rq_it->value().address, rq_it->value().v_address, rq_it->value().data, rq_it->value().pf_metadata,
-                               rq_it->value().instr_depend_on_me};
+                               rq_it->value().instr_depend_on_me, served_by};
         response.data = wq_it->value().data;
         for (auto ret : rq_it->value().to_return)
           ret->push_back(response);
 
-        rq_it->reset();
+        release(rq_it, false);
       } else if (auto found = std::find_if(std::begin(RQ), rq_it, checker); found != rq_it) {
         auto instr_copy = std::move(found->value().instr_depend_on_me);
         auto ret_copy = std::move(found->value().to_return);
@@ -256,7 +541,7 @@ void DRAM_CHANNEL::check_collision()
         std::set_union(std::begin(ret_copy), std::end(ret_copy), std::begin(rq_it->value().to_return), std::end(rq_it->value().to_return),
                        std::back_inserter(found->value().to_return));
 
-        rq_it->reset();
+        release(rq_it, false);
       } else if (found = std::find_if(std::next(rq_it), std::end(RQ), checker); found != std::end(RQ)) {
         auto instr_copy = std::move(found->value().instr_depend_on_me);
         auto ret_copy = std::move(found->value().to_return);
@@ -266,7 +551,7 @@ void DRAM_CHANNEL::check_collision()
         std::set_union(std::begin(ret_copy), std::end(ret_copy), std::begin(rq_it->value().to_return), std::end(rq_it->value().to_return),
                        std::back_inserter(found->value().to_return));
 
-        rq_it->reset();
+        release(rq_it, false);
       } else {
         rq_it->value().forward_checked = true;
       }
@@ -276,19 +561,31 @@ void DRAM_CHANNEL::check_collision()
 
 void MEMORY_CONTROLLER::initiate_requests()
 {
+  // Several controllers may share the upper levels' queues, each taking the requests in its own address range. Requests to this
+  // controller are taken in order, stopping at the first that cannot be accepted.
+  auto take = [this](auto& queue, auto add) {
+    for (auto it = std::begin(queue); it != std::end(queue);) {
+      if (!this->in_range(it->address))
+        ++it;
+      else if (add(*it))
+        it = queue.erase(it);
+      else
+        break;
+    }
+  };
+
   // Initiate read requests
   for (auto ul : queues) {
-    for (auto q : {std::ref(ul->RQ), std::ref(ul->PQ)}) {
-      auto [begin, end] = champsim::get_span_p(std::cbegin(q.get()), std::cend(q.get()), [ul, this](const auto& pkt) { return this->add_rq(pkt, ul); });
-      q.get().erase(begin, end);
-    }
+    for (auto q : {std::ref(ul->RQ), std::ref(ul->PQ)})
+      take(q.get(), [ul, this](const auto& pkt) { return this->add_rq(pkt, ul); });
 
     // Initiate write requests
-    auto [wq_begin, wq_end] = champsim::get_span_p(std::cbegin(ul->WQ), std::cend(ul->WQ), [this](const auto& pkt) { return this->add_wq(pkt); });
-    ul->WQ.erase(wq_begin, wq_end);
+    take(ul->WQ, [this](const auto& pkt) { return this->add_wq(pkt); });
   }
 }
 
+bool MEMORY_CONTROLLER::in_range(uint64_t address) const { return address >= RANGE_BEGIN && address - RANGE_BEGIN < RANGE_SIZE; }
+
 DRAM_CHANNEL::request_type::request_type(typename champsim::channel::request_type req)
     : pf_metadata(req.pf_metadata), address(req.address), v_address(req.address), data(req.data), instr_depend_on_me(req.instr_depend_on_me)
 {
@@ -301,14 +598,24 @@ bool MEMORY_CONTROLLER::add_rq(const request_type& packet, champsim::channel* ul
   auto& channel = channels[dram_get_channel(packet.address)];
 
   // Find empty slot
-  if (auto rq_it = std::find_if_not(std::begin(channel.RQ), std::end(channel.RQ), [](const auto& pkt) { return pkt.has_value(); });
-      rq_it != std::end(channel.RQ)) {
+  if (channel.rq_occupancy < std::size(channel.RQ)) {
+    auto rq_it = std::find_if_not(std::begin(channel.RQ), std::end(channel.RQ), [](const auto& pkt) { return pkt.has_value(); });
+    assert(rq_it != std::end(channel.RQ));
+
     *rq_it = DRAM_CHANNEL::request_type{packet};
     rq_it->value().forward_checked = false;
-    rq_it->value().event_cycle = current_cycle;
+    rq_it->value().event_cycle = current_cycle + LINK_LATENCY;
+    rq_it->value().cycle_enqueued = current_cycle;
+    rq_it->value().bank_idx = dram_get_rank(packet.address) * DRAM_BANKS + dram_get_bank(packet.address);
+    rq_it->value().row = dram_get_row(packet.address);
     if (packet.response_requested)
       rq_it->value().to_return = {&ul->returned};
 
+    ++channel.rq_occupancy;
+    channel.enqueue(rq_it, false);
+
+    if (vmem != nullptr)
+      vmem->record_access(packet.address);
     return true;
   }
 
@@ -320,12 +627,19 @@ bool MEMORY_CONTROLLER::add_wq(const request_type& packet)
   auto& channel = channels[dram_get_channel(packet.address)];
 
   // search for the empty index
-  if (auto wq_it = std::find_if_not(std::begin(channel.WQ), std::end(channel.WQ), [](const auto& pkt) { return pkt.has_value(); });
-      wq_it != std::end(channel.WQ)) {
+  if (channel.wq_occupancy < std::size(channel.WQ)) {
+    auto wq_it = std::find_if_not(std::begin(channel.WQ), std::end(channel.WQ), [](const auto& pkt) { return pkt.has_value(); });
+    assert(wq_it != std::end(channel.WQ));
+
     *wq_it = DRAM_CHANNEL::request_type{packet};
     wq_it->value().forward_checked = false;
-    wq_it->value().event_cycle = current_cycle;
+    wq_it->value().event_cycle = current_cycle + LINK_LATENCY;
+    wq_it->value().cycle_enqueued = current_cycle;
+    wq_it->value().bank_idx = dram_get_rank(packet.address) * DRAM_BANKS + dram_get_bank(packet.address);
+    wq_it->value().row = dram_get_row(packet.address);
 
+    ++channel.wq_occupancy;
+    channel.enqueue(wq_it, true);
     return true;
   }
 
@@ -333,56 +647,48 @@ bool MEMORY_CONTROLLER::add_wq(const request_type& packet)
   return false;
 }
 
-/*
- * | row address | rank index | column address | bank index | channel | block
- * offset |
- */
+uint32_t MEMORY_CONTROLLER::dram_get_channel(uint64_t address) { return static_cast<uint32_t>(address_mapping.channel(address - RANGE_BEGIN)); }
 
-uint32_t MEMORY_CONTROLLER::dram_get_channel(uint64_t address)
-{
-  int shift = LOG2_BLOCK_SIZE;
-  return (address >> shift) & champsim::bitmask(champsim::lg2(DRAM_CHANNELS));
-}
+uint32_t MEMORY_CONTROLLER::dram_get_bank(uint64_t address) { return static_cast<uint32_t>(address_mapping.bank(address - RANGE_BEGIN)); }
 
-uint32_t MEMORY_CONTROLLER::dram_get_bank(uint64_t address)
-{
-  int shift = champsim::lg2(DRAM_CHANNELS) + LOG2_BLOCK_SIZE;
-  return (address >> shift) & champsim::bitmask(champsim::lg2(DRAM_BANKS));
-}
+uint32_t MEMORY_CONTROLLER::dram_get_column(uint64_t address) { return static_cast<uint32_t>(address_mapping.column(address - RANGE_BEGIN)); }
 
-uint32_t MEMORY_CONTROLLER::dram_get_column(uint64_t address)
-{
-  int shift = champsim::lg2(DRAM_BANKS) + champsim::lg2(DRAM_CHANNELS) + LOG2_BLOCK_SIZE;
-  return (address >> shift) & champsim::bitmask(champsim::lg2(DRAM_COLUMNS));
-}
+uint32_t MEMORY_CONTROLLER::dram_get_rank(uint64_t address) { return static_cast<uint32_t>(address_mapping.rank(address - RANGE_BEGIN)); }
 
-uint32_t MEMORY_CONTROLLER::dram_get_rank(uint64_t address)
-{
-  int shift = champsim::lg2(DRAM_BANKS) + champsim::lg2(DRAM_COLUMNS) + champsim::lg2(DRAM_CHANNELS) + LOG2_BLOCK_SIZE;
-  return (address >> shift) & champsim::bitmask(champsim::lg2(DRAM_RANKS));
-}
+uint32_t MEMORY_CONTROLLER::dram_get_row(uint64_t address) { return static_cast<uint32_t>(address_mapping.row(address - RANGE_BEGIN)); }
+
+std::size_t MEMORY_CONTROLLER::size() const { return CAPACITY; }
 
-uint32_t MEMORY_CONTROLLER::dram_get_row(uint64_t address)
+std::pair<uint64_t, uint64_t> MEMORY_CONTROLLER::address_range() const { return {RANGE_BEGIN, RANGE_SIZE}; }
+
+std::function<double()> MEMORY_CONTROLLER::bandwidth_monitor() const
 {
-  int shift = champsim::lg2(DRAM_RANKS) + champsim::lg2(DRAM_BANKS) + champsim::lg2(DRAM_COLUMNS) + champsim::lg2(DRAM_CHANNELS) + LOG2_BLOCK_SIZE;
-  return (address >> shift) & champsim::bitmask(champsim::lg2(DRAM_ROWS));
-}
+  auto cycles_used = [this] {
+    return std::accumulate(std::begin(channels), std::end(channels), uint64_t{0}, [](auto acc, const auto& chan) { return acc + chan.dbus_cycles_used; });
+  };
 
-std::size_t MEMORY_CONTROLLER::size() const { return DRAM_CHANNELS * DRAM_RANKS * DRAM_BANKS * DRAM_ROWS * DRAM_COLUMNS * BLOCK_SIZE; }
+  return [this, cycles_used, last_cycle = current_cycle, last_used = cycles_used()]() mutable {
+    auto cycles = (current_cycle - last_cycle) * std::size(channels);
+    auto used = cycles_used() - last_used;
+    last_cycle = current_cycle;
+    last_used += used;
+    return (cycles == 0) ? 0.0 : std::min(1.0, std::ceil(used) / std::ceil(cycles));
+  };
+}
 
 // LCOV_EXCL_START Exclude the following function from LCOV
 void MEMORY_CONTROLLER::print_deadlock()
 {
   int j = 0;
   for (auto& chan : channels) {
-    fmt::print("DRAM Channel {}\n", j++);
+    fmt::print("{} Channel {}\n", NAME, j++);
     chan.print_deadlock();
   }
 }
 
 void DRAM_CHANNEL::print_deadlock()
 {
-  std::string_view q_writer{"instr_id: {} address: {:#x} v_addr: {:#x} type: {} translated: {}"};
+  std::string_view q_writer{"address: {:#x} v_addr: {:#x}"};
   auto q_entry_pack = [](const auto& entry) {
     return std::tuple{entry->address, entry->v_address};
   };
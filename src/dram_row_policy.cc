@@ -0,0 +1,67 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dram_row_policy.h"
+
+void champsim::row_buffer_policy::access(std::size_t, access_result) {}
+
+std::unique_ptr<champsim::row_buffer_policy> champsim::row_buffer_policy::make(dram_row_policy type, uint64_t timeout)
+{
+  switch (type) {
+  case dram_row_policy::CLOSED:
+    return std::make_unique<closed_row_policy>();
+  case dram_row_policy::TIMEOUT:
+    return std::make_unique<timeout_row_policy>(timeout);
+  case dram_row_policy::ADAPTIVE:
+    return std::make_unique<adaptive_row_policy>();
+  case dram_row_policy::OPEN:
+  default:
+    return std::make_unique<open_row_policy>();
+  }
+}
+
+uint64_t champsim::open_row_policy::close_after(std::size_t, bool, uint64_t) { return NEVER; }
+
+uint64_t champsim::closed_row_policy::close_after(std::size_t, bool pending_hit, uint64_t current_cycle) { return pending_hit ? NEVER : current_cycle; }
+
+champsim::timeout_row_policy::timeout_row_policy(uint64_t timeout_cycles) : timeout(timeout_cycles) {}
+
+uint64_t champsim::timeout_row_policy::close_after(std::size_t, bool pending_hit, uint64_t current_cycle)
+{
+  return pending_hit ? NEVER : current_cycle + timeout;
+}
+
+champsim::adaptive_row_policy::adaptive_row_policy()
+{
+  // Begin weakly predicting that rows should stay open
+  for (auto& ctr : predictors)
+    ctr = (decltype(predictors)::value_type::maximum + 1) / 2;
+}
+
+void champsim::adaptive_row_policy::access(std::size_t bank, access_result result)
+{
+  // A hit, or a reopening of a closed row, means the row should have stayed open
+  if (result == access_result::HIT || result == access_result::CLOSED_REOPEN)
+    ++predictors.at(bank);
+  else
+    --predictors.at(bank);
+}
+
+uint64_t champsim::adaptive_row_policy::close_after(std::size_t bank, bool pending_hit, uint64_t current_cycle)
+{
+  auto keep_open = pending_hit || predictors.at(bank).value() > decltype(predictors)::value_type::maximum / 2;
+  return keep_open ? NEVER : current_cycle;
+}
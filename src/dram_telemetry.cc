@@ -0,0 +1,56 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dram_telemetry.h"
+
+#include <algorithm>
+
+#include "champsim_constants.h"
+#include <fmt/core.h>
+#include <fmt/ostream.h>
+
+void champsim::dram_interval_stats::record_read(uint64_t latency)
+{
+  auto bucket = std::min<std::size_t>(champsim::lg2(latency), LATENCY_BUCKETS - 1);
+  ++read_latency[bucket];
+  ++reads;
+}
+
+champsim::dram_telemetry_writer::dram_telemetry_writer(std::string filename, uint64_t interval_cycles, int io_freq_mts)
+    : out(filename), io_freq(io_freq_mts), interval(interval_cycles)
+{
+  fmt::print(out, "controller,channel,cycle,bytes_read,bytes_written,bandwidth_mbps,avg_rq_occupancy,avg_wq_occupancy,write_drains,write_mode_cycles");
+  for (std::size_t i = 0; i < dram_interval_stats::LATENCY_BUCKETS; ++i)
+    fmt::print(out, ",read_latency_{}", i);
+  fmt::print(out, "\n");
+}
+
+void champsim::dram_telemetry_writer::write(std::string_view controller, std::size_t channel, uint64_t cycle, const dram_interval_stats& stats)
+{
+  auto bytes_read = stats.reads * BLOCK_SIZE;
+  auto bytes_written = stats.writes * BLOCK_SIZE;
+  auto cycles = std::max<uint64_t>(stats.cycles, 1);
+
+  // One DRAM cycle is one transfer, so bytes per cycle times millions of transfers per second gives MB/s
+  auto bandwidth = static_cast<double>(bytes_read + bytes_written) * io_freq / static_cast<double>(cycles);
+
+  fmt::print(out, "{},{},{},{},{},{:.1f},{:.2f},{:.2f},{},{}", controller, channel, cycle, bytes_read, bytes_written, bandwidth,
+             static_cast<double>(stats.rq_occupancy) / static_cast<double>(cycles), static_cast<double>(stats.wq_occupancy) / static_cast<double>(cycles),
+             stats.write_drains, stats.write_mode_cycles);
+  for (auto count : stats.read_latency)
+    fmt::print(out, ",{}", count);
+  fmt::print(out, "\n");
+}
@@ -34,10 +34,18 @@ void to_json(nlohmann::json& j, const O3_CPU::stats_type stats)
   for (auto [name, idx] : types)
     mpki.emplace(name, stats.branch_type_misses[idx]);
 
+  std::map<std::string, uint64_t> stalls{};
+  for (std::size_t idx = 0; idx < std::size(stall_type_names); ++idx)
+    stalls.emplace(stall_type_names[idx], stats.stall_cycles[idx]);
+
   j = nlohmann::json{{"instructions", stats.instrs()},
                      {"cycles", stats.cycles()},
                      {"Avg ROB occupancy at mispredict", std::ceil(stats.total_rob_occupancy_at_branch_mispredict) / std::ceil(total_mispredictions)},
-                     {"mispredict", mpki}};
+                     {"mispredict", mpki},
+                     {"memory order violations", stats.memory_order_violations},
+                     {"false memory dependences", stats.false_memory_dependences},
+                     {"stall cycles", stalls},
+                     {"memory stall cycles", stats.memory_stall_cycles}};
 }
 
 void to_json(nlohmann::json& j, const CACHE::stats_type stats)
@@ -53,6 +61,29 @@ void to_json(nlohmann::json& j, const CACHE::stats_type stats)
   statsmap.emplace("useful prefetch", stats.pf_useful);
   statsmap.emplace("useless prefetch", stats.pf_useless);
   statsmap.emplace("miss latency", stats.avg_miss_latency);
+  if (!std::empty(stats.pf_sources)) {
+    std::map<std::string, nlohmann::json> sources;
+    for (const auto& source : stats.pf_sources) {
+      sources.emplace(source.name, nlohmann::json{{"proposed", source.proposed},
+                                                  {"duplicate", source.duplicate},
+                                                  {"dropped", source.dropped},
+                                                  {"filtered", source.filtered},
+                                                  {"issued", source.issued},
+                                                  {"discarded", source.discarded},
+                                                  {"redundant", source.redundant},
+                                                  {"filled", source.filled},
+                                                  {"useful", source.useful},
+                                                  {"late", source.late},
+                                                  {"useless", source.useless},
+                                                  {"throttled", source.throttled},
+                                                  {"throttle level intervals", source.throttle_levels},
+                                                  {"dark", source.dark},
+                                                  {"selected intervals", source.selected},
+                                                  {"timely cycles histogram", source.timely_cycles},
+                                                  {"late cycles histogram", source.late_cycles}});
+    }
+    statsmap.emplace("prefetchers", sources);
+  }
   for (const auto& type : types) {
     statsmap.emplace(type.first, nlohmann::json{{"hit", stats.hits[type.second]}, {"miss", stats.misses[type.second]}});
   }
@@ -66,9 +97,34 @@ void to_json(nlohmann::json& j, const DRAM_CHANNEL::stats_type stats)
                      {"RQ ROW_BUFFER_MISS", stats.RQ_ROW_BUFFER_MISS},
                      {"WQ ROW_BUFFER_HIT", stats.WQ_ROW_BUFFER_HIT},
                      {"WQ ROW_BUFFER_MISS", stats.WQ_ROW_BUFFER_MISS},
+                     {"PRECHARGE CONFLICT", stats.CONFLICT_PRECHARGES},
+                     {"PRECHARGE POLICY", stats.POLICY_PRECHARGES},
+                     {"ACTIVATIONS", stats.ACTIVATIONS},
+                     {"REFRESHES", stats.REFRESHES},
+                     {"REFRESH CYCLES", stats.refresh_cycles},
                      {"AVG DBUS CONGESTED CYCLE", std::ceil(stats.dbus_cycle_congested) / std::ceil(stats.dbus_count_congested)}};
 }
 
+void to_json(nlohmann::json& j, const PageTableWalker::stats_type stats)
+{
+  std::map<std::string, nlohmann::json> pscl;
+  for (auto [level, hits] : stats.pscl_hits)
+    pscl.emplace(std::to_string(level), nlohmann::json{{"hit", hits}, {"miss", stats.pscl_misses.at(level)}});
+
+  j = nlohmann::json{{"walks", stats.walks},
+                     {"steps", stats.steps},
+                     {"walk latency", std::ceil(stats.total_walk_latency) / std::ceil(stats.walks)},
+                     {"walk latency histogram", stats.walk_latency},
+                     {"PSCL", pscl},
+                     {"cycles", stats.cycles},
+                     {"concurrent walks", stats.concurrent_walks}};
+}
+
+void to_json(nlohmann::json& j, const VirtualMemory::stats_type stats)
+{
+  j = nlohmann::json{{"hot page promotions", stats.promotions}, {"huge page promotions", stats.huge_page_promotions}};
+}
+
 namespace champsim
 {
 void to_json(nlohmann::json& j, const champsim::phase_stats stats)
@@ -78,14 +134,18 @@ void to_json(nlohmann::json& j, const champsim::phase_stats stats)
   roi_stats.emplace("DRAM", stats.roi_dram_stats);
   for (auto x : stats.roi_cache_stats)
     roi_stats.emplace(x.name, x);
+  for (auto x : stats.roi_ptw_stats)
+    roi_stats.emplace(x.name, x);
 
   std::map<std::string, nlohmann::json> sim_stats;
   sim_stats.emplace("cores", stats.sim_cpu_stats);
   sim_stats.emplace("DRAM", stats.sim_dram_stats);
   for (auto x : stats.sim_cache_stats)
     sim_stats.emplace(x.name, x);
+  for (auto x : stats.sim_ptw_stats)
+    sim_stats.emplace(x.name, x);
 
-  std::map<std::string, nlohmann::json> statsmap{{"name", stats.name}, {"traces", stats.trace_names}};
+  std::map<std::string, nlohmann::json> statsmap{{"name", stats.name}, {"traces", stats.trace_names}, {"virtual memory", stats.vmem_stats}};
   statsmap.emplace("roi", roi_stats);
   statsmap.emplace("sim", sim_stats);
   j = statsmap;
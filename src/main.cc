@@ -24,6 +24,7 @@
 #include "champsim_constants.h"
 #include "core_inst.inc"
 #include "phase_info.h"
+#include "runtime_config.h"
 #include "stats_printer.h"
 #include "tracereader.h"
 #include "vmem.h"
@@ -45,6 +46,11 @@ int main(int argc, char** argv)
   uint64_t warmup_instructions = 0;
   uint64_t simulation_instructions = std::numeric_limits<uint64_t>::max();
   std::string json_file_name;
+  std::string commit_log_prefix;
+  std::string dram_telemetry_prefix;
+  uint64_t dram_telemetry_interval = 10000;
+  std::vector<std::string> prefetcher_param_assignments;
+  std::string runtime_config_name;
   std::vector<std::string> trace_names;
 
   auto set_heartbeat_callback = [&](auto) {
@@ -65,6 +71,23 @@ int main(int argc, char** argv)
   auto json_option =
       app.add_option("--json", json_file_name, "The name of the file to receive JSON output. If no name is specified, stdout will be used")->expected(0, 1);
 
+  app.add_option("--commit-log", commit_log_prefix,
+                 "Record the timing of each instruction retired in the simulation phase. Each CPU writes to a file named with this prefix.");
+
+  app.add_option("--dram-telemetry", dram_telemetry_prefix,
+                 "Record the activity of each DRAM channel at regular intervals of the simulation phase. Each memory controller writes a CSV file "
+                 "named with this prefix.");
+  app.add_option("--dram-telemetry-interval", dram_telemetry_interval, "The length of each DRAM telemetry interval, in DRAM cycles");
+
+  app.add_option("--prefetcher-param", prefetcher_param_assignments,
+                 "Override a parameter of a cache's prefetcher, of the form CACHE.NAME=VALUE. May be given more than once.")
+      ->expected(1);
+
+  app.add_option("--config", runtime_config_name,
+                 "Choose the modules, and their parameters, from a JSON configuration file. The hierarchy is fixed when the simulator is configured, "
+                 "so only the modules, their parameters, and the prefetch activation are read. The modules must be compiled into the simulator.")
+      ->check(CLI::ExistingFile);
+
   app.add_option("traces", trace_names, "The paths to the traces")->required()->expected(NUM_CPUS)->check(CLI::ExistingFile);
 
   CLI11_PARSE(app, argc, argv);
@@ -81,6 +104,44 @@ int main(int argc, char** argv)
   if (simulation_given && !warmup_given)
     warmup_instructions = simulation_instructions * 2 / 10;
 
+  if (!commit_log_prefix.empty()) {
+    for (O3_CPU& cpu : gen_environment.cpu_view())
+      cpu.commit_log = std::make_unique<champsim::commit_log_writer>(fmt::format("{}.cpu{}.gz", commit_log_prefix, cpu.cpu));
+  }
+
+  if (!dram_telemetry_prefix.empty()) {
+    for (MEMORY_CONTROLLER& dram : gen_environment.memory_view())
+      dram.telemetry = std::make_unique<champsim::dram_telemetry_writer>(fmt::format("{}.{}.csv", dram_telemetry_prefix, dram.NAME), dram_telemetry_interval,
+                                                                         dram.IO_FREQ);
+  }
+
+  if (!runtime_config_name.empty()) {
+    std::ifstream runtime_config_file{runtime_config_name};
+    try {
+      champsim::apply_runtime_config(gen_environment, runtime_config_file);
+    } catch (const std::invalid_argument& err) {
+      fmt::print("ERROR: {}: {}\n", runtime_config_name, err.what());
+      return 1;
+    }
+  }
+
+  for (const auto& assignment : prefetcher_param_assignments) {
+    auto dot = assignment.find('.');
+    auto caches = gen_environment.cache_view();
+    auto found = std::find_if(std::begin(caches), std::end(caches), [name = assignment.substr(0, dot)](const CACHE& cache) { return cache.NAME == name; });
+    if (dot == std::string::npos || found == std::end(caches)) {
+      fmt::print("ERROR: prefetcher parameter {} does not name a cache.\n", assignment);
+      return 1;
+    }
+    found->get().prefetcher_params.set(assignment.substr(dot + 1));
+  }
+
+  // Throttled prefetchers respond to the bandwidth of the main memory
+  for (CACHE& cache : gen_environment.cache_view()) {
+    if (cache.pf_throttle.has_value())
+      cache.pf_throttle->set_bandwidth_source(gen_environment.dram_view().bandwidth_monitor());
+  }
+
   std::vector<champsim::tracereader> traces;
   std::transform(
       std::begin(trace_names), std::end(trace_names), std::back_inserter(traces),
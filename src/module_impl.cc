@@ -0,0 +1,43 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "module_impl.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+unsigned long long champsim::select_modules(const module_registry& registry, const std::vector<std::string>& names, std::string_view kind)
+{
+  unsigned long long result = 0;
+  for (const auto& name : names) {
+    // Modules are found by the name of their directory, as the configuration script does
+    std::string_view basename{name};
+    while (!basename.empty() && basename.back() == '/')
+      basename.remove_suffix(1);
+    if (auto slash = basename.find_last_of('/'); slash != std::string_view::npos)
+      basename.remove_prefix(slash + 1);
+
+    auto found = std::find_if(std::begin(registry), std::end(registry), [&](const auto& entry) { return entry.first == basename; });
+    if (found == std::end(registry)) {
+      std::string available;
+      for (const auto& entry : registry)
+        available += " " + entry.first;
+      throw std::invalid_argument{"The " + std::string{kind} + " '" + name + "' was not compiled into this simulator. Available:" + available};
+    }
+    result |= found->second;
+  }
+  return result;
+}
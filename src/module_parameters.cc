@@ -0,0 +1,58 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "module_parameters.h"
+
+#include <cstdlib>
+
+void champsim::module_parameters::parse(const std::string& text, bool& result)
+{
+  if (text == "true" || text == "1") {
+    result = true;
+  } else if (text == "false" || text == "0") {
+    result = false;
+  } else {
+    throw std::invalid_argument{"'" + text + "' is not a boolean"};
+  }
+}
+
+void champsim::module_parameters::parse(const std::string& text, double& result)
+{
+  char* last = nullptr;
+  result = std::strtod(text.c_str(), &last);
+  if (text.empty() || last != text.c_str() + text.size())
+    throw std::invalid_argument{"'" + text + "' is not a number"};
+}
+
+void champsim::module_parameters::parse(const std::string& text, std::string& result) { result = text; }
+
+void champsim::module_parameters::set(const std::string& assignment)
+{
+  auto eq = assignment.find('=');
+  if (eq == 0 || eq == std::string::npos)
+    throw std::invalid_argument{"Module parameter '" + assignment + "' is not of the form NAME=VALUE"};
+  set(assignment.substr(0, eq), assignment.substr(eq + 1));
+}
+
+std::vector<std::string> champsim::module_parameters::undeclared() const
+{
+  std::vector<std::string> result;
+  for (const auto& [name, value] : values) {
+    if (declared.count(name) == 0)
+      result.push_back(name);
+  }
+  return result;
+}
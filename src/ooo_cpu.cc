@@ -49,7 +49,9 @@ long O3_CPU::operate()
 
   progress += fetch_instruction(); // fetch
   progress += check_dib();
-  initialize_instruction();
+  progress += promote_to_ifetch();
+  initialize_instruction(); // predict
+  progress += prefetch_from_ftq();
 
   // heartbeat
   if (show_heartbeat && (num_retired >= next_print_instruction)) {
@@ -70,11 +72,33 @@ long O3_CPU::operate()
   return progress;
 }
 
+void O3_CPU::select_branch_predictor(const std::vector<std::string>& names)
+{
+  module_pimpl = std::make_unique<dynamic_module_model>(this, champsim::select_modules(branch_predictor_registry(), names, "branch predictor"),
+                                                        module_pimpl->btb_flags(), module_pimpl->memory_dependence_predictor_flags());
+}
+
+void O3_CPU::select_btb(const std::vector<std::string>& names)
+{
+  module_pimpl = std::make_unique<dynamic_module_model>(this, module_pimpl->branch_predictor_flags(), champsim::select_modules(btb_registry(), names, "BTB"),
+                                                        module_pimpl->memory_dependence_predictor_flags());
+}
+
+void O3_CPU::select_memory_dependence_predictor(const std::vector<std::string>& names)
+{
+  module_pimpl = std::make_unique<dynamic_module_model>(
+      this, module_pimpl->branch_predictor_flags(), module_pimpl->btb_flags(),
+      champsim::select_modules(memory_dependence_predictor_registry(), names, "memory dependence predictor"));
+}
+
 void O3_CPU::initialize()
 {
   // BRANCH PREDICTOR & BTB
   impl_initialize_branch_predictor();
   impl_initialize_btb();
+
+  // MEMORY DEPENDENCE PREDICTOR
+  impl_initialize_memory_dependence_predictor();
 }
 
 void O3_CPU::begin_phase()
@@ -106,25 +130,93 @@ void O3_CPU::end_phase(unsigned finished_cpu)
 
 void O3_CPU::initialize_instruction()
 {
-  auto instrs_to_read_this_cycle = std::min(FETCH_WIDTH, static_cast<long>(IFETCH_BUFFER_SIZE - std::size(IFETCH_BUFFER)));
+  // The branch predictor runs ahead of fetch, filling the FTQ with the predicted instruction stream
+  auto instrs_to_predict_this_cycle = std::min(PREDICTION_WIDTH, static_cast<long>(FTQ_SIZE - std::size(FETCH_TARGET_QUEUE)));
 
-  while (current_cycle >= fetch_resume_cycle && instrs_to_read_this_cycle > 0 && !std::empty(input_queue)) {
-    instrs_to_read_this_cycle--;
+  while (current_cycle >= fetch_resume_cycle && instrs_to_predict_this_cycle > 0 && !std::empty(input_queue)) {
+    instrs_to_predict_this_cycle--;
 
-    auto stop_fetch = do_init_instruction(input_queue.front());
-    if (stop_fetch)
-      instrs_to_read_this_cycle = 0;
+    auto stop_predict = do_init_instruction(input_queue.front());
+    if (stop_predict)
+      instrs_to_predict_this_cycle = 0;
 
-    // Add to IFETCH_BUFFER
-    IFETCH_BUFFER.push_back(input_queue.front());
+    // Add to FTQ
+    FETCH_TARGET_QUEUE.push_back(input_queue.front());
     input_queue.pop_front();
 
-    IFETCH_BUFFER.back().event_cycle = current_cycle;
+    FETCH_TARGET_QUEUE.back().event_cycle = current_cycle;
   }
 }
 
+long O3_CPU::prefetch_from_ftq()
+{
+  long progress{0};
+
+  // Issue an instruction prefetch for each new cache block that enters the FTQ
+  std::optional<uint64_t> prior_block;
+  if (ftq_prefetch_head > 0)
+    prior_block = FETCH_TARGET_QUEUE.at(ftq_prefetch_head - 1).ip >> LOG2_BLOCK_SIZE;
+  else if (!std::empty(IFETCH_BUFFER))
+    prior_block = IFETCH_BUFFER.back().ip >> LOG2_BLOCK_SIZE;
+
+  for (auto it = std::next(std::begin(FETCH_TARGET_QUEUE), static_cast<long>(ftq_prefetch_head)); it != std::end(FETCH_TARGET_QUEUE); ++it) {
+    auto block = it->ip >> LOG2_BLOCK_SIZE;
+    if (prior_block != block) {
+      if (!l1i->prefetch_line(it->ip, true, 0))
+        break;
+
+      if constexpr (champsim::debug_print) {
+        fmt::print("[FTQ] {} instr_id: {} ip: {:#x}\n", __func__, it->instr_id, it->ip);
+      }
+
+      ++progress;
+    }
+
+    prior_block = block;
+    ++ftq_prefetch_head;
+  }
+
+  return progress;
+}
+
+long O3_CPU::promote_to_ifetch()
+{
+  auto available_fetch_bandwidth = std::min<long>(FETCH_WIDTH, IFETCH_BUFFER_SIZE - std::size(IFETCH_BUFFER));
+  auto [window_begin, window_end] = champsim::get_span(std::begin(FETCH_TARGET_QUEUE), std::end(FETCH_TARGET_QUEUE), available_fetch_bandwidth);
+
+  // if taken, then we can't fetch anymore instructions this cycle
+  auto taken_branch = std::find_if(window_begin, window_end, [](const auto& x) { return x.is_branch && x.branch_taken; });
+  if (taken_branch != window_end)
+    window_end = std::next(taken_branch);
+
+  long progress{std::distance(window_begin, window_end)};
+
+  std::for_each(window_begin, window_end, [cycle = current_cycle](auto& x) {
+    x.event_cycle = cycle;
+    x.fetch_cycle = cycle;
+  });
+  std::move(window_begin, window_end, std::back_inserter(IFETCH_BUFFER));
+  FETCH_TARGET_QUEUE.erase(window_begin, window_end);
+  ftq_prefetch_head -= std::min<std::size_t>(ftq_prefetch_head, static_cast<std::size_t>(progress));
+
+  return progress;
+}
+
 namespace
 {
+instr_class infer_instr_class(const ooo_model_instr& arch_instr)
+{
+  // Without opcodes, the class is determined by the branch type and the shape of the memory operands
+  if (arch_instr.is_branch)
+    return instr_class::BRANCH;
+  // A read-modify-write instruction is a load. It also occupies a store port when it executes.
+  if (!std::empty(arch_instr.source_memory))
+    return instr_class::LOAD;
+  if (!std::empty(arch_instr.destination_memory))
+    return instr_class::STORE;
+  return instr_class::ALU;
+}
+
 void do_stack_pointer_folding(ooo_model_instr& arch_instr)
 {
   // The exact, true value of the stack pointer for any given instruction can usually be determined immediately after the instruction is decoded without
@@ -215,6 +307,7 @@ void O3_CPU::do_check_dib(ooo_model_instr& instr)
 
     // Also mark it as decoded
     instr.decoded = COMPLETED;
+    instr.dib_hit = true;
 
     // It can be acted on immediately
     instr.event_cycle = current_cycle;
@@ -279,8 +372,10 @@ long O3_CPU::promote_to_decode()
                                                          [cycle = current_cycle](const auto& x) { return x.fetched == COMPLETED && x.event_cycle <= cycle; });
   long progress{std::distance(window_begin, window_end)};
 
-  std::for_each(window_begin, window_end,
-                [cycle = current_cycle, lat = DECODE_LATENCY, warmup = warmup](auto& x) { return x.event_cycle = cycle + ((warmup || x.decoded) ? 0 : lat); });
+  std::for_each(window_begin, window_end, [cycle = current_cycle, lat = DECODE_LATENCY, warmup = warmup](auto& x) {
+    x.event_cycle = cycle + ((warmup || x.decoded) ? 0 : lat);
+    x.decode_cycle = cycle;
+  });
   std::move(window_begin, window_end, std::back_inserter(DECODE_BUFFER));
   IFETCH_BUFFER.erase(window_begin, window_end);
 
@@ -297,6 +392,7 @@ long O3_CPU::decode_instruction()
   // Send decoded instructions to dispatch
   std::for_each(window_begin, window_end, [&, this](auto& db_entry) {
     this->do_dib_update(db_entry);
+    db_entry.exec_class = ::infer_instr_class(db_entry);
 
     // Resume fetch
     if (db_entry.branch_mispredicted) {
@@ -333,7 +429,9 @@ long O3_CPU::dispatch_instruction()
          && ((std::size(DISPATCH_BUFFER.front().destination_memory) + std::size(SQ)) <= SQ_SIZE)) {
     ROB.push_back(std::move(DISPATCH_BUFFER.front()));
     DISPATCH_BUFFER.pop_front();
+    ROB.back().dispatch_cycle = current_cycle;
     do_memory_scheduling(ROB.back());
+    recovering_from_mispredict = false;
 
     available_dispatch_bandwidth--;
   }
@@ -387,36 +485,71 @@ long O3_CPU::execute_instruction()
   auto exec_bw = EXEC_WIDTH;
   for (auto rob_it = std::begin(ROB); rob_it != std::end(ROB) && exec_bw > 0; ++rob_it) {
     if (rob_it->scheduled == COMPLETED && rob_it->executed == 0 && rob_it->num_reg_dependent == 0 && rob_it->event_cycle <= current_cycle) {
-      do_execution(*rob_it);
-      --exec_bw;
+      if (do_execution(*rob_it))
+        --exec_bw;
     }
   }
 
   return EXEC_WIDTH - exec_bw;
 }
 
-void O3_CPU::do_execution(ooo_model_instr& rob_entry)
+bool O3_CPU::do_execution(ooo_model_instr& rob_entry)
 {
+  auto latency = EXEC_LATENCY;
+
+  // Bind the instruction to a free port for its class, if ports are configured for it. A read-modify-write instruction is also bound to a
+  // store port, which is occupied but does not add to its latency.
+  std::array<instr_class, 2> classes{rob_entry.exec_class, instr_class::STORE};
+  std::size_t num_classes = (rob_entry.exec_class == instr_class::LOAD && !std::empty(rob_entry.destination_memory)) ? 2 : 1;
+
+  std::array<std::vector<uint64_t>::iterator, 2> ports{};
+  for (std::size_t i = 0; i < num_classes; ++i) {
+    auto& port_cycles = exec_port_available_cycle.at(champsim::to_underlying(classes[i]));
+    ports[i] = std::min_element(std::begin(port_cycles), std::end(port_cycles));
+    if (ports[i] != std::end(port_cycles) && *ports[i] > current_cycle)
+      return false;
+  }
+
+  for (std::size_t i = 0; i < num_classes; ++i) {
+    const auto& port_config = EXEC_PORTS.at(champsim::to_underlying(classes[i]));
+    if (port_config.count > 0) {
+      *ports[i] = current_cycle + ((port_config.pipelined || warmup) ? 1 : std::max(port_config.latency, 1u));
+      if (i == 0)
+        latency = port_config.latency;
+    }
+  }
+
   rob_entry.executed = INFLIGHT;
-  rob_entry.event_cycle = current_cycle + (warmup ? 0 : EXEC_LATENCY);
+  rob_entry.event_cycle = current_cycle + (warmup ? 0 : latency);
+  rob_entry.execute_cycle = current_cycle;
 
   // Mark LQ entries as ready to translate
   for (auto& lq_entry : LQ)
     if (lq_entry.has_value() && lq_entry->instr_id == rob_entry.instr_id)
-      lq_entry->event_cycle = current_cycle + (warmup ? 0 : EXEC_LATENCY);
+      lq_entry->event_cycle = current_cycle + (warmup ? 0 : latency);
 
   // Mark SQ entries as ready to translate
   for (auto& sq_entry : SQ)
     if (sq_entry.instr_id == rob_entry.instr_id)
-      sq_entry.event_cycle = current_cycle + (warmup ? 0 : EXEC_LATENCY);
+      sq_entry.event_cycle = current_cycle + (warmup ? 0 : latency);
 
   if constexpr (champsim::debug_print) {
     fmt::print("[ROB] {} instr_id: {} event_cycle: {}\n", __func__, rob_entry.instr_id, rob_entry.event_cycle);
   }
+
+  return true;
 }
 
 void O3_CPU::do_memory_scheduling(ooo_model_instr& instr)
 {
+  // Find the store that the memory dependence predictor says this instruction's loads should wait on
+  auto predicted_it = std::end(SQ);
+  if (!PERFECT_MEMORY_DISAMBIGUATION && !std::empty(instr.source_memory)) {
+    predicted_it = std::find_if(std::begin(SQ), std::end(SQ), [id = impl_predict_load_dependence(instr.ip), this_id = instr.instr_id](const auto& x) {
+      return x.instr_id == id && x.instr_id < this_id && !x.fetch_issued;
+    });
+  }
+
   // load
   for (auto& smem : instr.source_memory) {
     auto q_entry = std::find_if_not(std::begin(LQ), std::end(LQ), [](const auto& lq_entry) { return lq_entry.has_value(); });
@@ -439,9 +572,24 @@ void O3_CPU::do_memory_scheduling(ooo_model_instr& instr)
         sq_it->lq_depend_on_me.push_back(*q_entry); // Forward the load when the store finishes
         (*q_entry)->producer_id = sq_it->instr_id;  // The load waits on the store to finish
 
+        // If the predictor did not hold this load back, it issues early and must be replayed
+        if (!PERFECT_MEMORY_DISAMBIGUATION && predicted_it == std::end(SQ)) {
+          (*q_entry)->producer_dependence = LSQ_ENTRY::dependence_type::REPLAY;
+          ++sim_stats.memory_order_violations;
+          impl_memory_order_violation(instr.ip, sq_it->ip);
+        }
+
         if constexpr (champsim::debug_print)
           fmt::print("[DISPATCH] {} instr_id: {} waits on: {}\n", __func__, instr.instr_id, sq_it->event_cycle);
       }
+    } else if (predicted_it != std::end(SQ)) {
+      predicted_it->lq_depend_on_me.push_back(*q_entry); // Issue the load when the predicted store finishes
+      (*q_entry)->producer_id = predicted_it->instr_id;
+      (*q_entry)->producer_dependence = LSQ_ENTRY::dependence_type::SYNCHRONIZE;
+      ++sim_stats.false_memory_dependences;
+
+      if constexpr (champsim::debug_print)
+        fmt::print("[DISPATCH] {} instr_id: {} predicted to wait on: {}\n", __func__, instr.instr_id, predicted_it->instr_id);
     }
   }
 
@@ -449,6 +597,9 @@ void O3_CPU::do_memory_scheduling(ooo_model_instr& instr)
   for (auto& dmem : instr.destination_memory)
     SQ.emplace_back(instr.instr_id, dmem, instr.ip, instr.asid); // add it to the store queue
 
+  if (!PERFECT_MEMORY_DISAMBIGUATION && !std::empty(instr.destination_memory))
+    impl_dispatch_store(instr.ip, instr.instr_id);
+
   if constexpr (champsim::debug_print) {
     fmt::print("[DISPATCH] {} instr_id: {} loads: {} stores: {}\n", __func__, instr.instr_id, std::size(instr.source_memory),
                std::size(instr.destination_memory));
@@ -498,13 +649,23 @@ void O3_CPU::do_finish_store(const LSQ_ENTRY& sq_entry)
 {
   sq_entry.finish(std::begin(ROB), std::end(ROB));
 
+  if (!PERFECT_MEMORY_DISAMBIGUATION)
+    impl_execute_store(sq_entry.ip, sq_entry.instr_id);
+
   // Release dependent loads
   for (std::optional<LSQ_ENTRY>& dependent : sq_entry.lq_depend_on_me) {
     assert(dependent.has_value()); // LQ entry is still allocated
     assert(dependent->producer_id == sq_entry.instr_id);
 
-    dependent->finish(std::begin(ROB), std::end(ROB));
-    dependent.reset();
+    if (dependent->producer_dependence == LSQ_ENTRY::dependence_type::FORWARD) {
+      dependent->finish(std::begin(ROB), std::end(ROB));
+      dependent.reset();
+    } else {
+      // The load issues to the cache on its own, after the replay penalty if it violated memory ordering
+      auto penalty = (warmup || dependent->producer_dependence != LSQ_ENTRY::dependence_type::REPLAY) ? 0 : MEMORY_REPLAY_PENALTY;
+      dependent->producer_id = std::numeric_limits<uint64_t>::max();
+      dependent->event_cycle = std::max(dependent->event_cycle, current_cycle + penalty);
+    }
   }
 }
 
@@ -556,8 +717,17 @@ void O3_CPU::do_complete_execution(ooo_model_instr& instr)
       dependent.scheduled = COMPLETED;
   }
 
-  if (instr.branch_mispredicted)
+  if (instr.memory_stall_cycles > 0) {
+    auto level = sim_stats.memory_stall_cycles.find(instr.served_by);
+    if (level == std::end(sim_stats.memory_stall_cycles))
+      level = sim_stats.memory_stall_cycles.emplace(instr.served_by, 0).first;
+    level->second += instr.memory_stall_cycles;
+  }
+
+  if (instr.branch_mispredicted) {
     fetch_resume_cycle = current_cycle + BRANCH_MISPREDICT_PENALTY;
+    recovering_from_mispredict = true;
+  }
 }
 
 long O3_CPU::complete_inflight_instruction()
@@ -607,7 +777,9 @@ long O3_CPU::handle_memory_return()
   for (auto l1d_bw = L1D_BANDWIDTH; l1d_bw > 0 && l1d_it != std::end(L1D_bus.lower_level->returned); --l1d_bw, ++l1d_it) {
     for (auto& lq_entry : LQ) {
       if (lq_entry.has_value() && lq_entry->fetch_issued && lq_entry->virtual_address >> LOG2_BLOCK_SIZE == l1d_it->v_address >> LOG2_BLOCK_SIZE) {
-        lq_entry->finish(std::begin(ROB), std::end(ROB));
+        auto rob_entry = lq_entry->finish(std::begin(ROB), std::end(ROB));
+        rob_entry->served_by = l1d_it->served_by;
+        rob_entry->record_served_by(lq_entry->virtual_address, l1d_it->served_by);
         lq_entry.reset();
         ++progress;
       }
@@ -626,12 +798,42 @@ long O3_CPU::retire_rob()
     std::for_each(retire_begin, retire_end, [](const auto& x) { fmt::print("[ROB] retire_rob instr_id: {} is retired\n", x.instr_id); });
   }
   auto retire_count = std::distance(retire_begin, retire_end);
+
+  // Attribute this cycle to a cause in the stall breakdown
+  auto cause = (retire_count > 0) ? stall_type::BASE : classify_stall();
+  ++sim_stats.stall_cycles[champsim::to_underlying(cause)];
+  if (cause == stall_type::MEMORY)
+    ++ROB.front().memory_stall_cycles;
+
+  if (commit_log && !warmup)
+    std::for_each(retire_begin, retire_end, [this](const auto& x) { this->commit_log->log(x, this->current_cycle); });
+
   num_retired += retire_count;
   ROB.erase(retire_begin, retire_end);
 
   return retire_count;
 }
 
+stall_type O3_CPU::classify_stall() const
+{
+  // The head of the ROB cannot retire. Blame the memory hierarchy if it is a load waiting for data.
+  if (!std::empty(ROB)) {
+    const auto& head = ROB.front();
+    if (!std::empty(head.source_memory) && head.executed == INFLIGHT && head.completed_mem_ops < head.num_mem_ops())
+      return stall_type::MEMORY;
+    return stall_type::CORE;
+  }
+
+  // The ROB is empty. Blame the oldest instruction in the front end.
+  if (std::empty(DISPATCH_BUFFER) && std::empty(DECODE_BUFFER) && !std::empty(IFETCH_BUFFER) && IFETCH_BUFFER.front().fetched != COMPLETED)
+    return stall_type::FRONTEND_ICACHE;
+  if (std::empty(DISPATCH_BUFFER) && !std::empty(DECODE_BUFFER) && !DECODE_BUFFER.front().dib_hit)
+    return stall_type::FRONTEND_DIB_MISS;
+  if (recovering_from_mispredict)
+    return stall_type::BAD_SPECULATION;
+  return stall_type::FRONTEND_FETCH_STALL;
+}
+
 // LCOV_EXCL_START Exclude the following function from LCOV
 void O3_CPU::print_deadlock()
 {
@@ -641,6 +843,7 @@ void O3_CPU::print_deadlock()
     return std::tuple{entry.instr_id, +entry.fetched, +entry.scheduled, +entry.executed, +entry.num_reg_dependent, entry.num_mem_ops() - entry.completed_mem_ops, entry.event_cycle};
   };
   std::string_view instr_fmt{"instr_id: {} fetched: {} scheduled: {} executed: {} num_reg_dependent: {} num_mem_ops: {} event: {}"};
+  champsim::range_print_deadlock(FETCH_TARGET_QUEUE, "cpu" + std::to_string(cpu) + "_FTQ", instr_fmt, instr_pack);
   champsim::range_print_deadlock(IFETCH_BUFFER, "cpu" + std::to_string(cpu) + "_IFETCH", instr_fmt, instr_pack);
   champsim::range_print_deadlock(DECODE_BUFFER, "cpu" + std::to_string(cpu) + "_DECODE", instr_fmt, instr_pack);
   champsim::range_print_deadlock(DISPATCH_BUFFER, "cpu" + std::to_string(cpu) + "_DISPATCH", instr_fmt, instr_pack);
@@ -673,7 +876,7 @@ LSQ_ENTRY::LSQ_ENTRY(uint64_t id, uint64_t addr, uint64_t local_ip, std::array<u
 {
 }
 
-void LSQ_ENTRY::finish(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end) const
+std::deque<ooo_model_instr>::iterator LSQ_ENTRY::finish(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end) const
 {
   auto rob_entry = std::partition_point(begin, end, [id = this->instr_id](auto x) { return x.instr_id < id; });
   assert(rob_entry != end);
@@ -686,6 +889,8 @@ void LSQ_ENTRY::finish(std::deque<ooo_model_instr>::iterator begin, std::deque<o
     fmt::print("[LSQ] {} instr_id: {} full_address: {:#x} remain_mem_ops: {} event_cycle: {}\n", __func__, instr_id, virtual_address,
                rob_entry->num_mem_ops() - rob_entry->completed_mem_ops, event_cycle);
   }
+
+  return rob_entry;
 }
 
 bool CacheBus::issue_read(request_type data_packet)
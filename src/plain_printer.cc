@@ -40,6 +40,8 @@ void champsim::plain_printer::print(O3_CPU::stats_type stats)
   fmt::print(stream, "{} Branch Prediction Accuracy: {:.4g}% MPKI: {:.4g} Average ROB Occupancy at Mispredict: {:.4g}\n", stats.name,
              (100.0 * std::ceil(total_branch - total_mispredictions)) / total_branch, (1000.0 * total_mispredictions) / std::ceil(stats.instrs()),
              std::ceil(stats.total_rob_occupancy_at_branch_mispredict) / total_mispredictions);
+  fmt::print(stream, "{} Memory order violations: {} False memory dependences: {}\n", stats.name, stats.memory_order_violations,
+             stats.false_memory_dependences);
 
   std::vector<double> mpkis;
   std::transform(std::begin(stats.branch_type_misses), std::end(stats.branch_type_misses), std::back_inserter(mpkis),
@@ -49,6 +51,13 @@ void champsim::plain_printer::print(O3_CPU::stats_type stats)
   for (auto [str, idx] : types)
     fmt::print(stream, "{}: {:.3}\n", str, mpkis[idx]);
   fmt::print(stream, "\n");
+
+  fmt::print(stream, "{} Cycle stack\n", stats.name);
+  for (std::size_t idx = 0; idx < std::size(stall_type_names); ++idx)
+    fmt::print(stream, "{}: {} ({:.4g}%)\n", stall_type_names[idx], stats.stall_cycles[idx], 100.0 * std::ceil(stats.stall_cycles[idx]) / std::ceil(stats.cycles()));
+  for (const auto& [level, cycles] : stats.memory_stall_cycles)
+    fmt::print(stream, "MEMORY {}: {}\n", level.empty() ? "UNKNOWN" : level, cycles);
+  fmt::print(stream, "\n");
 }
 
 void champsim::plain_printer::print(CACHE::stats_type stats)
@@ -76,6 +85,36 @@ void champsim::plain_printer::print(CACHE::stats_type stats)
 
     fmt::print(stream, "{} AVERAGE MISS LATENCY: {:.4g} cycles\n", stats.name, stats.avg_miss_latency);
   }
+
+  // Prefetchers that never proposed a prefetch are not shown
+  for (const auto& source : stats.pf_sources) {
+    if (source.proposed == 0)
+      continue;
+
+    fmt::print(stream, "{} PREFETCHER {} PROPOSED: {:10} THROTTLED: {:10} FILTERED: {:10} DUPLICATE: {:10} DROPPED: {:10} ISSUED: {:10}\n", stats.name,
+               source.name, source.proposed, source.throttled, source.filtered, source.duplicate, source.dropped, source.issued);
+    fmt::print(stream, "{} PREFETCHER {} DISCARDED: {:10} REDUNDANT: {:10} FILLED: {:10} USEFUL: {:10} LATE: {:10} USELESS: {:10}\n", stats.name,
+               source.name, source.discarded, source.redundant, source.filled, source.useful, source.late, source.useless);
+
+    for (auto [label, histogram] : {std::pair{"TIMELY", source.timely_cycles}, std::pair{"LATE", source.late_cycles}}) {
+      for (std::size_t bucket = 0; bucket < std::size(histogram); ++bucket) {
+        if (histogram[bucket] == 0)
+          continue;
+        auto lower = (bucket == 0) ? 0ull : (1ull << bucket);
+        if (bucket + 1 == std::size(histogram))
+          fmt::print(stream, "{} PREFETCHER {} {:<6} {:>6}+       cycles: {:10}\n", stats.name, source.name, label, lower, histogram[bucket]);
+        else
+          fmt::print(stream, "{} PREFETCHER {} {:<6} {:>6}-{:<6} cycles: {:10}\n", stats.name, source.name, label, lower, (2ull << bucket) - 1,
+                     histogram[bucket]);
+      }
+    }
+
+    if (source.dark > 0 || source.selected > 0)
+      fmt::print(stream, "{} PREFETCHER {} DARK: {:10} SELECTED INTERVALS: {:10}\n", stats.name, source.name, source.dark, source.selected);
+
+    for (std::size_t level = 0; level < std::size(source.throttle_levels); ++level)
+      fmt::print(stream, "{} PREFETCHER {} THROTTLE LEVEL {} INTERVALS: {:10}\n", stats.name, source.name, level, source.throttle_levels[level]);
+  }
 }
 
 void champsim::plain_printer::print(DRAM_CHANNEL::stats_type stats)
@@ -87,6 +126,37 @@ void champsim::plain_printer::print(DRAM_CHANNEL::stats_type stats)
     fmt::print(stream, " AVG DBUS CONGESTED CYCLE: -\n");
   fmt::print(stream, "WQ ROW_BUFFER_HIT: {:10}\n  ROW_BUFFER_MISS: {:10}\n  FULL: {:10}\n", stats.name, stats.WQ_ROW_BUFFER_HIT, stats.WQ_ROW_BUFFER_MISS,
              stats.WQ_FULL);
+  fmt::print(stream, " PRECHARGE CONFLICT: {:10}\n  POLICY: {:10}\n", stats.CONFLICT_PRECHARGES, stats.POLICY_PRECHARGES);
+  fmt::print(stream, " ACTIVATIONS: {:10}\n REFRESHES: {:10}\n REFRESH CYCLES: {:10}\n", stats.ACTIVATIONS, stats.REFRESHES, stats.refresh_cycles);
+}
+
+void champsim::plain_printer::print(VirtualMemory::stats_type stats)
+{
+  fmt::print(stream, "HOT PAGE PROMOTIONS: {:10} HUGE PAGE PROMOTIONS: {:10}\n", stats.promotions, stats.huge_page_promotions);
+}
+
+void champsim::plain_printer::print(PageTableWalker::stats_type stats)
+{
+  fmt::print(stream, "{} WALKS: {:10} STEPS: {:10} AVERAGE WALK LATENCY: {:.4g} cycles\n", stats.name, stats.walks, stats.steps,
+             std::ceil(stats.total_walk_latency) / std::ceil(stats.walks));
+  for (auto [level, hits] : stats.pscl_hits)
+    fmt::print(stream, "{} PSCL{} HIT: {:10} MISS: {:10}\n", stats.name, level, hits, stats.pscl_misses[level]);
+
+  for (std::size_t bucket = 0; bucket < std::size(stats.walk_latency); ++bucket) {
+    if (stats.walk_latency[bucket] == 0)
+      continue;
+    auto lower = (bucket == 0) ? 0ull : (1ull << bucket);
+    if (bucket + 1 == std::size(stats.walk_latency))
+      fmt::print(stream, "{} WALK LATENCY {:>6}+       cycles: {:10}\n", stats.name, lower, stats.walk_latency[bucket]);
+    else
+      fmt::print(stream, "{} WALK LATENCY {:>6}-{:<6} cycles: {:10}\n", stats.name, lower, (2ull << bucket) - 1, stats.walk_latency[bucket]);
+  }
+
+  uint64_t walk_cycles = 0;
+  for (std::size_t count = 0; count < std::size(stats.concurrent_walks); ++count)
+    walk_cycles += count * stats.concurrent_walks[count];
+  fmt::print(stream, "{} AVERAGE CONCURRENT WALKS: {:.4g} MAX: {}\n", stats.name, std::ceil(walk_cycles) / std::ceil(stats.cycles),
+             std::empty(stats.concurrent_walks) ? 0 : std::size(stats.concurrent_walks) - 1);
 }
 
 void champsim::plain_printer::print(champsim::phase_stats& stats)
@@ -105,6 +175,9 @@ void champsim::plain_printer::print(champsim::phase_stats& stats)
 
     for (const auto& stat : stats.sim_cache_stats)
       print(stat);
+
+    for (const auto& stat : stats.sim_ptw_stats)
+      print(stat);
   }
 
   fmt::print(stream, "\nRegion of Interest Statistics\n");
@@ -115,9 +188,15 @@ void champsim::plain_printer::print(champsim::phase_stats& stats)
   for (const auto& stat : stats.roi_cache_stats)
     print(stat);
 
+  for (const auto& stat : stats.roi_ptw_stats)
+    print(stat);
+
   fmt::print(stream, "\nDRAM Statistics\n");
   for (const auto& stat : stats.roi_dram_stats)
     print(stat);
+
+  fmt::print(stream, "\nVirtual Memory Statistics\n");
+  print(stats.vmem_stats);
 }
 
 void champsim::plain_printer::print(std::vector<phase_stats>& stats)
@@ -0,0 +1,182 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "prefetch_arbiter.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "msl/bits.h"
+
+void champsim::prefetch_arbiter::set_sources(unsigned long long flags)
+{
+  source_flags.clear();
+  for (auto flag : config.priority) {
+    if ((flags & flag) != 0 && std::find(std::begin(source_flags), std::end(source_flags), flag) == std::end(source_flags))
+      source_flags.push_back(flag);
+  }
+
+  for (unsigned long long flag = 1; flag != 0 && flag <= flags; flag <<= 1) {
+    if ((flags & flag) != 0 && std::find(std::begin(source_flags), std::end(source_flags), flag) == std::end(source_flags))
+      source_flags.push_back(flag);
+  }
+
+  counters.assign(std::size(source_flags), confidence_counter{});
+  queues.assign(std::max<std::size_t>(std::size(source_flags), 1), {});
+  waiting = 0;
+  resize_tracked_blocks();
+}
+
+std::size_t champsim::prefetch_arbiter::source_of(unsigned long long flag) const
+{
+  auto found = std::find(std::begin(source_flags), std::end(source_flags), flag);
+  if (found == std::end(source_flags))
+    return std::empty(source_flags) ? 0 : std::size(source_flags) - 1;
+  return static_cast<std::size_t>(std::distance(std::begin(source_flags), found));
+}
+
+// The table holds every block that can be waiting or recent, and is kept at most half full
+void champsim::prefetch_arbiter::resize_tracked_blocks()
+{
+  auto most_tracked = std::size(queues) * config.queue_size + config.filter_size;
+  tracked_bits = champsim::msl::lg2(2 * most_tracked) + 1;
+  tracked_blocks.assign(std::size_t{1} << tracked_bits, NO_BLOCK);
+  for (auto block : recent) {
+    if (block != NO_BLOCK)
+      track(block);
+  }
+}
+
+std::size_t champsim::prefetch_arbiter::home_slot(uint64_t block) const
+{
+  // Fibonacci hashing spreads consecutive blocks across the table
+  return static_cast<std::size_t>((block * 0x9e3779b97f4a7c15ull) >> (64 - tracked_bits));
+}
+
+// The slot holding the block, or the empty slot where it would be tracked
+std::size_t champsim::prefetch_arbiter::find_slot(uint64_t block) const
+{
+  auto mask = std::size(tracked_blocks) - 1;
+  auto idx = home_slot(block);
+  while (tracked_blocks[idx] != block && tracked_blocks[idx] != NO_BLOCK)
+    idx = (idx + 1) & mask;
+  return idx;
+}
+
+void champsim::prefetch_arbiter::track(uint64_t block)
+{
+  assert(block != NO_BLOCK);
+  tracked_blocks[find_slot(block)] = block;
+}
+
+void champsim::prefetch_arbiter::untrack(uint64_t block)
+{
+  auto mask = std::size(tracked_blocks) - 1;
+  auto hole = find_slot(block);
+  if (tracked_blocks[hole] == NO_BLOCK)
+    return;
+
+  // Shift back the blocks that probed past the hole, so that no probe stops early
+  for (auto idx = (hole + 1) & mask; tracked_blocks[idx] != NO_BLOCK; idx = (idx + 1) & mask) {
+    if (((idx - home_slot(tracked_blocks[idx])) & mask) >= ((idx - hole) & mask)) {
+      tracked_blocks[hole] = tracked_blocks[idx];
+      hole = idx;
+    }
+  }
+  tracked_blocks[hole] = NO_BLOCK;
+}
+
+void champsim::prefetch_arbiter::remember(uint64_t block)
+{
+  // The issued block stays tracked while it is remembered as recent
+  if (std::empty(recent)) {
+    untrack(block);
+    return;
+  }
+
+  if (recent[next_recent] != NO_BLOCK)
+    untrack(recent[next_recent]);
+  recent[next_recent] = block;
+  next_recent = (next_recent + 1) % std::size(recent);
+}
+
+auto champsim::prefetch_arbiter::propose(candidate pf) -> proposal_result
+{
+  auto block = pf.address >> offset_bits;
+  if (tracked_blocks[find_slot(block)] == block)
+    return proposal_result::DUPLICATE;
+
+  // Each source is bounded on its own, so that a busy source cannot crowd out the others
+  auto& queue = queues.at(std::min(pf.source, std::size(queues) - 1));
+  if (std::size(queue) >= config.queue_size)
+    return proposal_result::DROPPED;
+
+  queue.push_back(pf);
+  track(block);
+  ++waiting;
+  return proposal_result::ACCEPTED;
+}
+
+// The non-empty queue of the highest rank. Sources of equal confidence are ranked by priority.
+auto champsim::prefetch_arbiter::next_queue() -> std::deque<candidate>&
+{
+  std::size_t best = 0;
+  while (std::empty(queues[best]))
+    ++best;
+
+  if (config.order == policy::CONFIDENCE) {
+    for (auto source = best + 1; source < std::size(queues); ++source) {
+      if (!std::empty(queues[source]) && confidence(source) > confidence(best))
+        best = source;
+    }
+  }
+  return queues[best];
+}
+
+void champsim::prefetch_arbiter::confidence_counter::age()
+{
+  if (useful + useless >= CONFIDENCE_WINDOW) {
+    useful /= 2;
+    useless /= 2;
+  }
+}
+
+void champsim::prefetch_arbiter::record_useful(std::size_t source)
+{
+  if (source >= std::size(counters))
+    return;
+
+  ++counters[source].useful;
+  counters[source].age();
+}
+
+void champsim::prefetch_arbiter::record_useless(std::size_t source)
+{
+  if (source >= std::size(counters))
+    return;
+
+  ++counters[source].useless;
+  counters[source].age();
+}
+
+double champsim::prefetch_arbiter::confidence(std::size_t source) const
+{
+  if (source >= std::size(counters))
+    return 0.5;
+
+  const auto& counter = counters[source];
+  return (counter.useful + 1.0) / (counter.useful + counter.useless + 2.0);
+}
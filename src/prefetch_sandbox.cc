@@ -0,0 +1,129 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "prefetch_sandbox.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+
+champsim::prefetch_sandbox::prefetch_sandbox(config_type config_, unsigned offset_bits_)
+    : config(config_), offset_bits(offset_bits_), shadow(config.shadow_sets * config.shadow_ways)
+{
+  if (std::empty(shadow))
+    throw std::invalid_argument{"A prefetch sandbox must have at least one shadow set and way"};
+}
+
+void champsim::prefetch_sandbox::set_sources(std::size_t count)
+{
+  counters.assign(std::min(count, MAX_CANDIDATES), score_counter{});
+  demand_misses = 0;
+  selection = 0;
+  std::fill(std::begin(shadow), std::end(shadow), shadow_entry{});
+}
+
+auto champsim::prefetch_sandbox::set_begin(uint64_t block) -> std::vector<shadow_entry>::iterator
+{
+  auto set = static_cast<std::size_t>(block % config.shadow_sets);
+  return std::next(std::begin(shadow), static_cast<std::ptrdiff_t>(set * config.shadow_ways));
+}
+
+bool champsim::prefetch_sandbox::operate()
+{
+  if (++interval_cycles < config.interval)
+    return false;
+
+  interval_cycles = 0;
+
+  // Select the candidate with the greatest coverage, among those that are accurate enough
+  selection = NONE;
+  for (std::size_t source = 0; source < std::size(counters); ++source) {
+    if (counters[source].predicted <= 0 || accuracy(source) < config.accuracy_threshold)
+      continue;
+    if (selection == NONE || coverage(source) > coverage(selection))
+      selection = source;
+  }
+
+  for (auto& counter : counters) {
+    counter.predicted /= 2;
+    counter.covered /= 2;
+  }
+  demand_misses /= 2;
+
+  return true;
+}
+
+double champsim::prefetch_sandbox::accuracy(std::size_t source) const
+{
+  if (source >= std::size(counters) || counters[source].predicted <= 0)
+    return 0;
+  return std::min(1.0, counters[source].covered / counters[source].predicted);
+}
+
+double champsim::prefetch_sandbox::coverage(std::size_t source) const
+{
+  if (source >= std::size(counters) || demand_misses <= 0)
+    return 0;
+  return std::min(1.0, counters[source].covered / demand_misses);
+}
+
+void champsim::prefetch_sandbox::record_prediction(std::size_t source, uint64_t address)
+{
+  if (source >= std::size(counters))
+    return;
+
+  auto block = address >> offset_bits;
+  auto begin = set_begin(block);
+  auto end = std::next(begin, static_cast<std::ptrdiff_t>(config.shadow_ways));
+  auto entry = std::find_if(begin, end, [block](const auto& x) { return x.valid && x.block == block; });
+
+  // A block that a candidate has already predicted is not counted again
+  if (entry != end && (entry->candidates & (1ull << source)) != 0)
+    return;
+
+  // Replace the least recently predicted block. Its candidates are not credited.
+  if (entry == end) {
+    entry = std::min_element(begin, end, [](const auto& x, const auto& y) { return std::tie(x.valid, x.last_used) < std::tie(y.valid, y.last_used); });
+    *entry = shadow_entry{true, block, 0, 0};
+  }
+
+  entry->candidates |= (1ull << source);
+  entry->last_used = ++access_count;
+  ++counters[source].predicted;
+}
+
+void champsim::prefetch_sandbox::record_demand(uint64_t address, bool would_miss)
+{
+  if (would_miss)
+    ++demand_misses;
+
+  auto block = address >> offset_bits;
+  auto begin = set_begin(block);
+  auto end = std::next(begin, static_cast<std::ptrdiff_t>(config.shadow_ways));
+  auto entry = std::find_if(begin, end, [block](const auto& x) { return x.valid && x.block == block; });
+  if (entry == end)
+    return;
+
+  // The candidates that predicted a block the cache already had are not credited
+  if (would_miss) {
+    for (std::size_t source = 0; source < std::size(counters); ++source) {
+      if ((entry->candidates & (1ull << source)) != 0)
+        ++counters[source].covered;
+    }
+  }
+  entry->valid = false;
+}
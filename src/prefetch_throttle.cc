@@ -0,0 +1,175 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "prefetch_throttle.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+champsim::prefetch_throttle::prefetch_throttle(config_type config_, unsigned offset_bits_)
+    : config(std::move(config_)), offset_bits(offset_bits_), pollution_filter(config.pollution_filter_size, 0)
+{
+  if (std::empty(config.degrees))
+    throw std::invalid_argument{"A prefetch throttle must have at least one level"};
+}
+
+void champsim::prefetch_throttle::set_sources(std::size_t count)
+{
+  levels.assign(count, std::size(config.degrees) / 2);
+  counters.assign(count, feedback_counter{});
+  trigger_count.assign(count, 0);
+  demand_misses = 0;
+  std::fill(std::begin(pollution_filter), std::end(pollution_filter), 0);
+}
+
+std::size_t champsim::prefetch_throttle::filter_index(uint64_t address) const
+{
+  auto block = address >> offset_bits;
+  return static_cast<std::size_t>((block ^ (block >> 12)) % std::size(pollution_filter));
+}
+
+bool champsim::prefetch_throttle::operate()
+{
+  if (++interval_cycles < config.interval)
+    return false;
+
+  interval_cycles = 0;
+  if (bandwidth_source)
+    last_bandwidth = bandwidth_source();
+
+  for (std::size_t source = 0; source < std::size(levels); ++source) {
+    auto change = level_change(source);
+    if (change > 0 && levels[source] + 1 < std::size(config.degrees))
+      ++levels[source];
+    if (change < 0 && levels[source] > 0)
+      --levels[source];
+
+    counters[source].issued /= 2;
+    counters[source].useful /= 2;
+    counters[source].late /= 2;
+    counters[source].pollution /= 2;
+  }
+  demand_misses /= 2;
+
+  return true;
+}
+
+int champsim::prefetch_throttle::level_change(std::size_t source) const
+{
+  // A prefetcher that has not issued is left where it is
+  if (counters[source].issued < 1)
+    return 0;
+
+  const auto acc = accuracy(source);
+  const auto late = lateness(source) > config.lateness;
+  const auto polluting = pollution(source) > config.pollution;
+  const auto congested = last_bandwidth >= config.bandwidth_high;
+
+  // When the memory bandwidth is saturated, only the most accurate prefetchers keep their level
+  if (congested)
+    return (acc >= config.accuracy_high) ? 0 : -1;
+
+  if (acc >= config.accuracy_high)
+    return late ? 1 : (polluting ? -1 : 0);
+  if (acc >= config.accuracy_low)
+    return late ? (polluting ? -1 : 1) : (polluting ? -1 : 0);
+  return (late || polluting) ? -1 : 0;
+}
+
+void champsim::prefetch_throttle::begin_trigger() { std::fill(std::begin(trigger_count), std::end(trigger_count), 0); }
+
+bool champsim::prefetch_throttle::admit(std::size_t source)
+{
+  if (source >= std::size(trigger_count))
+    return true;
+
+  if (trigger_count[source] >= degree(source))
+    return false;
+
+  ++trigger_count[source];
+  return true;
+}
+
+std::size_t champsim::prefetch_throttle::level(std::size_t source) const
+{
+  if (source >= std::size(levels))
+    return std::size(config.degrees) - 1;
+  return levels[source];
+}
+
+std::size_t champsim::prefetch_throttle::degree(std::size_t source) const { return config.degrees.at(level(source)); }
+
+double champsim::prefetch_throttle::accuracy(std::size_t source) const
+{
+  if (source >= std::size(counters) || counters[source].issued <= 0)
+    return 0;
+  return std::min(1.0, counters[source].useful / counters[source].issued);
+}
+
+double champsim::prefetch_throttle::lateness(std::size_t source) const
+{
+  if (source >= std::size(counters) || counters[source].useful <= 0)
+    return 0;
+  return counters[source].late / counters[source].useful;
+}
+
+double champsim::prefetch_throttle::pollution(std::size_t source) const
+{
+  if (source >= std::size(counters) || demand_misses <= 0)
+    return 0;
+  return counters[source].pollution / demand_misses;
+}
+
+void champsim::prefetch_throttle::record_issued(std::size_t source)
+{
+  if (source < std::size(counters))
+    ++counters[source].issued;
+}
+
+void champsim::prefetch_throttle::record_discarded(std::size_t source)
+{
+  if (source < std::size(counters))
+    counters[source].issued = std::max(counters[source].issued - 1, 0.0);
+}
+
+void champsim::prefetch_throttle::record_useful(std::size_t source, bool late)
+{
+  if (source >= std::size(counters))
+    return;
+
+  ++counters[source].useful;
+  if (late)
+    ++counters[source].late;
+}
+
+void champsim::prefetch_throttle::record_prefetch_eviction(std::size_t source, uint64_t address)
+{
+  if (!std::empty(pollution_filter))
+    pollution_filter[filter_index(address)] = source + 1;
+}
+
+void champsim::prefetch_throttle::record_demand_miss(uint64_t address)
+{
+  ++demand_misses;
+  if (std::empty(pollution_filter))
+    return;
+
+  // A demand miss to a block that a prefetch evicted was caused by the prefetch
+  auto& entry = pollution_filter[filter_index(address)];
+  if (entry != 0 && entry - 1 < std::size(counters))
+    ++counters[entry - 1].pollution;
+  entry = 0;
+}
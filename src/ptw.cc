@@ -16,7 +16,9 @@
 
 #include "ptw.h"
 
-#include <numeric>
+#include <algorithm>
+#include <cassert>
+#include <limits>
 
 #include "champsim.h"
 #include "champsim_constants.h"
@@ -28,14 +30,16 @@
 
 PageTableWalker::PageTableWalker(Builder b)
     : champsim::operable(b.m_freq_scale), upper_levels(b.m_uls), lower_level(b.m_ll), NAME(b.m_name), MSHR_SIZE(b.m_mshr_size), MAX_READ(b.m_max_tag_check),
-      MAX_FILL(b.m_max_fill), HIT_LATENCY(b.m_latency), vmem(b.m_vmem), CR3_addr(b.m_vmem->get_pte_pa(b.m_cpu, 0, b.m_vmem->pt_levels).first)
+      MAX_FILL(b.m_max_fill), HIT_LATENCY(b.m_latency), cpu(b.m_cpu), vmem(b.m_vmem), CR3_addr(b.m_vmem->get_pte_pa(b.m_cpu, 0, b.m_vmem->pt_levels).first)
 {
   std::vector<std::array<uint32_t, 3>> local_pscl_dims{};
   std::remove_copy_if(std::begin(b.m_pscl), std::end(b.m_pscl), std::back_inserter(local_pscl_dims), [](auto x) { return std::get<0>(x) == 0; });
   std::sort(std::begin(local_pscl_dims), std::end(local_pscl_dims), std::greater{});
 
-  for (auto [level, sets, ways] : local_pscl_dims)
+  for (auto [level, sets, ways] : local_pscl_dims) {
     pscl.emplace_back(sets, ways, pscl_indexer{b.m_vmem->shamt(level)}, pscl_indexer{b.m_vmem->shamt(level)});
+    pscl_levels.push_back(level);
+  }
 }
 
 PageTableWalker::mshr_type::mshr_type(request_type req, std::size_t level)
@@ -46,19 +50,27 @@ PageTableWalker::mshr_type::mshr_type(request_type req, std::size_t level)
   asid[1] = req.asid[1];
 }
 
-auto PageTableWalker::handle_read(const request_type& handle_pkt, channel_type* ul) -> std::optional<mshr_type>
+bool PageTableWalker::handle_read(const request_type& handle_pkt, channel_type* ul)
 {
-  pscl_entry walk_init = {handle_pkt.v_address, CR3_addr, std::size(pscl)};
-  std::vector<std::optional<pscl_entry>> pscl_hits;
-  std::transform(std::begin(pscl), std::end(pscl), std::back_inserter(pscl_hits), [walk_init](auto& x) { return x.check_hit(walk_init); });
-  walk_init =
-      std::accumulate(std::begin(pscl_hits), std::end(pscl_hits), std::optional<pscl_entry>(walk_init), [](auto x, auto& y) { return y.value_or(*x); }).value();
+  // The walk begins after the deepest PSCL hit
+  const pscl_entry query = {handle_pkt.v_address, CR3_addr, std::size(pscl)};
+  auto walk_init = query;
+  uint64_t pscl_hit_mask = 0; // bit i is set if pscl[i] hit
+  assert(std::size(pscl) <= std::numeric_limits<uint64_t>::digits);
+  for (std::size_t i = 0; i < std::size(pscl); ++i) {
+    auto hit = pscl[i].check_hit(query);
+    if (hit.has_value()) {
+      walk_init = *hit;
+      pscl_hit_mask |= (1ull << i);
+    }
+  }
 
   auto walk_offset = vmem->get_offset(handle_pkt.address, walk_init.level) * PTE_BYTES;
 
   mshr_type fwd_mshr{handle_pkt, walk_init.level};
   fwd_mshr.address = champsim::splice_bits(walk_init.ptw_addr, walk_offset, LOG2_PAGE_SIZE);
   fwd_mshr.v_address = handle_pkt.address;
+  fwd_mshr.walk_begin_cycle = current_cycle;
   if (handle_pkt.response_requested)
     fwd_mshr.to_return = {&ul->returned};
 
@@ -67,10 +79,18 @@ auto PageTableWalker::handle_read(const request_type& handle_pkt, channel_type*
                walk_offset / PTE_BYTES, walk_init.level);
   }
 
-  return step_translation(fwd_mshr);
+  if (!step_translation(fwd_mshr))
+    return false;
+
+  // The lookups are counted only once the walk begins, since a request that could not begin is looked up again
+  for (std::size_t i = 0; i < std::size(pscl); ++i)
+    ++(((pscl_hit_mask >> i) & 1) ? sim_stats.pscl_hits : sim_stats.pscl_misses)[pscl_levels[i]];
+
+  MSHR.push_back(std::move(fwd_mshr));
+  return true;
 }
 
-auto PageTableWalker::handle_fill(const mshr_type& fill_mshr) -> std::optional<mshr_type>
+bool PageTableWalker::handle_fill(const mshr_type& fill_mshr)
 {
   if constexpr (champsim::debug_print) {
     fmt::print("[{}] {} address: {:#x} v_address: {:#x} data: {:#x} pt_page_offset: {} translation_level: {} event: {} current: {}\n", NAME, __func__,
@@ -86,10 +106,14 @@ auto PageTableWalker::handle_fill(const mshr_type& fill_mshr) -> std::optional<m
   fwd_mshr.translation_level = fill_mshr.translation_level - 1;
   fwd_mshr.event_cycle = std::numeric_limits<uint64_t>::max();
 
-  return step_translation(fwd_mshr);
+  if (!step_translation(fwd_mshr))
+    return false;
+
+  MSHR.push_back(std::move(fwd_mshr));
+  return true;
 }
 
-auto PageTableWalker::step_translation(const mshr_type& source) -> std::optional<mshr_type>
+bool PageTableWalker::step_translation(const mshr_type& source)
 {
   request_type packet;
   packet.address = source.address;
@@ -102,11 +126,10 @@ auto PageTableWalker::step_translation(const mshr_type& source) -> std::optional
   packet.type = access_type::TRANSLATION;
 
   bool success = lower_level->add_rq(packet);
-
   if (success)
-    return source;
+    ++sim_stats.steps;
 
-  return std::nullopt;
+  return success;
 }
 
 long PageTableWalker::operate()
@@ -117,14 +140,27 @@ long PageTableWalker::operate()
   progress += std::distance(std::cbegin(lower_level->returned), std::cend(lower_level->returned));
   lower_level->returned.clear();
 
-  std::vector<mshr_type> next_steps{};
+  // Walks move between the queues, so each is in exactly one of them
+  auto walks_in_progress = std::size(MSHR) + std::size(finished) + std::size(completed);
+  if (std::size(sim_stats.concurrent_walks) <= walks_in_progress)
+    sim_stats.concurrent_walks.resize(walks_in_progress + 1);
+  ++sim_stats.concurrent_walks[walks_in_progress];
+  ++sim_stats.cycles;
 
   auto fill_bw = MAX_FILL;
   auto [complete_begin, complete_end] = champsim::get_span_p(std::cbegin(completed), std::cend(completed), fill_bw,
                                                              [cycle = current_cycle](const auto& pkt) { return pkt.event_cycle <= cycle; });
-  std::for_each(complete_begin, complete_end, [](auto& mshr_entry) {
-    for (auto ret : mshr_entry.to_return)
+  std::for_each(complete_begin, complete_end, [this](auto& mshr_entry) {
+    auto latency = this->current_cycle - mshr_entry.walk_begin_cycle;
+    auto bucket = std::min<std::size_t>(latency == 0 ? 0 : champsim::lg2(latency), stats_type::LATENCY_BUCKETS - 1);
+    ++this->sim_stats.walks;
+    this->sim_stats.total_walk_latency += latency;
+    ++this->sim_stats.walk_latency[bucket];
+
+    for (auto ret : mshr_entry.to_return) {
       ret->emplace_back(mshr_entry.v_address, mshr_entry.v_address, mshr_entry.data, mshr_entry.pf_metadata, mshr_entry.instr_depend_on_me);
+      ret->back().page_bits = mshr_entry.page_bits;
+    }
   });
   fill_bw -= std::distance(complete_begin, complete_end);
   progress += std::distance(complete_begin, complete_end);
@@ -132,29 +168,19 @@ long PageTableWalker::operate()
 
   auto [mshr_begin, mshr_end] =
       champsim::get_span_p(std::cbegin(finished), std::cend(finished), fill_bw, [cycle = current_cycle](const auto& pkt) { return pkt.event_cycle <= cycle; });
-  std::tie(mshr_begin, mshr_end) = champsim::get_span_p(mshr_begin, mshr_end, [&next_steps, this](const auto& pkt) {
-    auto result = this->handle_fill(pkt);
-    if (result.has_value())
-      next_steps.push_back(*result);
-    return result.has_value();
-  });
+  std::tie(mshr_begin, mshr_end) = champsim::get_span_p(mshr_begin, mshr_end, [this](const auto& pkt) { return this->handle_fill(pkt); });
   progress += std::distance(mshr_begin, mshr_end);
   finished.erase(mshr_begin, mshr_end);
 
   auto tag_bw = MAX_READ;
   for (auto ul : upper_levels) {
-    auto [rq_begin, rq_end] = champsim::get_span_p(std::cbegin(ul->RQ), std::cend(ul->RQ), tag_bw, [&next_steps, ul, this](const auto& pkt) {
-      auto result = this->handle_read(pkt, ul);
-      if (result.has_value())
-        next_steps.push_back(*result);
-      return result.has_value();
-    });
+    auto [rq_begin, rq_end] =
+        champsim::get_span_p(std::cbegin(ul->RQ), std::cend(ul->RQ), tag_bw, [ul, this](const auto& pkt) { return this->handle_read(pkt, ul); });
     tag_bw -= std::distance(rq_begin, rq_end);
     progress += std::distance(rq_begin, rq_end);
     ul->RQ.erase(rq_begin, rq_end);
   }
 
-  MSHR.insert(std::cend(MSHR), std::begin(next_steps), std::end(next_steps));
   return progress;
 }
 
@@ -175,6 +201,8 @@ void PageTableWalker::finish_packet(const response_type& packet)
     uint64_t penalty;
     std::tie(mshr_entry.data, penalty) = this->vmem->va_to_pa(mshr_entry.cpu, mshr_entry.v_address);
     mshr_entry.event_cycle = this->current_cycle + (this->warmup ? 0 : penalty + HIT_LATENCY);
+    mshr_entry.page_bits = static_cast<unsigned>(this->vmem->shamt(this->vmem->page_level(mshr_entry.cpu, mshr_entry.v_address)));
+    mshr_entry.translation_level = 0;
 
     if constexpr (champsim::debug_print) {
       fmt::print("[{}] complete_packet address: {:#x} v_address: {:#x} data: {:#x} translation_level: {}\n", this->NAME, mshr_entry.address, mshr_entry.v_address,
@@ -182,23 +210,36 @@ void PageTableWalker::finish_packet(const response_type& packet)
     }
   };
 
-  auto last_finished =
-      std::partition(std::begin(MSHR), std::end(MSHR), [addr = packet.address](auto x) { return (x.address >> LOG2_BLOCK_SIZE) == (addr >> LOG2_BLOCK_SIZE); });
+  auto last_finished = std::partition(std::begin(MSHR), std::end(MSHR),
+                                      [addr = packet.address](const auto& x) { return (x.address >> LOG2_BLOCK_SIZE) == (addr >> LOG2_BLOCK_SIZE); });
 
-  std::for_each(std::begin(MSHR), last_finished, [finish_step, finish_last_step](auto& mshr_entry) {
-    if (mshr_entry.translation_level > 0)
+  // Walks for huge pages end at the level whose entry maps the page
+  std::for_each(std::begin(MSHR), last_finished, [this, finish_step, finish_last_step](auto& mshr_entry) {
+    if (mshr_entry.translation_level >= this->vmem->page_level(mshr_entry.cpu, mshr_entry.v_address))
       finish_step(mshr_entry);
     else
       finish_last_step(mshr_entry);
   });
 
   std::partition_copy(std::begin(MSHR), last_finished, std::back_inserter(finished), std::back_inserter(completed),
-                      [](auto x) { return x.translation_level > 0; });
+                      [](const auto& x) { return x.translation_level > 0; });
   MSHR.erase(std::begin(MSHR), last_finished);
 }
 
 void PageTableWalker::begin_phase()
 {
+  stats_type new_roi_stats, new_sim_stats;
+
+  new_roi_stats.name = NAME;
+  new_sim_stats.name = NAME;
+  for (auto level : pscl_levels) {
+    new_sim_stats.pscl_hits[level] = 0;
+    new_sim_stats.pscl_misses[level] = 0;
+  }
+
+  roi_stats = new_roi_stats;
+  sim_stats = new_sim_stats;
+
   for (auto ul : upper_levels) {
     channel_type::stats_type ul_new_roi_stats, ul_new_sim_stats;
     ul->roi_stats = ul_new_roi_stats;
@@ -206,6 +247,12 @@ void PageTableWalker::begin_phase()
   }
 }
 
+void PageTableWalker::end_phase(unsigned finished_cpu)
+{
+  if (finished_cpu == cpu)
+    roi_stats = sim_stats;
+}
+
 // LCOV_EXCL_START Exclude the following function from LCOV
 void PageTableWalker::print_deadlock()
 {
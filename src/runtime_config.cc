@@ -0,0 +1,356 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "runtime_config.h"
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+namespace
+{
+using json = nlohmann::json;
+
+const std::array<std::string, 6> pinned_cache_names{{"L1I", "L1D", "ITLB", "DTLB", "L2C", "STLB"}};
+
+// Modules may be named by a single string, or by a list of strings
+std::vector<std::string> module_names(const json& value)
+{
+  if (value.is_array())
+    return value.get<std::vector<std::string>>();
+  return {value.get<std::string>()};
+}
+
+// Parameters may be given as strings, numbers, or booleans
+std::string parameter_string(const json& value) { return value.is_string() ? value.get<std::string>() : value.dump(); }
+
+// The access types that activate the prefetcher may be given as a comma-separated string, or as a list
+unsigned prefetch_activate_mask(const json& value)
+{
+  std::vector<std::string> names;
+  if (value.is_array()) {
+    names = value.get<std::vector<std::string>>();
+  } else {
+    std::istringstream stream{value.get<std::string>()};
+    for (std::string name; std::getline(stream, name, ',');) {
+      name.erase(0, name.find_first_not_of(' '));
+      name.erase(name.find_last_not_of(' ') + 1);
+      if (!name.empty())
+        names.push_back(name);
+    }
+  }
+
+  const std::map<std::string, access_type> types{{"LOAD", access_type::LOAD},
+                                                 {"RFO", access_type::RFO},
+                                                 {"PREFETCH", access_type::PREFETCH},
+                                                 {"WRITE", access_type::WRITE},
+                                                 {"TRANSLATION", access_type::TRANSLATION}};
+  unsigned result = 0;
+  for (const auto& name : names) {
+    auto found = types.find(name);
+    if (found == std::end(types))
+      throw std::invalid_argument{"'" + name + "' is not an access type that can activate a prefetcher"};
+    result |= 1u << champsim::to_underlying(found->second);
+  }
+  return result;
+}
+
+// An arbiter may be enabled with true, or configured with an object. Keys that are not given take their defaults.
+std::optional<champsim::prefetch_arbiter::config_type> prefetch_arbiter_config(const json& value)
+{
+  if (value.is_boolean()) {
+    if (value.get<bool>())
+      return champsim::prefetch_arbiter::config_type{};
+    return std::nullopt;
+  }
+
+  const std::map<std::string, champsim::prefetch_arbiter::policy> policies{{"priority", champsim::prefetch_arbiter::policy::PRIORITY},
+                                                                           {"confidence", champsim::prefetch_arbiter::policy::CONFIDENCE}};
+  champsim::prefetch_arbiter::config_type result{};
+  auto policy_name = value.value("policy", std::string{"priority"});
+  auto found = policies.find(policy_name);
+  if (found == std::end(policies))
+    throw std::invalid_argument{"'" + policy_name + "' is not a prefetch arbiter policy"};
+  result.order = found->second;
+  result.issue_budget = value.value("issue_budget", result.issue_budget);
+  result.filter_size = value.value("filter_size", result.filter_size);
+  result.queue_size = value.value("queue_size", result.queue_size);
+  return result;
+}
+
+// A throttle may be enabled with true, or configured with an object. Keys that are not given take their defaults.
+std::optional<champsim::prefetch_throttle::config_type> prefetch_throttle_config(const json& value)
+{
+  if (value.is_boolean()) {
+    if (value.get<bool>())
+      return champsim::prefetch_throttle::config_type{};
+    return std::nullopt;
+  }
+
+  champsim::prefetch_throttle::config_type result{};
+  result.interval = value.value("interval", result.interval);
+  result.degrees = value.value("degrees", result.degrees);
+  result.accuracy_high = value.value("accuracy_high", result.accuracy_high);
+  result.accuracy_low = value.value("accuracy_low", result.accuracy_low);
+  result.lateness = value.value("lateness", result.lateness);
+  result.pollution = value.value("pollution", result.pollution);
+  result.bandwidth_high = value.value("bandwidth_high", result.bandwidth_high);
+  result.pollution_filter_size = value.value("pollution_filter_size", result.pollution_filter_size);
+  return result;
+}
+
+// A sandbox may be enabled with true, or configured with an object. Keys that are not given take their defaults.
+std::optional<champsim::prefetch_sandbox::config_type> prefetch_sandbox_config(const json& value)
+{
+  if (value.is_boolean()) {
+    if (value.get<bool>())
+      return champsim::prefetch_sandbox::config_type{};
+    return std::nullopt;
+  }
+
+  if (!value.is_object())
+    throw std::invalid_argument{"A prefetch sandbox must be a boolean or an object"};
+
+  champsim::prefetch_sandbox::config_type result{};
+  result.interval = value.value("interval", result.interval);
+  result.shadow_sets = value.value("shadow_sets", result.shadow_sets);
+  result.shadow_ways = value.value("shadow_ways", result.shadow_ways);
+  result.accuracy_threshold = value.value("accuracy_threshold", result.accuracy_threshold);
+  return result;
+}
+
+// Keys that are not given take their defaults
+champsim::prefetch_queue_policy prefetch_queue_config(const json& value)
+{
+  if (!value.is_object())
+    throw std::invalid_argument{"A prefetch queue policy must be an object"};
+
+  champsim::prefetch_queue_policy result{};
+  result.confidence_order = value.value("confidence_order", result.confidence_order);
+  result.drop_redundant = value.value("drop_redundant", result.drop_redundant);
+  result.max_age = value.value("max_age", result.max_age);
+  result.mshr_reserve = value.value("mshr_reserve", result.mshr_reserve);
+  return result;
+}
+
+// Copy the cores to fill out the number of cores, and give them the modules specified at the root, as config.sh does
+std::vector<json> core_configs(const json& config, std::size_t num_cores)
+{
+  auto cores = config.value("ooo_cpu", json::array({json::object()}));
+  if (!cores.is_array() || cores.empty())
+    throw std::invalid_argument{"The key ooo_cpu must be a list of cores"};
+
+  auto repeat_factor = (num_cores + std::size(cores) - 1) / std::size(cores);
+  std::vector<json> result;
+  for (std::size_t i = 0; i < num_cores; ++i) {
+    auto core = cores.at(i / repeat_factor);
+    for (const auto* key : {"branch_predictor", "btb", "memory_dependence_predictor"}) {
+      if (!core.contains(key) && config.contains(key))
+        core[key] = config[key];
+    }
+    result.push_back(core);
+  }
+  return result;
+}
+
+// The name config.sh gives to a cache of a core
+std::string element_name(const json& core, std::size_t index, const std::string& key)
+{
+  if (auto found = core.find(key); found != std::end(core)) {
+    if (found->is_string())
+      return found->get<std::string>();
+    if (found->is_object() && found->contains("name"))
+      return found->at("name").get<std::string>();
+  }
+  return fmt::format("cpu{}_{}", index, key);
+}
+
+// Gather the specifications of each cache, from highest precedence to lowest, as config.sh does
+std::map<std::string, std::vector<json>> cache_configs(const json& config, const std::vector<json>& cores)
+{
+  std::map<std::string, std::vector<json>> result;
+  for (const auto& cache : config.value("caches", json::array()))
+    result[cache.at("name").get<std::string>()].push_back(cache);
+
+  for (std::size_t i = 0; i < std::size(cores); ++i) {
+    for (const auto& key : pinned_cache_names) {
+      if (cores[i].contains(key) && cores[i][key].is_object())
+        result[element_name(cores[i], i, key)].push_back(cores[i][key]);
+    }
+  }
+
+  for (std::size_t i = 0; i < std::size(cores); ++i) {
+    for (const auto& key : pinned_cache_names) {
+      if (config.contains(key) && config[key].is_object())
+        result[config[key].value("name", element_name(cores[i], i, key))].push_back(config[key]);
+    }
+  }
+
+  if (config.contains("LLC") && config["LLC"].is_object())
+    result["LLC"].push_back(config["LLC"]);
+
+  return result;
+}
+
+// The value of a key in the specification of highest precedence that gives it
+const json* find_key(const std::vector<json>& specs, const char* key)
+{
+  auto found = std::find_if(std::begin(specs), std::end(specs), [key](const json& spec) { return spec.contains(key); });
+  return (found == std::end(specs)) ? nullptr : &found->at(key);
+}
+
+// Whether the given queues lead to the named element. The queues of walkers and memories are not visible, so these are found only by name.
+bool leads_to(champsim::environment& env, const champsim::channel* queue, const std::string& name)
+{
+  if (queue == nullptr)
+    return false;
+
+  auto caches = env.cache_view();
+  auto reader = std::find_if(std::begin(caches), std::end(caches), [queue](const CACHE& cache) {
+    return std::find(std::begin(cache.upper_levels), std::end(cache.upper_levels), queue) != std::end(cache.upper_levels);
+  });
+  if (reader != std::end(caches))
+    return reader->get().NAME == name;
+
+  auto ptws = env.ptw_view();
+  auto memories = env.memory_view();
+  return std::any_of(std::begin(ptws), std::end(ptws), [&name](const PageTableWalker& ptw) { return ptw.NAME == name; })
+         || std::any_of(std::begin(memories), std::end(memories), [&name](const MEMORY_CONTROLLER& mem) { return mem.NAME == name; });
+}
+
+// The hierarchy is fixed when the simulator is configured, so the file must describe each cache as it was built.
+// Keys that are not given are not checked, since config.sh derives their defaults from the rest of the hierarchy.
+void check_cache_geometry(champsim::environment& env, const CACHE& cache, const std::vector<json>& specs)
+{
+  auto check = [&cache, &specs](const char* key, auto built) {
+    if (auto given = find_key(specs, key); given != nullptr && given->get<decltype(built)>() != built) {
+      throw std::invalid_argument{fmt::format("The configuration gives cache {} a {} of {}, but the simulator was configured with {}", cache.NAME, key,
+                                              given->dump(), json(built).dump())};
+    }
+  };
+
+  check("sets", cache.NUM_SET);
+  check("ways", cache.NUM_WAY);
+  check("mshr_size", cache.MSHR_SIZE);
+  check("pq_size", cache.PQ_SIZE);
+  check("latency", cache.LATENCY);
+  check("hit_latency", cache.HIT_LATENCY);
+  check("fill_latency", cache.FILL_LATENCY);
+
+  // The queues from each upper level are sized by the cache they lead to
+  for (const auto* ul : cache.upper_levels) {
+    check("rq_size", ul->rq_size());
+    check("wq_size", ul->wq_size());
+    check("pq_size", ul->pq_size());
+  }
+
+  for (auto [key, queue] : {std::pair{"lower_level", cache.lower_level}, std::pair{"lower_translate", cache.lower_translate}}) {
+    if (auto given = find_key(specs, key); given != nullptr && !leads_to(env, queue, given->get<std::string>())) {
+      throw std::invalid_argument{
+          fmt::format("The configuration gives cache {} a {} of {}, but the simulator was not configured so", cache.NAME, key, given->dump())};
+    }
+  }
+}
+} // namespace
+
+void champsim::apply_runtime_config(environment& env, std::istream& config_file)
+{
+  try {
+    auto config = json::parse(config_file);
+
+    auto cpus = env.cpu_view();
+    if (config.contains("num_cores") && config["num_cores"].get<std::size_t>() != std::size(cpus)) {
+      throw std::invalid_argument{
+          fmt::format("The configuration has {} cores, but the simulator was configured with {}", config["num_cores"].get<std::size_t>(), std::size(cpus))};
+    }
+
+    auto cores = core_configs(config, std::size(cpus));
+    for (std::size_t i = 0; i < std::size(cpus); ++i) {
+      O3_CPU& cpu = cpus.at(i);
+      if (cores[i].contains("branch_predictor"))
+        cpu.select_branch_predictor(module_names(cores[i]["branch_predictor"]));
+      if (cores[i].contains("btb"))
+        cpu.select_btb(module_names(cores[i]["btb"]));
+      if (cores[i].contains("memory_dependence_predictor"))
+        cpu.select_memory_dependence_predictor(module_names(cores[i]["memory_dependence_predictor"]));
+    }
+
+    auto specs = cache_configs(config, cores);
+    auto caches = env.cache_view();
+    for (CACHE& cache : caches) {
+      auto found = specs.find(cache.NAME);
+      if (found == std::end(specs))
+        continue;
+
+      check_cache_geometry(env, cache, found->second);
+
+      // The arbiter is placed first, so that the prefetchers selected after it are given priority in the order they are named
+      if (auto arbiter = find_key(found->second, "prefetch_arbiter"); arbiter != nullptr) {
+        auto arbiter_config = prefetch_arbiter_config(*arbiter);
+        if (arbiter_config.has_value() && cache.pf_arbiter.has_value())
+          arbiter_config->priority = cache.pf_arbiter->get_config().priority;
+
+        if (arbiter_config.has_value())
+          cache.pf_arbiter.emplace(*arbiter_config, cache.OFFSET_BITS);
+        else
+          cache.pf_arbiter.reset();
+      }
+      if (auto throttle = find_key(found->second, "prefetch_throttle"); throttle != nullptr) {
+        if (auto throttle_config = prefetch_throttle_config(*throttle); throttle_config.has_value())
+          cache.pf_throttle.emplace(*throttle_config, cache.OFFSET_BITS);
+        else
+          cache.pf_throttle.reset();
+      }
+      if (auto sandbox = find_key(found->second, "prefetch_sandbox"); sandbox != nullptr) {
+        if (auto sandbox_config = prefetch_sandbox_config(*sandbox); sandbox_config.has_value())
+          cache.pf_sandbox.emplace(*sandbox_config, cache.OFFSET_BITS);
+        else
+          cache.pf_sandbox.reset();
+      }
+      if (auto pq = find_key(found->second, "prefetch_queue"); pq != nullptr)
+        cache.pq_policy = prefetch_queue_config(*pq);
+      if (auto pref = find_key(found->second, "prefetcher"); pref != nullptr)
+        cache.select_prefetcher(module_names(*pref));
+      if (auto repl = find_key(found->second, "replacement"); repl != nullptr)
+        cache.select_replacement(module_names(*repl));
+      if (auto activate = find_key(found->second, "prefetch_activate"); activate != nullptr)
+        cache.pref_activate_mask = prefetch_activate_mask(*activate);
+
+      // Parameters given with higher precedence replace those given with lower
+      std::for_each(std::rbegin(found->second), std::rend(found->second), [&cache](const json& spec) {
+        auto params = spec.value("prefetcher_params", json::object());
+        for (const auto& [name, value] : params.items())
+          cache.prefetcher_params.set(name, parameter_string(value));
+      });
+    }
+
+    for (const auto& [name, spec] : specs) {
+      if (std::none_of(std::begin(caches), std::end(caches), [name = name](const CACHE& cache) { return cache.NAME == name; }))
+        fmt::print("WARNING: cache {} in the configuration is not part of this simulator. Its modules are ignored.\n", name);
+    }
+  } catch (const json::exception& err) {
+    throw std::invalid_argument{std::string{"The configuration could not be read: "} + err.what()};
+  }
+}
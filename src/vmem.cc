@@ -16,7 +16,10 @@
 
 #include "vmem.h"
 
+#include <algorithm>
 #include <cassert>
+#include <numeric>
+#include <utility>
 
 #include "champsim.h"
 #include "champsim_constants.h"
@@ -24,17 +27,54 @@
 #include <fmt/core.h>
 
 VirtualMemory::VirtualMemory(uint64_t page_table_page_size, std::size_t page_table_levels, uint64_t minor_penalty, MEMORY_CONTROLLER& dram)
-    : next_ppage(VMEM_RESERVE_CAPACITY), last_ppage(1ull << (LOG2_PAGE_SIZE + champsim::lg2(page_table_page_size / PTE_BYTES) * page_table_levels)),
-      minor_fault_penalty(minor_penalty), pt_levels(page_table_levels), pte_page_size(page_table_page_size)
+    : VirtualMemory(page_table_page_size, page_table_levels, minor_penalty, {dram}, champsim::page_placement::FIRST_TOUCH, 0)
+{
+}
+
+VirtualMemory::VirtualMemory(uint64_t page_table_page_size, std::size_t page_table_levels, uint64_t minor_penalty,
+                             std::vector<std::reference_wrapper<MEMORY_CONTROLLER>> memory_tiers, champsim::page_placement page_placement,
+                             uint64_t promote_after, champsim::huge_page_config huge, champsim::page_allocation_config page_allocation)
+    : allocation_rng(page_allocation.seed), minor_fault_penalty(minor_penalty), pt_levels(page_table_levels), pte_page_size(page_table_page_size),
+      placement(page_placement), promotion_threshold(promote_after), huge_pages(huge), allocation(page_allocation),
+      huge_page_level(1 + (champsim::lg2(huge.size) - LOG2_PAGE_SIZE) / champsim::lg2(page_table_page_size / PTE_BYTES))
 {
   assert(page_table_page_size > 1024);
   assert(page_table_page_size == (1ull << champsim::lg2(page_table_page_size)));
-  assert(last_ppage > VMEM_RESERVE_CAPACITY);
+  assert(!std::empty(memory_tiers));
+
+  // Huge pages are mapped by the entries of an intermediate level of the page table
+  if (huge_pages.policy != champsim::huge_page_policy::NONE) {
+    assert(huge_page_level > 1 && huge_page_level < pt_levels);
+    assert(huge_pages.size == (1ull << shamt(huge_page_level)));
+    assert(huge_pages.fraction <= 100);
+  }
+  assert(allocation.colors > 0);
+  assert(allocation.fragment_pages > 0);
+
+  page_table.resize(pt_levels + 1);
 
-  auto required_bits = champsim::lg2(last_ppage);
+  // The page table can only address so many pages
+  uint64_t va_limit = 1ull << (LOG2_PAGE_SIZE + champsim::lg2(page_table_page_size / PTE_BYTES) * page_table_levels);
+
+  uint64_t physical_size = 0;
+  for (MEMORY_CONTROLLER& tier : memory_tiers) {
+    auto [begin, size] = tier.address_range();
+    auto first = std::max(begin, VMEM_RESERVE_CAPACITY);
+    auto last = begin + std::min(size, va_limit - std::min(begin, va_limit));
+    tiers.push_back({first, first, std::max(first, last), std::max(first, last)});
+    physical_size += tier.size();
+
+    if (allocation.policy == champsim::page_allocation::COLORED) {
+      for (uint64_t color = 0; color < allocation.colors; ++color)
+        tiers.back().next_color_ppage.push_back(first + ((color + allocation.colors - page_color(first)) % allocation.colors) * PAGE_SIZE);
+    }
+  }
+  assert(available_ppages() > 0);
+
+  auto required_bits = champsim::lg2(va_limit);
   if (required_bits > 64)
     fmt::print("WARNING: virtual memory configuration would require {} bits of addressing.\n", required_bits); // LCOV_EXCL_LINE
-  if (required_bits > champsim::lg2(dram.size()))
+  if (required_bits > champsim::lg2(physical_size))
     fmt::print("WARNING: physical memory size is smaller than virtual memory size.\n"); // LCOV_EXCL_LINE
 }
 
@@ -45,25 +85,209 @@ uint64_t VirtualMemory::get_offset(uint64_t vaddr, std::size_t level) const
   return (vaddr >> shamt(level)) & champsim::bitmask(champsim::lg2(pte_page_size / PTE_BYTES));
 }
 
-uint64_t VirtualMemory::ppage_front() const
+std::size_t VirtualMemory::tier_of(uint64_t paddr) const
 {
-  assert(available_ppages() > 0);
-  return next_ppage;
+  auto found = std::find_if(std::begin(tiers), std::end(tiers), [paddr](const auto& tier) { return paddr >= tier.first_ppage && paddr < tier.end_ppage; });
+  return static_cast<std::size_t>(std::distance(std::begin(tiers), found));
+}
+
+bool VirtualMemory::fits(const memory_tier& tier, std::size_t page_bits)
+{
+  auto below_last = [last = tier.last_ppage](auto ppage) { return ppage < last; };
+  if (page_bits == LOG2_PAGE_SIZE
+      && (!std::empty(tier.free_ppages) || std::any_of(std::begin(tier.next_color_ppage), std::end(tier.next_color_ppage), below_last)))
+    return true;
+
+  auto size = 1ull << page_bits;
+  return tier.last_ppage - tier.next_ppage >= size && ((tier.last_ppage - size) & ~champsim::bitmask(page_bits)) >= tier.next_ppage;
 }
 
-void VirtualMemory::ppage_pop() { next_ppage += PAGE_SIZE; }
+bool VirtualMemory::can_allocate(std::size_t page_bits) const
+{
+  return std::any_of(std::begin(tiers), std::end(tiers), [page_bits](const auto& tier) { return fits(tier, page_bits); });
+}
 
-std::size_t VirtualMemory::available_ppages() const { return (last_ppage - next_ppage) / PAGE_SIZE; }
+uint64_t VirtualMemory::page_color(uint64_t addr) const { return (addr >> LOG2_PAGE_SIZE) % allocation.colors; }
+
+void VirtualMemory::refill_pool(memory_tier& tier)
+{
+  uint64_t run = 1;
+  uint64_t gap = 0;
+  if (allocation.policy == champsim::page_allocation::RANDOM) {
+    run = RANDOM_POOL_PAGES;
+  } else if (allocation.policy == champsim::page_allocation::FRAGMENTED) {
+    run = 1 + std::geometric_distribution<uint64_t>{1.0 / static_cast<double>(allocation.fragment_pages)}(allocation_rng);
+    gap = std::uniform_int_distribution<uint64_t>{1, allocation.fragment_pages}(allocation_rng);
+  }
+
+  auto remaining = (tier.last_ppage - tier.next_ppage) / PAGE_SIZE;
+  run = std::min(run, remaining);
+  gap = std::min(gap, remaining - run);
+
+  auto pool_begin = std::size(tier.free_ppages);
+  for (uint64_t i = 0; i < run; ++i)
+    tier.free_ppages.push_back(tier.next_ppage + i * PAGE_SIZE);
+  tier.next_ppage += (run + gap) * PAGE_SIZE;
+
+  if (allocation.policy == champsim::page_allocation::RANDOM)
+    std::shuffle(std::next(std::begin(tier.free_ppages), static_cast<std::ptrdiff_t>(pool_begin)), std::end(tier.free_ppages), allocation_rng);
+}
+
+uint64_t VirtualMemory::allocate_from(std::size_t tier_idx, std::size_t page_bits, std::optional<uint64_t> vaddr)
+{
+  auto& tier = tiers.at(tier_idx);
+  assert(fits(tier, page_bits));
+  // Pages that were given back are handed out from the pool before new ones
+  if (page_bits == LOG2_PAGE_SIZE && allocation.policy == champsim::page_allocation::SEQUENTIAL && std::empty(tier.free_ppages)) {
+    auto ppage = tier.next_ppage;
+    tier.next_ppage += PAGE_SIZE;
+    return ppage;
+  }
+
+  if (page_bits == LOG2_PAGE_SIZE && allocation.policy == champsim::page_allocation::COLORED) {
+    // Pages without a virtual page to match take the color of the next page, so that they are allocated in order
+    auto color = page_color(vaddr.value_or(tier.next_ppage));
+    auto next = std::next(std::begin(tier.next_color_ppage), static_cast<std::ptrdiff_t>(color));
+
+    // If no page of the right color remains, any page will do
+    if (*next >= tier.last_ppage)
+      next = std::find_if(std::begin(tier.next_color_ppage), std::end(tier.next_color_ppage), [last = tier.last_ppage](auto ppage) { return ppage < last; });
+
+    // A page that was given back is handed out if it has the right color, or if no new page remains
+    bool reuse = !std::empty(tier.free_ppages) && (page_color(tier.free_ppages.front()) == color || next == std::end(tier.next_color_ppage));
+    if (!reuse) {
+      auto ppage = *next;
+      *next += allocation.colors * PAGE_SIZE;
+      tier.next_ppage = std::max(tier.next_ppage, ppage + PAGE_SIZE);
+      return ppage;
+    }
+  }
+
+  if (page_bits == LOG2_PAGE_SIZE) {
+    if (std::empty(tier.free_ppages) && tier.next_ppage < tier.last_ppage)
+      refill_pool(tier);
+
+    auto ppage = tier.free_ppages.front();
+    tier.free_ppages.pop_front();
+    return ppage;
+  }
+
+  // Larger pages are taken from the top of the tier, aligned to their size
+  tier.last_ppage = (tier.last_ppage - (1ull << page_bits)) & ~champsim::bitmask(page_bits);
+  return tier.last_ppage;
+}
+
+void VirtualMemory::free_ppage(uint64_t ppage) { tiers.at(tier_of(ppage)).free_ppages.push_back(ppage); }
+
+uint64_t VirtualMemory::allocate_ppage(champsim::page_placement how, std::size_t page_bits, std::optional<uint64_t> vaddr)
+{
+  assert(can_allocate(page_bits));
+
+  // The order in which tiers are tried
+  std::vector<std::size_t> order(std::size(tiers));
+  std::iota(std::begin(order), std::end(order), 0);
+  if (how == champsim::page_placement::HOT_PAGE)
+    std::reverse(std::begin(order), std::end(order));
+  else if (how == champsim::page_placement::INTERLEAVE)
+    std::rotate(std::begin(order), std::next(std::begin(order), static_cast<std::ptrdiff_t>(next_interleave_tier)), std::end(order));
+
+  auto found = std::find_if(std::begin(order), std::end(order), [this, page_bits](auto idx) { return fits(tiers[idx], page_bits); });
+  if (how == champsim::page_placement::INTERLEAVE)
+    next_interleave_tier = (*found + 1) % std::size(tiers);
+  return allocate_from(*found, page_bits, vaddr);
+}
+
+std::size_t VirtualMemory::available_ppages() const
+{
+  // Under colored allocation, the pages of each color between its cursor and next_ppage are also free
+  auto color_stride = allocation.colors * PAGE_SIZE;
+  return std::accumulate(std::begin(tiers), std::end(tiers), std::size_t{0}, [color_stride](auto acc, const auto& tier) {
+    auto below_next = std::min(tier.next_ppage, tier.last_ppage);
+    for (auto ppage : tier.next_color_ppage)
+      acc += (ppage < below_next) ? (below_next - ppage + color_stride - 1) / color_stride : 0;
+    return acc + (tier.last_ppage - tier.next_ppage) / PAGE_SIZE + std::size(tier.free_ppages);
+  });
+}
+
+uint64_t VirtualMemory::page_key(uint32_t cpu_num, uint64_t vaddr, std::size_t shift)
+{
+  assert(shift < 64);
+  assert(cpu_num < (1ull << shift));
+  return (uint64_t{cpu_num} << (64 - shift)) | (vaddr >> shift);
+}
+
+std::size_t VirtualMemory::huge_page_bits() const { return shamt(huge_page_level); }
+
+bool VirtualMemory::chosen_for_huge_page(uint64_t region) const
+{
+  // Fibonacci hashing, so that neighboring regions are chosen independently
+  return ((region * 0x9e3779b97f4a7c15ull) >> 32) % 100 < huge_pages.fraction;
+}
+
+std::size_t VirtualMemory::page_level(uint32_t cpu_num, uint64_t vaddr) const
+{
+  if (huge_pages.policy == champsim::huge_page_policy::NONE)
+    return 1;
+
+  auto region = page_key(cpu_num, vaddr, huge_page_bits());
+  if (huge_page_map.find(region) != nullptr)
+    return huge_page_level;
+
+  // The fault that would map this page would also map the region with a huge page
+  bool unmapped = (vpage_to_ppage_map.find(page_key(cpu_num, vaddr, LOG2_PAGE_SIZE)) == nullptr);
+  bool chosen = false;
+  if (huge_pages.policy == champsim::huge_page_policy::FIXED) {
+    chosen = chosen_for_huge_page(region);
+  } else if (huge_pages.policy == champsim::huge_page_policy::PROMOTE) {
+    auto touched = region_touches.find(region);
+    chosen = (touched == nullptr ? 0 : *touched) + 1 >= huge_pages.promote_after;
+  }
+
+  return (unmapped && chosen && can_allocate(huge_page_bits())) ? huge_page_level : 1;
+}
 
 std::pair<uint64_t, uint64_t> VirtualMemory::va_to_pa(uint32_t cpu_num, uint64_t vaddr)
 {
-  auto [ppage, fault] = vpage_to_ppage_map.insert({{cpu_num, vaddr >> LOG2_PAGE_SIZE}, ppage_front()});
+  if (huge_pages.policy != champsim::huge_page_policy::NONE) {
+    auto region = page_key(cpu_num, vaddr, huge_page_bits());
+    auto huge_ppage = huge_page_map.find(region);
+    bool fault = (huge_ppage == nullptr && page_level(cpu_num, vaddr) == huge_page_level);
+
+    // Base pages already mapped in a promoted region are not reclaimed
+    if (fault) {
+      huge_ppage = huge_page_map.try_emplace(region, allocate_ppage(placement, huge_page_bits())).first;
+      if (huge_pages.policy == champsim::huge_page_policy::PROMOTE)
+        ++huge_page_promotions;
+    }
+
+    if (huge_ppage != nullptr) {
+      auto paddr = champsim::splice_bits(*huge_ppage, vaddr, huge_page_bits());
+      if constexpr (champsim::debug_print) {
+        fmt::print("[VMEM] {} paddr: {:x} vaddr: {:x} fault: {} huge\n", __func__, paddr, vaddr, fault);
+      }
+
+      return {paddr, fault ? minor_fault_penalty : 0};
+    }
+  }
+
+  auto key = page_key(cpu_num, vaddr, LOG2_PAGE_SIZE);
+  auto ppage = vpage_to_ppage_map.find(key);
+  bool fault = (ppage == nullptr);
 
   // this vpage doesn't yet have a ppage mapping
-  if (fault)
-    ppage_pop();
+  if (fault) {
+    if (huge_pages.policy == champsim::huge_page_policy::PROMOTE)
+      ++*region_touches.try_emplace(page_key(cpu_num, vaddr, huge_page_bits()), 0).first;
+
+    ppage = vpage_to_ppage_map.try_emplace(key, allocate_ppage(placement, LOG2_PAGE_SIZE, vaddr)).first;
+    if (placement == champsim::page_placement::HOT_PAGE && tier_of(*ppage) != 0) {
+      slow_page_entry owned{key, 0, true};
+      if (auto [entry, inserted] = slow_ppages.try_emplace(*ppage >> LOG2_PAGE_SIZE, owned); !inserted)
+        *entry = owned;
+    }
+  }
 
-  auto paddr = champsim::splice_bits(ppage->second, vaddr, LOG2_PAGE_SIZE);
+  auto paddr = champsim::splice_bits(*ppage, vaddr, LOG2_PAGE_SIZE);
   if constexpr (champsim::debug_print) {
     fmt::print("[VMEM] {} paddr: {:x} vaddr: {:x} fault: {}\n", __func__, paddr, vaddr, fault);
   }
@@ -73,28 +297,45 @@ std::pair<uint64_t, uint64_t> VirtualMemory::va_to_pa(uint32_t cpu_num, uint64_t
 
 std::pair<uint64_t, uint64_t> VirtualMemory::get_pte_pa(uint32_t cpu_num, uint64_t vaddr, std::size_t level)
 {
-  if (next_pte_page == 0) {
-    next_pte_page = ppage_front();
-    ppage_pop();
-  }
+  // Page tables are placed in the fastest tier with space
+  if (next_pte_page == 0)
+    next_pte_page = allocate_ppage(champsim::page_placement::FIRST_TOUCH);
 
-  std::tuple key{cpu_num, vaddr >> shamt(level), level};
-  auto [ppage, fault] = page_table.insert({key, next_pte_page});
+  auto [ppage, fault] = page_table.at(level).try_emplace(page_key(cpu_num, vaddr, shamt(level)), next_pte_page);
 
   // this PTE doesn't yet have a mapping
   if (fault) {
     next_pte_page += pte_page_size;
-    if (!(next_pte_page % PAGE_SIZE)) {
-      next_pte_page = ppage_front();
-      ppage_pop();
-    }
+    if (!(next_pte_page % PAGE_SIZE))
+      next_pte_page = allocate_ppage(champsim::page_placement::FIRST_TOUCH);
   }
 
   auto offset = get_offset(vaddr, level);
-  auto paddr = champsim::splice_bits(ppage->second, offset * PTE_BYTES, champsim::lg2(pte_page_size));
+  auto paddr = champsim::splice_bits(*ppage, offset * PTE_BYTES, champsim::lg2(pte_page_size));
   if constexpr (champsim::debug_print) {
     fmt::print("[VMEM] {} paddr: {:x} vaddr: {:x} pt_page_offset: {} translation_level: {} fault: {}\n", __func__, paddr, vaddr, offset, level, fault);
   }
 
   return {paddr, fault ? minor_fault_penalty : 0};
 }
+
+void VirtualMemory::record_access(uint64_t paddr)
+{
+  if (placement != champsim::page_placement::HOT_PAGE)
+    return;
+
+  // Page table pages, and pages already in the fastest tier, have no owner
+  auto entry = slow_ppages.find(paddr >> LOG2_PAGE_SIZE);
+  if (entry == nullptr || !entry->mapped)
+    return;
+
+  auto& fastest = tiers.front();
+  if (++entry->accesses < promotion_threshold || !fits(fastest, LOG2_PAGE_SIZE))
+    return;
+
+  // Translations and blocks already cached keep the old address until they are evicted. The old page is given back to its tier.
+  auto ppage = vpage_to_ppage_map.find(entry->owner);
+  free_ppage(std::exchange(*ppage, allocate_from(0)));
+  entry->mapped = false;
+  ++promotions;
+}
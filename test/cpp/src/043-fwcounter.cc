@@ -117,6 +117,22 @@ TEMPLATE_TEST_CASE("A fixed-width counter can subtract a negative number in plac
   REQUIRE(lhs.value() == 2);
 }
 
+TEMPLATE_TEST_CASE("A fixed-width counter can increment", "", champsim::msl::fwcounter<8>, champsim::msl::sfwcounter<8>) {
+  TestType lhs{1};
+  ++lhs;
+  REQUIRE(lhs.value() == 2);
+  lhs++;
+  REQUIRE(lhs.value() == 3);
+}
+
+TEMPLATE_TEST_CASE("A fixed-width counter can decrement", "", champsim::msl::fwcounter<8>, champsim::msl::sfwcounter<8>) {
+  TestType lhs{3};
+  --lhs;
+  REQUIRE(lhs.value() == 2);
+  lhs--;
+  REQUIRE(lhs.value() == 1);
+}
+
 TEMPLATE_TEST_CASE("A fixed-width counter saturates with addition", "", champsim::msl::fwcounter<2>, champsim::msl::sfwcounter<2>) {
   TestType lhs{1};
   lhs += 3*lhs.maximum;
@@ -0,0 +1,55 @@
+#include <catch.hpp>
+#include "util/flat_hash_map.h"
+
+SCENARIO("A flat hash map finds the values inserted into it") {
+  GIVEN("An empty map") {
+    champsim::flat_hash_map<uint64_t> uut{4};
+
+    THEN("No keys are found") {
+      REQUIRE(uut.find(0) == nullptr);
+      REQUIRE(uut.size() == 0);
+    }
+
+    WHEN("A value is inserted") {
+      auto [value, inserted] = uut.try_emplace(0x1234, 0xdead);
+
+      THEN("It is inserted and can be found") {
+        REQUIRE(inserted);
+        REQUIRE(*value == 0xdead);
+        REQUIRE(uut.find(0x1234) != nullptr);
+        REQUIRE(*uut.find(0x1234) == 0xdead);
+        REQUIRE(uut.size() == 1);
+      }
+
+      AND_WHEN("Another value is inserted with the same key") {
+        auto [second_value, second_inserted] = uut.try_emplace(0x1234, 0xbeef);
+
+        THEN("The original value is kept") {
+          REQUIRE_FALSE(second_inserted);
+          REQUIRE(*second_value == 0xdead);
+          REQUIRE(uut.size() == 1);
+        }
+      }
+    }
+
+    WHEN("Many more values are inserted than the initial capacity") {
+      constexpr uint64_t num_values = 10000;
+      for (uint64_t i = 0; i < num_values; ++i)
+        uut.try_emplace(i << 12, i);
+
+      THEN("The map grows, and every value can be found") {
+        REQUIRE(uut.size() == num_values);
+        REQUIRE(uut.capacity() >= num_values);
+        for (uint64_t i = 0; i < num_values; ++i) {
+          auto found = uut.find(i << 12);
+          REQUIRE(found != nullptr);
+          REQUIRE(*found == i);
+        }
+      }
+
+      THEN("Keys that were not inserted are not found") {
+        REQUIRE(uut.find((num_values << 12) + 1) == nullptr);
+      }
+    }
+  }
+}
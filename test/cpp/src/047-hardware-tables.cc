@@ -0,0 +1,151 @@
+#include <catch.hpp>
+#include "msl/cam.h"
+#include "msl/set_assoc_table.h"
+
+#include <vector>
+
+TEMPLATE_TEST_CASE("A CAM fills invalid entries before replacing", "", champsim::msl::lru_policy<4>, champsim::msl::plru_policy<4>,
+    champsim::msl::srrip_policy<4>) {
+  GIVEN("An empty CAM") {
+    champsim::msl::cam<int, 4, TestType> uut;
+
+    THEN("Every key misses") {
+      REQUIRE(uut.find(0) == nullptr);
+      REQUIRE(uut.occupancy() == 0);
+    }
+
+    WHEN("It is filled") {
+      for (int i = 0; i < 4; ++i)
+        REQUIRE_FALSE(uut.insert(static_cast<uint64_t>(100 + i), i).has_value());
+
+      THEN("Every entry hits") {
+        REQUIRE(uut.occupancy() == 4);
+        for (int i = 0; i < 4; ++i) {
+          REQUIRE(uut.find(static_cast<uint64_t>(100 + i)) != nullptr);
+          REQUIRE(*uut.find(static_cast<uint64_t>(100 + i)) == i);
+        }
+      }
+
+      AND_WHEN("Another key is inserted") {
+        auto evicted = uut.insert(200, 42);
+
+        THEN("One entry is replaced") {
+          REQUIRE(evicted.has_value());
+          REQUIRE(uut.find(evicted->first) == nullptr);
+          REQUIRE(*uut.find(200) == 42);
+          REQUIRE(uut.occupancy() == 4);
+        }
+      }
+
+      AND_WHEN("An entry is erased") {
+        auto erased = uut.erase(102);
+
+        THEN("Its data is returned and it misses") {
+          REQUIRE(erased.has_value());
+          REQUIRE(erased.value() == 2);
+          REQUIRE(uut.find(102) == nullptr);
+        }
+
+        THEN("The next insertion replaces nothing") {
+          REQUIRE_FALSE(uut.insert(200, 42).has_value());
+        }
+      }
+    }
+  }
+}
+
+TEMPLATE_TEST_CASE("A CAM does not replace its most recently used entry", "", champsim::msl::lru_policy<4>, champsim::msl::plru_policy<4>,
+    champsim::msl::srrip_policy<4>) {
+  GIVEN("A full CAM") {
+    champsim::msl::cam<int, 4, TestType> uut;
+    for (int i = 0; i < 4; ++i)
+      uut.insert(static_cast<uint64_t>(i), i);
+
+    WHEN("An entry is used, and new keys are inserted") {
+      REQUIRE(uut.touch(2) != nullptr);
+      auto evicted = uut.insert(10, 10);
+
+      THEN("The used entry is kept") {
+        REQUIRE(evicted.has_value());
+        REQUIRE(evicted->first != 2);
+        REQUIRE(uut.find(2) != nullptr);
+      }
+    }
+  }
+}
+
+SCENARIO("An LRU CAM replaces its least recently used entry") {
+  GIVEN("A full CAM") {
+    champsim::msl::cam<int, 4> uut;
+    for (int i = 0; i < 4; ++i)
+      uut.insert(static_cast<uint64_t>(i), i);
+
+    WHEN("All but one entry are used") {
+      uut.touch(3);
+      uut.touch(0);
+      uut.touch(2);
+
+      THEN("The remaining entry is replaced") {
+        auto evicted = uut.insert(10, 10);
+        REQUIRE(evicted.has_value());
+        REQUIRE(evicted->first == 1);
+        REQUIRE(evicted->second == 1);
+      }
+    }
+
+    WHEN("An entry is found without being used") {
+      REQUIRE(uut.find(0) != nullptr);
+
+      THEN("It is still the least recently used") {
+        auto evicted = uut.insert(10, 10);
+        REQUIRE(evicted.has_value());
+        REQUIRE(evicted->first == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("A set-associative table keeps keys in their own sets") {
+  GIVEN("A table with four sets of two ways") {
+    champsim::msl::set_assoc_table<int, 2> uut{4};
+
+    WHEN("Three keys of the same set are inserted") {
+      uut.insert(1, 1);
+      uut.insert(5, 5);
+      uut.insert(2, 2);
+      auto evicted = uut.insert(9, 9);
+
+      THEN("Only that set replaces an entry") {
+        REQUIRE(evicted.has_value());
+        REQUIRE(evicted->first == 1);
+        REQUIRE(uut.find(2) != nullptr);
+        REQUIRE(uut.occupancy() == 3);
+      }
+    }
+
+    WHEN("An existing key is inserted again") {
+      uut.insert(1, 1);
+      auto evicted = uut.insert(1, 2);
+
+      THEN("Its data is overwritten") {
+        REQUIRE_FALSE(evicted.has_value());
+        REQUIRE(*uut.find(1) == 2);
+        REQUIRE(uut.occupancy() == 1);
+      }
+    }
+
+    WHEN("Several keys are inserted") {
+      for (uint64_t key : {3, 4, 7, 8})
+        uut.insert(key, static_cast<int>(key));
+
+      THEN("Every entry is visited") {
+        std::vector<uint64_t> keys;
+        uut.for_each([&](auto key, auto value) {
+          REQUIRE(key == static_cast<uint64_t>(value));
+          keys.push_back(key);
+        });
+        REQUIRE_THAT(keys, Catch::Matchers::UnorderedEquals(std::vector<uint64_t>{3, 4, 7, 8}));
+      }
+    }
+  }
+}
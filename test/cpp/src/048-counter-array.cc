@@ -0,0 +1,55 @@
+#include <catch.hpp>
+#include "msl/counter_array.h"
+
+TEMPLATE_TEST_CASE_SIG("A counter array saturates each counter independently", "", ((std::size_t BITS), BITS), 1, 3, 4, 5, 12) {
+  constexpr std::size_t size = 70;
+  constexpr auto maximum = (1u << BITS) - 1;
+  champsim::msl::counter_array<BITS, size> uut{};
+
+  STATIC_REQUIRE(decltype(uut)::maximum == maximum);
+
+  GIVEN("Counters that are all zero") {
+    THEN("Decrementing leaves them at zero") {
+      uut.decrement(0);
+      REQUIRE(uut[0] == 0);
+    }
+
+    WHEN("Every other counter is incremented past its maximum") {
+      for (std::size_t i = 0; i < size; i += 2)
+        for (unsigned j = 0; j < maximum + 2; ++j)
+          uut.increment(i);
+
+      THEN("They saturate, and their neighbors are unchanged") {
+        for (std::size_t i = 0; i < size; ++i)
+          REQUIRE(uut[i] == (i % 2 == 0 ? maximum : 0));
+      }
+
+      AND_WHEN("One is decremented") {
+        uut.decrement(size - 2);
+
+        THEN("Only it changes") {
+          REQUIRE(uut[size - 2] == maximum - 1);
+          REQUIRE(uut[size - 4] == maximum);
+        }
+      }
+    }
+  }
+
+  GIVEN("Counters filled with a value") {
+    uut.fill(1);
+
+    THEN("Every counter has the value") {
+      for (std::size_t i = 0; i < size; ++i)
+        REQUIRE(uut[i] == 1);
+    }
+
+    WHEN("A counter is set beyond its maximum") {
+      uut.set(size - 1, maximum + 10);
+
+      THEN("It is clamped") {
+        REQUIRE(uut[size - 1] == maximum);
+        REQUIRE(uut[size - 2] == 1);
+      }
+    }
+  }
+}
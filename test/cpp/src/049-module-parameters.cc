@@ -0,0 +1,58 @@
+#include <catch.hpp>
+#include "module_parameters.h"
+
+SCENARIO("Module parameters take their defaults unless given") {
+  GIVEN("A set of parameters") {
+    champsim::module_parameters uut{{"NUM_OFFSETS", "8"}, {"ENABLE", "true"}, {"RATIO", "0.25"}, {"MASK", "0x3f"}, {"NAME", "abc"}};
+
+    THEN("Given parameters are parsed as the declared type") {
+      REQUIRE(uut.get<unsigned>("NUM_OFFSETS", 4) == 8);
+      REQUIRE(uut.get<bool>("ENABLE", false));
+      REQUIRE(uut.get<double>("RATIO", 1.0) == 0.25);
+      REQUIRE(uut.get<uint64_t>("MASK", 0) == 0x3f);
+      REQUIRE(uut.get("NAME", "xyz") == "abc");
+    }
+
+    THEN("Parameters that were not given take the default") {
+      REQUIRE(uut.get<int>("SCORE_MAX", 31) == 31);
+      REQUIRE(uut.get<bool>("DISABLE", true));
+    }
+
+    WHEN("A parameter is overridden") {
+      uut.set("NUM_OFFSETS=16");
+
+      THEN("The new value is used") {
+        REQUIRE(uut.get<unsigned>("NUM_OFFSETS", 4) == 16);
+      }
+    }
+
+    WHEN("Some parameters are declared") {
+      uut.get<unsigned>("NUM_OFFSETS", 4);
+      uut.get<bool>("ENABLE", false);
+      uut.get<int>("SCORE_MAX", 31);
+
+      THEN("The rest are undeclared") {
+        REQUIRE_THAT(uut.undeclared(), Catch::Matchers::UnorderedEquals(std::vector<std::string>{"MASK", "NAME", "RATIO"}));
+      }
+    }
+  }
+}
+
+SCENARIO("Module parameters reject values that do not parse") {
+  GIVEN("A set of malformed parameters") {
+    champsim::module_parameters uut{{"SIZE", "12abc"}, {"NEGATIVE", "-1"}, {"FLAG", "yes"}, {"RATIO", ""}, {"BIG", "300"}};
+
+    THEN("Declaring them throws") {
+      REQUIRE_THROWS_AS(uut.get<int>("SIZE", 0), std::invalid_argument);
+      REQUIRE_THROWS_AS(uut.get<unsigned>("NEGATIVE", 0), std::invalid_argument);
+      REQUIRE_THROWS_AS(uut.get<bool>("FLAG", false), std::invalid_argument);
+      REQUIRE_THROWS_AS(uut.get<double>("RATIO", 0.0), std::invalid_argument);
+      REQUIRE_THROWS_AS(uut.get<uint8_t>("BIG", 0), std::invalid_argument);
+    }
+
+    THEN("Assignments must have a name and a value") {
+      REQUIRE_THROWS_AS(uut.set("SIZE"), std::invalid_argument);
+      REQUIRE_THROWS_AS(uut.set("=8"), std::invalid_argument);
+    }
+  }
+}
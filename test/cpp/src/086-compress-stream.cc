@@ -0,0 +1,45 @@
+#include <catch.hpp>
+
+#include <sstream>
+
+#include "inf_stream.h"
+
+namespace
+{
+template <typename Tag>
+std::string round_trip(const std::string& plaintext)
+{
+  std::ostringstream compressed;
+  {
+    champsim::inf_ostream<Tag, std::ostringstream> comp_stream{std::ostringstream{}};
+    comp_stream.write(plaintext.data(), static_cast<std::streamsize>(std::size(plaintext)));
+    comp_stream.close();
+    compressed << comp_stream.underlying->str();
+  }
+
+  champsim::inf_istream<Tag, std::istringstream> decomp_stream{std::istringstream{compressed.str()}};
+  std::string result(std::size(plaintext) + 1, '\0');
+  decomp_stream.read(result.data(), static_cast<std::streamsize>(std::size(result)));
+  result.resize(static_cast<std::size_t>(decomp_stream.gcount()));
+  return result;
+}
+} // namespace
+
+TEST_CASE("A compressed stream can be decompressed") {
+  // Long enough to span several internal buffers
+  std::string plaintext;
+  for (unsigned i = 0; plaintext.size() < (1u << 18); ++i)
+    plaintext += "Lorem ipsum dolor sit amet " + std::to_string(i) + "\n";
+
+  SECTION("gzip") {
+    REQUIRE(round_trip<champsim::decomp_tags::gzip_tag_t<>>(plaintext) == plaintext);
+  }
+
+  SECTION("lzma") {
+    REQUIRE(round_trip<champsim::decomp_tags::lzma_tag_t<>>(plaintext) == plaintext);
+  }
+
+  SECTION("bzip2") {
+    REQUIRE(round_trip<champsim::decomp_tags::bzip2_tag_t>(plaintext) == plaintext);
+  }
+}
@@ -0,0 +1,82 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "ooo_cpu.h"
+#include "instr.h"
+
+SCENARIO("The fetch target queue issues instruction prefetches ahead of fetch") {
+  GIVEN("An input queue with instructions spanning several cache blocks") {
+    constexpr std::array<uint64_t, 8> addrs{{0x1000, 0x1004, 0x1040, 0x1044, 0x1080, 0x1084, 0x10c0, 0x10c4}};
+
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE l1i{CACHE::Builder{champsim::defaults::default_l1i}
+      .name("155-l1i")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+    };
+
+    do_nothing_MRC mock_L1I;
+    do_nothing_MRC mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .ftq_size(16)
+      .prediction_width(8)
+      .l1i(&l1i)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+
+    uut.initialize();
+    std::for_each(std::begin(addrs), std::end(addrs), [&](auto x){ uut.input_queue.push_back(champsim::test::instruction_with_ip(x)); });
+
+    WHEN("The core operates for one cycle") {
+      uut._operate();
+
+      THEN("The predicted instructions are placed in the FTQ") {
+        REQUIRE(std::size(uut.FETCH_TARGET_QUEUE) == std::size(addrs));
+        REQUIRE(std::empty(uut.input_queue));
+      }
+
+      THEN("One prefetch is issued for each cache block") {
+        REQUIRE(l1i.get_pq_occupancy().back() == 4);
+      }
+    }
+  }
+}
+
+SCENARIO("The FTQ size limits how far prediction runs ahead") {
+  auto size = GENERATE(as<std::size_t>{}, 1, 2, 4);
+  GIVEN("An input queue with many instructions") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE l1i{CACHE::Builder{champsim::defaults::default_l1i}
+      .name("155-l1i")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+    };
+
+    do_nothing_MRC mock_L1I;
+    do_nothing_MRC mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .ftq_size(size)
+      .prediction_width(8)
+      .l1i(&l1i)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+
+    uut.initialize();
+    for (uint64_t i = 0; i < 8; ++i)
+      uut.input_queue.push_back(champsim::test::instruction_with_ip(0x1000 + 4*i));
+
+    WHEN("The core operates for one cycle") {
+      uut._operate();
+
+      THEN("The FTQ is filled to its capacity") {
+        REQUIRE(std::size(uut.FETCH_TARGET_QUEUE) == size);
+        REQUIRE(std::size(uut.input_queue) == 8 - size);
+      }
+    }
+  }
+}
@@ -0,0 +1,105 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "ooo_cpu.h"
+#include "instr.h"
+
+SCENARIO("The number of execution ports limits how many instructions of a class execute each cycle") {
+  auto ports = GENERATE(as<unsigned>{}, 1, 2, 3);
+  GIVEN("A ROB with many ready ALU instructions") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .execute_width(4)
+      .execution_port(instr_class::ALU, ports, 1, true)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+
+    for (uint64_t i = 0; i < 8; ++i) {
+      uut.ROB.push_back(champsim::test::instruction_with_ip(1));
+      uut.ROB.back().instr_id = i;
+      uut.ROB.back().scheduled = COMPLETED;
+      uut.ROB.back().event_cycle = uut.current_cycle;
+    }
+
+    WHEN("The core operates for one cycle") {
+      uut._operate();
+
+      THEN("Only as many instructions as there are ports begin executing") {
+        auto count = std::count_if(std::begin(uut.ROB), std::end(uut.ROB), [](const auto& x){ return x.executed != 0; });
+        REQUIRE(count == static_cast<long>(ports));
+      }
+    }
+  }
+}
+
+SCENARIO("An unpipelined port is busy for its entire latency") {
+  GIVEN("A ROB with two ready ALU instructions and a single unpipelined ALU port") {
+    constexpr unsigned latency = 4;
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .execution_port(instr_class::ALU, 1, latency, false)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+    uut.warmup = false;
+
+    for (uint64_t i = 0; i < 2; ++i) {
+      uut.ROB.push_back(champsim::test::instruction_with_ip(1));
+      uut.ROB.back().instr_id = i;
+      uut.ROB.back().scheduled = COMPLETED;
+      uut.ROB.back().event_cycle = uut.current_cycle;
+    }
+
+    WHEN("The core operates for fewer cycles than the latency") {
+      for (unsigned i = 0; i < latency; ++i)
+        uut._operate();
+
+      THEN("The second instruction has not begun executing") {
+        REQUIRE(uut.ROB.at(0).executed != 0);
+        REQUIRE(uut.ROB.at(0).event_cycle == latency);
+        REQUIRE(uut.ROB.at(1).executed == 0);
+      }
+    }
+
+    WHEN("The core operates for the latency") {
+      for (unsigned i = 0; i <= latency; ++i)
+        uut._operate();
+
+      THEN("The second instruction begins executing") {
+        REQUIRE(uut.ROB.at(1).executed != 0);
+      }
+    }
+  }
+}
+
+SCENARIO("A read-modify-write instruction occupies both a load port and a store port") {
+  GIVEN("A ROB with two ready read-modify-write instructions, two load ports, and one store port") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .execution_port(instr_class::LOAD, 2, 1, true)
+      .execution_port(instr_class::STORE, 1, 1, true)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+
+    for (uint64_t i = 0; i < 2; ++i) {
+      uut.ROB.push_back(champsim::test::instruction_with_ip(1));
+      uut.ROB.back().instr_id = i;
+      uut.ROB.back().exec_class = instr_class::LOAD;
+      uut.ROB.back().source_memory.push_back(0xdeadbeef);
+      uut.ROB.back().destination_memory.push_back(0xdeadbeef);
+      uut.ROB.back().scheduled = COMPLETED;
+      uut.ROB.back().event_cycle = uut.current_cycle;
+    }
+
+    WHEN("The core operates for one cycle") {
+      uut._operate();
+
+      THEN("Only one instruction begins executing, because the store port is busy") {
+        REQUIRE(uut.ROB.at(0).executed != 0);
+        REQUIRE(uut.ROB.at(1).executed == 0);
+      }
+    }
+  }
+}
@@ -0,0 +1,84 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "ooo_cpu.h"
+#include "instr.h"
+
+namespace
+{
+void add_store_load_pair(O3_CPU& uut, uint64_t first_id)
+{
+  auto store = champsim::test::instruction_with_ip(0x4000);
+  store.instr_id = first_id;
+  store.destination_memory.push_back(0xdeadbeef);
+
+  auto load = champsim::test::instruction_with_ip(0x4040);
+  load.instr_id = first_id + 1;
+  load.source_memory.push_back(0xdeadbeef);
+
+  uut.DISPATCH_BUFFER.push_back(store);
+  uut.DISPATCH_BUFFER.push_back(load);
+}
+}
+
+SCENARIO("Without a memory dependence predictor, loads are perfectly disambiguated") {
+  GIVEN("A store and a dependent load in the dispatch buffer") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+
+    uut.initialize();
+    add_store_load_pair(uut, 1);
+
+    WHEN("The instructions are dispatched") {
+      for (int i = 0; i < 2; ++i)
+        for (auto op : std::array<champsim::operable*,3>{{&uut, &mock_L1I, &mock_L1D}})
+          op->_operate();
+
+      THEN("No memory order violation occurs") {
+        REQUIRE(std::size(uut.ROB) == 2);
+        REQUIRE(uut.sim_stats.memory_order_violations == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("The store set predictor learns a dependence after a violation") {
+  GIVEN("A core with a store set predictor and a store and dependent load in the dispatch buffer") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+      .memory_replay_penalty(10)
+      .memory_dependence_predictor<O3_CPU::mmemdepDstore_set>()
+    };
+
+    uut.initialize();
+    add_store_load_pair(uut, 1);
+
+    WHEN("The instructions are dispatched") {
+      for (int i = 0; i < 2; ++i)
+        for (auto op : std::array<champsim::operable*,3>{{&uut, &mock_L1I, &mock_L1D}})
+          op->_operate();
+
+      THEN("The untrained predictor causes a memory order violation") {
+        REQUIRE(std::size(uut.ROB) == 2);
+        REQUIRE(uut.sim_stats.memory_order_violations == 1);
+      }
+
+      AND_WHEN("The same store and load are dispatched again") {
+        add_store_load_pair(uut, 3);
+        for (int i = 0; i < 2; ++i)
+          for (auto op : std::array<champsim::operable*,3>{{&uut, &mock_L1I, &mock_L1D}})
+            op->_operate();
+
+        THEN("The load is predicted to wait on the store") {
+          REQUIRE(std::size(uut.ROB) == 4);
+          REQUIRE(uut.sim_stats.memory_order_violations == 1);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,131 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "ooo_cpu.h"
+#include "instr.h"
+
+SCENARIO("Each cycle is attributed to exactly one cause") {
+  GIVEN("An empty core") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+    uut.warmup = false;
+    uut.begin_phase();
+
+    WHEN("The core operates with nothing to do") {
+      constexpr uint64_t cycles = 10;
+      for (uint64_t i = 0; i < cycles; ++i)
+        for (auto op : std::array<champsim::operable*,3>{{&uut, &mock_L1I, &mock_L1D}})
+          op->_operate();
+
+      THEN("Every cycle is a front-end stall") {
+        REQUIRE(uut.sim_stats.stall_cycles[champsim::to_underlying(stall_type::FRONTEND_FETCH_STALL)] == cycles);
+      }
+    }
+
+    WHEN("An instruction is waiting in the instruction fetch buffer") {
+      uut.IFETCH_BUFFER.push_back(champsim::test::instruction_with_ip(1));
+      uut._operate();
+
+      THEN("The cycle is attributed to the instruction cache") {
+        REQUIRE(uut.sim_stats.stall_cycles[champsim::to_underlying(stall_type::FRONTEND_ICACHE)] == 1);
+      }
+    }
+
+    WHEN("An instruction is waiting to be decoded") {
+      uut.DECODE_BUFFER.push_back(champsim::test::instruction_with_ip(1));
+      uut.DECODE_BUFFER.back().event_cycle = std::numeric_limits<uint64_t>::max();
+      uut._operate();
+
+      THEN("The cycle is attributed to a decoded instruction buffer miss") {
+        REQUIRE(uut.sim_stats.stall_cycles[champsim::to_underlying(stall_type::FRONTEND_DIB_MISS)] == 1);
+      }
+    }
+
+    WHEN("An instruction that hit in the decoded instruction buffer is passing through decode") {
+      uut.DECODE_BUFFER.push_back(champsim::test::instruction_with_ip(1));
+      uut.DECODE_BUFFER.back().dib_hit = true;
+      uut.DECODE_BUFFER.back().event_cycle = std::numeric_limits<uint64_t>::max();
+      uut._operate();
+
+      THEN("The cycle is not attributed to a decoded instruction buffer miss") {
+        REQUIRE(uut.sim_stats.stall_cycles[champsim::to_underlying(stall_type::FRONTEND_DIB_MISS)] == 0);
+        REQUIRE(uut.sim_stats.stall_cycles[champsim::to_underlying(stall_type::FRONTEND_FETCH_STALL)] == 1);
+      }
+    }
+
+    WHEN("A completed instruction is at the head of the ROB") {
+      uut.ROB.push_back(champsim::test::instruction_with_ip(1));
+      uut.ROB.back().executed = COMPLETED;
+      uut._operate();
+
+      THEN("The cycle is attributed to the base") {
+        REQUIRE(uut.sim_stats.stall_cycles[champsim::to_underlying(stall_type::BASE)] == 1);
+      }
+    }
+
+    WHEN("A mispredicted branch resolves") {
+      uut.ROB.push_back(champsim::test::instruction_with_ip(1));
+      uut.ROB.back().is_branch = true;
+      uut.ROB.back().branch_mispredicted = 1;
+      uut.ROB.back().executed = INFLIGHT;
+      uut.ROB.back().event_cycle = uut.current_cycle;
+
+      for (int i = 0; i < 5; ++i)
+        uut._operate();
+
+      THEN("The cycles waiting for the correct path are attributed to bad speculation") {
+        REQUIRE(std::empty(uut.ROB));
+        REQUIRE(uut.sim_stats.stall_cycles[champsim::to_underlying(stall_type::BAD_SPECULATION)] > 0);
+        REQUIRE(uut.sim_stats.stall_cycles[champsim::to_underlying(stall_type::FRONTEND_FETCH_STALL)] == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("A load at the head of the ROB stalls on the level that serves it") {
+  using namespace std::literals;
+  GIVEN("A core with a load waiting on the data cache") {
+    do_nothing_MRC mock_L1I;
+    release_MRC mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+    uut.initialize();
+    uut.warmup = false;
+    uut.begin_phase();
+
+    auto load = champsim::test::instruction_with_ip(0x4040);
+    load.source_memory.push_back(0xdeadbeef);
+    uut.DISPATCH_BUFFER.push_back(load);
+
+    for (int i = 0; i < 20; ++i)
+      for (auto op : std::array<champsim::operable*,3>{{&uut, &mock_L1I, &mock_L1D}})
+        op->_operate();
+
+    THEN("The load has been issued and the core is stalled on memory") {
+      REQUIRE(mock_L1D.packet_count() == 1);
+      REQUIRE(std::size(uut.ROB) == 1);
+      REQUIRE(uut.sim_stats.stall_cycles[champsim::to_underlying(stall_type::MEMORY)] > 0);
+      REQUIRE(std::empty(uut.sim_stats.memory_stall_cycles));
+    }
+
+    WHEN("The data is returned") {
+      mock_L1D.release_all();
+      for (auto& response : mock_L1D.queues.returned)
+        response.served_by = "301-serving-level"sv;
+
+      for (int i = 0; i < 20; ++i)
+        for (auto op : std::array<champsim::operable*,3>{{&uut, &mock_L1I, &mock_L1D}})
+          op->_operate();
+
+      THEN("The stall is attributed to the level that returned the data") {
+        REQUIRE(std::empty(uut.ROB));
+        REQUIRE(uut.sim_stats.memory_stall_cycles.at("301-serving-level") == uut.sim_stats.stall_cycles[champsim::to_underlying(stall_type::MEMORY)]);
+      }
+    }
+  }
+}
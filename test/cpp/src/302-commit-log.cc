@@ -0,0 +1,96 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "ooo_cpu.h"
+#include "instr.h"
+#include "commit_log.h"
+
+#include <cstdio>
+#include <filesystem>
+
+SCENARIO("The commit log records retired instructions") {
+  using namespace std::literals;
+  GIVEN("A commit log with several instructions") {
+    auto filename = (std::filesystem::temp_directory_path() / "302-commit-log.gz").string();
+    constexpr uint64_t num_instrs = 10000;
+
+    {
+      champsim::commit_log_writer writer{filename};
+      for (uint64_t i = 0; i < num_instrs; ++i) {
+        auto instr = champsim::test::instruction_with_ip(0x1000 + 4 * i);
+        instr.instr_id = i;
+        instr.fetch_cycle = i;
+        instr.decode_cycle = i + 1;
+        instr.dispatch_cycle = i + 2;
+        instr.execute_cycle = i + 3;
+        if (i % 2 == 0) {
+          instr.source_memory.push_back(0xdeadbeef + i);
+          instr.source_memory_served_by[0] = (i % 4 == 0) ? "302-L1D"sv : "302-LLC"sv;
+        }
+        writer.log(instr, i + 10);
+      }
+    }
+
+    WHEN("The log is read back") {
+      champsim::commit_log_reader reader{filename};
+      std::vector<champsim::commit_record> records;
+      for (auto record = reader.next(); record.has_value(); record = reader.next())
+        records.push_back(*record);
+
+      THEN("Every instruction is recorded in order with its timing and serving levels") {
+        REQUIRE(std::size(records) == num_instrs);
+        for (uint64_t i = 0; i < num_instrs; ++i) {
+          CHECK(records[i].instr_id == i);
+          CHECK(records[i].ip == 0x1000 + 4 * i);
+          CHECK(records[i].fetch_cycle == i);
+          CHECK(records[i].execute_cycle == i + 3);
+          CHECK(records[i].retire_cycle == i + 10);
+          if (i % 2 == 0) {
+            REQUIRE(std::size(records[i].loads) == 1);
+            CHECK(records[i].loads[0].address == 0xdeadbeef + i);
+            CHECK(records[i].loads[0].served_by == ((i % 4 == 0) ? "302-L1D" : "302-LLC"));
+          } else {
+            CHECK(std::empty(records[i].loads));
+          }
+        }
+      }
+    }
+
+    std::remove(filename.c_str());
+  }
+}
+
+SCENARIO("A core records its retired instructions in the commit log") {
+  GIVEN("A core with a commit log and a completed instruction") {
+    auto filename = (std::filesystem::temp_directory_path() / "302-core-commit-log.gz").string();
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+    uut.warmup = false;
+    uut.commit_log = std::make_unique<champsim::commit_log_writer>(filename);
+
+    uut.ROB.push_back(champsim::test::instruction_with_ip(0x4040));
+    uut.ROB.back().instr_id = 7;
+    uut.ROB.back().executed = COMPLETED;
+
+    WHEN("The instruction retires") {
+      uut._operate();
+      uut.commit_log.reset();
+
+      THEN("It appears in the log") {
+        champsim::commit_log_reader reader{filename};
+        auto record = reader.next();
+        REQUIRE(record.has_value());
+        CHECK(record->instr_id == 7);
+        CHECK(record->ip == 0x4040);
+        CHECK(record->retire_cycle == uut.current_cycle - 1);
+        CHECK_FALSE(reader.next().has_value());
+      }
+    }
+
+    uut.commit_log.reset();
+    std::remove(filename.c_str());
+  }
+}
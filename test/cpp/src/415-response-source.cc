@@ -0,0 +1,67 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+
+SCENARIO("A response carries the name of the level that supplied the data") {
+  using namespace std::literals;
+  GIVEN("An empty cache") {
+    std::string_view served_by{};
+    release_MRC mock_ll;
+    to_rq_MRP mock_ul{[&](auto req, auto resp) {
+      served_by = resp.served_by;
+      return req.address == resp.address;
+    }};
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("415-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_ll, &mock_ul}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A packet misses and is filled from the lower level") {
+      decltype(mock_ul)::request_type seed;
+      seed.address = 0xdeadbeef;
+      seed.is_translated = true;
+      seed.cpu = 0;
+      auto seed_result = mock_ul.issue(seed);
+
+      for (auto i = 0; i < 10; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      mock_ll.release_all();
+      for (auto& response : mock_ll.queues.returned)
+        response.served_by = "415-lower"sv;
+
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("The response names the lower level") {
+        REQUIRE(seed_result);
+        REQUIRE(mock_ul.packets.front().return_time > 0);
+        REQUIRE(served_by == "415-lower");
+      }
+
+      AND_WHEN("A packet with the same address is sent") {
+        auto test_result = mock_ul.issue(seed);
+        for (auto i = 0; i < 100; ++i)
+          for (auto elem : elements)
+            elem->_operate();
+
+        THEN("The hit response names this cache") {
+          REQUIRE(test_result);
+          REQUIRE(served_by == "415-uut");
+        }
+      }
+    }
+  }
+}
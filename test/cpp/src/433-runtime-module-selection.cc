@@ -0,0 +1,225 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "runtime_config.h"
+
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace test
+{
+  extern std::map<CACHE*, std::vector<uint64_t>> address_operate_collector;
+}
+
+namespace
+{
+  struct cache_only_environment final : champsim::environment {
+    CACHE& cache;
+    explicit cache_only_environment(CACHE& c) : cache(c) {}
+
+    std::vector<std::reference_wrapper<O3_CPU>> cpu_view() override { return {}; }
+    std::vector<std::reference_wrapper<CACHE>> cache_view() override { return {std::ref(cache)}; }
+    std::vector<std::reference_wrapper<PageTableWalker>> ptw_view() override { return {}; }
+    MEMORY_CONTROLLER& dram_view() override { throw std::logic_error{"No memory in this environment"}; }
+    std::vector<std::reference_wrapper<MEMORY_CONTROLLER>> memory_view() override { return {}; }
+    VirtualMemory& vmem_view() override { throw std::logic_error{"No virtual memory in this environment"}; }
+    std::vector<std::reference_wrapper<champsim::operable>> operable_view() override { return {std::ref<champsim::operable>(cache)}; }
+  };
+}
+
+SCENARIO("A prefetcher can be selected at run time") {
+  GIVEN("A cache configured without a prefetcher") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("433a-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+    };
+
+    WHEN("A compiled prefetcher is selected by name") {
+      uut.select_prefetcher({"address_collector"});
+
+      std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+      for (auto elem : elements) {
+        elem->initialize();
+        elem->warmup = false;
+        elem->begin_phase();
+      }
+
+      decltype(mock_ul)::request_type seed;
+      seed.address = 0xdead'beef;
+      seed.cpu = 0;
+      auto seed_result = mock_ul.issue(seed);
+
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("The prefetcher sees the access") {
+        REQUIRE(seed_result);
+        REQUIRE_THAT(test::address_operate_collector[&uut], Catch::Matchers::Equals(std::vector<uint64_t>{seed.address}));
+      }
+    }
+
+    THEN("A prefetcher that was not compiled cannot be selected") {
+      REQUIRE_THROWS_AS(uut.select_prefetcher({"no_such_prefetcher"}), std::invalid_argument);
+    }
+  }
+}
+
+SCENARIO("A configuration file selects the modules of the caches it names") {
+  GIVEN("A cache named like the last-level cache") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_llc}
+      .name("LLC")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+    };
+    cache_only_environment env{uut};
+
+    WHEN("A configuration gives its prefetcher and parameters in two places") {
+      std::istringstream config{R"({
+        "LLC": { "prefetcher": "prefetcher/address_collector", "prefetch_activate": "LOAD, WRITE", "prefetcher_params": { "DEGREE": 1, "ENABLE": true } },
+        "caches": [ { "name": "LLC", "prefetcher_params": { "DEGREE": 2 } } ]
+      })"};
+      champsim::apply_runtime_config(env, config);
+
+      THEN("The parameters of higher precedence are kept") {
+        REQUIRE(uut.prefetcher_params.get<int>("DEGREE", 0) == 2);
+        REQUIRE(uut.prefetcher_params.get<bool>("ENABLE", false));
+      }
+
+      THEN("The prefetch activation is replaced") {
+        REQUIRE(uut.pref_activate_mask == ((1u << champsim::to_underlying(access_type::LOAD)) | (1u << champsim::to_underlying(access_type::WRITE))));
+      }
+
+      THEN("The prefetcher is selected") {
+        uut.initialize();
+        uut.warmup = false;
+        uut.begin_phase();
+
+        decltype(mock_ul)::request_type seed;
+        seed.address = 0xcafe'f000;
+        seed.cpu = 0;
+        REQUIRE(mock_ul.issue(seed));
+
+        for (auto i = 0; i < 100; ++i) {
+          mock_ul._operate();
+          uut._operate();
+          mock_ll._operate();
+        }
+
+        REQUIRE_THAT(test::address_operate_collector[&uut], Catch::Matchers::Equals(std::vector<uint64_t>{seed.address}));
+      }
+    }
+
+    WHEN("A configuration gives a prefetch arbiter") {
+      std::istringstream config{R"({
+        "LLC": { "prefetcher": ["metadata_collector", "address_collector"], "prefetch_arbiter": { "policy": "confidence", "issue_budget": 2 } }
+      })"};
+      champsim::apply_runtime_config(env, config);
+
+      THEN("The arbiter is configured, and gives priority in the order the prefetchers are named") {
+        REQUIRE(uut.pf_arbiter.has_value());
+        REQUIRE(uut.pf_arbiter->get_config().order == champsim::prefetch_arbiter::policy::CONFIDENCE);
+        REQUIRE(uut.pf_arbiter->get_config().issue_budget == 2);
+
+        uut.initialize();
+        auto first = champsim::select_modules(CACHE::prefetcher_registry(), {"metadata_collector"}, "prefetcher");
+        auto second = champsim::select_modules(CACHE::prefetcher_registry(), {"address_collector"}, "prefetcher");
+        REQUIRE(uut.pf_arbiter->sources() == std::vector<unsigned long long>{first, second});
+      }
+    }
+
+    WHEN("A configuration gives a prefetch throttle") {
+      std::istringstream config{R"({
+        "LLC": { "prefetch_throttle": { "interval": 100, "degrees": [1, 2] } }
+      })"};
+      champsim::apply_runtime_config(env, config);
+
+      THEN("The throttle is configured, and keys that are not given take their defaults") {
+        REQUIRE(uut.pf_throttle.has_value());
+        REQUIRE(uut.pf_throttle->get_config().interval == 100);
+        REQUIRE(uut.pf_throttle->get_config().degrees == std::vector<std::size_t>{1, 2});
+        REQUIRE(uut.pf_throttle->get_config().accuracy_high == Approx(0.75));
+      }
+    }
+
+    WHEN("A configuration gives a prefetch sandbox") {
+      std::istringstream config{R"({
+        "LLC": { "prefetch_sandbox": { "interval": 100 } }
+      })"};
+      champsim::apply_runtime_config(env, config);
+
+      THEN("The sandbox is configured, and keys that are not given take their defaults") {
+        REQUIRE(uut.pf_sandbox.has_value());
+        REQUIRE(uut.pf_sandbox->get_config().interval == 100);
+        REQUIRE(uut.pf_sandbox->get_config().shadow_ways == 8);
+      }
+    }
+
+    WHEN("A configuration gives a prefetch queue policy") {
+      std::istringstream config{R"({
+        "LLC": { "prefetch_queue": { "drop_redundant": true, "mshr_reserve": 2 } }
+      })"};
+      champsim::apply_runtime_config(env, config);
+
+      THEN("The policy is configured, and keys that are not given take their defaults") {
+        REQUIRE(uut.pq_policy.drop_redundant);
+        REQUIRE(uut.pq_policy.mshr_reserve == 2);
+        REQUIRE_FALSE(uut.pq_policy.confidence_order);
+        REQUIRE(uut.pq_policy.max_age == 0);
+      }
+    }
+
+    THEN("A configuration that describes the cache as it was built is accepted") {
+      std::istringstream config{"{ \"LLC\": { \"sets\": " + std::to_string(uut.NUM_SET) + ", \"ways\": 16, \"latency\": 20, \"mshr_size\": "
+                                + std::to_string(uut.MSHR_SIZE) + " } }"};
+      REQUIRE_NOTHROW(champsim::apply_runtime_config(env, config));
+    }
+
+    THEN("A configuration that gives the cache another size is rejected") {
+      std::istringstream config{"{ \"LLC\": { \"sets\": " + std::to_string(2 * uut.NUM_SET) + " } }"};
+      REQUIRE_THROWS_AS(champsim::apply_runtime_config(env, config), std::invalid_argument);
+    }
+
+    THEN("A configuration that gives the cache another latency is rejected") {
+      std::istringstream config{R"({ "LLC": { "latency": 40 } })"};
+      REQUIRE_THROWS_AS(champsim::apply_runtime_config(env, config), std::invalid_argument);
+    }
+
+    THEN("A configuration that connects the cache to another lower level is rejected") {
+      std::istringstream config{R"({ "caches": [ { "name": "LLC", "lower_level": "L4C" } ] })"};
+      REQUIRE_THROWS_AS(champsim::apply_runtime_config(env, config), std::invalid_argument);
+    }
+
+    THEN("A configuration with a prefetch queue policy that is not an object is rejected") {
+      std::istringstream config{R"({ "LLC": { "prefetch_queue": true } })"};
+      REQUIRE_THROWS_AS(champsim::apply_runtime_config(env, config), std::invalid_argument);
+    }
+
+    THEN("A configuration with a prefetch sandbox that is neither a boolean nor an object is rejected") {
+      std::istringstream config{R"({ "LLC": { "prefetch_sandbox": 100 } })"};
+      REQUIRE_THROWS_AS(champsim::apply_runtime_config(env, config), std::invalid_argument);
+    }
+
+    THEN("A configuration with an unknown arbiter policy is rejected") {
+      std::istringstream config{R"({ "LLC": { "prefetch_arbiter": { "policy": "random" } } })"};
+      REQUIRE_THROWS_AS(champsim::apply_runtime_config(env, config), std::invalid_argument);
+    }
+
+    THEN("A configuration that names a module that was not compiled is rejected") {
+      std::istringstream config{R"({ "LLC": { "replacement": "no_such_replacement" } })"};
+      REQUIRE_THROWS_AS(champsim::apply_runtime_config(env, config), std::invalid_argument);
+    }
+
+    THEN("A configuration that is not valid JSON is rejected") {
+      std::istringstream config{R"({ "LLC": )"};
+      REQUIRE_THROWS_AS(champsim::apply_runtime_config(env, config), std::invalid_argument);
+    }
+  }
+}
@@ -0,0 +1,243 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "prefetch_arbiter.h"
+
+#include <vector>
+
+namespace
+{
+  champsim::prefetch_arbiter::candidate candidate_from(std::size_t source, uint64_t address)
+  {
+    return {address, true, 0, 0, source};
+  }
+
+  std::vector<uint64_t> issue_all(champsim::prefetch_arbiter& uut)
+  {
+    std::vector<uint64_t> issued;
+    uut.issue([&issued](const auto& pf) {
+      issued.push_back(pf.address);
+      return true;
+    });
+    return issued;
+  }
+}
+
+SCENARIO("The prefetch arbiter numbers its sources in order of priority") {
+  GIVEN("An arbiter with a priority order") {
+    champsim::prefetch_arbiter uut{{champsim::prefetch_arbiter::policy::PRIORITY, 1, 8, 8, {4, 1}}, 6};
+
+    WHEN("It is given three prefetchers") {
+      uut.set_sources(1 | 2 | 4);
+
+      THEN("The prioritized prefetchers come first, then the rest") {
+        REQUIRE(uut.sources() == std::vector<unsigned long long>{4, 1, 2});
+        REQUIRE(uut.source_of(1) == 1);
+      }
+
+      THEN("An unknown prefetcher is given the lowest priority") {
+        REQUIRE(uut.source_of(8) == 2);
+      }
+    }
+  }
+}
+
+SCENARIO("The prefetch arbiter drops duplicates and overflows") {
+  using proposal_result = champsim::prefetch_arbiter::proposal_result;
+  GIVEN("An arbiter with a small queue") {
+    champsim::prefetch_arbiter uut{{champsim::prefetch_arbiter::policy::PRIORITY, 4, 8, 2, {}}, 6};
+    uut.set_sources(1 | 2);
+
+    WHEN("Two prefetchers propose the same block") {
+      auto first = uut.propose(candidate_from(0, 0xcafe'0000));
+      auto second = uut.propose(candidate_from(1, 0xcafe'0010));
+
+      THEN("Only the first is accepted") {
+        REQUIRE(first == proposal_result::ACCEPTED);
+        REQUIRE(second == proposal_result::DUPLICATE);
+        REQUIRE(uut.occupancy() == 1);
+      }
+
+      AND_WHEN("The block is issued and proposed again") {
+        issue_all(uut);
+        auto again = uut.propose(candidate_from(1, 0xcafe'0000));
+
+        THEN("The recent-prefetch filter drops it") {
+          REQUIRE(again == proposal_result::DUPLICATE);
+        }
+      }
+    }
+
+    WHEN("More blocks are proposed than the queue holds") {
+      uut.propose(candidate_from(0, 0xcafe'0000));
+      uut.propose(candidate_from(0, 0xcafe'1000));
+      auto overflow = uut.propose(candidate_from(0, 0xcafe'2000));
+
+      THEN("The last is dropped") {
+        REQUIRE(overflow == proposal_result::DROPPED);
+        REQUIRE(uut.occupancy() == 2);
+      }
+
+      AND_WHEN("Another source proposes a block") {
+        auto other = uut.propose(candidate_from(1, 0xcafe'3000));
+
+        THEN("It has its own queue") {
+          REQUIRE(other == proposal_result::ACCEPTED);
+          REQUIRE(uut.occupancy() == 3);
+        }
+      }
+    }
+  }
+
+  GIVEN("An arbiter that remembers no recent blocks") {
+    champsim::prefetch_arbiter uut{{champsim::prefetch_arbiter::policy::PRIORITY, 64, 0, 64, {}}, 6};
+    uut.set_sources(1);
+
+    WHEN("Many blocks are issued, and then proposed again") {
+      for (uint64_t i = 0; i < 64; ++i)
+        REQUIRE(uut.propose(candidate_from(0, i << 6)) == proposal_result::ACCEPTED);
+      issue_all(uut);
+
+      std::vector<proposal_result> results;
+      for (uint64_t i = 0; i < 64; ++i)
+        results.push_back(uut.propose(candidate_from(0, i << 6)));
+
+      THEN("None of them is a duplicate") {
+        REQUIRE(std::count(std::begin(results), std::end(results), proposal_result::ACCEPTED) == 64);
+      }
+    }
+  }
+
+  GIVEN("An arbiter that remembers one recent block") {
+    champsim::prefetch_arbiter uut{{champsim::prefetch_arbiter::policy::PRIORITY, 4, 1, 8, {}}, 6};
+    uut.set_sources(1 | 2);
+
+    WHEN("Two blocks are issued in turn, and the first is proposed again") {
+      uut.propose(candidate_from(0, 0xcafe'0000));
+      issue_all(uut);
+      uut.propose(candidate_from(0, 0xcafe'1000));
+      issue_all(uut);
+      auto first_again = uut.propose(candidate_from(1, 0xcafe'0000));
+      auto second_again = uut.propose(candidate_from(1, 0xcafe'1000));
+
+      THEN("Only the block that is still remembered is dropped") {
+        REQUIRE(first_again == proposal_result::ACCEPTED);
+        REQUIRE(second_again == proposal_result::DUPLICATE);
+      }
+    }
+  }
+}
+
+SCENARIO("The prefetch arbiter issues within its budget") {
+  GIVEN("A priority arbiter with a budget of two") {
+    champsim::prefetch_arbiter uut{{champsim::prefetch_arbiter::policy::PRIORITY, 2, 8, 8, {}}, 6};
+    uut.set_sources(1 | 2);
+
+    uut.propose(candidate_from(1, 0xcafe'0000));
+    uut.propose(candidate_from(1, 0xcafe'1000));
+    uut.propose(candidate_from(0, 0xcafe'2000));
+
+    WHEN("The arbiter issues") {
+      auto issued = issue_all(uut);
+
+      THEN("The higher priority source goes first, and one candidate waits") {
+        REQUIRE(issued == std::vector<uint64_t>{0xcafe'2000, 0xcafe'0000});
+        REQUIRE(uut.occupancy() == 1);
+      }
+    }
+
+    WHEN("The issue function fails") {
+      auto issued = uut.issue([](const auto&) { return false; });
+
+      THEN("Nothing is issued") {
+        REQUIRE(issued == 0);
+        REQUIRE(uut.occupancy() == 3);
+      }
+    }
+  }
+
+  GIVEN("A confidence arbiter whose lower priority source is more accurate") {
+    champsim::prefetch_arbiter uut{{champsim::prefetch_arbiter::policy::CONFIDENCE, 1, 8, 8, {}}, 6};
+    uut.set_sources(1 | 2);
+    for (int i = 0; i < 10; ++i) {
+      uut.record_useless(0);
+      uut.record_useful(1);
+    }
+
+    uut.propose(candidate_from(0, 0xcafe'0000));
+    uut.propose(candidate_from(1, 0xcafe'1000));
+
+    WHEN("The arbiter issues") {
+      auto issued = issue_all(uut);
+
+      THEN("The more accurate source goes first") {
+        REQUIRE(uut.confidence(1) > uut.confidence(0));
+        REQUIRE(issued == std::vector<uint64_t>{0xcafe'1000});
+      }
+    }
+  }
+}
+
+SCENARIO("A cache with a prefetch arbiter accounts for each prefetcher") {
+  GIVEN("A cache arbitrating between two prefetchers") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("434-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .prefetch_arbiter({champsim::prefetch_arbiter::policy::PRIORITY, 1, 8, 8, {}})
+    };
+    uut.select_prefetcher({"metadata_collector", "address_collector"});
+    auto second = champsim::select_modules(CACHE::prefetcher_registry(), {"address_collector"}, "prefetcher");
+
+    std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    THEN("The prefetchers are named in priority order") {
+      REQUIRE(std::size(uut.sim_stats.pf_sources) == 2);
+      REQUIRE(uut.sim_stats.pf_sources[0].name == "metadata_collector");
+      REQUIRE(uut.sim_stats.pf_sources[1].name == "address_collector");
+    }
+
+    WHEN("The second prefetcher proposes a block twice") {
+      uut.active_prefetcher = second;
+      REQUIRE(uut.prefetch_line(0xdead'be00, true, 0));
+      REQUIRE_FALSE(uut.prefetch_line(0xdead'be00, true, 0));
+
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("It is issued once, and attributed to the second prefetcher") {
+        REQUIRE(mock_ll.packet_count() == 1);
+        REQUIRE(uut.sim_stats.pf_sources[1].proposed == 2);
+        REQUIRE(uut.sim_stats.pf_sources[1].duplicate == 1);
+        REQUIRE(uut.sim_stats.pf_sources[1].issued == 1);
+        REQUIRE(uut.sim_stats.pf_sources[0].proposed == 0);
+      }
+
+      AND_WHEN("A load hits the prefetched block") {
+        decltype(mock_ul)::request_type test;
+        test.address = 0xdead'be00;
+        test.cpu = 0;
+        REQUIRE(mock_ul.issue(test));
+
+        for (auto i = 0; i < 100; ++i)
+          for (auto elem : elements)
+            elem->_operate();
+
+        THEN("The second prefetcher is credited") {
+          REQUIRE(uut.sim_stats.pf_sources[1].useful == 1);
+          REQUIRE(uut.sim_stats.pf_sources[0].useful == 0);
+          REQUIRE(uut.pf_arbiter->confidence(1) > uut.pf_arbiter->confidence(0));
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,149 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+
+#include <numeric>
+
+namespace
+{
+  template <typename T>
+  uint64_t histogram_total(const T& histogram)
+  {
+    return std::accumulate(std::begin(histogram), std::end(histogram), uint64_t{0});
+  }
+}
+
+SCENARIO("A cache accounts for the prefetches of its prefetcher") {
+  GIVEN("A cache with one prefetcher and no arbiter") {
+    constexpr uint64_t hit_latency = 2;
+    constexpr uint64_t fill_latency = 2;
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("435a-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .hit_latency(hit_latency)
+      .fill_latency(fill_latency)
+      .prefetcher<CACHE::ptestDcppDmodulesDprefetcherDaddress_collector>()
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    THEN("The prefetcher is named in the stats") {
+      REQUIRE(std::size(uut.sim_stats.pf_sources) == 1);
+      REQUIRE(uut.sim_stats.pf_sources[0].name == "address_collector");
+    }
+
+    WHEN("A prefetch is issued and filled") {
+      constexpr uint64_t seed_addr = 0xdeadbeef;
+      REQUIRE(uut.prefetch_line(seed_addr, true, 0));
+
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("It is counted as issued and filled") {
+        REQUIRE(uut.sim_stats.pf_sources[0].proposed == 1);
+        REQUIRE(uut.sim_stats.pf_sources[0].issued == 1);
+        REQUIRE(uut.sim_stats.pf_sources[0].filled == 1);
+        REQUIRE(uut.sim_stats.pf_sources[0].useful == 0);
+      }
+
+      AND_WHEN("A load hits the prefetched block") {
+        decltype(mock_ul)::request_type test;
+        test.address = seed_addr;
+        test.cpu = 0;
+        REQUIRE(mock_ul.issue(test));
+
+        for (uint64_t i = 0; i < 2*hit_latency; ++i)
+          for (auto elem : elements)
+            elem->_operate();
+
+        THEN("The prefetch is useful and timely") {
+          REQUIRE(uut.sim_stats.pf_useful == 1);
+          REQUIRE(uut.sim_stats.pf_sources[0].useful == 1);
+          REQUIRE(uut.sim_stats.pf_sources[0].late == 0);
+          REQUIRE(histogram_total(uut.sim_stats.pf_sources[0].timely_cycles) == 1);
+        }
+      }
+
+      AND_WHEN("The same block is prefetched again") {
+        REQUIRE(uut.prefetch_line(seed_addr, true, 0));
+
+        for (uint64_t i = 0; i < 2*hit_latency; ++i)
+          for (auto elem : elements)
+            elem->_operate();
+
+        THEN("The second prefetch is redundant") {
+          REQUIRE(uut.sim_stats.pf_sources[0].issued == 2);
+          REQUIRE(uut.sim_stats.pf_sources[0].redundant == 1);
+          REQUIRE(uut.sim_stats.pf_sources[0].useful == 0);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A cache counts a prefetch that a demand finds in flight as late") {
+  GIVEN("A cache with one prefetcher whose lower level holds its misses") {
+    release_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("435b-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .prefetcher<CACHE::ptestDcppDmodulesDprefetcherDaddress_collector>()
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A load arrives while the prefetch is in the MSHR") {
+      constexpr uint64_t seed_addr = 0xdeadbeef;
+      REQUIRE(uut.prefetch_line(seed_addr, true, 0));
+
+      for (auto i = 0; i < 20; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      decltype(mock_ul)::request_type test;
+      test.address = seed_addr;
+      test.cpu = 0;
+      REQUIRE(mock_ul.issue(test));
+
+      for (auto i = 0; i < 20; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      mock_ll.release_all();
+      for (auto i = 0; i < 20; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("The prefetch is useful but late") {
+        REQUIRE(mock_ll.packet_count() == 1);
+        REQUIRE(uut.sim_stats.pf_useful == 1);
+        REQUIRE(uut.sim_stats.pf_sources[0].useful == 1);
+        REQUIRE(uut.sim_stats.pf_sources[0].late == 1);
+        REQUIRE(histogram_total(uut.sim_stats.pf_sources[0].late_cycles) == 1);
+        REQUIRE(histogram_total(uut.sim_stats.pf_sources[0].timely_cycles) == 0);
+      }
+
+      THEN("The filled block is not counted again") {
+        REQUIRE(uut.sim_stats.pf_sources[0].filled == 0);
+        REQUIRE(uut.sim_stats.pf_sources[0].useless == 0);
+      }
+    }
+  }
+}
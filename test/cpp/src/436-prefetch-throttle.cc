@@ -0,0 +1,182 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "prefetch_throttle.h"
+
+namespace
+{
+  champsim::prefetch_throttle::config_type short_interval()
+  {
+    champsim::prefetch_throttle::config_type config{};
+    config.interval = 10;
+    return config;
+  }
+
+  void finish_interval(champsim::prefetch_throttle& uut)
+  {
+    for (uint64_t i = 0; i < uut.get_config().interval; ++i)
+      uut.operate();
+  }
+}
+
+SCENARIO("A prefetch throttle limits the prefetches of each trigger") {
+  GIVEN("A throttle with one source") {
+    champsim::prefetch_throttle uut{short_interval(), 6};
+    uut.set_sources(1);
+
+    THEN("The source starts at the middle level") {
+      REQUIRE(uut.level(0) == 2);
+      REQUIRE(uut.degree(0) == 4);
+    }
+
+    WHEN("The source proposes more prefetches than its degree") {
+      uut.begin_trigger();
+      int admitted = 0;
+      for (int i = 0; i < 10; ++i)
+        admitted += uut.admit(0) ? 1 : 0;
+
+      THEN("Only its degree is admitted") {
+        REQUIRE(admitted == 4);
+      }
+
+      AND_WHEN("A new trigger begins") {
+        uut.begin_trigger();
+
+        THEN("The source may prefetch again") {
+          REQUIRE(uut.admit(0));
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A prefetch throttle adapts to the feedback of each source") {
+  GIVEN("A throttle with one source") {
+    champsim::prefetch_throttle uut{short_interval(), 6};
+    uut.set_sources(1);
+
+    WHEN("The source is accurate but late") {
+      for (int i = 0; i < 10; ++i) {
+        uut.record_issued(0);
+        uut.record_useful(0, true);
+      }
+      finish_interval(uut);
+
+      THEN("It becomes more aggressive") {
+        REQUIRE(uut.accuracy(0) == Approx(1));
+        REQUIRE(uut.level(0) == 3);
+      }
+    }
+
+    WHEN("The source is inaccurate and causes demand misses") {
+      for (int i = 0; i < 10; ++i)
+        uut.record_issued(0);
+      uut.record_prefetch_eviction(0, 0xcafe'0000);
+      uut.record_demand_miss(0xcafe'0000);
+      finish_interval(uut);
+
+      THEN("It becomes less aggressive") {
+        REQUIRE(uut.pollution(0) > 0);
+        REQUIRE(uut.level(0) == 1);
+      }
+    }
+
+    WHEN("The source is fairly accurate and late, but the memory bandwidth is saturated") {
+      uut.set_bandwidth_source([]() { return 0.9; });
+      for (int i = 0; i < 10; ++i) {
+        uut.record_issued(0);
+        if (i % 2 == 0)
+          uut.record_useful(0, true);
+      }
+      finish_interval(uut);
+
+      THEN("It becomes less aggressive") {
+        REQUIRE(uut.bandwidth() == Approx(0.9));
+        REQUIRE(uut.level(0) == 1);
+      }
+    }
+
+    WHEN("Half of the prefetches of the source are discarded before they are sent, and the rest are useful") {
+      for (int i = 0; i < 10; ++i) {
+        uut.record_issued(0);
+        if (i % 2 == 0)
+          uut.record_discarded(0);
+        else
+          uut.record_useful(0, false);
+      }
+
+      THEN("The discarded prefetches do not lower its accuracy") {
+        REQUIRE(uut.accuracy(0) == Approx(1));
+      }
+    }
+
+    WHEN("The source does not prefetch") {
+      finish_interval(uut);
+
+      THEN("Its level does not change") {
+        REQUIRE(uut.level(0) == 2);
+      }
+    }
+  }
+}
+
+SCENARIO("A cache with a prefetch throttle drops prefetches beyond the degree") {
+  GIVEN("A throttled cache whose only level has a degree of one") {
+    auto config = short_interval();
+    config.degrees = {1};
+
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("436-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .prefetcher<CACHE::ptestDcppDmodulesDprefetcherDaddress_collector>()
+      .prefetch_throttle(config)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("Two prefetches are issued for one trigger") {
+      uut.begin_prefetch_trigger();
+      auto first = uut.prefetch_line(0xdead'be00, true, 0);
+      auto second = uut.prefetch_line(0xdead'bf00, true, 0);
+
+      for (uint64_t i = 0; i < config.interval; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("The second is dropped") {
+        REQUIRE(uut.prefetch_degree() == 1);
+        REQUIRE(first);
+        REQUIRE_FALSE(second);
+        REQUIRE(mock_ll.packet_count() == 1);
+        REQUIRE(uut.sim_stats.pf_sources[0].proposed == 2);
+        REQUIRE(uut.sim_stats.pf_sources[0].throttled == 1);
+      }
+
+      THEN("The interval at the throttle's level is counted") {
+        REQUIRE(uut.sim_stats.pf_sources[0].throttle_levels == std::vector<uint64_t>{1});
+      }
+    }
+
+    WHEN("One prefetch is issued for a trigger, and another on a later cycle") {
+      uut.begin_prefetch_trigger();
+      auto first = uut.prefetch_line(0xdead'be00, true, 0);
+      uut.impl_prefetcher_cycle_operate();
+      auto second = uut.prefetch_line(0xdead'bf00, true, 0);
+
+      THEN("The later prefetch counts against the same trigger, and is dropped") {
+        REQUIRE(first);
+        REQUIRE_FALSE(second);
+        REQUIRE(uut.sim_stats.pf_sources[0].throttled == 1);
+      }
+    }
+  }
+}
@@ -0,0 +1,76 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+
+SCENARIO("A cache's occupancy snapshot agrees with its queues") {
+  auto queue_count = GENERATE(as<std::size_t>(), 1, 2, 3);
+  GIVEN("A cache with " + std::to_string(queue_count) + " upper levels") {
+    do_nothing_MRC mock_ll;
+    std::vector<to_pq_MRP> queues{queue_count};
+    std::vector<champsim::channel*> queue_ptrs;
+    std::transform(std::begin(queues), std::end(queues), std::back_inserter(queue_ptrs), [](auto& q){ return &q.queues; });
+
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("437-uut-" + std::to_string(queue_count))
+      .upper_levels(std::move(queue_ptrs))
+      .lower_level(&mock_ll.queues)
+    };
+
+    uut.initialize();
+    uut.warmup = false;
+    uut.begin_phase();
+
+    THEN("The snapshot gives the same occupancies and sizes as the other functions") {
+      const auto& snapshot = uut.get_occupancy_snapshot();
+      REQUIRE(snapshot.mshr == uut.get_mshr_occupancy());
+      REQUIRE(snapshot.mshr_size == uut.get_mshr_size());
+      REQUIRE(snapshot.internal_pq == uut.get_pq_occupancy().back());
+      REQUIRE(snapshot.internal_pq_size == uut.get_pq_size().back());
+      REQUIRE_THAT(snapshot.rq, Catch::Matchers::RangeEquals(uut.get_rq_occupancy()));
+      REQUIRE_THAT(snapshot.rq_size, Catch::Matchers::RangeEquals(uut.get_rq_size()));
+      REQUIRE_THAT(snapshot.wq, Catch::Matchers::RangeEquals(uut.get_wq_occupancy()));
+      REQUIRE_THAT(snapshot.wq_size, Catch::Matchers::RangeEquals(uut.get_wq_size()));
+      REQUIRE_THAT(snapshot.pq, Catch::Matchers::RangeEquals(std::vector<std::size_t>(queue_count, 0)));
+      REQUIRE(std::size(snapshot.pq_size) == queue_count);
+    }
+
+    WHEN("The cache issues a prefetch") {
+      const auto& before = uut.get_occupancy_snapshot();
+      const auto* pq_data = std::data(before.pq);
+      uut.prefetch_line(0xdeadbeef, true, 0);
+
+      THEN("The internal prefetch queue occupancy is current within the cycle") {
+        const auto& after = uut.get_occupancy_snapshot();
+        REQUIRE(after.internal_pq == 1);
+        REQUIRE(uut.get_internal_pq_occupancy() == 1);
+      }
+
+      THEN("The snapshot reuses its storage") {
+        const auto& after = uut.get_occupancy_snapshot();
+        REQUIRE(&after == &before);
+        REQUIRE(std::data(after.pq) == pq_data);
+      }
+    }
+
+    WHEN("An upper level issues a request") {
+      uut.get_occupancy_snapshot();
+
+      champsim::channel::request_type test;
+      test.address = 0xdeadbeef;
+      queues.front().issue(test);
+
+      THEN("The upper level occupancy is not sampled again within the cycle") {
+        REQUIRE(uut.get_occupancy_snapshot().pq.front() == 0);
+      }
+
+      AND_WHEN("The cycle advances") {
+        ++uut.current_cycle;
+
+        THEN("The upper level occupancy is sampled again") {
+          REQUIRE(uut.get_occupancy_snapshot().pq.front() == 1);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,202 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+
+SCENARIO("A cache may drop prefetches to blocks it already has") {
+  GIVEN("A cache that drops redundant prefetches") {
+    do_nothing_MRC mock_ll;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("438a-uut")
+      .lower_level(&mock_ll.queues)
+      .prefetcher<CACHE::ptestDcppDmodulesDprefetcherDaddress_collector>()
+      .prefetch_queue_policy({false, true, 0, 0})
+    };
+
+    std::array<champsim::operable*, 2> elements{{&mock_ll, &uut}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A block is prefetched twice") {
+      auto first = uut.prefetch_line(0xdead'be00, true, 0);
+      auto second = uut.prefetch_line(0xdead'be00, true, 0);
+
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("The second prefetch is filtered") {
+        REQUIRE(first);
+        REQUIRE_FALSE(second);
+        REQUIRE(mock_ll.packet_count() == 1);
+        REQUIRE(uut.sim_stats.pf_sources[0].filtered == 1);
+        REQUIRE(uut.sim_stats.pf_sources[0].issued == 1);
+      }
+
+      AND_WHEN("The block is prefetched again after it is filled") {
+        auto third = uut.prefetch_line(0xdead'be00, true, 0);
+
+        THEN("The prefetch is filtered") {
+          REQUIRE(uut.contains_line(0xdead'be00));
+          REQUIRE_FALSE(third);
+          REQUIRE(uut.sim_stats.pf_sources[0].filtered == 2);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A cache may discard prefetches that wait too long") {
+  GIVEN("A cache that checks no tags, and that discards prefetches after some cycles") {
+    constexpr uint64_t max_age = 10;
+    do_nothing_MRC mock_ll;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("438b-uut")
+      .lower_level(&mock_ll.queues)
+      .tag_bandwidth(0)
+      .prefetcher<CACHE::ptestDcppDmodulesDprefetcherDaddress_collector>()
+      .prefetch_queue_policy({false, false, max_age, 0})
+    };
+
+    std::array<champsim::operable*, 2> elements{{&mock_ll, &uut}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A prefetch is issued") {
+      REQUIRE(uut.prefetch_line(0xdead'be00, true, 0));
+
+      for (uint64_t i = 0; i <= max_age; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("It waits until it reaches the age") {
+        REQUIRE(uut.get_internal_pq_occupancy() == 1);
+      }
+
+      AND_WHEN("It waits longer") {
+        for (auto elem : elements)
+          elem->_operate();
+
+        THEN("It is discarded") {
+          REQUIRE(uut.get_internal_pq_occupancy() == 0);
+          REQUIRE(uut.sim_stats.pf_sources[0].discarded == 1);
+          REQUIRE(mock_ll.packet_count() == 0);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A cache may reserve MSHR entries for demand misses") {
+  GIVEN("A cache whose prefetches may not take any MSHR entry") {
+    constexpr uint32_t mshr_size = 4;
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("438c-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .mshr_size(mshr_size)
+      .prefetcher<CACHE::ptestDcppDmodulesDprefetcherDaddress_collector>()
+      .prefetch_queue_policy({false, false, 0, mshr_size})
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A prefetch misses") {
+      REQUIRE(uut.prefetch_line(0xdead'be00, true, 0));
+
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("It is discarded without a miss being sent") {
+        REQUIRE(uut.sim_stats.pf_sources[0].discarded == 1);
+        REQUIRE(mock_ll.packet_count() == 0);
+      }
+
+      AND_WHEN("A load misses") {
+        decltype(mock_ul)::request_type test;
+        test.address = 0xcafe'be00;
+        test.cpu = 0;
+        REQUIRE(mock_ul.issue(test));
+
+        for (auto i = 0; i < 100; ++i)
+          for (auto elem : elements)
+            elem->_operate();
+
+        THEN("It takes a reserved entry") {
+          REQUIRE(mock_ll.packet_count() == 1);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A cache may order its prefetch queue by the confidence of its prefetchers") {
+  GIVEN("A cache with two prefetchers and room for one prefetch, which it does not check") {
+    do_nothing_MRC mock_ll;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("438d-uut")
+      .lower_level(&mock_ll.queues)
+      .pq_size(1)
+      .tag_bandwidth(0)
+      .prefetch_queue_policy({true, false, 0, 0})
+    };
+    uut.select_prefetcher({"metadata_collector", "address_collector"});
+    auto confident = champsim::select_modules(CACHE::prefetcher_registry(), {"metadata_collector"}, "prefetcher");
+    auto doubtful = champsim::select_modules(CACHE::prefetcher_registry(), {"address_collector"}, "prefetcher");
+
+    std::array<champsim::operable*, 2> elements{{&mock_ll, &uut}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    auto& sources = uut.sim_stats.pf_sources;
+    auto find_source = [&](std::string name) {
+      return std::distance(std::begin(sources), std::find_if(std::begin(sources), std::end(sources), [&](const auto& x) { return x.name == name; }));
+    };
+    auto& confident_stats = sources.at(find_source("metadata_collector"));
+    auto& doubtful_stats = sources.at(find_source("address_collector"));
+    confident_stats.useful = 10;
+    doubtful_stats.useless = 10;
+
+    WHEN("The less confident prefetcher fills the queue") {
+      uut.active_prefetcher = doubtful;
+      REQUIRE(uut.prefetch_line(0xdead'be00, true, 0));
+
+      AND_WHEN("The more confident prefetcher issues a prefetch") {
+        uut.active_prefetcher = confident;
+        auto result = uut.prefetch_line(0xcafe'be00, true, 0);
+
+        THEN("It displaces the less confident prefetch") {
+          REQUIRE(result);
+          REQUIRE(uut.get_internal_pq_occupancy() == 1);
+          REQUIRE(doubtful_stats.discarded == 1);
+        }
+
+        AND_WHEN("The less confident prefetcher issues another prefetch") {
+          uut.active_prefetcher = doubtful;
+
+          THEN("It is rejected") {
+            REQUIRE_FALSE(uut.prefetch_line(0xbeef'be00, true, 0));
+            REQUIRE(confident_stats.discarded == 0);
+          }
+        }
+      }
+    }
+  }
+}
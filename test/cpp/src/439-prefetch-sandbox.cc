@@ -0,0 +1,182 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "prefetch_sandbox.h"
+
+namespace
+{
+  champsim::prefetch_sandbox::config_type short_interval()
+  {
+    champsim::prefetch_sandbox::config_type config{};
+    config.interval = 10;
+    return config;
+  }
+
+  void finish_interval(champsim::prefetch_sandbox& uut)
+  {
+    for (uint64_t i = 0; i < uut.get_config().interval; ++i)
+      uut.operate();
+  }
+}
+
+SCENARIO("A prefetch sandbox selects the candidate that covers the most misses") {
+  GIVEN("A sandbox with two candidates") {
+    champsim::prefetch_sandbox uut{short_interval(), 6};
+    uut.set_sources(2);
+
+    THEN("The first candidate is selected") {
+      REQUIRE(uut.selected() == 0);
+      REQUIRE(uut.is_selected(0));
+      REQUIRE_FALSE(uut.is_selected(1));
+    }
+
+    WHEN("Only the second candidate predicts the blocks that miss") {
+      for (uint64_t i = 0; i < 10; ++i) {
+        uut.record_prediction(0, 0xdead'0000 + (i << 6));
+        uut.record_prediction(1, 0xbeef'0000 + (i << 6));
+      }
+      for (uint64_t i = 0; i < 10; ++i)
+        uut.record_demand(0xbeef'0000 + (i << 6), true);
+      finish_interval(uut);
+
+      THEN("The second candidate is selected") {
+        REQUIRE(uut.accuracy(1) == Approx(1));
+        REQUIRE(uut.coverage(1) == Approx(1));
+        REQUIRE(uut.accuracy(0) == Approx(0));
+        REQUIRE(uut.selected() == 1);
+      }
+    }
+
+    WHEN("The candidates predict blocks that the cache already has") {
+      for (uint64_t i = 0; i < 10; ++i) {
+        uut.record_prediction(0, 0xbeef'0000 + (i << 6));
+        uut.record_demand(0xbeef'0000 + (i << 6), false);
+      }
+      finish_interval(uut);
+
+      THEN("They are not credited, and neither is selected") {
+        REQUIRE(uut.accuracy(0) == Approx(0));
+        REQUIRE(uut.selected() == champsim::prefetch_sandbox::NONE);
+      }
+    }
+
+    WHEN("Both candidates predict the same block") {
+      uut.record_prediction(0, 0xbeef'0000);
+      uut.record_prediction(1, 0xbeef'0000);
+      uut.record_demand(0xbeef'0000, true);
+
+      THEN("Both are credited") {
+        REQUIRE(uut.coverage(0) == Approx(1));
+        REQUIRE(uut.coverage(1) == Approx(1));
+      }
+    }
+  }
+
+  GIVEN("A sandbox with a single shadow entry") {
+    auto config = short_interval();
+    config.shadow_sets = 1;
+    config.shadow_ways = 1;
+    champsim::prefetch_sandbox uut{config, 6};
+    uut.set_sources(1);
+
+    WHEN("A prediction is replaced before the demand access") {
+      uut.record_prediction(0, 0xbeef'0000);
+      uut.record_prediction(0, 0xdead'0000);
+      uut.record_demand(0xbeef'0000, true);
+
+      THEN("The candidate is not credited") {
+        REQUIRE(uut.coverage(0) == Approx(0));
+      }
+    }
+  }
+}
+
+SCENARIO("A cache with a prefetch sandbox issues only the prefetches of the selected prefetcher") {
+  GIVEN("A cache with two prefetchers and a sandbox") {
+    champsim::prefetch_sandbox::config_type config{};
+    config.interval = 100;
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("439-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .prefetch_sandbox(config)
+    };
+    uut.select_prefetcher({"metadata_collector", "address_collector"});
+
+    std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    auto& sources = uut.sim_stats.pf_sources;
+    REQUIRE(std::size(sources) == 2);
+    auto dark_flag = champsim::select_modules(CACHE::prefetcher_registry(), {sources[1].name}, "prefetcher");
+
+    WHEN("The prefetcher that is not selected issues a prefetch") {
+      uut.active_prefetcher = dark_flag;
+      auto result = uut.prefetch_line(0xdead'be00, true, 0);
+
+      for (auto i = 0; i < 10; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("It is accepted, but not issued") {
+        REQUIRE(result);
+        REQUIRE(mock_ll.packet_count() == 0);
+        REQUIRE(sources[1].dark == 1);
+        REQUIRE(sources[1].issued == 0);
+      }
+
+      AND_WHEN("A load misses on the predicted block") {
+        decltype(mock_ul)::request_type test;
+        test.address = 0xdead'be00;
+        test.cpu = 0;
+        REQUIRE(mock_ul.issue(test));
+
+        for (uint64_t i = 0; i < config.interval; ++i)
+          for (auto elem : elements)
+            elem->_operate();
+
+        THEN("The prefetcher that predicted it is selected") {
+          REQUIRE(uut.pf_sandbox->coverage(1) > 0);
+          REQUIRE(uut.pf_sandbox->selected() == 1);
+          REQUIRE(sources[0].selected == 1);
+        }
+      }
+    }
+
+    WHEN("The prefetcher that is not selected predicts a block that the selected one has already brought in") {
+      uut.active_prefetcher = champsim::select_modules(CACHE::prefetcher_registry(), {sources[0].name}, "prefetcher");
+      REQUIRE(uut.prefetch_line(0xdead'be00, true, 0));
+
+      for (auto i = 0; i < 10; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      uut.active_prefetcher = dark_flag;
+      REQUIRE(uut.prefetch_line(0xdead'be00, true, 0));
+
+      AND_WHEN("A load hits on the prefetched block") {
+        decltype(mock_ul)::request_type test;
+        test.address = 0xdead'be00;
+        test.cpu = 0;
+        REQUIRE(mock_ul.issue(test));
+
+        for (auto i = 0; i < 10; ++i)
+          for (auto elem : elements)
+            elem->_operate();
+
+        THEN("Both prefetchers are credited with covering it") {
+          REQUIRE(mock_ll.packet_count() == 1);
+          REQUIRE(uut.pf_sandbox->coverage(0) > 0);
+          REQUIRE(uut.pf_sandbox->coverage(1) > 0);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,153 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+
+#include "champsim_constants.h"
+#include "dram_controller.h"
+#include "ptw.h"
+#include "vmem.h"
+
+#include <array>
+#include <numeric>
+
+SCENARIO("The page table walker counts PSCL hits and misses at each level") {
+  GIVEN("A page table walker with four PSCLs") {
+    MEMORY_CONTROLLER dram{MEMORY_CONTROLLER::Builder{}};
+    VirtualMemory vmem{1 << 12, 5, 200, dram};
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    PageTableWalker uut{PageTableWalker::Builder{champsim::defaults::default_ptw}
+      .name("604a-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .virtual_memory(&vmem)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ul, &uut, &mock_ll}};
+
+    uut.warmup = false;
+    uut.begin_phase();
+
+    WHEN("The same page is walked twice") {
+      decltype(mock_ul)::request_type test;
+      test.address = 0xdeadbeef;
+      test.v_address = test.address;
+      test.cpu = 0;
+
+      for (auto i = 0; i < 2; ++i) {
+        REQUIRE(mock_ul.issue(test));
+        for (auto j = 0; j < 10000; ++j)
+          for (auto elem : elements)
+            elem->_operate();
+      }
+
+      THEN("Every level misses on the first walk and hits on the second") {
+        for (std::size_t level = 2; level <= 5; ++level) {
+          REQUIRE(uut.sim_stats.pscl_hits.at(level) == 1);
+          REQUIRE(uut.sim_stats.pscl_misses.at(level) == 1);
+        }
+      }
+
+      THEN("The second walk takes only the last step") {
+        REQUIRE(uut.sim_stats.walks == 2);
+        REQUIRE(uut.sim_stats.steps == 5 + 1);
+      }
+
+      THEN("Each walk is counted in the latency histogram") {
+        REQUIRE(std::accumulate(std::begin(uut.sim_stats.walk_latency), std::end(uut.sim_stats.walk_latency), uint64_t{0}) == 2);
+        REQUIRE(uut.sim_stats.total_walk_latency > 0);
+      }
+    }
+  }
+}
+
+SCENARIO("The page table walker counts the PSCL lookups of a walk that must wait once") {
+  GIVEN("A page table walker whose lower level can hold one request") {
+    MEMORY_CONTROLLER dram{MEMORY_CONTROLLER::Builder{}};
+    VirtualMemory vmem{1 << 12, 5, 200, dram};
+    champsim::channel ll{1, 0, 0, LOG2_BLOCK_SIZE, false};
+    to_rq_MRP mock_ul;
+    PageTableWalker uut{PageTableWalker::Builder{champsim::defaults::default_ptw}
+      .name("604c-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&ll)
+      .virtual_memory(&vmem)
+    };
+
+    // The lower level is not operated, so that its queue stays full
+    std::array<champsim::operable*, 2> elements{{&mock_ul, &uut}};
+
+    uut.warmup = false;
+    uut.begin_phase();
+
+    WHEN("Two pages are walked, and the second cannot begin") {
+      decltype(mock_ul)::request_type test;
+      test.cpu = 0;
+      for (uint64_t address : {0xdeadbeefull, 0xffff'ffff'ffff'f000ull}) {
+        test.address = address;
+        test.v_address = test.address;
+        REQUIRE(mock_ul.issue(test));
+      }
+
+      for (auto j = 0; j < 100; ++j)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("Only the walk that began is counted") {
+        for (std::size_t level = 2; level <= 5; ++level) {
+          REQUIRE(uut.sim_stats.pscl_hits.at(level) == 0);
+          REQUIRE(uut.sim_stats.pscl_misses.at(level) == 1);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("The page table walker tracks concurrent walks") {
+  GIVEN("A page table walker") {
+    MEMORY_CONTROLLER dram{MEMORY_CONTROLLER::Builder{}};
+    VirtualMemory vmem{1 << 12, 5, 200, dram};
+    do_nothing_MRC mock_ll{10};
+    to_rq_MRP mock_ul;
+    PageTableWalker uut{PageTableWalker::Builder{champsim::defaults::default_ptw}
+      .name("604b-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .virtual_memory(&vmem)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ul, &uut, &mock_ll}};
+
+    uut.warmup = false;
+    uut.begin_phase();
+
+    WHEN("Two pages in distant regions are walked at once") {
+      decltype(mock_ul)::request_type test;
+      test.cpu = 0;
+      for (uint64_t address : {0xdeadbeefull, 0xffff'ffff'ffff'f000ull}) {
+        test.address = address;
+        test.v_address = test.address;
+        REQUIRE(mock_ul.issue(test));
+      }
+
+      for (auto j = 0; j < 10000; ++j)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("Two walks were in progress at once") {
+        REQUIRE(std::size(uut.sim_stats.concurrent_walks) == 3);
+        REQUIRE(uut.sim_stats.concurrent_walks.at(2) > 0);
+        REQUIRE(std::accumulate(std::begin(uut.sim_stats.concurrent_walks), std::end(uut.sim_stats.concurrent_walks), uint64_t{0}) == uut.sim_stats.cycles);
+      }
+    }
+
+    WHEN("The phase ends") {
+      uut.end_phase(0);
+
+      THEN("The region of interest statistics are recorded") {
+        REQUIRE(uut.roi_stats.name == "604b-uut");
+        REQUIRE(uut.roi_stats.cycles == uut.sim_stats.cycles);
+      }
+    }
+  }
+}
@@ -0,0 +1,98 @@
+#include <catch.hpp>
+
+#include "champsim_constants.h"
+#include "dram_controller.h"
+
+namespace
+{
+uint64_t dram_address(uint64_t row, uint64_t column, uint64_t bank)
+{
+  // | row address | rank index | column address | bank index | channel | block offset |
+  auto column_shift = champsim::lg2(DRAM_BANKS) + champsim::lg2(DRAM_CHANNELS) + LOG2_BLOCK_SIZE;
+  auto row_shift = champsim::lg2(DRAM_RANKS) + champsim::lg2(DRAM_COLUMNS) + column_shift;
+  return (row << row_shift) | (column << column_shift) | (bank << (champsim::lg2(DRAM_CHANNELS) + LOG2_BLOCK_SIZE));
+}
+
+std::vector<uint64_t> return_order(double age_cap)
+{
+  champsim::channel ul{};
+  champsim::dram_timing_parameters params;
+  params.tRP = 12.5;
+  params.tRCD = 12.5;
+  params.tCAS = 12.5;
+  params.turnaround = 7.5;
+  MEMORY_CONTROLLER uut{MEMORY_CONTROLLER::Builder{}.io_freq(3200).timing(params).scheduler_age_cap(age_cap).upper_levels({&ul})};
+  uut.warmup = false;
+  uut.begin_phase();
+
+  // Two requests to the same row, separated by a request to a different row in the same bank
+  for (auto addr : {dram_address(1, 0, 0), dram_address(2, 0, 0), dram_address(1, 1, 0)}) {
+    champsim::channel::request_type req;
+    req.address = addr;
+    req.v_address = addr;
+    ul.add_rq(req);
+  }
+
+  for (int i = 0; i < 1000; ++i)
+    uut._operate();
+
+  std::vector<uint64_t> retval;
+  std::transform(std::begin(ul.returned), std::end(ul.returned), std::back_inserter(retval), [](const auto& x) { return x.address; });
+  return retval;
+}
+} // namespace
+
+SCENARIO("The DRAM scheduler serves row buffer hits first") {
+  GIVEN("A memory controller with a large age cap") {
+    WHEN("Requests to two rows in the same bank are interleaved") {
+      auto order = return_order(1e6);
+
+      THEN("The request that hits in the open row bypasses the older request") {
+        REQUIRE_THAT(order, Catch::Matchers::Equals(std::vector<uint64_t>{dram_address(1, 0, 0), dram_address(1, 1, 0), dram_address(2, 0, 0)}));
+      }
+    }
+  }
+
+  GIVEN("A memory controller with no age cap") {
+    WHEN("Requests to two rows in the same bank are interleaved") {
+      auto order = return_order(0);
+
+      THEN("The requests are served in arrival order") {
+        REQUIRE_THAT(order, Catch::Matchers::Equals(std::vector<uint64_t>{dram_address(1, 0, 0), dram_address(2, 0, 0), dram_address(1, 1, 0)}));
+      }
+    }
+  }
+}
+
+SCENARIO("The DRAM controller tracks queue occupancy") {
+  GIVEN("A memory controller") {
+    champsim::channel ul{};
+    MEMORY_CONTROLLER uut{1, 3200, 12.5, 12.5, 12.5, 7.5, {&ul}};
+    uut.warmup = false;
+    uut.begin_phase();
+
+    WHEN("Requests are sent") {
+      for (uint64_t i = 0; i < 4; ++i) {
+        champsim::channel::request_type req;
+        req.address = dram_address(i + 1, 0, i);
+        req.v_address = req.address;
+        ul.add_rq(req);
+      }
+      uut._operate();
+
+      THEN("They are counted") {
+        REQUIRE(uut.channels[0].rq_occupancy == 4);
+      }
+
+      AND_WHEN("They are all returned") {
+        for (int i = 0; i < 1000; ++i)
+          uut._operate();
+
+        THEN("The occupancy returns to zero") {
+          REQUIRE(std::size(ul.returned) == 4);
+          REQUIRE(uut.channels[0].rq_occupancy == 0);
+        }
+      }
+    }
+  }
+}
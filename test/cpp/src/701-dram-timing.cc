@@ -0,0 +1,148 @@
+#include <catch.hpp>
+
+#include "champsim_constants.h"
+#include "dram_controller.h"
+
+namespace
+{
+champsim::dram_timing_parameters basic_timing()
+{
+  champsim::dram_timing_parameters params;
+  params.tRP = 12.5;
+  params.tRCD = 12.5;
+  params.tCAS = 12.5;
+  return params;
+}
+} // namespace
+
+SCENARIO("Activations are limited by the four-activate window") {
+  GIVEN("A channel with a long four-activate window") {
+    auto params = basic_timing();
+    params.tFAW = 100;
+    DRAM_CHANNEL uut;
+    uut.timing = champsim::dram_timing{params, 3200};
+
+    WHEN("Five banks are activated in the same cycle") {
+      std::vector<uint64_t> ready;
+      for (std::size_t bank = 0; bank < 5; ++bank)
+        ready.push_back(uut.issue_commands(bank, 1, false, 0));
+
+      THEN("The first four are not delayed") {
+        for (std::size_t i = 0; i < 4; ++i)
+          REQUIRE(ready.at(i) == uut.timing.tRCD + uut.timing.tCAS);
+      }
+
+      THEN("The fifth waits for the window to pass") {
+        REQUIRE(ready.at(4) == uut.timing.tFAW + uut.timing.tRCD + uut.timing.tCAS);
+        REQUIRE(uut.sim_stats.ACTIVATIONS == 5);
+      }
+    }
+  }
+}
+
+SCENARIO("Activations within a bank group are spaced farther apart") {
+  GIVEN("A channel with distinct short and long activate-to-activate delays") {
+    auto params = basic_timing();
+    params.tRRD_S = 5;
+    params.tRRD_L = 20;
+    DRAM_CHANNEL uut;
+    uut.timing = champsim::dram_timing{params, 3200};
+    uut.issue_commands(0, 1, false, 0);
+
+    WHEN("A bank in the same bank group is activated") {
+      auto ready = uut.issue_commands(DRAM_BANK_GROUPS, 1, false, 0);
+
+      THEN("It waits for the long delay") {
+        REQUIRE(ready == uut.timing.tRRD_L + uut.timing.tRCD + uut.timing.tCAS);
+      }
+    }
+
+    WHEN("A bank in a different bank group is activated") {
+      auto ready = uut.issue_commands(1, 1, false, 0);
+
+      THEN("It waits for the short delay") {
+        REQUIRE(ready == uut.timing.tRRD_S + uut.timing.tRCD + uut.timing.tCAS);
+      }
+    }
+  }
+}
+
+SCENARIO("A row may not be closed until it has been open for the minimum activation time") {
+  GIVEN("A bank that has just activated a row") {
+    auto params = basic_timing();
+    params.tRAS = 50;
+    DRAM_CHANNEL uut;
+    uut.timing = champsim::dram_timing{params, 3200};
+    uut.issue_commands(0, 1, false, 0);
+    uut.bank_request[0].open_row = 1;
+
+    WHEN("A different row in the same bank is requested") {
+      auto ready = uut.issue_commands(0, 2, false, 1);
+
+      THEN("The precharge waits for the activation time") {
+        REQUIRE(ready == uut.timing.tRAS + uut.timing.tRP + uut.timing.tRCD + uut.timing.tCAS);
+      }
+    }
+
+    WHEN("The same row is requested") {
+      auto ready = uut.issue_commands(0, 1, false, 1);
+
+      THEN("The column is read without another activation") {
+        REQUIRE(ready == uut.timing.tRCD + uut.timing.tCAS);
+        REQUIRE(uut.sim_stats.ACTIVATIONS == 1);
+      }
+    }
+  }
+}
+
+SCENARIO("A read after a write waits for the write data") {
+  GIVEN("A rank that has just written") {
+    auto params = basic_timing();
+    params.tWTR_S = 10;
+    DRAM_CHANNEL uut;
+    uut.timing = champsim::dram_timing{params, 3200};
+    auto write_ready = uut.issue_commands(0, 1, true, 0);
+
+    WHEN("A different bank group is read") {
+      auto ready = uut.issue_commands(1, 1, false, 0);
+
+      THEN("The read command waits until after the write data and the write-to-read delay") {
+        REQUIRE(ready == write_ready + uut.timing.tBURST + uut.timing.tWTR_S + uut.timing.tCAS);
+      }
+    }
+  }
+}
+
+SCENARIO("The memory controller refreshes its ranks") {
+  auto mode = GENERATE(champsim::dram_refresh_mode::ALL_BANK, champsim::dram_refresh_mode::SAME_BANK);
+  GIVEN("A memory controller with refresh enabled") {
+    auto params = basic_timing();
+    params.tREFI = 1000;
+    params.tRFC = 100;
+    params.tRFCsb = 50;
+    params.refresh = mode;
+    MEMORY_CONTROLLER uut{MEMORY_CONTROLLER::Builder{}.io_freq(3200).timing(params)};
+    uut.warmup = false;
+    uut.begin_phase();
+
+    WHEN("The controller operates for one refresh interval") {
+      auto interval = champsim::dram_timing{params, 3200}.tREFI;
+      for (uint64_t i = 0; i <= interval; ++i)
+        uut._operate();
+
+      THEN("Every bank is refreshed once") {
+        auto expected = (mode == champsim::dram_refresh_mode::ALL_BANK) ? 1 : DRAM_CHANNEL::BANKS_PER_GROUP;
+        REQUIRE(uut.channels[0].sim_stats.REFRESHES == DRAM_RANKS * expected);
+      }
+
+      THEN("The first refreshed bank may not activate until its refresh completes") {
+        auto refresh_time = (mode == champsim::dram_refresh_mode::ALL_BANK) ? uut.channels[0].timing.tRFC : uut.channels[0].timing.tRFCsb;
+        REQUIRE(uut.channels[0].bank_timers[0].next_activate == uut.channels[0].refresh_interval() + refresh_time);
+      }
+
+      THEN("The controller makes progress while the refresh is in flight, so that an idle system is not reported as deadlocked") {
+        REQUIRE(uut._operate() > 0);
+      }
+    }
+  }
+}
@@ -0,0 +1,88 @@
+#include <catch.hpp>
+
+#include <set>
+#include <tuple>
+
+#include "champsim_constants.h"
+#include "dram_address_mapping.h"
+
+SCENARIO("The default DRAM address mapping slices the address into fields") {
+  GIVEN("The default mapping") {
+    constexpr auto uut = champsim::dram_address_mapping::row_rank_column_bank_channel();
+
+    THEN("The fields are contiguous, from the channel up to the row") {
+      STATIC_REQUIRE(uut.channel.shift == LOG2_BLOCK_SIZE);
+      STATIC_REQUIRE(uut.bank.shift == uut.channel.shift + uut.channel.width);
+      STATIC_REQUIRE(uut.column.shift == uut.bank.shift + uut.bank.width);
+      STATIC_REQUIRE(uut.rank.shift == uut.column.shift + uut.column.width);
+      STATIC_REQUIRE(uut.row.shift == uut.rank.shift + uut.rank.width);
+    }
+
+    WHEN("An address is mapped") {
+      constexpr uint64_t row = 5, column = 3, bank = 1;
+      constexpr uint64_t address = (row << uut.row.shift) | (column << uut.column.shift) | (bank << uut.bank.shift);
+
+      THEN("Each field is recovered") {
+        REQUIRE(uut.row(address) == row);
+        REQUIRE(uut.column(address) == column);
+        REQUIRE(uut.bank(address) == bank);
+        REQUIRE(uut.channel(address) == 0);
+        REQUIRE(uut.rank(address) == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("A field may be XORed with other address bits") {
+  GIVEN("A two-bit field XORed with four higher bits") {
+    champsim::dram_address_field uut{0, 2, 0b1111'0000};
+
+    THEN("The higher bits are folded into the field") {
+      REQUIRE(uut(0b0000'0001) == 0b01);
+      REQUIRE(uut(0b0001'0000) == 0b01);
+      REQUIRE(uut(0b0100'0000) == 0b01);
+      REQUIRE(uut(0b1011'0010) == (0b10 ^ 0b11 ^ 0b10));
+    }
+  }
+
+  GIVEN("A zero-width field") {
+    champsim::dram_address_field uut{6, 0, 0xff00};
+
+    THEN("The field is always zero") {
+      REQUIRE(uut(0xffff) == 0);
+    }
+  }
+}
+
+SCENARIO("Permutation-based interleaving spreads conflicting rows across banks") {
+  GIVEN("The permutation mapping") {
+    constexpr auto uut = champsim::dram_address_mapping::permutation();
+    constexpr auto baseline = champsim::dram_address_mapping::row_rank_column_bank_channel();
+
+    WHEN("Addresses that differ only in their row are mapped") {
+      std::set<uint64_t> banks, baseline_banks;
+      for (uint64_t row = 0; row < DRAM_BANKS; ++row) {
+        banks.insert(uut.bank(row << uut.row.shift));
+        baseline_banks.insert(baseline.bank(row << baseline.row.shift));
+      }
+
+      THEN("They map to different banks") {
+        REQUIRE(std::size(baseline_banks) == 1);
+        REQUIRE(std::size(banks) == DRAM_BANKS);
+      }
+    }
+
+    WHEN("Many addresses are mapped") {
+      std::set<std::tuple<uint64_t, uint64_t, uint64_t, uint64_t, uint64_t>> coordinates;
+      constexpr uint64_t count = 1 << 16;
+      for (uint64_t i = 0; i < count; ++i) {
+        auto address = i << LOG2_BLOCK_SIZE;
+        coordinates.insert({uut.channel(address), uut.rank(address), uut.bank(address), uut.row(address), uut.column(address)});
+      }
+
+      THEN("No two addresses share DRAM coordinates") {
+        REQUIRE(std::size(coordinates) == count);
+      }
+    }
+  }
+}
@@ -0,0 +1,143 @@
+#include <catch.hpp>
+
+#include "champsim_constants.h"
+#include "dram_controller.h"
+
+namespace
+{
+struct row_policy_fixture {
+  champsim::channel ul{};
+  MEMORY_CONTROLLER uut;
+
+  row_policy_fixture(champsim::dram_row_policy policy, double timeout)
+      : uut{MEMORY_CONTROLLER::Builder{}
+                .io_freq(3200)
+                .timing([] {
+                  champsim::dram_timing_parameters params;
+                  params.tRP = 12.5;
+                  params.tRCD = 12.5;
+                  params.tCAS = 12.5;
+                  return params;
+                }())
+                .row_policy(policy, timeout)
+                .upper_levels({&ul})}
+  {
+    uut.warmup = false;
+    uut.begin_phase();
+  }
+
+  void read(uint64_t row)
+  {
+    champsim::channel::request_type req;
+    req.address = (row << champsim::dram_address_mapping::row_rank_column_bank_channel().row.shift);
+    req.v_address = req.address;
+    ul.add_rq(req);
+
+    for (int i = 0; i < 200; ++i)
+      uut._operate();
+  }
+
+  auto& channel() { return uut.channels.at(0); }
+};
+} // namespace
+
+SCENARIO("An open-page controller leaves rows open") {
+  GIVEN("A controller with the open-page policy") {
+    row_policy_fixture fixture{champsim::dram_row_policy::OPEN, 0};
+
+    WHEN("A row is read") {
+      fixture.read(1);
+
+      THEN("The row stays open") {
+        REQUIRE(fixture.channel().bank_request.at(0).open_row == 1);
+        REQUIRE(fixture.channel().sim_stats.POLICY_PRECHARGES == 0);
+      }
+
+      AND_WHEN("A different row in the same bank is read") {
+        fixture.read(2);
+
+        THEN("The conflict is counted") {
+          REQUIRE(fixture.channel().sim_stats.CONFLICT_PRECHARGES == 1);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A closed-page controller closes rows once the bank is idle") {
+  GIVEN("A controller with the closed-page policy") {
+    row_policy_fixture fixture{champsim::dram_row_policy::CLOSED, 0};
+
+    WHEN("Two rows in the same bank are read") {
+      fixture.read(1);
+      fixture.read(2);
+
+      THEN("Each row is closed by the policy, and neither access conflicts") {
+        REQUIRE(fixture.channel().bank_request.at(0).open_row == std::numeric_limits<uint32_t>::max());
+        REQUIRE(fixture.channel().sim_stats.POLICY_PRECHARGES == 2);
+        REQUIRE(fixture.channel().sim_stats.CONFLICT_PRECHARGES == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("A timeout controller closes rows after the bank has been idle") {
+  GIVEN("A controller with a long timeout") {
+    row_policy_fixture fixture{champsim::dram_row_policy::TIMEOUT, 1000};
+
+    WHEN("A row is read") {
+      fixture.read(1);
+
+      THEN("The row is still open") {
+        REQUIRE(fixture.channel().bank_request.at(0).open_row == 1);
+      }
+
+      AND_WHEN("The timeout passes") {
+        for (int i = 0; i < 4000; ++i)
+          fixture.uut._operate();
+
+        THEN("The row is closed") {
+          REQUIRE(fixture.channel().bank_request.at(0).open_row == std::numeric_limits<uint32_t>::max());
+          REQUIRE(fixture.channel().sim_stats.POLICY_PRECHARGES == 1);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("The adaptive row policy learns whether to leave rows open") {
+  using access_result = champsim::row_buffer_policy::access_result;
+  GIVEN("An adaptive row policy") {
+    champsim::adaptive_row_policy uut;
+
+    THEN("Rows begin open") {
+      REQUIRE(uut.close_after(0, false, 10) == champsim::row_buffer_policy::NEVER);
+    }
+
+    WHEN("A bank sees repeated conflicts") {
+      for (int i = 0; i < 4; ++i)
+        uut.access(0, access_result::CONFLICT);
+
+      THEN("Its rows are closed once it is idle") {
+        REQUIRE(uut.close_after(0, false, 10) == 10);
+      }
+
+      THEN("Rows are left open for queued hits") {
+        REQUIRE(uut.close_after(0, true, 10) == champsim::row_buffer_policy::NEVER);
+      }
+
+      THEN("Other banks are unaffected") {
+        REQUIRE(uut.close_after(1, false, 10) == champsim::row_buffer_policy::NEVER);
+      }
+
+      AND_WHEN("The bank reopens the rows it closed") {
+        for (int i = 0; i < 4; ++i)
+          uut.access(0, access_result::CLOSED_REOPEN);
+
+        THEN("Its rows are left open again") {
+          REQUIRE(uut.close_after(0, false, 10) == champsim::row_buffer_policy::NEVER);
+        }
+      }
+    }
+  }
+}
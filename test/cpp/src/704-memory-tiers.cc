@@ -0,0 +1,71 @@
+#include <catch.hpp>
+
+#include <map>
+#include <string_view>
+
+#include "champsim_constants.h"
+#include "dram_controller.h"
+
+namespace
+{
+champsim::dram_timing_parameters basic_timing()
+{
+  champsim::dram_timing_parameters params;
+  params.tRP = 12.5;
+  params.tRCD = 12.5;
+  params.tCAS = 12.5;
+  return params;
+}
+} // namespace
+
+SCENARIO("Memory tiers serve the requests in their address ranges") {
+  GIVEN("Two memory controllers sharing an upper level, the second behind a slow link") {
+    champsim::channel ul{};
+    MEMORY_CONTROLLER near{MEMORY_CONTROLLER::Builder{}
+                               .name("NEAR")
+                               .io_freq(3200)
+                               .timing(basic_timing())
+                               .address_range(0, MEMORY_CONTROLLER::CAPACITY)
+                               .upper_levels({&ul})};
+    MEMORY_CONTROLLER far{MEMORY_CONTROLLER::Builder{}
+                              .name("FAR")
+                              .io_freq(3200)
+                              .timing(basic_timing())
+                              .address_range(MEMORY_CONTROLLER::CAPACITY, MEMORY_CONTROLLER::CAPACITY)
+                              .link_latency(100)
+                              .upper_levels({&ul})};
+    for (MEMORY_CONTROLLER& uut : {std::ref(near), std::ref(far)}) {
+      uut.warmup = false;
+      uut.begin_phase();
+    }
+
+    WHEN("A request to the far tier is followed by a request to the near tier") {
+      for (auto addr : {MEMORY_CONTROLLER::CAPACITY + BLOCK_SIZE, uint64_t{BLOCK_SIZE}}) {
+        champsim::channel::request_type req;
+        req.address = addr;
+        req.v_address = addr;
+        ul.add_rq(req);
+      }
+
+      std::map<std::string_view, uint64_t> return_cycle;
+      for (uint64_t cycle = 0; cycle < 2000; ++cycle) {
+        near._operate();
+        far._operate();
+        for (const auto& response : ul.returned)
+          return_cycle.try_emplace(response.served_by, cycle);
+      }
+
+      THEN("Each request is served by the controller for its address") {
+        REQUIRE(std::size(ul.returned) == 2);
+        REQUIRE(ul.returned.front().address == BLOCK_SIZE);
+        REQUIRE(ul.returned.front().served_by == "NEAR");
+        REQUIRE(ul.returned.back().address == MEMORY_CONTROLLER::CAPACITY + BLOCK_SIZE);
+        REQUIRE(ul.returned.back().served_by == "FAR");
+      }
+
+      THEN("The far request is delayed by the link latency") {
+        REQUIRE(return_cycle.at("FAR") - return_cycle.at("NEAR") >= 320);
+      }
+    }
+  }
+}
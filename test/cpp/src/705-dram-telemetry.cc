@@ -0,0 +1,100 @@
+#include <catch.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+#include "champsim_constants.h"
+#include "dram_controller.h"
+
+namespace
+{
+std::vector<std::vector<std::string>> read_csv(std::string filename)
+{
+  std::vector<std::vector<std::string>> rows;
+  std::ifstream in{filename};
+  for (std::string line; std::getline(in, line);) {
+    std::vector<std::string> row;
+    std::istringstream line_stream{line};
+    for (std::string field; std::getline(line_stream, field, ',');)
+      row.push_back(field);
+    rows.push_back(row);
+  }
+  return rows;
+}
+} // namespace
+
+SCENARIO("The memory controller records interval telemetry") {
+  GIVEN("A memory controller with telemetry enabled") {
+    auto filename = (std::filesystem::temp_directory_path() / "705-dram-telemetry.csv").string();
+    constexpr uint64_t interval = 100;
+    constexpr uint64_t num_reads = 4;
+
+    champsim::channel ul{};
+    champsim::dram_timing_parameters params;
+    params.tRP = 12.5;
+    params.tRCD = 12.5;
+    params.tCAS = 12.5;
+    MEMORY_CONTROLLER uut{MEMORY_CONTROLLER::Builder{}.io_freq(3200).timing(params).upper_levels({&ul})};
+    uut.telemetry = std::make_unique<champsim::dram_telemetry_writer>(filename, interval, uut.IO_FREQ);
+    uut.warmup = false;
+    uut.begin_phase();
+
+    WHEN("Reads are served") {
+      for (uint64_t i = 0; i < num_reads; ++i) {
+        champsim::channel::request_type req;
+        req.address = (i + 1) * BLOCK_SIZE;
+        req.v_address = req.address;
+        ul.add_rq(req);
+      }
+
+      for (uint64_t i = 0; i <= 10 * interval; ++i)
+        uut._operate();
+      uut.telemetry.reset();
+
+      auto rows = read_csv(filename);
+      REQUIRE_FALSE(std::empty(rows));
+      const auto& header = rows.front();
+      auto column = [&header](std::string name) {
+        return static_cast<std::size_t>(std::distance(std::begin(header), std::find(std::begin(header), std::end(header), name)));
+      };
+      auto total = [&rows](std::size_t col) {
+        return std::accumulate(std::next(std::begin(rows)), std::end(rows), uint64_t{0}, [col](auto acc, const auto& row) { return acc + std::stoull(row.at(col)); });
+      };
+
+      THEN("One row is written per channel per interval") {
+        REQUIRE(std::size(rows) == 1 + 10 * DRAM_CHANNELS);
+      }
+
+      THEN("The bytes read are recorded") {
+        REQUIRE(total(column("bytes_read")) == num_reads * BLOCK_SIZE);
+        REQUIRE(total(column("bytes_written")) == 0);
+      }
+
+      THEN("Each read is recorded in the latency histogram") {
+        uint64_t histogram_total = 0;
+        for (std::size_t i = 0; i < champsim::dram_interval_stats::LATENCY_BUCKETS; ++i)
+          histogram_total += total(column("read_latency_" + std::to_string(i)));
+        REQUIRE(histogram_total == num_reads);
+      }
+    }
+
+    WHEN("The phase ends partway through an interval") {
+      for (uint64_t i = 0; i < 10 * interval + interval / 2; ++i)
+        uut._operate();
+      uut.end_phase(0);
+      uut.telemetry.reset();
+
+      auto rows = read_csv(filename);
+
+      THEN("A row is written for the partial interval") {
+        REQUIRE(std::size(rows) == 1 + 11 * DRAM_CHANNELS);
+        REQUIRE(std::stoull(rows.back().at(2)) == uut.current_cycle);
+      }
+    }
+
+    std::remove(filename.c_str());
+  }
+}
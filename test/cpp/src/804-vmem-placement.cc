@@ -0,0 +1,98 @@
+#include <catch.hpp>
+#include "vmem.h"
+
+#include "dram_controller.h"
+
+namespace
+{
+struct tiered_fixture {
+  MEMORY_CONTROLLER fast{MEMORY_CONTROLLER::Builder{}.name("FAST").address_range(0, MEMORY_CONTROLLER::CAPACITY)};
+  MEMORY_CONTROLLER slow{MEMORY_CONTROLLER::Builder{}.name("SLOW").address_range(MEMORY_CONTROLLER::CAPACITY, MEMORY_CONTROLLER::CAPACITY)};
+
+  bool in_fast(uint64_t paddr) const { return paddr < MEMORY_CONTROLLER::CAPACITY; }
+};
+} // namespace
+
+SCENARIO("First-touch placement fills the fastest tier first") {
+  GIVEN("A virtual memory over two tiers") {
+    tiered_fixture tiers;
+    VirtualMemory uut{1 << 12, 5, 200, {tiers.fast, tiers.slow}, champsim::page_placement::FIRST_TOUCH, 0};
+
+    WHEN("Pages are touched") {
+      auto [paddr_a, delay_a] = uut.va_to_pa(0, 0);
+      auto [paddr_b, delay_b] = uut.va_to_pa(0, PAGE_SIZE);
+
+      THEN("Both pages are placed in the fast tier") {
+        REQUIRE(tiers.in_fast(paddr_a));
+        REQUIRE(tiers.in_fast(paddr_b));
+      }
+    }
+  }
+}
+
+SCENARIO("Interleaved placement alternates between tiers") {
+  GIVEN("A virtual memory over two tiers") {
+    tiered_fixture tiers;
+    VirtualMemory uut{1 << 12, 5, 200, {tiers.fast, tiers.slow}, champsim::page_placement::INTERLEAVE, 0};
+
+    WHEN("Pages are touched") {
+      auto [paddr_a, delay_a] = uut.va_to_pa(0, 0);
+      auto [paddr_b, delay_b] = uut.va_to_pa(0, PAGE_SIZE);
+      auto [paddr_c, delay_c] = uut.va_to_pa(0, 2 * PAGE_SIZE);
+
+      THEN("Consecutive pages are placed in alternating tiers") {
+        REQUIRE(tiers.in_fast(paddr_a));
+        REQUIRE_FALSE(tiers.in_fast(paddr_b));
+        REQUIRE(tiers.in_fast(paddr_c));
+      }
+    }
+  }
+}
+
+SCENARIO("Hot pages are promoted to the fastest tier") {
+  GIVEN("A virtual memory over two tiers with hot page placement") {
+    constexpr uint64_t threshold = 4;
+    tiered_fixture tiers;
+    VirtualMemory uut{1 << 12, 5, 200, {tiers.fast, tiers.slow}, champsim::page_placement::HOT_PAGE, threshold};
+
+    WHEN("A page is touched") {
+      auto [paddr, delay] = uut.va_to_pa(0, 0);
+
+      THEN("It is placed in the slow tier") {
+        REQUIRE_FALSE(tiers.in_fast(paddr));
+      }
+
+      AND_WHEN("It is accessed fewer times than the threshold") {
+        for (uint64_t i = 0; i < threshold - 1; ++i)
+          uut.record_access(paddr);
+
+        THEN("It stays in the slow tier") {
+          REQUIRE(uut.va_to_pa(0, 0).first == paddr);
+          REQUIRE(uut.promotions == 0);
+        }
+      }
+
+      AND_WHEN("It is accessed as many times as the threshold") {
+        for (uint64_t i = 0; i < threshold; ++i)
+          uut.record_access(paddr + i * BLOCK_SIZE);
+
+        auto [new_paddr, new_delay] = uut.va_to_pa(0, 0);
+        THEN("It is moved to the fast tier") {
+          REQUIRE(tiers.in_fast(new_paddr));
+          REQUIRE(new_delay == 0);
+          REQUIRE(uut.promotions == 1);
+        }
+
+        THEN("The old page is handed out again") {
+          REQUIRE(uut.va_to_pa(0, PAGE_SIZE).first == paddr);
+        }
+
+        THEN("Further accesses to the old page do not promote again") {
+          for (uint64_t i = 0; i < threshold; ++i)
+            uut.record_access(paddr);
+          REQUIRE(uut.promotions == 1);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,214 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+
+#include "champsim_constants.h"
+#include "dram_controller.h"
+#include "ptw.h"
+#include "vmem.h"
+
+#include <array>
+
+namespace
+{
+constexpr uint64_t huge_2M = (1ull << 21);
+constexpr uint64_t huge_1G = (1ull << 30);
+} // namespace
+
+SCENARIO("A fixed fraction of regions is mapped with huge pages") {
+  GIVEN("A virtual memory that maps every region with a 2MB page") {
+    MEMORY_CONTROLLER dram{MEMORY_CONTROLLER::Builder{}};
+    VirtualMemory uut{1 << 12, 5, 200, {dram}, champsim::page_placement::FIRST_TOUCH, 0, {champsim::huge_page_policy::FIXED, huge_2M, 100, 0}};
+
+    THEN("Unmapped pages are expected at the second level") {
+      REQUIRE(uut.huge_page_level == 2);
+      REQUIRE(uut.page_level(0, 0xdeadbeef) == 2);
+    }
+
+    WHEN("Two pages in the same region are touched") {
+      auto [paddr_a, delay_a] = uut.va_to_pa(0, 0x20'0000);
+      auto [paddr_b, delay_b] = uut.va_to_pa(0, 0x20'0000 + 5 * PAGE_SIZE + 0x123);
+
+      THEN("They are placed contiguously in one aligned huge page") {
+        REQUIRE((paddr_a & (huge_2M - 1)) == 0);
+        REQUIRE(paddr_b == paddr_a + 5 * PAGE_SIZE + 0x123);
+        REQUIRE(delay_a > 0);
+        REQUIRE(delay_b == 0);
+      }
+    }
+  }
+
+  GIVEN("A virtual memory that maps no region with a huge page") {
+    MEMORY_CONTROLLER dram{MEMORY_CONTROLLER::Builder{}};
+    VirtualMemory uut{1 << 12, 5, 200, {dram}, champsim::page_placement::FIRST_TOUCH, 0, {champsim::huge_page_policy::FIXED, huge_2M, 0, 0}};
+
+    WHEN("Two pages in the same region are touched") {
+      auto [paddr_a, delay_a] = uut.va_to_pa(0, 0);
+      auto [paddr_b, delay_b] = uut.va_to_pa(0, PAGE_SIZE);
+
+      THEN("Both are mapped with base pages") {
+        REQUIRE(uut.page_level(0, 0) == 1);
+        REQUIRE(delay_a > 0);
+        REQUIRE(delay_b > 0);
+      }
+    }
+  }
+}
+
+SCENARIO("Densely touched regions are promoted to huge pages") {
+  GIVEN("A virtual memory that promotes regions after four pages are touched") {
+    constexpr uint64_t threshold = 4;
+    MEMORY_CONTROLLER dram{MEMORY_CONTROLLER::Builder{}};
+    VirtualMemory uut{1 << 12, 5, 200, {dram}, champsim::page_placement::FIRST_TOUCH, 0, {champsim::huge_page_policy::PROMOTE, huge_2M, 0, threshold}};
+
+    WHEN("Fewer pages than the threshold are touched") {
+      for (uint64_t i = 0; i < threshold - 1; ++i)
+        (void)uut.va_to_pa(0, i * PAGE_SIZE);
+
+      THEN("The region is mapped with base pages") {
+        REQUIRE(uut.page_level(0, 0) == 1);
+        REQUIRE(uut.huge_page_promotions == 0);
+      }
+
+      THEN("The next new page is expected to be mapped with a huge page") {
+        REQUIRE(uut.page_level(0, (threshold - 1) * PAGE_SIZE) == 2);
+      }
+
+      AND_WHEN("One more page is touched") {
+        auto [paddr, delay] = uut.va_to_pa(0, (threshold - 1) * PAGE_SIZE);
+
+        THEN("The region is promoted") {
+          REQUIRE(uut.huge_page_promotions == 1);
+          REQUIRE(uut.page_level(0, 0) == 2);
+          REQUIRE(uut.va_to_pa(0, 0).first == paddr - (threshold - 1) * PAGE_SIZE);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Walks for huge pages end early") {
+  auto [huge_size, expected_steps] = GENERATE(table<uint64_t, std::size_t>({{huge_2M, 4}, {huge_1G, 3}}));
+
+  GIVEN("A 5-level virtual memory that maps every region with a huge page of " + std::to_string(huge_size) + " bytes") {
+    constexpr std::size_t levels = 5;
+    MEMORY_CONTROLLER dram{MEMORY_CONTROLLER::Builder{}};
+    VirtualMemory vmem{1 << 12, levels, 200, {dram}, champsim::page_placement::FIRST_TOUCH, 0, {champsim::huge_page_policy::FIXED, huge_size, 100, 0}};
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    PageTableWalker uut{PageTableWalker::Builder{champsim::defaults::default_ptw}
+      .name("805a-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .virtual_memory(&vmem)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ul, &uut, &mock_ll}};
+
+    uut.warmup = false;
+    uut.begin_phase();
+
+    WHEN("The PTW receives a request") {
+      decltype(mock_ul)::request_type test;
+      test.address = 0xdeadbeef;
+      test.v_address = test.address;
+      test.cpu = 0;
+
+      auto test_result = mock_ul.issue(test);
+      REQUIRE(test_result);
+
+      for (auto i = 0; i < 10000; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN(std::to_string(expected_steps) + " requests are issued") {
+        REQUIRE(mock_ll.packet_count() == expected_steps);
+        REQUIRE(mock_ul.packets.back().return_time > 0);
+      }
+    }
+  }
+}
+
+SCENARIO("A TLB entry for a huge page serves every page in it") {
+  GIVEN("A TLB backed by a walker over a virtual memory with 2MB pages") {
+    MEMORY_CONTROLLER dram{MEMORY_CONTROLLER::Builder{}};
+    VirtualMemory vmem{1 << 12, 5, 200, {dram}, champsim::page_placement::FIRST_TOUCH, 0, {champsim::huge_page_policy::FIXED, huge_2M, 100, 0}};
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    champsim::channel tlb_to_ptw{};
+    PageTableWalker ptw{PageTableWalker::Builder{champsim::defaults::default_ptw}
+      .name("805b-ptw")
+      .upper_levels({&tlb_to_ptw})
+      .lower_level(&mock_ll.queues)
+      .virtual_memory(&vmem)
+    };
+    CACHE uut{CACHE::Builder{champsim::defaults::default_stlb}
+      .name("805b-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&tlb_to_ptw)
+    };
+
+    // The upper level is not operated, so that its responses can be inspected
+    std::array<champsim::operable*, 3> elements{{&uut, &ptw, &mock_ll}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("Two pages in the same huge page are translated in turn") {
+      constexpr uint64_t first_address = 0x4020'1abc;
+      constexpr uint64_t second_address = first_address + 7 * PAGE_SIZE;
+
+      decltype(mock_ul)::request_type test;
+      test.address = first_address;
+      test.v_address = test.address;
+      test.cpu = 0;
+      REQUIRE(mock_ul.issue(test));
+
+      for (auto i = 0; i < 10000; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+      auto walk_steps = mock_ll.packet_count();
+
+      test.address = second_address;
+      test.v_address = test.address;
+      REQUIRE(mock_ul.issue(test));
+
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("The second translation hits without another walk") {
+        REQUIRE(mock_ll.packet_count() == walk_steps);
+        REQUIRE(uut.sim_stats.hits.at(champsim::to_underlying(access_type::LOAD)).at(0) == 1);
+      }
+
+      THEN("Each translation is for its own page") {
+        REQUIRE(std::size(mock_ul.queues.returned) == 2);
+        REQUIRE(mock_ul.queues.returned.at(0).page_bits == champsim::lg2(huge_2M));
+        REQUIRE(mock_ul.queues.returned.at(1).data == vmem.va_to_pa(0, second_address).first);
+      }
+    }
+
+    WHEN("A page is translated, and another page in the same huge page is invalidated") {
+      constexpr uint64_t first_address = 0x4020'1abc;
+      constexpr uint64_t second_address = first_address + 7 * PAGE_SIZE;
+
+      decltype(mock_ul)::request_type test;
+      test.address = first_address;
+      test.v_address = test.address;
+      test.cpu = 0;
+      REQUIRE(mock_ul.issue(test));
+
+      for (auto i = 0; i < 10000; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("The entry for the huge page is found") {
+        REQUIRE(uut.invalidate_entry(second_address) < uut.NUM_WAY);
+      }
+    }
+  }
+}
@@ -0,0 +1,130 @@
+#include <catch.hpp>
+#include "vmem.h"
+
+#include "dram_controller.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+namespace
+{
+std::vector<uint64_t> touch_pages(VirtualMemory& vmem, uint64_t count)
+{
+  std::vector<uint64_t> ppages;
+  for (uint64_t i = 0; i < count; ++i)
+    ppages.push_back(vmem.va_to_pa(0, i * PAGE_SIZE).first >> LOG2_PAGE_SIZE);
+  return ppages;
+}
+
+long count_adjacent(const std::vector<uint64_t>& ppages)
+{
+  long adjacent = 0;
+  for (std::size_t i = 1; i < std::size(ppages); ++i)
+    adjacent += (ppages[i] == ppages[i - 1] + 1);
+  return adjacent;
+}
+
+VirtualMemory make_vmem(MEMORY_CONTROLLER& dram, champsim::page_allocation_config allocation)
+{
+  return VirtualMemory{1 << 12, 5, 200, {dram}, champsim::page_placement::FIRST_TOUCH, 0, {}, allocation};
+}
+} // namespace
+
+SCENARIO("Sequential allocation gives consecutive pages adjacent frames") {
+  GIVEN("A virtual memory with sequential allocation") {
+    MEMORY_CONTROLLER dram{MEMORY_CONTROLLER::Builder{}};
+    auto uut = make_vmem(dram, {champsim::page_allocation::SEQUENTIAL, 0, 1, 16});
+
+    WHEN("Consecutive pages are touched") {
+      auto ppages = touch_pages(uut, 64);
+
+      THEN("Every page follows the last") {
+        REQUIRE(count_adjacent(ppages) == 63);
+      }
+    }
+  }
+}
+
+SCENARIO("Random allocation scatters consecutive pages") {
+  GIVEN("Two virtual memories with random allocation and the same seed") {
+    MEMORY_CONTROLLER dram{MEMORY_CONTROLLER::Builder{}};
+    auto uut = make_vmem(dram, {champsim::page_allocation::RANDOM, 42, 1, 16});
+    auto twin = make_vmem(dram, {champsim::page_allocation::RANDOM, 42, 1, 16});
+
+    WHEN("Consecutive pages are touched") {
+      auto ppages = touch_pages(uut, 256);
+
+      THEN("The frames are distinct and rarely adjacent") {
+        REQUIRE(std::size(std::set<uint64_t>(std::begin(ppages), std::end(ppages))) == std::size(ppages));
+        REQUIRE(count_adjacent(ppages) < 16);
+      }
+
+      THEN("The allocation is reproducible") {
+        REQUIRE(touch_pages(twin, 256) == ppages);
+      }
+    }
+  }
+}
+
+SCENARIO("Colored allocation matches the color of the virtual page") {
+  GIVEN("A virtual memory with colored allocation") {
+    constexpr uint64_t colors = 32;
+    MEMORY_CONTROLLER dram{MEMORY_CONTROLLER::Builder{}};
+    auto uut = make_vmem(dram, {champsim::page_allocation::COLORED, 0, colors, 16});
+
+    WHEN("Pages of arbitrary colors are touched") {
+      std::vector<uint64_t> vpages{3, 3 + colors, 17, 200, 1000, 1001, 5};
+      for (auto vpage : vpages) {
+        auto ppage = uut.va_to_pa(0, vpage * PAGE_SIZE).first >> LOG2_PAGE_SIZE;
+
+        THEN("Page " + std::to_string(vpage) + " has a frame of the same color") {
+          REQUIRE(ppage % colors == vpage % colors);
+        }
+      }
+    }
+
+    WHEN("Many pages of one color are touched, and then pages of the other colors") {
+      constexpr uint64_t count = 64;
+      std::vector<uint64_t> ppages;
+      for (uint64_t i = 0; i < count; ++i)
+        ppages.push_back(uut.va_to_pa(0, i * colors * PAGE_SIZE).first >> LOG2_PAGE_SIZE);
+      auto highest = *std::max_element(std::begin(ppages), std::end(ppages));
+
+      std::vector<uint64_t> other_ppages;
+      for (uint64_t color = 1; color < colors; ++color)
+        other_ppages.push_back(uut.va_to_pa(0, (count * colors + color) * PAGE_SIZE).first >> LOG2_PAGE_SIZE);
+
+      THEN("The pages of one color are distinct frames of that color") {
+        REQUIRE(std::size(std::set<uint64_t>(std::begin(ppages), std::end(ppages))) == count);
+        REQUIRE(std::all_of(std::begin(ppages), std::end(ppages), [](auto ppage) { return ppage % colors == 0; }));
+      }
+
+      THEN("The pages of the other colors take the frames that were passed over") {
+        REQUIRE(std::all_of(std::begin(other_ppages), std::end(other_ppages), [highest](auto ppage) { return ppage < highest; }));
+      }
+    }
+  }
+}
+
+SCENARIO("Fragmented allocation breaks memory into runs") {
+  GIVEN("A virtual memory with fragmented allocation") {
+    MEMORY_CONTROLLER dram{MEMORY_CONTROLLER::Builder{}};
+    auto uut = make_vmem(dram, {champsim::page_allocation::FRAGMENTED, 7, 1, 8});
+    auto available = uut.available_ppages();
+
+    WHEN("Consecutive pages are touched") {
+      auto ppages = touch_pages(uut, 256);
+
+      THEN("The frames are distinct, in runs separated by gaps") {
+        REQUIRE(std::size(std::set<uint64_t>(std::begin(ppages), std::end(ppages))) == std::size(ppages));
+        REQUIRE(count_adjacent(ppages) > 0);
+        REQUIRE(count_adjacent(ppages) < 255);
+      }
+
+      THEN("The gaps are not available to be allocated") {
+        REQUIRE(uut.available_ppages() < available - std::size(ppages));
+      }
+    }
+  }
+}
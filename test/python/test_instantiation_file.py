@@ -13,3 +13,52 @@ class VectorStringgTest(unittest.TestCase):
     def test_list_with_two(self):
         self.assertEqual(config.instantiation_file.vector_string(['a','b']), '{a, b}');
 
+
+class ModuleParametersStringTest(unittest.TestCase):
+
+    def test_empty(self):
+        self.assertEqual(config.instantiation_file.module_parameters_string({}), '{}');
+
+    def test_values_are_strings(self):
+        self.assertEqual(config.instantiation_file.module_parameters_string({'NUM_OFFSETS': 8, 'RATIO': 0.5, 'NAME': 'abc'}),
+                '{{"NUM_OFFSETS", "8"}, {"RATIO", "0.5"}, {"NAME", "abc"}}');
+
+    def test_booleans_are_lowercase(self):
+        self.assertEqual(config.instantiation_file.module_parameters_string({'ENABLE': True, 'DISABLE': False}),
+                '{{"ENABLE", "true"}, {"DISABLE", "false"}}');
+
+class PrefetchArbiterStringTest(unittest.TestCase):
+
+    def test_enabled_takes_defaults(self):
+        self.assertEqual(config.instantiation_file.prefetch_arbiter_string(True, [{'name': 'a'}]),
+                'champsim::prefetch_arbiter::config_type{champsim::prefetch_arbiter::policy::PRIORITY, 1, 64, 32, {CACHE::pa}}');
+
+    def test_prefetchers_keep_their_order(self):
+        self.assertEqual(config.instantiation_file.prefetch_arbiter_string({'policy': 'confidence', 'issue_budget': 2}, [{'name': 'b'}, {'name': 'a'}]),
+                'champsim::prefetch_arbiter::config_type{champsim::prefetch_arbiter::policy::CONFIDENCE, 2, 64, 32, {CACHE::pb, CACHE::pa}}');
+
+class PrefetchThrottleStringTest(unittest.TestCase):
+
+    def test_enabled_takes_defaults(self):
+        self.assertEqual(config.instantiation_file.prefetch_throttle_string(True),
+                'champsim::prefetch_throttle::config_type{8192, {1, 2, 4, 8, 16}, 0.75, 0.4, 0.01, 0.005, 0.75, 4096}');
+
+    def test_given_keys_replace_defaults(self):
+        self.assertEqual(config.instantiation_file.prefetch_throttle_string({'interval': 100, 'degrees': [2, 4]}),
+                'champsim::prefetch_throttle::config_type{100, {2, 4}, 0.75, 0.4, 0.01, 0.005, 0.75, 4096}');
+
+class PrefetchQueuePolicyStringTest(unittest.TestCase):
+
+    def test_given_keys_replace_defaults(self):
+        self.assertEqual(config.instantiation_file.prefetch_queue_policy_string({'drop_redundant': True, 'mshr_reserve': 2}),
+                'champsim::prefetch_queue_policy{0, 1, 0, 2}');
+
+class PrefetchSandboxStringTest(unittest.TestCase):
+
+    def test_enabled_takes_defaults(self):
+        self.assertEqual(config.instantiation_file.prefetch_sandbox_string(True),
+                'champsim::prefetch_sandbox::config_type{32768, 256, 8, 0.25}');
+
+    def test_given_keys_replace_defaults(self):
+        self.assertEqual(config.instantiation_file.prefetch_sandbox_string({'interval': 1000, 'accuracy_threshold': 0.5}),
+                'champsim::prefetch_sandbox::config_type{1000, 256, 8, 0.5}');
@@ -0,0 +1,54 @@
+import unittest
+
+import config.modules
+
+class DynamicDiscriminatorTests(unittest.TestCase):
+
+    def test_void_calls_each_selected_module(self):
+        lines = list(config.modules.get_dynamic_discriminator('fn', 'p_flags', [('pa', 'a_fn'), ('pb', 'b_fn')], (('uint64_t', 'x'),), classname='CACHE::dynamic_module_model'))
+        self.assertEqual(lines, [
+            'inline void CACHE::dynamic_module_model::impl_fn(uint64_t x)',
+            '{',
+            '  if ((p_flags & CACHE::pa) != 0) intern_->a_fn(x);',
+            '  if ((p_flags & CACHE::pb) != 0) intern_->b_fn(x);',
+            '}',
+            ''
+        ])
+
+    def test_nonvoid_joins_results(self):
+        lines = list(config.modules.get_dynamic_discriminator('fn', 'p_flags', [('pa', 'a_fn')], (('uint64_t', 'x'),), 'uint32_t', 'std::bit_xor', classname='CACHE::dynamic_module_model'))
+        self.assertIn('  std::bit_xor<decltype(result)> joiner{};', lines)
+        self.assertIn('  if ((p_flags & CACHE::pa) != 0) result = joiner(result, intern_->a_fn(x));', lines)
+        self.assertIn('  return result;', lines)
+
+    def test_prologue_precedes_each_call(self):
+        lines = list(config.modules.get_dynamic_discriminator('fn', 'p_flags', [('pa', 'a_fn')], (('uint64_t', 'x'),), classname='CACHE::dynamic_module_model', prologue='intern_->active = {classname}::{key};'))
+        self.assertIn('  if ((p_flags & CACHE::pa) != 0) { intern_->active = CACHE::pa; intern_->a_fn(x); }', lines)
+
+    def test_no_modules_leaves_arguments_unnamed(self):
+        lines = list(config.modules.get_dynamic_discriminator('fn', 'm_flags', [], (('uint64_t', 'x'),), 'uint64_t', 'champsim::detail::take_last', classname='O3_CPU::dynamic_module_model'))
+        self.assertEqual(lines, ['inline uint64_t O3_CPU::dynamic_module_model::impl_fn(uint64_t) { return {}; }', ''])
+
+class ModuleRegistryTests(unittest.TestCase):
+
+    def test_names_are_directory_names(self):
+        mod_data = [
+            { 'name': 'prefetcherDnext_line', 'fname': 'prefetcher/next_line' },
+            { 'name': 'HHDmyDpref', 'fname': '../my/pref/' }
+        ]
+        lines = list(config.modules.get_module_registry('prefetcher_registry', 'p', mod_data, 'CACHE'))
+        self.assertIn('    {"next_line", CACHE::pprefetcherDnext_line},', lines)
+        self.assertIn('    {"pref", CACHE::pHHDmyDpref},', lines)
+
+class CompiledModuleTests(unittest.TestCase):
+
+    def test_only_compiled_modules_are_dispatched_at_run_time(self):
+        pref_data = {
+            'a': { 'name': 'a', 'fname': 'prefetcher/a', 'func_map': { k: 'pref_a_'+k for k in ('prefetcher_initialize', 'prefetcher_cache_operate', 'prefetcher_cache_fill', 'prefetcher_cycle_operate', 'prefetcher_final_stats', 'prefetcher_branch_operate') } },
+            'b': { 'name': 'b', 'fname': 'prefetcher/b', 'func_map': { k: 'pref_b_'+k for k in ('prefetcher_initialize', 'prefetcher_cache_operate', 'prefetcher_cache_fill', 'prefetcher_cycle_operate', 'prefetcher_final_stats', 'prefetcher_branch_operate') } }
+        }
+        _, definitions = config.modules.get_cache_module_lines(pref_data, {}, compiled=['a'])
+        definitions = list(definitions)
+        self.assertIn('  if ((p_flags & CACHE::pa) != 0) { intern_->active_prefetcher = CACHE::pa; intern_->pref_a_prefetcher_initialize(); }', definitions)
+        self.assertNotIn('  if ((p_flags & CACHE::pb) != 0) { intern_->active_prefetcher = CACHE::pb; intern_->pref_b_prefetcher_initialize(); }', definitions)
+        self.assertIn('  if constexpr ((P_FLAG & CACHE::pb) != 0) { intern_->active_prefetcher = CACHE::pb; intern_->pref_b_prefetcher_initialize(); }', definitions)
@@ -136,7 +136,7 @@ class ParseNormalizedTests(unittest.TestCase):
                 'test_PTW': { 'name': 'test_PTW', 'lower_level': 'test_L1D' }
             }
 
-        result = config.parse.parse_normalized(config_cores, config_caches, config_ptws, {}, {}, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(config_cores, config_caches, config_ptws, {}, {}, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         cache_names = [core['L1I'] for core in result[0]['cores']]
         caches = result[0]['caches']
 
@@ -169,7 +169,7 @@ class ParseNormalizedTests(unittest.TestCase):
                 'test_PTW1': { 'name': 'test_PTW1', 'lower_level': 'test_L1D1' }
             }
 
-        result = config.parse.parse_normalized(config_cores, config_caches, config_ptws, {}, {}, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(config_cores, config_caches, config_ptws, {}, {}, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         cache_names = [core['L1I'] for core in result[0]['cores']]
         caches = result[0]['caches']
 
@@ -193,7 +193,7 @@ class ParseNormalizedTests(unittest.TestCase):
                 'test_PTW': { 'name': 'test_PTW', 'lower_level': 'test_L1D' }
             }
 #
-        result = config.parse.parse_normalized(config_cores, config_caches, config_ptws, {}, {}, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(config_cores, config_caches, config_ptws, {}, {}, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         cache_names = [core['L1I'] for core in result[0]['cores']] + [core['L1D'] for core in result[0]['cores']]
         caches = result[0]['caches']
 
@@ -227,7 +227,7 @@ class ParseNormalizedTests(unittest.TestCase):
                 'test_PTW1': { 'name': 'test_PTW1', 'lower_level': 'test_L1D1' }
             }
 
-        result = config.parse.parse_normalized(config_cores, config_caches, config_ptws, {}, {}, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(config_cores, config_caches, config_ptws, {}, {}, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         cache_names = [core['L1I'] for core in result[0]['cores']] + [core['L1D'] for core in result[0]['cores']]
         caches = result[0]['caches']
 
@@ -252,7 +252,7 @@ class ParseNormalizedTests(unittest.TestCase):
                 'test_PTW': { 'name': 'test_PTW', 'lower_level': 'test_L1D' }
             }
 
-        result = config.parse.parse_normalized(config_cores, config_caches, config_ptws, {}, {}, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(config_cores, config_caches, config_ptws, {}, {}, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         cache_names = [core['ITLB'] for core in result[0]['cores']] + [core['DTLB'] for core in result[0]['cores']]
         caches = result[0]['caches']
 
@@ -286,7 +286,7 @@ class ParseNormalizedTests(unittest.TestCase):
                 'test_PTW1': { 'name': 'test_PTW1', 'lower_level': 'test_L1D1' }
             }
 
-        result = config.parse.parse_normalized(config_cores, config_caches, config_ptws, {}, {}, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(config_cores, config_caches, config_ptws, {}, {}, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         cache_names = [core['ITLB'] for core in result[0]['cores']] + [core['DTLB'] for core in result[0]['cores']]
         caches = result[0]['caches']
 
@@ -311,7 +311,7 @@ class ParseNormalizedTests(unittest.TestCase):
                 'test_PTW': { 'name': 'test_PTW', 'lower_level': 'test_L1D' }
             }
 
-        result = config.parse.parse_normalized(config_cores, config_caches, config_ptws, {}, {}, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(config_cores, config_caches, config_ptws, {}, {}, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         for name in ('L1I', 'L1D', 'ITLB', 'DTLB'):
             cache_names_and_frequencies = [(core[name], core['frequency']) for core in result[0]['cores']]
             caches = result[0]['caches']
@@ -345,7 +345,7 @@ class ParseNormalizedTests(unittest.TestCase):
                 'test_PTW1': { 'name': 'test_PTW1', 'lower_level': 'test_L1D1' }
             }
 
-        result = config.parse.parse_normalized(config_cores, config_caches, config_ptws, {}, {}, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(config_cores, config_caches, config_ptws, {}, {}, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         for name in ('L1I', 'L1D', 'ITLB', 'DTLB'):
             cache_names_and_frequencies = [(core[name], core['frequency']) for core in result[0]['cores']]
             caches = result[0]['caches']
@@ -450,7 +450,7 @@ class NormalizeConfigTest(unittest.TestCase):
         self.assertEqual(vmem.get('__test__'), True)
 
     def test_core_params_are_moved_to_core_array(self):
-        core_keys_to_copy = ('frequency', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'rob_size', 'lq_size', 'sq_size', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width', 'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency', 'schedule_latency', 'execute_latency', 'branch_predictor', 'btb', 'DIB')
+        core_keys_to_copy = ('frequency', 'ftq_size', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'rob_size', 'lq_size', 'sq_size', 'prediction_width', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width', 'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency', 'schedule_latency', 'execute_latency', 'branch_predictor', 'btb', 'memory_dependence_predictor', 'memory_replay_penalty', 'execution_ports', 'DIB')
         for k in core_keys_to_copy:
             with self.subTest(key=k):
                 cores, caches, ptws, pmem, vmem = config.parse.normalize_config({ k: '__test__' })
@@ -480,32 +480,32 @@ class EnvironmentParseTests(unittest.TestCase):
 
     def test_cc_passes_through(self):
         test_config = { 'CC': 'cc' }
-        result = config.parse.parse_normalized(*self.base_config, test_config, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(*self.base_config, test_config, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         self.assertEqual(test_config, result[4])
 
     def test_cxx_passes_through(self):
         test_config = { 'CXX': 'cxx' }
-        result = config.parse.parse_normalized(*self.base_config, test_config, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(*self.base_config, test_config, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         self.assertEqual(test_config, result[4])
 
     def test_cppflags_passes_through(self):
         test_config = { 'CPPFLAGS': 'cppflags' }
-        result = config.parse.parse_normalized(*self.base_config, test_config, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(*self.base_config, test_config, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         self.assertEqual(test_config, result[4])
 
     def test_cxxflags_passes_through(self):
         test_config = { 'CXXFLAGS': 'cxxflags' }
-        result = config.parse.parse_normalized(*self.base_config, test_config, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(*self.base_config, test_config, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         self.assertEqual(test_config, result[4])
 
     def test_ldflags_passes_through(self):
         test_config = { 'LDFLAGS': 'ldflags' }
-        result = config.parse.parse_normalized(*self.base_config, test_config, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(*self.base_config, test_config, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         self.assertEqual(test_config, result[4])
 
     def test_ldlibs_passes_through(self):
         test_config = { 'LDLIBS': 'ldlibs' }
-        result = config.parse.parse_normalized(*self.base_config, test_config, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(*self.base_config, test_config, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         self.assertEqual(test_config, result[4])
 
 class ConfigRootPassthroughParseTests(unittest.TestCase):
@@ -532,19 +532,19 @@ class ConfigRootPassthroughParseTests(unittest.TestCase):
 
     def test_block_size_passes_through(self):
         test_config = { 'block_size': 27 }
-        result = config.parse.parse_normalized(*self.base_config, test_config, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(*self.base_config, test_config, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         self.assertIn('block_size', result[3])
         self.assertEqual(test_config.get('block_size'), result[3].get('block_size'))
 
     def test_page_size_passes_through(self):
         test_config = { 'page_size': 27 }
-        result = config.parse.parse_normalized(*self.base_config, test_config, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(*self.base_config, test_config, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         self.assertIn('page_size', result[3])
         self.assertEqual(test_config.get('page_size'), result[3].get('page_size'))
 
     def test_heartbeat_frequency_passes_through(self):
         test_config = { 'heartbeat_frequency': 27 }
-        result = config.parse.parse_normalized(*self.base_config, test_config, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(*self.base_config, test_config, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         self.assertIn('heartbeat_frequency', result[3])
         self.assertEqual(test_config.get('heartbeat_frequency'), result[3].get('heartbeat_frequency'))
 
@@ -580,64 +580,151 @@ class CompileAllModulesTests(unittest.TestCase):
     def test_no_compile_all_finds_given_branch(self):
         local_config = self.base_config
         local_config[0][0]['branch_predictor'] = 'test_branch'
-        result = config.parse.parse_normalized(*local_config, {}, FoundMoreContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(*local_config, {}, FoundMoreContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         self.assertIn('test_branch', result[1])
 
-        result_all = config.parse.parse_normalized(*local_config, {}, FoundMoreContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), True)
+        result_all = config.parse.parse_normalized(*local_config, {}, FoundMoreContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), True)
         self.assertIn('test_branch', result_all[1])
 
     def test_no_compile_all_finds_given_btb(self):
         local_config = self.base_config
         local_config[0][0]['btb'] = 'test_btb'
-        result = config.parse.parse_normalized(*local_config, {}, PassthroughContext(), FoundMoreContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(*local_config, {}, PassthroughContext(), FoundMoreContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         self.assertIn('test_btb', result[1])
 
-        result_all = config.parse.parse_normalized(*local_config, {}, PassthroughContext(), FoundMoreContext(), PassthroughContext(), PassthroughContext(), True)
+        result_all = config.parse.parse_normalized(*local_config, {}, PassthroughContext(), FoundMoreContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), True)
         self.assertIn('test_btb', result_all[1])
 
     def test_no_compile_all_finds_given_pref(self):
         local_config = self.base_config
         local_config[1]['test_L1D']['prefetcher'] = 'test_pref'
-        result = config.parse.parse_normalized(*local_config, {}, PassthroughContext(), PassthroughContext(), FoundMoreContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(*local_config, {}, PassthroughContext(), PassthroughContext(), FoundMoreContext(), PassthroughContext(), PassthroughContext(), False)
         self.assertIn('test_pref', result[1])
 
-        result_all = config.parse.parse_normalized(*local_config, {}, PassthroughContext(), PassthroughContext(), FoundMoreContext(), PassthroughContext(), True)
+        result_all = config.parse.parse_normalized(*local_config, {}, PassthroughContext(), PassthroughContext(), FoundMoreContext(), PassthroughContext(), PassthroughContext(), True)
         self.assertIn('test_pref', result_all[1])
 
     def test_no_compile_all_finds_given_repl(self):
         local_config = self.base_config
         local_config[1]['test_L1D']['replacement'] = 'test_repl'
-        result = config.parse.parse_normalized(*local_config, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), FoundMoreContext(), False)
+        result = config.parse.parse_normalized(*local_config, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), FoundMoreContext(), PassthroughContext(), False)
         self.assertIn('test_repl', result[1])
 
-        result_all = config.parse.parse_normalized(*local_config, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), FoundMoreContext(), True)
+        result_all = config.parse.parse_normalized(*local_config, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), FoundMoreContext(), PassthroughContext(), True)
         self.assertIn('test_repl', result_all[1])
 
+    def test_no_compile_all_finds_given_memdep(self):
+        local_config = self.base_config
+        local_config[0][0]['memory_dependence_predictor'] = 'test_memdep'
+        result = config.parse.parse_normalized(*local_config, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), FoundMoreContext(), False)
+        self.assertIn('test_memdep', result[1])
+
+        result_all = config.parse.parse_normalized(*local_config, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), FoundMoreContext(), True)
+        self.assertIn('test_memdep', result_all[1])
+
     def test_compile_all_finds_extra_branch(self):
-        result = config.parse.parse_normalized(*self.base_config, {}, FoundMoreContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(*self.base_config, {}, FoundMoreContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         self.assertNotIn('extra', result[1])
 
-        result_all = config.parse.parse_normalized(*self.base_config, {}, FoundMoreContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), True)
+        result_all = config.parse.parse_normalized(*self.base_config, {}, FoundMoreContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), True)
         self.assertIn('extra', result_all[1])
 
     def test_compile_all_finds_extra_btb(self):
-        result = config.parse.parse_normalized(*self.base_config, {}, PassthroughContext(), FoundMoreContext(), PassthroughContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(*self.base_config, {}, PassthroughContext(), FoundMoreContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
         self.assertNotIn('extra', result[1])
 
-        result_all = config.parse.parse_normalized(*self.base_config, {}, PassthroughContext(), FoundMoreContext(), PassthroughContext(), PassthroughContext(), True)
+        result_all = config.parse.parse_normalized(*self.base_config, {}, PassthroughContext(), FoundMoreContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), True)
         self.assertIn('extra', result_all[1])
 
     def test_compile_all_finds_extra_pref(self):
-        result = config.parse.parse_normalized(*self.base_config, {}, PassthroughContext(), PassthroughContext(), FoundMoreContext(), PassthroughContext(), False)
+        result = config.parse.parse_normalized(*self.base_config, {}, PassthroughContext(), PassthroughContext(), FoundMoreContext(), PassthroughContext(), PassthroughContext(), False)
         self.assertNotIn('extra', result[1])
 
-        result_all = config.parse.parse_normalized(*self.base_config, {}, PassthroughContext(), PassthroughContext(), FoundMoreContext(), PassthroughContext(), True)
+        result_all = config.parse.parse_normalized(*self.base_config, {}, PassthroughContext(), PassthroughContext(), FoundMoreContext(), PassthroughContext(), PassthroughContext(), True)
         self.assertIn('extra', result_all[1])
 
     def test_compile_all_finds_extra_repl(self):
-        result = config.parse.parse_normalized(*self.base_config, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), FoundMoreContext(), False)
+        result = config.parse.parse_normalized(*self.base_config, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), FoundMoreContext(), PassthroughContext(), False)
+        self.assertNotIn('extra', result[1])
+
+        result_all = config.parse.parse_normalized(*self.base_config, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), FoundMoreContext(), PassthroughContext(), True)
+        self.assertIn('extra', result_all[1])
+
+    def test_compile_all_finds_extra_memdep(self):
+        result = config.parse.parse_normalized(*self.base_config, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), FoundMoreContext(), False)
         self.assertNotIn('extra', result[1])
 
-        result_all = config.parse.parse_normalized(*self.base_config, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), FoundMoreContext(), True)
+        result_all = config.parse.parse_normalized(*self.base_config, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), FoundMoreContext(), True)
         self.assertIn('extra', result_all[1])
 
+class MemoryTierParseTests(unittest.TestCase):
+
+    def setUp(self):
+        self.base_config = (
+            [{
+                'name': 'test_cpu', 'L1I': 'test_L1I', 'L1D': 'test_L1D',
+                'ITLB': 'test_ITLB', 'DTLB': 'test_DTLB', 'PTW': 'test_PTW',
+                '_index': 0
+            }],
+            {
+                'test_L1I': { 'name': 'test_L1I', 'lower_level': 'DRAM' },
+                'test_L1D': { 'name': 'test_L1D', 'lower_level': 'DRAM' },
+                'test_ITLB': { 'name': 'test_ITLB', 'lower_level': 'test_PTW' },
+                'test_DTLB': { 'name': 'test_DTLB', 'lower_level': 'test_PTW' }
+            },
+            {
+                'test_PTW': { 'name': 'test_PTW', 'lower_level': 'test_L1D' }
+            }
+        )
+
+    def parse_pmem(self, pmem):
+        result = config.parse.parse_normalized(*self.base_config, pmem, {}, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        return result[0]['pmem']
+
+    def test_no_tiers_by_default(self):
+        pmem = self.parse_pmem({})
+        self.assertEqual(pmem['tiers'], [])
+
+    def test_tiers_inherit_from_physical_memory(self):
+        pmem = self.parse_pmem({ 'tCAS': 20, 'tiers': [{ 'name': 'CXL', 'link_latency': 70 }] })
+        self.assertEqual(pmem['tiers'][0]['name'], 'CXL')
+        self.assertEqual(pmem['tiers'][0]['link_latency'], 70)
+        self.assertEqual(pmem['tiers'][0]['tCAS'], 20)
+        self.assertEqual(pmem['link_latency'], 0)
+
+    def test_tiers_share_geometry(self):
+        pmem = self.parse_pmem({ 'tiers': [{ 'name': 'CXL', 'channels': 4 }] })
+        self.assertEqual(pmem['tiers'][0]['channels'], pmem['channels'])
+
+class PageColorParseTests(unittest.TestCase):
+
+    def setUp(self):
+        self.base_config = (
+            [{
+                'name': 'test_cpu', 'L1I': 'test_L1I', 'L1D': 'test_L1D',
+                'ITLB': 'test_ITLB', 'DTLB': 'test_DTLB', 'PTW': 'test_PTW',
+                '_index': 0
+            }],
+            {
+                'test_L1I': { 'name': 'test_L1I', 'lower_level': 'test_LLC' },
+                'test_L1D': { 'name': 'test_L1D', 'lower_level': 'test_LLC' },
+                'test_LLC': { 'name': 'test_LLC', 'sets': 4096, 'lower_level': 'DRAM' },
+                'test_ITLB': { 'name': 'test_ITLB', 'lower_level': 'test_PTW' },
+                'test_DTLB': { 'name': 'test_DTLB', 'lower_level': 'test_PTW' }
+            },
+            {
+                'test_PTW': { 'name': 'test_PTW', 'lower_level': 'test_L1D' }
+            }
+        )
+
+    def parse_vmem(self, vmem):
+        result = config.parse.parse_normalized(*self.base_config, {}, vmem, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), PassthroughContext(), False)
+        return result[0]['vmem']
+
+    def test_colors_follow_the_last_level_cache(self):
+        vmem = self.parse_vmem({})
+        self.assertEqual(vmem['page_colors'], 4096 * 64 // 4096)
+
+    def test_colors_can_be_given(self):
+        vmem = self.parse_vmem({ 'page_colors': 8 })
+        self.assertEqual(vmem['page_colors'], 8)